@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton implementation for Bison's Yacc-like parsers in C
+/* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -36,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -43,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "2.3"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -55,52 +57,22 @@
 /* Pure parsers.  */
 #define YYPURE 1
 
-/* Using locations.  */
-#define YYLSP_NEEDED 0
-
-/* Substitute the variable and function names.  */
-#define yyparse QL_parse
-#define yylex   QL_lex
-#define yyerror QL_error
-#define yylval  QL_lval
-#define yychar  QL_char
-#define yydebug QL_debug
-#define yynerrs QL_nerrs
-
-
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     ID = 258,
-     LOOKUP = 259,
-     FROM = 260,
-     TO = 261,
-     BOUND = 262,
-     CORN = 263,
-     BITFIELD = 264,
-     INTEGER = 265,
-     REAL = 266
-   };
-#endif
-/* Tokens.  */
-#define ID 258
-#define LOOKUP 259
-#define FROM 260
-#define TO 261
-#define BOUND 262
-#define CORN 263
-#define BITFIELD 264
-#define INTEGER 265
-#define REAL 266
+/* Push parsers.  */
+#define YYPUSH 0
 
+/* Pull parsers.  */
+#define YYPULL 1
 
 
+/* Substitute the variable and function names.  */
+#define yyparse         QL_parse
+#define yylex           QL_lex
+#define yyerror         QL_error
+#define yydebug         QL_debug
+#define yynerrs         QL_nerrs
 
-/* Copy the first part of user declarations.  */
-#line 1 "QL.y"
+/* First part of user prologue.  */
+#line 16 "QL.y"
 
 	#include<string.h>
 	#include<stdlib.h>
@@ -111,95 +83,276 @@
 	#include"QL.tab.h"
 	#include"lex.QL_.h"
 
-	#define YYERROR_VERBOSE
-	//#define YYLEX_PARAM scanner
-	//#define YYPARSE_PARAM yyscan_t scanner
-
-	void yyerror (yyscan_t,char*);
-
+	void yyerror (yyscan_t,lifo_t *const,double[],lifo_t *const,lifo_t *const,char const*);
 
 	extern int QL_lex (YYSTYPE *yylval_param, yyscan_t yyscanner);
-/*
-	lifo_t* stack;
-	double varray [BUFSIZ];
 
-	unsigned vindex = 0;
-	unsigned key_cardinality = 0;
-	unsigned predicates_cardinality = 0;
-*/
+	/**
+	 * Parsing state is kept per thread as the
+	 * server parses queries concurrently.
+	 */
+	static __thread unsigned vindex = 0;
+	static __thread unsigned key_cardinality = 0;
+	static __thread unsigned predicates_cardinality = 0;
+
+	static __thread double approximation_epsilon = 0;
+	static __thread double approximation_pages = 0;
+	static __thread double query_threads = 0;
+	static __thread double query_memory = 0;
+	static __thread double query_metrics = 0;
+	static __thread unsigned query_fields = 0;
+
+	static __thread char parse_error [BUFSIZ>>2];
+
+	/**
+	 * Maps the name of a query option, e.g. an approximation
+	 * knob, to its operation code, or 0 if unknown. The flag
+	 * "count" reports the number of results in place of them,
+	 * after any offset and limit are applied.
+	 */
+	static int query_option (char const*const name) {
+		if (!strcmp (name,"eps")) return EPSILON;
+		else if (!strcmp (name,"pages")) return PAGES;
+		else if (!strcmp (name,"threads")) return THREADS;
+		else if (!strcmp (name,"memory")) return MEMORY;
+		else if (!strcmp (name,"count")) return COUNT;
+		else if (!strcmp (name,"sample")) return SAMPLE;
+		else if (!strcmp (name,"metrics")) return METRICS;
+		else if (!strcmp (name,"limit")) return LIMIT;
+		else if (!strcmp (name,"offset")) return OFFSET;
+		else if (!strcmp (name,"fields")) return FIELDS;
+		else return 0;
+	}
 
+	/**
+	 * Adds a field to those reported for each result, where
+	 * fields are listed as in "fields=objects|keys|metrics".
+	 */
+	static boolean add_query_field (char *const name) {
+		unsigned const field = !strcmp (name,"objects") ? OBJECTS_FIELD
+					: !strcmp (name,"keys") ? KEYS_FIELD
+					: !strcmp (name,"metrics") ? METRICS_FIELD : 0;
+		free (name);
+		query_fields |= field;
+		return field != 0;
+	}
 
-/* Enabling traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
+	/**
+	 * The argument of a prepared query an identifier stands for,
+	 * where placeholders are written as '_' followed by the number
+	 * of the argument, starting from 1, or else 0.
+	 */
+	static long placeholder_argument (char const*const name) {
+		char* end = NULL;
+		long const argument = *name == '_' ? strtol (name+1,&end,10) : 0;
+		return argument > 0 && end != NULL && *end == '\0' ? argument : 0;
+	}
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
+	/**
+	 * Notes that the next value of a key is bound to an argument
+	 * of a prepared query. Placeholders stand for values of keys
+	 * only, including the number of neighbors of a bound, since
+	 * identifiers elsewhere name heapfiles, options or fields.
+	 */
+	static boolean push_placeholder (lifo_t *const placeholders, char *const name) {
+		long const argument = placeholder_argument (name);
+		boolean const is_placeholder = argument > 0;
+		free (name);
+		if (is_placeholder) {
+			insert_into_stack (placeholders,(void*)argument);
+			insert_into_stack (placeholders,(void*)(uint64_t)vindex);
+		}
+		return is_placeholder;
+	}
 
-/* Enabling the token table.  */
-#ifndef YYTOKEN_TABLE
-# define YYTOKEN_TABLE 1
-#endif
+	/**
+	 * Pushes the trailer of a query that is popped first when
+	 * the query is processed; i.e. the terminating symbol, the
+	 * type of the join, its threshold, its approximation, its
+	 * degree of parallelism, the megabytes of its results
+	 * kept in memory (0 for the server's defaults) and the
+	 * fields reported for each of its results.
+	 */
+	static void push_query_trailer (lifo_t *const stack, double varray[], void *const join_type, double const threshold) {
+		insert_into_stack (stack,varray+vindex);
+		varray [vindex++] = approximation_epsilon;
+		varray [vindex++] = approximation_pages;
+		varray [vindex++] = query_threads;
+		varray [vindex++] = query_memory;
+		varray [vindex++] = (query_fields ? query_fields : DEFAULT_FIELDS) | (query_metrics ? METRICS_FIELD : 0);
+
+		insert_into_stack (stack,varray+vindex);
+		insert_into_stack (stack,join_type);
+		insert_into_stack (stack,(void*)';');
+		varray [vindex++] = threshold;
+	}
 
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 37 "QL.y"
-{
-	char* str;
-	double dval;
-	int ival;
-}
-/* Line 193 of yacc.c.  */
-#line 161 "QL.tab.c"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
-# define YYSTYPE_IS_TRIVIAL 1
-#endif
+#line 191 "QL.tab.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
 
+#include "QL.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_ID = 3,                         /* ID  */
+  YYSYMBOL_LOOKUP = 4,                     /* LOOKUP  */
+  YYSYMBOL_FROM = 5,                       /* FROM  */
+  YYSYMBOL_TO = 6,                         /* TO  */
+  YYSYMBOL_BOUND = 7,                      /* BOUND  */
+  YYSYMBOL_CORN = 8,                       /* CORN  */
+  YYSYMBOL_EPSILON = 9,                    /* EPSILON  */
+  YYSYMBOL_PAGES = 10,                     /* PAGES  */
+  YYSYMBOL_THREADS = 11,                   /* THREADS  */
+  YYSYMBOL_MEMORY = 12,                    /* MEMORY  */
+  YYSYMBOL_COUNT = 13,                     /* COUNT  */
+  YYSYMBOL_SAMPLE = 14,                    /* SAMPLE  */
+  YYSYMBOL_METRICS = 15,                   /* METRICS  */
+  YYSYMBOL_LIMIT = 16,                     /* LIMIT  */
+  YYSYMBOL_OFFSET = 17,                    /* OFFSET  */
+  YYSYMBOL_FIELDS = 18,                    /* FIELDS  */
+  YYSYMBOL_BITFIELD = 19,                  /* BITFIELD  */
+  YYSYMBOL_INTEGER = 20,                   /* INTEGER  */
+  YYSYMBOL_REAL = 21,                      /* REAL  */
+  YYSYMBOL_22_ = 22,                       /* ';'  */
+  YYSYMBOL_23_ = 23,                       /* '/'  */
+  YYSYMBOL_24_ = 24,                       /* '%'  */
+  YYSYMBOL_25_ = 25,                       /* '?'  */
+  YYSYMBOL_26_ = 26,                       /* '='  */
+  YYSYMBOL_27_ = 27,                       /* ','  */
+  YYSYMBOL_28_ = 28,                       /* '&'  */
+  YYSYMBOL_YYACCEPT = 29,                  /* $accept  */
+  YYSYMBOL_QUERY = 30,                     /* QUERY  */
+  YYSYMBOL_COMMANDS = 31,                  /* COMMANDS  */
+  YYSYMBOL_COMMAND = 32,                   /* COMMAND  */
+  YYSYMBOL_rCOMMAND = 33,                  /* rCOMMAND  */
+  YYSYMBOL_rSUBQUERY = 34,                 /* rSUBQUERY  */
+  YYSYMBOL_cSUBQUERY = 35,                 /* cSUBQUERY  */
+  YYSYMBOL_SUBQUERY = 36,                  /* SUBQUERY  */
+  YYSYMBOL_PREDICATES = 37,                /* PREDICATES  */
+  YYSYMBOL_PREDICATE = 38,                 /* PREDICATE  */
+  YYSYMBOL_OPTIONS = 39,                   /* OPTIONS  */
+  YYSYMBOL_FIELD_LIST = 40,                /* FIELD_LIST  */
+  YYSYMBOL_OPTION = 41,                    /* OPTION  */
+  YYSYMBOL_rKEY = 42,                      /* rKEY  */
+  YYSYMBOL_DJOIN_PRED = 43,                /* DJOIN_PRED  */
+  YYSYMBOL_CP_PRED = 44,                   /* CP_PRED  */
+  YYSYMBOL_JOIN_PRED = 45,                 /* JOIN_PRED  */
+  YYSYMBOL_KEY = 46                        /* KEY  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-/* Copy the second part of user declarations.  */
 
 
-/* Line 216 of yacc.c.  */
-#line 174 "QL.tab.c"
 
 #ifdef short
 # undef short
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
-#else
-typedef unsigned char yytype_uint8;
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#elif (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
 typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef short int yytype_int8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -207,55 +360,106 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
 #  if ENABLE_NLS
 #   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
-#   define YY_(msgid) dgettext ("bison-runtime", msgid)
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
 #  endif
 # endif
 # ifndef YY_
-#  define YY_(msgid) msgid
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(e) ((void) (e))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(e) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-/* Identity function, used to suppress warnings about constant conditions.  */
-#ifndef lint
-# define YYID(n) (n)
-#else
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static int
-YYID (int i)
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
 #else
-static int
-YYID (i)
-    int i;
+# define YY_INITIAL_VALUE(Value) Value
 #endif
-{
-  return i;
-}
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
 #endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if 1
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -272,11 +476,11 @@ YYID (i)
 #    define alloca _alloca
 #   else
 #    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
 #     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#     ifndef _STDLIB_H
-#      define _STDLIB_H 1
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
 #     endif
 #    endif
 #   endif
@@ -284,8 +488,8 @@ YYID (i)
 # endif
 
 # ifdef YYSTACK_ALLOC
-   /* Pacify GCC's `empty if-body' warning.  */
-#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (YYID (0))
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
     /* The OS might guarantee only one guard page at the bottom of the stack,
        and a page size can be as small as 4096 bytes.  So we cannot safely
@@ -299,119 +503,125 @@ YYID (i)
 #  ifndef YYSTACK_ALLOC_MAXIMUM
 #   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
 #  endif
-#  if (defined __cplusplus && ! defined _STDLIB_H \
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
        && ! ((defined YYMALLOC || defined malloc) \
-	     && (defined YYFREE || defined free)))
+             && (defined YYFREE || defined free)))
 #   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-#   ifndef _STDLIB_H
-#    define _STDLIB_H 1
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
 #   endif
 #  endif
 #  ifndef YYMALLOC
 #   define YYMALLOC malloc
-#   if ! defined malloc && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined malloc && ! defined EXIT_SUCCESS
 void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 #  ifndef YYFREE
 #   define YYFREE free
-#   if ! defined free && ! defined _STDLIB_H && (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
+#   if ! defined free && ! defined EXIT_SUCCESS
 void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* 1 */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-	 || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss;
-  YYSTYPE yyvs;
-  };
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
       + YYSTACK_GAP_MAXIMUM)
 
-/* Copy COUNT objects from FROM to TO.  The source and destination do
-   not overlap.  */
-# ifndef YYCOPY
-#  if defined __GNUC__ && 1 < __GNUC__
-#   define YYCOPY(To, From, Count) \
-      __builtin_memcpy (To, From, (Count) * sizeof (*(From)))
-#  else
-#   define YYCOPY(To, From, Count)		\
-      do					\
-	{					\
-	  YYSIZE_T yyi;				\
-	  for (yyi = 0; yyi < (Count); yyi++)	\
-	    (To)[yyi] = (From)[yyi];		\
-	}					\
-      while (YYID (0))
-#  endif
-# endif
+# define YYCOPY_NEEDED 1
 
 /* Relocate STACK from its old location to the new one.  The
    local variables YYSIZE and YYSTACKSIZE give the old and new number of
    elements in the stack, and YYPTR gives the new location of the
    stack.  Advance YYPTR to a properly aligned location for the next
    stack.  */
-# define YYSTACK_RELOCATE(Stack)					\
-    do									\
-      {									\
-	YYSIZE_T yynewbytes;						\
-	YYCOPY (&yyptr->Stack, Stack, yysize);				\
-	Stack = &yyptr->Stack;						\
-	yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-	yyptr += yynewbytes / sizeof (*yyptr);				\
-      }									\
-    while (YYID (0))
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
 
 #endif
 
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
 /* YYFINAL -- State number of the termination state.  */
 #define YYFINAL  11
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   66
+#define YYLAST   98
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  19
+#define YYNTOKENS  29
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  14
+#define YYNNTS  18
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  37
-/* YYNRULES -- Number of states.  */
-#define YYNSTATES  64
+#define YYNRULES  57
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  99
 
-/* YYTRANSLATE(YYLEX) -- Bison symbol number corresponding to YYLEX.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   266
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   276
 
-#define YYTRANSLATE(YYX)						\
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
 
-/* YYTRANSLATE[YYLEX] -- Bison symbol number corresponding to YYLEX.  */
-static const yytype_uint8 yytranslate[] =
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,    14,    18,     2,
-       2,     2,     2,     2,    17,     2,     2,    13,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,    12,
-       2,    16,     2,    15,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,    24,    28,     2,
+       2,     2,     2,     2,    27,     2,     2,    23,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    22,
+       2,    26,     2,    25,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -431,260 +641,212 @@ static const yytype_uint8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
-       5,     6,     7,     8,     9,    10,    11
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21
 };
 
 #if YYDEBUG
-/* YYPRHS[YYN] -- Index of the first RHS symbol of rule number YYN in
-   YYRHS.  */
-static const yytype_uint8 yyprhs[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,     0,     3,     6,    10,    14,    19,    23,    28,    30,
-      33,    36,    38,    41,    44,    47,    50,    53,    56,    59,
-      61,    65,    69,    71,    75,    79,    83,    87,    91,    94,
-      97,   100,   103,   106,   109,   113,   117,   119
+       0,   182,   182,   186,   190,   194,   198,   202,   206,   210,
+     214,   218,   222,   226,   235,   236,   239,   240,   248,   249,
+     253,   254,   261,   262,   269,   280,   294,   298,   305,   310,
+     315,   320,   325,   338,   351,   362,   373,   383,   384,   388,
+     398,   411,   430,   449,   461,   462,   466,   467,   474,   475,
+     482,   483,   496,   501,   506,   515,   520,   525
 };
+#endif
 
-/* YYRHS -- A `-1'-separated list of the rules' RHS.  */
-static const yytype_int8 yyrhs[] =
-{
-      20,     0,    -1,    22,    12,    -1,    22,    13,    12,    -1,
-      21,    30,    12,    -1,    21,    30,    13,    12,    -1,    21,
-      31,    12,    -1,    21,    31,    13,    12,    -1,     1,    -1,
-      22,    22,    -1,    21,    22,    -1,    25,    -1,    23,    29,
-      -1,    25,    24,    -1,    23,    24,    -1,    14,    24,    -1,
-      14,    26,    -1,    13,    25,    -1,    13,    26,    -1,     3,
-      -1,     3,    15,    27,    -1,    27,    18,    28,    -1,    28,
-      -1,     4,    16,    32,    -1,     5,    16,    32,    -1,     6,
-      16,    32,    -1,     7,    16,    32,    -1,     8,    16,     9,
-      -1,    14,    29,    -1,    14,    32,    -1,    13,    30,    -1,
-      13,    11,    -1,    13,    31,    -1,    13,    10,    -1,    32,
-      17,    11,    -1,    32,    17,    10,    -1,    11,    -1,    10,
-      -1
-};
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
 
-/* YYRLINE[YYN] -- source line where rule number YYN was defined.  */
-static const yytype_uint8 yyrline[] =
-{
-       0,    67,    67,    74,    81,    88,    95,   102,   109,   118,
-     119,   122,   123,   131,   132,   136,   137,   144,   145,   152,
-     157,   165,   169,   176,   181,   186,   191,   196,   205,   206,
-     210,   211,   215,   216,   220,   225,   230,   235
-};
-#endif
+#if 1
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 
-#if YYDEBUG || YYERROR_VERBOSE || YYTOKEN_TABLE
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "ID", "LOOKUP", "FROM", "TO", "BOUND",
-  "CORN", "BITFIELD", "INTEGER", "REAL", "';'", "'/'", "'%'", "'?'", "'='",
-  "','", "'&'", "$accept", "QUERY", "COMMANDS", "COMMAND", "rCOMMAND",
-  "rSUBQUERY", "cSUBQUERY", "SUBQUERY", "PREDICATES", "PREDICATE", "rKEY",
-  "DJOIN_PRED", "CP_PRED", "KEY", 0
+  "\"end of file\"", "error", "\"invalid token\"", "ID", "LOOKUP", "FROM",
+  "TO", "BOUND", "CORN", "EPSILON", "PAGES", "THREADS", "MEMORY", "COUNT",
+  "SAMPLE", "METRICS", "LIMIT", "OFFSET", "FIELDS", "BITFIELD", "INTEGER",
+  "REAL", "';'", "'/'", "'%'", "'?'", "'='", "','", "'&'", "$accept",
+  "QUERY", "COMMANDS", "COMMAND", "rCOMMAND", "rSUBQUERY", "cSUBQUERY",
+  "SUBQUERY", "PREDICATES", "PREDICATE", "OPTIONS", "FIELD_LIST", "OPTION",
+  "rKEY", "DJOIN_PRED", "CP_PRED", "JOIN_PRED", "KEY", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[YYLEX-NUM] -- Internal token number corresponding to
-   token YYLEX-NUM.  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,    59,    47,    37,    63,    61,    44,    38
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-27)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-25)
 
-/* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
 {
-       0,    19,    20,    20,    20,    20,    20,    20,    20,    21,
-      21,    22,    22,    23,    23,    24,    24,    25,    25,    26,
-      26,    27,    27,    28,    28,    28,    28,    28,    29,    29,
-      30,    30,    31,    31,    32,    32,    32,    32
+      -1,   -27,     5,    39,    -9,    15,    27,    43,    24,   -27,
+     -27,   -27,     6,   -27,    25,    37,    41,   -27,     8,   -27,
+       0,   -27,   -27,     1,   -27,    50,    44,   -27,   -27,   -27,
+     -27,   -27,   -27,    53,    58,   -27,    56,    58,   -27,    57,
+      58,   -27,    47,   -27,   -27,   -27,   -27,   -27,    54,    59,
+      60,    61,    62,    63,    64,    52,   -27,    71,   -27,    66,
+     -16,   -27,   -27,   -15,   -27,   -12,    -2,    12,    14,    14,
+      14,    14,    65,    50,   -27,    20,   -27,    58,   -27,   -27,
+     -27,   -27,   -27,   -27,   -27,   -27,    79,   -27,    54,    54,
+      54,    54,   -27,   -27,   -27,   -27,    79,   -27,   -27
 };
 
-/* YYR2[YYN] -- Number of symbols composing right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       0,     2,     2,     3,     3,     4,     3,     4,     1,     2,
-       2,     1,     2,     2,     2,     2,     2,     2,     2,     1,
-       3,     3,     1,     3,     3,     3,     3,     3,     2,     2,
-       2,     2,     2,     2,     3,     3,     1,     1
+       0,    13,     0,     0,     0,     0,     0,    16,    24,    22,
+      23,     1,     0,    15,     0,     0,     0,     2,     0,    14,
+       0,    19,    17,     0,    18,     0,    24,    49,    47,    46,
+      48,    50,     4,     0,     0,     7,     0,     0,    10,     0,
+       0,     3,    57,    56,    55,    20,    21,    44,    45,    34,
+       0,     0,     0,     0,     0,    25,    27,     0,     5,     0,
+       0,    38,     8,     0,    11,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,    51,     0,     6,     0,     9,    12,
+      54,    53,    52,    40,    33,    32,    35,    57,    28,    29,
+      30,    31,    36,    26,    42,    41,    43,    37,    39
 };
 
-/* YYDEFACT[STATE-NAME] -- Default rule to reduce with in state
-   STATE-NUM when YYTABLE doesn't specify something else to do.  Zero
-   means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
 {
-       0,     8,     0,     0,     0,     0,     0,    11,    19,    17,
-      18,     1,     0,    10,     0,     0,     2,     0,     9,     0,
-      14,    12,     0,    13,     0,    33,    31,    30,    32,     4,
-       0,     6,     0,     3,    37,    36,    15,    16,    28,    29,
-       0,     0,     0,     0,     0,    20,    22,     5,     7,     0,
-       0,     0,     0,     0,     0,     0,    35,    34,    23,    24,
-      25,    26,    27,    21
+     -27,   -27,   -27,    69,   -27,    70,    34,   -18,   -27,    10,
+      28,    18,    17,    75,    84,    85,    86,   -26
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     3,     4,     5,     6,    36,     7,    10,    45,    46,
-      21,    14,    15,    39
+       0,     3,     4,     5,     6,    45,     7,    10,    55,    56,
+      60,    86,    61,    22,    14,    15,    16,    48
 };
 
-/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-   STATE-NUM.  */
-#define YYPACT_NINF -19
-static const yytype_int8 yypact[] =
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
 {
-       0,   -19,    18,     3,    -7,    24,    -6,     8,    15,   -19,
-     -19,   -19,     1,   -19,    26,    28,   -19,    16,   -19,     6,
-     -19,   -19,     4,   -19,    19,   -19,   -19,   -19,   -19,   -19,
-      36,   -19,    39,   -19,   -19,   -19,   -19,   -19,   -19,    35,
-      37,    38,    40,    41,    44,    45,   -19,   -19,   -19,    32,
-      34,    34,    34,    34,    46,    19,   -19,   -19,    35,    35,
-      35,    35,   -19,   -19
+       1,    80,    46,    42,     8,    46,    76,    78,     8,    26,
+      79,     8,    77,    77,    12,    83,    77,    87,    81,    82,
+      43,    44,     2,    83,    20,    23,    27,    28,     2,    12,
+      41,     2,    84,    85,    43,    44,     9,    17,    18,    11,
+      94,    95,    88,    89,    90,    91,     9,    32,    33,    25,
+      34,    20,     9,    49,    50,    51,    52,    53,    54,    35,
+      36,    59,    37,    38,    39,    63,    40,    23,    65,    25,
+      57,   -24,    25,    13,    19,    58,    21,    24,    62,    64,
+      73,    66,    98,    93,    92,    67,    68,    69,    70,    71,
+      72,    74,    75,    96,    97,    47,    29,    30,    31
 };
 
-/* YYPGOTO[NTERM-NUM].  */
-static const yytype_int8 yypgoto[] =
+static const yytype_int8 yycheck[] =
 {
-     -19,   -19,   -19,    42,   -19,    43,    -2,   -17,   -19,     7,
-      47,    49,    52,   -18
+       1,     3,    20,     3,     3,    23,    22,    22,     3,     3,
+      22,     3,    28,    28,    23,     3,    28,     3,    20,    21,
+      20,    21,    23,     3,    24,    24,    20,    21,    23,    23,
+      22,    23,    20,    21,    20,    21,     2,    22,    23,     0,
+      20,    21,    68,    69,    70,    71,    12,    22,    23,    25,
+      25,    24,    18,     3,     4,     5,     6,     7,     8,    22,
+      23,     3,    25,    22,    23,    37,    25,    24,    40,    25,
+      26,    24,    25,     4,     5,    22,     6,     7,    22,    22,
+      28,    27,     3,    73,    19,    26,    26,    26,    26,    26,
+      26,    20,    26,    75,    77,    20,    12,    12,    12
 };
 
-/* YYTABLE[YYPACT[STATE-NUM]].  What to do in state STATE-NUM.  If
-   positive, shift that token.  If negative, reduce the rule which
-   number is the opposite.  If zero, do what YYDEFACT says.
-   If YYTABLE_NINF, syntax error.  */
-#define YYTABLE_NINF -1
-static const yytype_uint8 yytable[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-       9,     1,    37,    11,     8,    37,    12,     8,    19,     8,
-       9,    25,    26,     2,    12,     9,    34,    35,    22,     8,
-      19,     8,    22,    40,    41,    42,    43,    44,    33,     2,
-      24,     2,    58,    59,    60,    61,    16,    17,    29,    30,
-      31,    32,    56,    57,    34,    35,    13,    18,    47,    20,
-      23,    48,    49,    50,    51,    62,    52,    53,     0,     0,
-      54,    27,    63,    55,    28,     0,    38
+       0,     1,    23,    30,    31,    32,    33,    35,     3,    35,
+      36,     0,    23,    32,    43,    44,    45,    22,    23,    32,
+      24,    34,    42,    24,    34,    25,     3,    20,    21,    43,
+      44,    45,    22,    23,    25,    22,    23,    25,    22,    23,
+      25,    22,     3,    20,    21,    34,    36,    42,    46,     3,
+       4,     5,     6,     7,     8,    37,    38,    26,    22,     3,
+      39,    41,    22,    39,    22,    39,    27,    26,    26,    26,
+      26,    26,    26,    28,    20,    26,    22,    28,    22,    22,
+       3,    20,    21,     3,    20,    21,    40,     3,    46,    46,
+      46,    46,    19,    38,    20,    21,    40,    41,     3
 };
 
-static const yytype_int8 yycheck[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       2,     1,    19,     0,     3,    22,    13,     3,    14,     3,
-      12,    10,    11,    13,    13,    17,    10,    11,    14,     3,
-      14,     3,    14,     4,     5,     6,     7,     8,    12,    13,
-      15,    13,    50,    51,    52,    53,    12,    13,    12,    13,
-      12,    13,    10,    11,    10,    11,     4,     5,    12,     6,
-       7,    12,    17,    16,    16,     9,    16,    16,    -1,    -1,
-      16,    12,    55,    18,    12,    -1,    19
+       0,    29,    30,    30,    30,    30,    30,    30,    30,    30,
+      30,    30,    30,    30,    31,    31,    32,    32,    33,    33,
+      34,    34,    35,    35,    36,    36,    37,    37,    38,    38,
+      38,    38,    38,    38,    38,    38,    38,    39,    39,    40,
+      40,    41,    41,    41,    42,    42,    43,    43,    44,    44,
+      45,    45,    46,    46,    46,    46,    46,    46
 };
 
-/* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-   symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,     1,    13,    20,    21,    22,    23,    25,     3,    25,
-      26,     0,    13,    22,    30,    31,    12,    13,    22,    14,
-      24,    29,    14,    24,    15,    10,    11,    30,    31,    12,
-      13,    12,    13,    12,    10,    11,    24,    26,    29,    32,
-       4,     5,     6,     7,     8,    27,    28,    12,    12,    17,
-      16,    16,    16,    16,    16,    18,    10,    11,    32,    32,
-      32,    32,     9,    28
+       0,     2,     2,     3,     3,     4,     5,     3,     4,     5,
+       3,     4,     5,     1,     2,     2,     1,     2,     2,     2,
+       2,     2,     2,     2,     1,     3,     3,     1,     3,     3,
+       3,     3,     3,     3,     1,     3,     3,     3,     1,     2,
+       1,     3,     3,     3,     2,     2,     2,     2,     2,     2,
+       2,     4,     3,     3,     3,     1,     1,     1
 };
 
-#define yyerrok		(yyerrstatus = 0)
-#define yyclearin	(yychar = YYEMPTY)
-#define YYEMPTY		(-2)
-#define YYEOF		0
 
-#define YYACCEPT	goto yyacceptlab
-#define YYABORT		goto yyabortlab
-#define YYERROR		goto yyerrorlab
+enum { YYENOMEM = -2 };
 
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
 
-/* Like YYERROR except do call yyerror.  This remains here temporarily
-   to ease the transition to the new meaning of YYERROR, for GCC.
-   Once GCC version 2 has supplanted version 1, this can go.  */
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
-#define YYFAIL		goto yyerrlab
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)					\
-do								\
-  if (yychar == YYEMPTY && yylen == 1)				\
-    {								\
-      yychar = (Token);						\
-      yylval = (Value);						\
-      yytoken = YYTRANSLATE (yychar);				\
-      YYPOPSTACK (1);						\
-      goto yybackup;						\
-    }								\
-  else								\
-    {								\
-      yyerror (scanner, YY_("syntax error: cannot back up")); \
-      YYERROR;							\
-    }								\
-while (YYID (0))
-
-
-#define YYTERROR	1
-#define YYERRCODE	256
-
-
-/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
-   If N is 0, then set CURRENT to the empty location which ends
-   the previous symbol: RHS[0] (always defined).  */
-
-#define YYRHSLOC(Rhs, K) ((Rhs)[K])
-#ifndef YYLLOC_DEFAULT
-# define YYLLOC_DEFAULT(Current, Rhs, N)				\
-    do									\
-      if (YYID (N))                                                    \
-	{								\
-	  (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;	\
-	  (Current).first_column = YYRHSLOC (Rhs, 1).first_column;	\
-	  (Current).last_line    = YYRHSLOC (Rhs, N).last_line;		\
-	  (Current).last_column  = YYRHSLOC (Rhs, N).last_column;	\
-	}								\
-      else								\
-	{								\
-	  (Current).first_line   = (Current).last_line   =		\
-	    YYRHSLOC (Rhs, 0).last_line;				\
-	  (Current).first_column = (Current).last_column =		\
-	    YYRHSLOC (Rhs, 0).last_column;				\
-	}								\
-    while (YYID (0))
-#endif
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (scanner, stack, varray, strings, placeholders, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
-   This macro was not mandated originally: define only if we know
-   we won't break user code: when these are the locations we know.  */
-
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
-#  define YY_LOCATION_PRINT(File, Loc)			\
-     fprintf (File, "%d.%d-%d.%d",			\
-	      (Loc).first_line, (Loc).first_column,	\
-	      (Loc).last_line,  (Loc).last_column)
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
-
-
-/* YYLEX -- calling `yylex' with the right arguments.  */
-
-#ifdef YYLEX_PARAM
-# define YYLEX yylex (&yylval, YYLEX_PARAM)
-#else
-# define YYLEX yylex (&yylval, scanner)
-#endif
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -694,83 +856,63 @@ while (YYID (0))
 #  define YYFPRINTF fprintf
 # endif
 
-# define YYDPRINTF(Args)			\
-do {						\
-  if (yydebug)					\
-    YYFPRINTF Args;				\
-} while (YYID (0))
-
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)			  \
-do {									  \
-  if (yydebug)								  \
-    {									  \
-      YYFPRINTF (stderr, "%s ", Title);					  \
-      yy_symbol_print (stderr,						  \
-		  Type, Value, scanner); \
-      YYFPRINTF (stderr, "\n");						  \
-    }									  \
-} while (YYID (0))
-
-
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
-
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, yyscan_t scanner)
-#else
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, scanner, stack, varray, strings, placeholders); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
 static void
-yy_symbol_value_print (yyoutput, yytype, yyvaluep, scanner)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-    yyscan_t scanner;
-#endif
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, yyscan_t scanner, lifo_t *const stack, double varray[], lifo_t *const strings, lifo_t *const placeholders)
 {
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (scanner);
+  YY_USE (stack);
+  YY_USE (varray);
+  YY_USE (strings);
+  YY_USE (placeholders);
   if (!yyvaluep)
     return;
-  YYUSE (scanner);
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# else
-  YYUSE (yyoutput);
-# endif
-  switch (yytype)
-    {
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, yyscan_t scanner)
-#else
-static void
-yy_symbol_print (yyoutput, yytype, yyvaluep, scanner)
-    FILE *yyoutput;
-    int yytype;
-    YYSTYPE const * const yyvaluep;
-    yyscan_t scanner;
-#endif
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, yyscan_t scanner, lifo_t *const stack, double varray[], lifo_t *const strings, lifo_t *const placeholders)
 {
-  if (yytype < YYNTOKENS)
-    YYFPRINTF (yyoutput, "token %s (", yytname[yytype]);
-  else
-    YYFPRINTF (yyoutput, "nterm %s (", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, scanner);
-  YYFPRINTF (yyoutput, ")");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, scanner, stack, varray, strings, placeholders);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -778,81 +920,68 @@ yy_symbol_print (yyoutput, yytype, yyvaluep, scanner)
 | TOP (included).                                                   |
 `------------------------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static void
-yy_stack_print (yytype_int16 *bottom, yytype_int16 *top)
-#else
 static void
-yy_stack_print (bottom, top)
-    yytype_int16 *bottom;
-    yytype_int16 *top;
-#endif
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
-  for (; bottom <= top; ++bottom)
-    YYFPRINTF (stderr, " %d", *bottom);
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
   YYFPRINTF (stderr, "\n");
 }
 
-# define YY_STACK_PRINT(Bottom, Top)				\
-do {								\
-  if (yydebug)							\
-    yy_stack_print ((Bottom), (Top));				\
-} while (YYID (0))
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
 
 
 /*------------------------------------------------.
 | Report that the YYRULE is going to be reduced.  |
 `------------------------------------------------*/
 
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yy_reduce_print (YYSTYPE *yyvsp, int yyrule, yyscan_t scanner)
-#else
-static void
-yy_reduce_print (yyvsp, yyrule, scanner)
-    YYSTYPE *yyvsp;
-    int yyrule;
-    yyscan_t scanner;
-#endif
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, yyscan_t scanner, lifo_t *const stack, double varray[], lifo_t *const strings, lifo_t *const placeholders)
 {
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  unsigned long int yylno = yyrline[yyrule];
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
-	     yyrule - 1, yylno);
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
-      fprintf (stderr, "   $%d = ", yyi + 1);
-      yy_symbol_print (stderr, yyrhs[yyprhs[yyrule] + yyi],
-		       &(yyvsp[(yyi + 1) - (yynrhs)])
-		       		       , scanner);
-      fprintf (stderr, "\n");
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], scanner, stack, varray, strings, placeholders);
+      YYFPRINTF (stderr, "\n");
     }
 }
 
-# define YY_REDUCE_PRINT(Rule)		\
-do {					\
-  if (yydebug)				\
-    yy_reduce_print (yyvsp, Rule, scanner); \
-} while (YYID (0))
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, scanner, stack, varray, strings, placeholders); \
+} while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
 
 
 /* YYINITDEPTH -- initial size of the parser's stacks.  */
-#ifndef	YYINITDEPTH
+#ifndef YYINITDEPTH
 # define YYINITDEPTH 200
 #endif
 
@@ -867,49 +996,81 @@ int yydebug;
 # define YYMAXDEPTH 10000
 #endif
 
-
 
-#if YYERROR_VERBOSE
+/* Context of a parse error.  */
+typedef struct
+{
+  yy_state_t *yyssp;
+  yysymbol_kind_t yytoken;
+} yypcontext_t;
+
+/* Put in YYARG at most YYARGN of the expected tokens given the
+   current YYCTX, and return the number of tokens stored in YYARG.  If
+   YYARG is null, return the number of expected tokens (guaranteed to
+   be less than YYNTOKENS).  Return YYENOMEM on memory exhaustion.
+   Return 0 if there are more than YYARGN expected tokens, yet fill
+   YYARG up to YYARGN. */
+static int
+yypcontext_expected_tokens (const yypcontext_t *yyctx,
+                            yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  int yyn = yypact[+*yyctx->yyssp];
+  if (!yypact_value_is_default (yyn))
+    {
+      /* Start YYX at -YYN if negative to avoid negative indexes in
+         YYCHECK.  In other words, skip the first -YYN actions for
+         this state because they are default actions.  */
+      int yyxbegin = yyn < 0 ? -yyn : 0;
+      /* Stay within bounds of both yycheck and yytname.  */
+      int yychecklim = YYLAST - yyn + 1;
+      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
+      int yyx;
+      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
+        if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yytable[yyx + yyn]))
+          {
+            if (!yyarg)
+              ++yycount;
+            else if (yycount == yyargn)
+              return 0;
+            else
+              yyarg[yycount++] = YY_CAST (yysymbol_kind_t, yyx);
+          }
+    }
+  if (yyarg && yycount == 0 && 0 < yyargn)
+    yyarg[0] = YYSYMBOL_YYEMPTY;
+  return yycount;
+}
 
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
+
+
+
+#ifndef yystrlen
+# if defined __GLIBC__ && defined _STRING_H
+#  define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
+# else
 /* Return the length of YYSTR.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-static YYSIZE_T
+static YYPTRDIFF_T
 yystrlen (const char *yystr)
-#else
-static YYSIZE_T
-yystrlen (yystr)
-    const char *yystr;
-#endif
 {
-  YYSIZE_T yylen;
+  YYPTRDIFF_T yylen;
   for (yylen = 0; yystr[yylen]; yylen++)
     continue;
   return yylen;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
+#ifndef yystpcpy
+# if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
+#  define yystpcpy stpcpy
+# else
 /* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
    YYDEST.  */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static char *
 yystpcpy (char *yydest, const char *yysrc)
-#else
-static char *
-yystpcpy (yydest, yysrc)
-    char *yydest;
-    const char *yysrc;
-#endif
 {
   char *yyd = yydest;
   const char *yys = yysrc;
@@ -919,10 +1080,10 @@ yystpcpy (yydest, yysrc)
 
   return yyd - 1;
 }
-#  endif
 # endif
+#endif
 
-# ifndef yytnamerr
+#ifndef yytnamerr
 /* Copy to YYRES the contents of YYSTR after stripping away unnecessary
    quotes and backslashes, so that it's suitable for yyerror.  The
    heuristic is that double-quoting is unnecessary unless the string
@@ -930,205 +1091,205 @@ yystpcpy (yydest, yysrc)
    backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
    null, do not copy; instead, return the length of what the result
    would have been.  */
-static YYSIZE_T
+static YYPTRDIFF_T
 yytnamerr (char *yyres, const char *yystr)
 {
   if (*yystr == '"')
     {
-      YYSIZE_T yyn = 0;
+      YYPTRDIFF_T yyn = 0;
       char const *yyp = yystr;
-
       for (;;)
-	switch (*++yyp)
-	  {
-	  case '\'':
-	  case ',':
-	    goto do_not_strip_quotes;
-
-	  case '\\':
-	    if (*++yyp != '\\')
-	      goto do_not_strip_quotes;
-	    /* Fall through.  */
-	  default:
-	    if (yyres)
-	      yyres[yyn] = *yyp;
-	    yyn++;
-	    break;
-
-	  case '"':
-	    if (yyres)
-	      yyres[yyn] = '\0';
-	    return yyn;
-	  }
+        switch (*++yyp)
+          {
+          case '\'':
+          case ',':
+            goto do_not_strip_quotes;
+
+          case '\\':
+            if (*++yyp != '\\')
+              goto do_not_strip_quotes;
+            else
+              goto append;
+
+          append:
+          default:
+            if (yyres)
+              yyres[yyn] = *yyp;
+            yyn++;
+            break;
+
+          case '"':
+            if (yyres)
+              yyres[yyn] = '\0';
+            return yyn;
+          }
     do_not_strip_quotes: ;
     }
 
-  if (! yyres)
+  if (yyres)
+    return yystpcpy (yyres, yystr) - yyres;
+  else
     return yystrlen (yystr);
-
-  return yystpcpy (yyres, yystr) - yyres;
 }
-# endif
+#endif
 
-/* Copy into YYRESULT an error message about the unexpected token
-   YYCHAR while in state YYSTATE.  Return the number of bytes copied,
-   including the terminating null byte.  If YYRESULT is null, do not
-   copy anything; just return the number of bytes that would be
-   copied.  As a special case, return 0 if an ordinary "syntax error"
-   message will do.  Return YYSIZE_MAXIMUM if overflow occurs during
-   size calculation.  */
-static YYSIZE_T
-yysyntax_error (char *yyresult, int yystate, int yychar)
-{
-  int yyn = yypact[yystate];
 
-  if (! (YYPACT_NINF < yyn && yyn <= YYLAST))
-    return 0;
-  else
+static int
+yy_syntax_error_arguments (const yypcontext_t *yyctx,
+                           yysymbol_kind_t yyarg[], int yyargn)
+{
+  /* Actual size of YYARG. */
+  int yycount = 0;
+  /* There are many possibilities here to consider:
+     - If this state is a consistent state with a default action, then
+       the only way this function was invoked is if the default action
+       is an error action.  In that case, don't check for expected
+       tokens because there are none.
+     - The only way there can be no lookahead present (in yychar) is if
+       this state is a consistent state with a default action.  Thus,
+       detecting the absence of a lookahead is sufficient to determine
+       that there is no unexpected or expected token to report.  In that
+       case, just report a simple "syntax error".
+     - Don't assume there isn't a lookahead just because this state is a
+       consistent state with a default action.  There might have been a
+       previous inconsistent state, consistent state with a non-default
+       action, or user semantic action that manipulated yychar.
+     - Of course, the expected token list depends on states to have
+       correct lookahead information, and it depends on the parser not
+       to perform extra reductions after fetching a lookahead from the
+       scanner and before detecting a syntax error.  Thus, state merging
+       (from LALR or IELR) and default reductions corrupt the expected
+       token list.  However, the list is correct for canonical LR with
+       one exception: it will still contain any token that will not be
+       accepted due to an error action in a later state.
+  */
+  if (yyctx->yytoken != YYSYMBOL_YYEMPTY)
     {
-      int yytype = YYTRANSLATE (yychar);
-      YYSIZE_T yysize0 = yytnamerr (0, yytname[yytype]);
-      YYSIZE_T yysize = yysize0;
-      YYSIZE_T yysize1;
-      int yysize_overflow = 0;
-      enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-      char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-      int yyx;
-
-# if 0
-      /* This is so xgettext sees the translatable formats that are
-	 constructed on the fly.  */
-      YY_("syntax error, unexpected %s");
-      YY_("syntax error, unexpected %s, expecting %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s");
-      YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s");
-# endif
-      char *yyfmt;
-      char const *yyf;
-      static char const yyunexpected[] = "syntax error, unexpected %s";
-      static char const yyexpecting[] = ", expecting %s";
-      static char const yyor[] = " or %s";
-      char yyformat[sizeof yyunexpected
-		    + sizeof yyexpecting - 1
-		    + ((YYERROR_VERBOSE_ARGS_MAXIMUM - 2)
-		       * (sizeof yyor - 1))];
-      char const *yyprefix = yyexpecting;
+      int yyn;
+      if (yyarg)
+        yyarg[yycount] = yyctx->yytoken;
+      ++yycount;
+      yyn = yypcontext_expected_tokens (yyctx,
+                                        yyarg ? yyarg + 1 : yyarg, yyargn - 1);
+      if (yyn == YYENOMEM)
+        return YYENOMEM;
+      else
+        yycount += yyn;
+    }
+  return yycount;
+}
 
-      /* Start YYX at -YYN if negative to avoid negative indexes in
-	 YYCHECK.  */
-      int yyxbegin = yyn < 0 ? -yyn : 0;
+/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
+   about the unexpected token YYTOKEN for the state stack whose top is
+   YYSSP.
 
-      /* Stay within bounds of both yycheck and yytname.  */
-      int yychecklim = YYLAST - yyn + 1;
-      int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-      int yycount = 1;
+   Return 0 if *YYMSG was successfully written.  Return -1 if *YYMSG is
+   not large enough to hold the message.  In that case, also set
+   *YYMSG_ALLOC to the required number of bytes.  Return YYENOMEM if the
+   required number of bytes is too large to store.  */
+static int
+yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
+                const yypcontext_t *yyctx)
+{
+  enum { YYARGS_MAX = 5 };
+  /* Internationalized format string. */
+  const char *yyformat = YY_NULLPTR;
+  /* Arguments of yyformat: reported tokens (one for the "unexpected",
+     one per "expected"). */
+  yysymbol_kind_t yyarg[YYARGS_MAX];
+  /* Cumulated lengths of YYARG.  */
+  YYPTRDIFF_T yysize = 0;
+
+  /* Actual size of YYARG. */
+  int yycount = yy_syntax_error_arguments (yyctx, yyarg, YYARGS_MAX);
+  if (yycount == YYENOMEM)
+    return YYENOMEM;
+
+  switch (yycount)
+    {
+#define YYCASE_(N, S)                       \
+      case N:                               \
+        yyformat = S;                       \
+        break
+    default: /* Avoid compiler warnings. */
+      YYCASE_(0, YY_("syntax error"));
+      YYCASE_(1, YY_("syntax error, unexpected %s"));
+      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
+      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
+      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
+      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
+#undef YYCASE_
+    }
 
-      yyarg[0] = yytname[yytype];
-      yyfmt = yystpcpy (yyformat, yyunexpected);
+  /* Compute error message size.  Don't count the "%s"s, but reserve
+     room for the terminator.  */
+  yysize = yystrlen (yyformat) - 2 * yycount + 1;
+  {
+    int yyi;
+    for (yyi = 0; yyi < yycount; ++yyi)
+      {
+        YYPTRDIFF_T yysize1
+          = yysize + yytnamerr (YY_NULLPTR, yytname[yyarg[yyi]]);
+        if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
+          yysize = yysize1;
+        else
+          return YYENOMEM;
+      }
+  }
 
-      for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-	if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR)
-	  {
-	    if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-	      {
-		yycount = 1;
-		yysize = yysize0;
-		yyformat[sizeof yyunexpected - 1] = '\0';
-		break;
-	      }
-	    yyarg[yycount++] = yytname[yyx];
-	    yysize1 = yysize + yytnamerr (0, yytname[yyx]);
-	    yysize_overflow |= (yysize1 < yysize);
-	    yysize = yysize1;
-	    yyfmt = yystpcpy (yyfmt, yyprefix);
-	    yyprefix = yyor;
-	  }
-
-      yyf = YY_(yyformat);
-      yysize1 = yysize + yystrlen (yyf);
-      yysize_overflow |= (yysize1 < yysize);
-      yysize = yysize1;
-
-      if (yysize_overflow)
-	return YYSIZE_MAXIMUM;
-
-      if (yyresult)
-	{
-	  /* Avoid sprintf, as that infringes on the user's name space.
-	     Don't have undefined behavior even if the translation
-	     produced a string with the wrong number of "%s"s.  */
-	  char *yyp = yyresult;
-	  int yyi = 0;
-	  while ((*yyp = *yyf) != '\0')
-	    {
-	      if (*yyp == '%' && yyf[1] == 's' && yyi < yycount)
-		{
-		  yyp += yytnamerr (yyp, yyarg[yyi++]);
-		  yyf += 2;
-		}
-	      else
-		{
-		  yyp++;
-		  yyf++;
-		}
-	    }
-	}
-      return yysize;
+  if (*yymsg_alloc < yysize)
+    {
+      *yymsg_alloc = 2 * yysize;
+      if (! (yysize <= *yymsg_alloc
+             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
+        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
+      return -1;
     }
+
+  /* Avoid sprintf, as that infringes on the user's name space.
+     Don't have undefined behavior even if the translation
+     produced a string with the wrong number of "%s"s.  */
+  {
+    char *yyp = *yymsg;
+    int yyi = 0;
+    while ((*yyp = *yyformat) != '\0')
+      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
+        {
+          yyp += yytnamerr (yyp, yytname[yyarg[yyi++]]);
+          yyformat += 2;
+        }
+      else
+        {
+          ++yyp;
+          ++yyformat;
+        }
+  }
+  return 0;
 }
-#endif /* YYERROR_VERBOSE */
-
+
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
-/*ARGSUSED*/
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, yyscan_t scanner)
-#else
-static void
-yydestruct (yymsg, yytype, yyvaluep, scanner)
-    const char *yymsg;
-    int yytype;
-    YYSTYPE *yyvaluep;
-    yyscan_t scanner;
-#endif
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, yyscan_t scanner, lifo_t *const stack, double varray[], lifo_t *const strings, lifo_t *const placeholders)
 {
-  YYUSE (yyvaluep);
-  YYUSE (scanner);
-
+  YY_USE (yyvaluep);
+  YY_USE (scanner);
+  YY_USE (stack);
+  YY_USE (varray);
+  YY_USE (strings);
+  YY_USE (placeholders);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
-  switch (yytype)
-    {
-
-      default:
-	break;
-    }
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
-
-
-/* Prevent warnings from -Wmissing-prototypes.  */
-
-#ifdef YYPARSE_PARAM
-#if defined __STDC__ || defined __cplusplus
-int yyparse (void *YYPARSE_PARAM, lifo_t *const stack, double varray[]);
-#else
-int yyparse (lifo_t *const stack, double varray[]);
-#endif
-#else /* ! YYPARSE_PARAM */
-#if defined __STDC__ || defined __cplusplus
-int yyparse (yyscan_t scanner, lifo_t *const stack, double varray[]);
-#else
-int yyparse (lifo_t *const stack, double varray[]);
-#endif
-#endif /* ! YYPARSE_PARAM */
 
 
 
@@ -1139,83 +1300,57 @@ int yyparse (lifo_t *const stack, double varray[]);
 | yyparse.  |
 `----------*/
 
-#ifdef YYPARSE_PARAM
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
-int
-yyparse (void *YYPARSE_PARAM, lifo_t *const stack, double varray[])
-#else
-int
-yyparse (YYPARSE_PARAM)
-    void *YYPARSE_PARAM;
-#endif
-#else /* ! YYPARSE_PARAM */
-#if (defined __STDC__ || defined __C99__FUNC__ \
-     || defined __cplusplus || defined _MSC_VER)
 int
-yyparse (yyscan_t scanner, lifo_t *const stack, double varray[])
-#else
-int
-yyparse (scanner)
-    yyscan_t scanner;
-#endif
-#endif
+yyparse (yyscan_t scanner, lifo_t *const stack, double varray[], lifo_t *const strings, lifo_t *const placeholders)
 {
-	unsigned vindex = 0;
-	unsigned key_cardinality = 0;
-	unsigned predicates_cardinality = 0;
-
-  /* The look-ahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
-/* The semantic value of the look-ahead symbol.  */
-YYSTYPE yylval;
 
-/* Number of syntax errors so far.  */
-int yynerrs;
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
-  int yystate;
-  int yyn;
-  int yyresult;
-  /* Number of tokens to shift before error messages enabled.  */
-  int yyerrstatus;
-  /* Look-ahead token as an internal (translated) token number.  */
-  int yytoken = 0;
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
-
-  /* Three stacks and their tools:
-     `yyss': related to states,
-     `yyvs': related to semantic values,
-     `yyls': related to locations.
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
 
-     Refer to the stacks thru separate pointers, to allow yyoverflow
-     to reallocate them elsewhere.  */
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
 
-  /* The state stack.  */
-  yytype_int16 yyssa[YYINITDEPTH];
-  yytype_int16 *yyss = yyssa;
-  yytype_int16 *yyssp;
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
 
-  /* The semantic value stack.  */
-  YYSTYPE yyvsa[YYINITDEPTH];
-  YYSTYPE *yyvs = yyvsa;
-  YYSTYPE *yyvsp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
-
-  YYSIZE_T yystacksize = YYINITDEPTH;
-
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
 
+  /* Buffer for error messages, and its allocated size.  */
+  char yymsgbuf[128];
+  char *yymsg = yymsgbuf;
+  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
 
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
@@ -1223,128 +1358,155 @@ int yynerrs;
 
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
-  yychar = YYEMPTY;		/* Cause a token to be read.  */
+  yychar = YYEMPTY; /* Cause a token to be read.  */
 
-  /* Initialize stack pointers.
-     Waste one element of value and location stack
-     so that they stay on the same level as the state stack.
-     The wasted elements are never initialized.  */
 
-  yyssp = yyss;
-  yyvsp = yyvs;
+/* User initialization code.  */
+#line 139 "QL.y"
+{
+	vindex = 0;
+	key_cardinality = 0;
+	predicates_cardinality = 0;
+	approximation_epsilon = 0;
+	approximation_pages = 0;
+	query_threads = 0;
+	query_memory = 0;
+	query_metrics = 0;
+	query_fields = 0;
+}
+
+#line 1379 "QL.tab.c"
 
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
-	/* Give user a chance to reallocate the stack.  Use copies of
-	   these so that the &'s don't force the real ones into
-	   memory.  */
-	YYSTYPE *yyvs1 = yyvs;
-	yytype_int16 *yyss1 = yyss;
-
-
-	/* Each stack pointer address is followed by the size of the
-	   data in use in that stack, in bytes.  This used to be a
-	   conditional around just the two extra args, but that might
-	   be undefined if yyoverflow is a macro.  */
-	yyoverflow (YY_("memory exhausted"),
-		    &yyss1, yysize * sizeof (*yyssp),
-		    &yyvs1, yysize * sizeof (*yyvsp),
-
-		    &yystacksize);
-
-	yyss = yyss1;
-	yyvs = yyvs1;
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-	goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
-	yystacksize = YYMAXDEPTH;
+        yystacksize = YYMAXDEPTH;
 
       {
-	yytype_int16 *yyss1 = yyss;
-	union yyalloc *yyptr =
-	  (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
-	if (! yyptr)
-	  goto yyexhaustedlab;
-	YYSTACK_RELOCATE (yyss);
-	YYSTACK_RELOCATE (yyvs);
-
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
 #  undef YYSTACK_RELOCATE
-	if (yyss1 != yyssa)
-	  YYSTACK_FREE (yyss1);
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
 
-
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-		  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
-	YYABORT;
+        YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
-     look-ahead token if we need one and don't already have one.  */
+     lookahead token if we need one and don't already have one.  */
 
-  /* First try to decide what to do without reference to look-ahead token.  */
+  /* First try to decide what to do without reference to lookahead token.  */
   yyn = yypact[yystate];
-  if (yyn == YYPACT_NINF)
+  if (yypact_value_is_default (yyn))
     goto yydefault;
 
-  /* Not known => get a look-ahead token if don't already have one.  */
+  /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid look-ahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = YYLEX;
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex (&yylval, scanner);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1359,30 +1521,26 @@ yybackup:
   yyn = yytable[yyn];
   if (yyn <= 0)
     {
-      if (yyn == 0 || yyn == YYTABLE_NINF)
-	goto yyerrlab;
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
       yyn = -yyn;
       goto yyreduce;
     }
 
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
   /* Count tokens shifted since error; after three, turn off error
      status.  */
   if (yyerrstatus)
     yyerrstatus--;
 
-  /* Shift the look-ahead token.  */
+  /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token unless it is eof.  */
-  if (yychar != YYEOF)
-    yychar = YYEMPTY;
-
   yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1397,14 +1555,14 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
   yylen = yyr2[yyn];
 
   /* If YYLEN is nonzero, implement the default value of the action:
-     `$$ = $1'.
+     '$$ = $1'.
 
      Otherwise, the following line sets YYVAL to garbage.
      This behavior is undocumented and Bison
@@ -1417,384 +1575,692 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 67 "QL.y"
-    {
+  case 2: /* QUERY: COMMAND ';'  */
+#line 182 "QL.y"
+                        {
 						LOG (debug,"SINGLE COMMAND ';' ENCOUNTERED. \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,';');
-						varray [vindex++] = 0;
-					;}
+						push_query_trailer (stack,varray,NULL,0);
+					}
+#line 1585 "QL.tab.c"
     break;
 
-  case 3:
-#line 74 "QL.y"
-    {
+  case 3: /* QUERY: COMMAND '/' ';'  */
+#line 186 "QL.y"
+                          {
 						LOG (debug,"SINGLE COMMAND '/;' ENCOUNTERED. \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,';');
-						varray [vindex++] = 0;
-					;}
+						push_query_trailer (stack,varray,NULL,0);
+					}
+#line 1594 "QL.tab.c"
     break;
 
-  case 4:
-#line 81 "QL.y"
-    {
+  case 4: /* QUERY: COMMANDS DJOIN_PRED ';'  */
+#line 190 "QL.y"
+                                  {
 						LOG (debug,"DISTANCE JOIN. \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,';');
-						varray [vindex++] = (yyvsp[(3) - (3)].dval);
-					;}
+						push_query_trailer (stack,varray,NULL,(yyvsp[-1].dval));
+					}
+#line 1603 "QL.tab.c"
     break;
 
-  case 5:
-#line 88 "QL.y"
-    {
+  case 5: /* QUERY: COMMANDS DJOIN_PRED '/' ';'  */
+#line 194 "QL.y"
+                                      {
 						LOG (debug,"DISTANCE JOIN/ . \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,';');
-						varray [vindex++] = (yyvsp[(3) - (4)].dval);
-					;}
+						push_query_trailer (stack,varray,NULL,(yyvsp[-2].dval));
+					}
+#line 1612 "QL.tab.c"
     break;
 
-  case 6:
-#line 95 "QL.y"
-    {
+  case 6: /* QUERY: COMMANDS DJOIN_PRED '?' OPTIONS ';'  */
+#line 198 "QL.y"
+                                              {
+						LOG (debug,"APPROXIMATE DISTANCE JOIN. \n");
+						push_query_trailer (stack,varray,NULL,(yyvsp[-3].dval));
+					}
+#line 1621 "QL.tab.c"
+    break;
+
+  case 7: /* QUERY: COMMANDS CP_PRED ';'  */
+#line 202 "QL.y"
+                                {
 						LOG (debug,"CLOSEST PAIRS. \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,(void*)0xffffffffffffffff);
-						insert_into_stack (stack,';');
-						varray [vindex++] = (yyvsp[(3) - (3)].ival);
-					;}
+						push_query_trailer (stack,varray,(void*)0xffffffffffffffff,(yyvsp[-1].ival));
+					}
+#line 1630 "QL.tab.c"
     break;
 
-  case 7:
-#line 102 "QL.y"
-    {
+  case 8: /* QUERY: COMMANDS CP_PRED '/' ';'  */
+#line 206 "QL.y"
+                                        {
 						LOG (debug,"CLOSEST PAIRS/ . \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,(void*)0xffffffffffffffff);
-						insert_into_stack (stack,';');
-						varray [vindex++] = (yyvsp[(3) - (4)].ival);
-					;}
+						push_query_trailer (stack,varray,(void*)0xffffffffffffffff,(yyvsp[-2].ival));
+					}
+#line 1639 "QL.tab.c"
     break;
 
-  case 8:
-#line 109 "QL.y"
-    {
+  case 9: /* QUERY: COMMANDS CP_PRED '?' OPTIONS ';'  */
+#line 210 "QL.y"
+                                                {
+						LOG (debug,"APPROXIMATE CLOSEST PAIRS. \n");
+						push_query_trailer (stack,varray,(void*)0xffffffffffffffff,(yyvsp[-3].ival));
+					}
+#line 1648 "QL.tab.c"
+    break;
+
+  case 10: /* QUERY: COMMANDS JOIN_PRED ';'  */
+#line 214 "QL.y"
+                                        {
+						LOG (debug,"kNN JOIN. \n");
+						push_query_trailer (stack,varray,(void*)'k',(yyvsp[-1].ival));
+					}
+#line 1657 "QL.tab.c"
+    break;
+
+  case 11: /* QUERY: COMMANDS JOIN_PRED '/' ';'  */
+#line 218 "QL.y"
+                                        {
+						LOG (debug,"kNN JOIN/ . \n");
+						push_query_trailer (stack,varray,(void*)'k',(yyvsp[-2].ival));
+					}
+#line 1666 "QL.tab.c"
+    break;
+
+  case 12: /* QUERY: COMMANDS JOIN_PRED '?' OPTIONS ';'  */
+#line 222 "QL.y"
+                                                {
+						LOG (debug,"kNN JOIN WITH OPTIONS. \n");
+						push_query_trailer (stack,varray,(void*)'k',(yyvsp[-3].ival));
+					}
+#line 1675 "QL.tab.c"
+    break;
+
+  case 13: /* QUERY: error  */
+#line 226 "QL.y"
+                                        {
 						LOG (error,"Erroneous command... \n");
 						yyclearin;
 						yyerrok;
 						YYABORT;
-					;}
+					}
+#line 1686 "QL.tab.c"
     break;
 
-  case 9:
-#line 118 "QL.y"
-    {LOG (debug,"PAIR OF COMMANDS. \n");;}
+  case 14: /* COMMANDS: COMMAND COMMAND  */
+#line 235 "QL.y"
+                                {LOG (debug,"PAIR OF COMMANDS. \n");}
+#line 1692 "QL.tab.c"
     break;
 
-  case 10:
-#line 119 "QL.y"
-    {LOG (debug,"COMMAND ADDED IN COMMAND SEQUENCE. \n");;}
+  case 15: /* COMMANDS: COMMANDS COMMAND  */
+#line 236 "QL.y"
+                                   {LOG (debug,"COMMAND ADDED IN COMMAND SEQUENCE. \n");}
+#line 1698 "QL.tab.c"
     break;
 
-  case 11:
-#line 122 "QL.y"
-    {LOG (debug,"cSUBQUERY PARSED. \n");;}
+  case 16: /* COMMAND: cSUBQUERY  */
+#line 239 "QL.y"
+                                {LOG (debug,"cSUBQUERY PARSED. \n");}
+#line 1704 "QL.tab.c"
     break;
 
-  case 12:
-#line 123 "QL.y"
-    {
+  case 17: /* COMMAND: rCOMMAND rKEY  */
+#line 240 "QL.y"
+                        {
 						LOG (debug,"REVERSE NN. \n");
 						insert_into_stack (stack,(void*)key_cardinality);
 						insert_into_stack (stack,(void*)'%');
-					;}
+					}
+#line 1714 "QL.tab.c"
     break;
 
-  case 13:
-#line 131 "QL.y"
-    {LOG (debug,"FIRST rSUBQUERY PARSED. \n");;}
+  case 18: /* rCOMMAND: cSUBQUERY rSUBQUERY  */
+#line 248 "QL.y"
+                                        {LOG (debug,"FIRST rSUBQUERY PARSED. \n");}
+#line 1720 "QL.tab.c"
     break;
 
-  case 14:
-#line 132 "QL.y"
-    {LOG (debug,"NEW rSUBQUERY PARSED. \n");;}
+  case 19: /* rCOMMAND: rCOMMAND rSUBQUERY  */
+#line 249 "QL.y"
+                                        {LOG (debug,"NEW rSUBQUERY PARSED. \n");}
+#line 1726 "QL.tab.c"
     break;
 
-  case 15:
-#line 136 "QL.y"
-    {LOG (debug,"More slashes preceding rsubquery. \n");;}
+  case 20: /* rSUBQUERY: '%' rSUBQUERY  */
+#line 253 "QL.y"
+                                {LOG (debug,"More slashes preceding rsubquery. \n");}
+#line 1732 "QL.tab.c"
     break;
 
-  case 16:
-#line 137 "QL.y"
-    {
+  case 21: /* rSUBQUERY: '%' SUBQUERY  */
+#line 254 "QL.y"
+                        {
 						LOG (debug,"Put together rsubquery. \n");
 						insert_into_stack (stack,(void*)'%');
-					;}
+					}
+#line 1741 "QL.tab.c"
     break;
 
-  case 17:
-#line 144 "QL.y"
-    {LOG (debug,"More slashes preceding csubquery. \n");;}
+  case 22: /* cSUBQUERY: '/' cSUBQUERY  */
+#line 261 "QL.y"
+                        {LOG (debug,"More slashes preceding csubquery. \n");}
+#line 1747 "QL.tab.c"
     break;
 
-  case 18:
-#line 145 "QL.y"
-    {
+  case 23: /* cSUBQUERY: '/' SUBQUERY  */
+#line 262 "QL.y"
+                        {
 						LOG (debug,"Put together csubquery. \n");
 						insert_into_stack (stack,(void*)'/');
-					;}
+					}
+#line 1756 "QL.tab.c"
     break;
 
-  case 19:
-#line 152 "QL.y"
-    {
+  case 24: /* SUBQUERY: ID  */
+#line 269 "QL.y"
+                                {
 						LOG (debug,"Single identifier subquery. \n");
+						if (placeholder_argument ((yyvsp[0].str))) {
+							free ((yyvsp[0].str));
+							yyerror (scanner,stack,varray,strings,placeholders,"placeholders are only allowed in keys");
+							YYABORT;
+						}
 						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,(yyvsp[(1) - (1)].str));
-					;}
+						insert_into_stack (strings,(void*)stack->size);
+						insert_into_stack (stack,(yyvsp[0].str));
+					}
+#line 1772 "QL.tab.c"
     break;
 
-  case 20:
-#line 157 "QL.y"
-    {
+  case 25: /* SUBQUERY: ID '?' PREDICATES  */
+#line 280 "QL.y"
+                            {
 						LOG (debug,"Parsed subquery. \n")
+						if (placeholder_argument ((yyvsp[-2].str))) {
+							free ((yyvsp[-2].str));
+							yyerror (scanner,stack,varray,strings,placeholders,"placeholders are only allowed in keys");
+							YYABORT;
+						}
 						insert_into_stack (stack,(void*)predicates_cardinality);
-						insert_into_stack (stack,(yyvsp[(1) - (3)].str));
-					;}
+						insert_into_stack (strings,(void*)stack->size);
+						insert_into_stack (stack,(yyvsp[-2].str));
+					}
+#line 1788 "QL.tab.c"
     break;
 
-  case 21:
-#line 165 "QL.y"
-    {
+  case 26: /* PREDICATES: PREDICATES '&' PREDICATE  */
+#line 294 "QL.y"
+                                        {
 						LOG (debug,"Yet another predicate in the collection... \n");
 						predicates_cardinality++;
-					;}
+					}
+#line 1797 "QL.tab.c"
     break;
 
-  case 22:
-#line 169 "QL.y"
-    {
+  case 27: /* PREDICATES: PREDICATE  */
+#line 298 "QL.y"
+                                        {
 						LOG (debug,"First query predicate encountered. \n");
 						predicates_cardinality = 1;
-					;}
+					}
+#line 1806 "QL.tab.c"
     break;
 
-  case 23:
-#line 176 "QL.y"
-    {
+  case 28: /* PREDICATE: LOOKUP '=' KEY  */
+#line 305 "QL.y"
+                                        {
 						LOG (debug,"LOOKUP. \n");
 						insert_into_stack (stack,(void*)key_cardinality);
 						insert_into_stack (stack,(void*)LOOKUP);
-					;}
+					}
+#line 1816 "QL.tab.c"
     break;
 
-  case 24:
-#line 181 "QL.y"
-    {
+  case 29: /* PREDICATE: FROM '=' KEY  */
+#line 310 "QL.y"
+                        {
 						LOG (debug,"FROM. \n");
 						insert_into_stack (stack,(void*)key_cardinality);
 						insert_into_stack (stack,(void*)FROM);
-					;}
+					}
+#line 1826 "QL.tab.c"
     break;
 
-  case 25:
-#line 186 "QL.y"
-    {
+  case 30: /* PREDICATE: TO '=' KEY  */
+#line 315 "QL.y"
+                                {
 						LOG (debug,"TO. \n");
 						insert_into_stack (stack,(void*)key_cardinality);
 						insert_into_stack (stack,(void*)TO);
-					;}
+					}
+#line 1836 "QL.tab.c"
     break;
 
-  case 26:
-#line 191 "QL.y"
-    {
+  case 31: /* PREDICATE: BOUND '=' KEY  */
+#line 320 "QL.y"
+                        {
 						LOG (debug,"BOUND. \n");
 						insert_into_stack (stack,(void*)key_cardinality);
 						insert_into_stack (stack,(void*)BOUND);
-					;}
+					}
+#line 1846 "QL.tab.c"
     break;
 
-  case 27:
-#line 196 "QL.y"
-    {
+  case 32: /* PREDICATE: ID '=' REAL  */
+#line 325 "QL.y"
+                                {
+						LOG (debug,"QUERY OPTION. \n");
+						int const option = query_option ((yyvsp[-2].str));
+						free ((yyvsp[-2].str));
+						if (!option || option == MEMORY || option == COUNT || option == METRICS || option == FIELDS) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+						insert_into_stack (stack,varray+vindex);
+						varray [vindex++] = (yyvsp[0].dval);
+						insert_into_stack (stack,1);
+						insert_into_stack (stack,(void*)option);
+					}
+#line 1864 "QL.tab.c"
+    break;
+
+  case 33: /* PREDICATE: ID '=' INTEGER  */
+#line 338 "QL.y"
+                                {
+						LOG (debug,"QUERY OPTION. \n");
+						int const option = query_option ((yyvsp[-2].str));
+						free ((yyvsp[-2].str));
+						if (!option || option == MEMORY || option == COUNT || option == METRICS || option == FIELDS) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+						insert_into_stack (stack,varray+vindex);
+						varray [vindex++] = (yyvsp[0].ival);
+						insert_into_stack (stack,1);
+						insert_into_stack (stack,(void*)option);
+					}
+#line 1882 "QL.tab.c"
+    break;
+
+  case 34: /* PREDICATE: ID  */
+#line 351 "QL.y"
+                                        {
+						LOG (debug,"QUERY FLAG. \n");
+						int const option = query_option ((yyvsp[0].str));
+						free ((yyvsp[0].str));
+						if (option != COUNT) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query flag");
+							YYABORT;
+						}
+						insert_into_stack (stack,0);
+						insert_into_stack (stack,(void*)option);
+					}
+#line 1898 "QL.tab.c"
+    break;
+
+  case 35: /* PREDICATE: ID '=' FIELD_LIST  */
+#line 362 "QL.y"
+                                {
+						LOG (debug,"FIELDS. \n");
+						int const option = query_option ((yyvsp[-2].str));
+						free ((yyvsp[-2].str));
+						if (option != FIELDS) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+						insert_into_stack (stack,0);
+						insert_into_stack (stack,(void*)option);
+					}
+#line 1914 "QL.tab.c"
+    break;
+
+  case 36: /* PREDICATE: CORN '=' BITFIELD  */
+#line 373 "QL.y"
+                            {
 						LOG (debug,"SKYLINE. \n");
-						insert_into_stack (stack,(yyvsp[(3) - (3)].str));
+						insert_into_stack (strings,(void*)stack->size);
+						insert_into_stack (stack,(yyvsp[0].str));
 						insert_into_stack (stack,1);
 						insert_into_stack (stack,(void*)CORN);
-					;}
+					}
+#line 1926 "QL.tab.c"
     break;
 
-  case 28:
-#line 205 "QL.y"
-    {;}
+  case 37: /* OPTIONS: OPTIONS '&' OPTION  */
+#line 383 "QL.y"
+                                {}
+#line 1932 "QL.tab.c"
     break;
 
-  case 29:
-#line 206 "QL.y"
-    {LOG (debug,"rKEY encountered.\n");;}
+  case 38: /* OPTIONS: OPTION  */
+#line 384 "QL.y"
+                                        {}
+#line 1938 "QL.tab.c"
     break;
 
-  case 30:
-#line 210 "QL.y"
-    {;}
+  case 39: /* FIELD_LIST: FIELD_LIST ID  */
+#line 388 "QL.y"
+                                {
+						if (placeholder_argument ((yyvsp[0].str))) {
+							free ((yyvsp[0].str));
+							yyerror (scanner,stack,varray,strings,placeholders,"placeholders are only allowed in keys");
+							YYABORT;
+						}else if (!add_query_field ((yyvsp[0].str))) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown field");
+							YYABORT;
+						}
+					}
+#line 1953 "QL.tab.c"
     break;
 
-  case 31:
-#line 211 "QL.y"
-    {LOG (debug,"Distance join predicate encountered.\n");;}
+  case 40: /* FIELD_LIST: ID  */
+#line 398 "QL.y"
+                                        {
+						if (placeholder_argument ((yyvsp[0].str))) {
+							free ((yyvsp[0].str));
+							yyerror (scanner,stack,varray,strings,placeholders,"placeholders are only allowed in keys");
+							YYABORT;
+						}else if (!add_query_field ((yyvsp[0].str))) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown field");
+							YYABORT;
+						}
+					}
+#line 1968 "QL.tab.c"
     break;
 
-  case 32:
-#line 215 "QL.y"
-    {;}
+  case 41: /* OPTION: ID '=' REAL  */
+#line 411 "QL.y"
+                                {
+						LOG (debug,"Join option '%s' encountered.\n",(yyvsp[-2].str));
+						int const option = query_option ((yyvsp[-2].str));
+						free ((yyvsp[-2].str));
+						if (option == EPSILON) {
+							approximation_epsilon = (yyvsp[0].dval);
+						}else if (option == PAGES) {
+							approximation_pages = (yyvsp[0].dval);
+						}else if (option == THREADS) {
+							query_threads = (yyvsp[0].dval);
+						}else if (option == MEMORY) {
+							query_memory = (yyvsp[0].dval);
+						}else if (option == METRICS) {
+							query_metrics = (yyvsp[0].dval);
+						}else{
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+					}
+#line 1992 "QL.tab.c"
     break;
 
-  case 33:
-#line 216 "QL.y"
-    {LOG (debug,"Closest pairs predicate encountered.\n");;}
+  case 42: /* OPTION: ID '=' INTEGER  */
+#line 430 "QL.y"
+                                {
+						LOG (debug,"Join option '%s' encountered.\n",(yyvsp[-2].str));
+						int const option = query_option ((yyvsp[-2].str));
+						free ((yyvsp[-2].str));
+						if (option == EPSILON) {
+							approximation_epsilon = (yyvsp[0].ival);
+						}else if (option == PAGES) {
+							approximation_pages = (yyvsp[0].ival);
+						}else if (option == THREADS) {
+							query_threads = (yyvsp[0].ival);
+						}else if (option == MEMORY) {
+							query_memory = (yyvsp[0].ival);
+						}else if (option == METRICS) {
+							query_metrics = (yyvsp[0].ival);
+						}else{
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+					}
+#line 2016 "QL.tab.c"
     break;
 
-  case 34:
-#line 220 "QL.y"
-    {
+  case 43: /* OPTION: ID '=' FIELD_LIST  */
+#line 449 "QL.y"
+                                {
+						LOG (debug,"Join option '%s' encountered.\n",(yyvsp[-2].str));
+						int const option = query_option ((yyvsp[-2].str));
+						free ((yyvsp[-2].str));
+						if (option != FIELDS) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+					}
+#line 2030 "QL.tab.c"
+    break;
+
+  case 44: /* rKEY: '%' rKEY  */
+#line 461 "QL.y"
+                                {}
+#line 2036 "QL.tab.c"
+    break;
+
+  case 45: /* rKEY: '%' KEY  */
+#line 462 "QL.y"
+                                {LOG (debug,"rKEY encountered.\n");}
+#line 2042 "QL.tab.c"
+    break;
+
+  case 46: /* DJOIN_PRED: '/' DJOIN_PRED  */
+#line 466 "QL.y"
+                        {(yyval.dval) = (yyvsp[0].dval);}
+#line 2048 "QL.tab.c"
+    break;
+
+  case 47: /* DJOIN_PRED: '/' REAL  */
+#line 467 "QL.y"
+                                {
+						LOG (debug,"Distance join predicate encountered.\n");
+						(yyval.dval) = (yyvsp[0].dval);
+					}
+#line 2057 "QL.tab.c"
+    break;
+
+  case 48: /* CP_PRED: '/' CP_PRED  */
+#line 474 "QL.y"
+                                {(yyval.ival) = (yyvsp[0].ival);}
+#line 2063 "QL.tab.c"
+    break;
+
+  case 49: /* CP_PRED: '/' INTEGER  */
+#line 475 "QL.y"
+                        {
+						LOG (debug,"Closest pairs predicate encountered.\n");
+						(yyval.ival) = (yyvsp[0].ival);
+					}
+#line 2072 "QL.tab.c"
+    break;
+
+  case 50: /* JOIN_PRED: '/' JOIN_PRED  */
+#line 482 "QL.y"
+                        {(yyval.ival) = (yyvsp[0].ival);}
+#line 2078 "QL.tab.c"
+    break;
+
+  case 51: /* JOIN_PRED: '/' ID '=' INTEGER  */
+#line 483 "QL.y"
+                                {
+						LOG (debug,"Join predicate '%s' encountered.\n",(yyvsp[-2].str));
+						if (strcmp ((yyvsp[-2].str),"knn")) {
+							free ((yyvsp[-2].str));
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown join predicate");
+							YYABORT;
+						}
+						free ((yyvsp[-2].str));
+						(yyval.ival) = (yyvsp[0].ival);
+					}
+#line 2093 "QL.tab.c"
+    break;
+
+  case 52: /* KEY: KEY ',' REAL  */
+#line 496 "QL.y"
+                        {
 						insert_into_stack (stack,varray+vindex);
-						varray [vindex++] = (yyvsp[(3) - (3)].dval);
+						varray [vindex++] = (yyvsp[0].dval);
 						key_cardinality++;
-					;}
+					}
+#line 2103 "QL.tab.c"
     break;
 
-  case 35:
-#line 225 "QL.y"
-    {
+  case 53: /* KEY: KEY ',' INTEGER  */
+#line 501 "QL.y"
+                          {
 						insert_into_stack (stack,varray+vindex);
-						varray [vindex++] = (yyvsp[(3) - (3)].ival);
+						varray [vindex++] = (yyvsp[0].ival);
 						key_cardinality++;
-					;}
+					}
+#line 2113 "QL.tab.c"
     break;
 
-  case 36:
-#line 230 "QL.y"
-    {
+  case 54: /* KEY: KEY ',' ID  */
+#line 506 "QL.y"
+                                {
+						if (!push_placeholder (placeholders,(yyvsp[0].str))) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown placeholder");
+							YYABORT;
+						}
 						insert_into_stack (stack,varray+vindex);
-						varray [vindex++] = (yyvsp[(1) - (1)].dval);
+						varray [vindex++] = 0;
+						key_cardinality++;
+					}
+#line 2127 "QL.tab.c"
+    break;
+
+  case 55: /* KEY: REAL  */
+#line 515 "QL.y"
+                                {
+						insert_into_stack (stack,varray+vindex);
+						varray [vindex++] = (yyvsp[0].dval);
 						key_cardinality = 1;
-					;}
+					}
+#line 2137 "QL.tab.c"
     break;
 
-  case 37:
-#line 235 "QL.y"
-    {
+  case 56: /* KEY: INTEGER  */
+#line 520 "QL.y"
+                                {
+						insert_into_stack (stack,varray+vindex);
+						varray [vindex++] = (yyvsp[0].ival);
+						key_cardinality = 1;
+					}
+#line 2147 "QL.tab.c"
+    break;
+
+  case 57: /* KEY: ID  */
+#line 525 "QL.y"
+                                {
+						if (!push_placeholder (placeholders,(yyvsp[0].str))) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown placeholder");
+							YYABORT;
+						}
 						insert_into_stack (stack,varray+vindex);
-						varray [vindex++] = (yyvsp[(1) - (1)].ival);
+						varray [vindex++] = 0;
 						key_cardinality = 1;
-					;}
+					}
+#line 2161 "QL.tab.c"
     break;
 
 
-/* Line 1267 of yacc.c.  */
-#line 1702 "QL.tab.c"
+#line 2165 "QL.tab.c"
+
       default: break;
     }
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
 
-
-  /* Now `shift' the result of the reduction.  Determine what state
+  /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
 
-/*------------------------------------.
-| yyerrlab -- here on detecting error |
-`------------------------------------*/
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
 yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (scanner, YY_("syntax error"));
-#else
       {
-	YYSIZE_T yysize = yysyntax_error (0, yystate, yychar);
-	if (yymsg_alloc < yysize && yymsg_alloc < YYSTACK_ALLOC_MAXIMUM)
-	  {
-	    YYSIZE_T yyalloc = 2 * yysize;
-	    if (! (yysize <= yyalloc && yyalloc <= YYSTACK_ALLOC_MAXIMUM))
-	      yyalloc = YYSTACK_ALLOC_MAXIMUM;
-	    if (yymsg != yymsgbuf)
-	      YYSTACK_FREE (yymsg);
-	    yymsg = (char *) YYSTACK_ALLOC (yyalloc);
-	    if (yymsg)
-	      yymsg_alloc = yyalloc;
-	    else
-	      {
-		yymsg = yymsgbuf;
-		yymsg_alloc = sizeof yymsgbuf;
-	      }
-	  }
-
-	if (0 < yysize && yysize <= yymsg_alloc)
-	  {
-	    (void) yysyntax_error (yymsg, yystate, yychar);
-	    yyerror (scanner, yymsg);
-	  }
-	else
-	  {
-	    yyerror (scanner, YY_("syntax error"));
-	    if (yysize != 0)
-	      goto yyexhaustedlab;
-	  }
+        yypcontext_t yyctx
+          = {yyssp, yytoken};
+        char const *yymsgp = YY_("syntax error");
+        int yysyntax_error_status;
+        yysyntax_error_status = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+        if (yysyntax_error_status == 0)
+          yymsgp = yymsg;
+        else if (yysyntax_error_status == -1)
+          {
+            if (yymsg != yymsgbuf)
+              YYSTACK_FREE (yymsg);
+            yymsg = YY_CAST (char *,
+                             YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
+            if (yymsg)
+              {
+                yysyntax_error_status
+                  = yysyntax_error (&yymsg_alloc, &yymsg, &yyctx);
+                yymsgp = yymsg;
+              }
+            else
+              {
+                yymsg = yymsgbuf;
+                yymsg_alloc = sizeof yymsgbuf;
+                yysyntax_error_status = YYENOMEM;
+              }
+          }
+        yyerror (scanner, stack, varray, strings, placeholders, yymsgp);
+        if (yysyntax_error_status == YYENOMEM)
+          YYNOMEM;
       }
-#endif
     }
 
-
-
   if (yyerrstatus == 3)
     {
-      /* If just tried and failed to reuse look-ahead token after an
-	 error, discard it.  */
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
 
       if (yychar <= YYEOF)
-	{
-	  /* Return failure if at end of input.  */
-	  if (yychar == YYEOF)
-	    YYABORT;
-	}
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
       else
-	{
-	  yydestruct ("Error: discarding",
-		      yytoken, &yylval, scanner);
-	  yychar = YYEMPTY;
-	}
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, scanner, stack, varray, strings, placeholders);
+          yychar = YYEMPTY;
+        }
     }
 
-  /* Else will try to reuse look-ahead token after shifting the error
+  /* Else will try to reuse lookahead token after shifting the error
      token.  */
   goto yyerrlab1;
 
@@ -1803,14 +2269,13 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  /* Do not reclaim the symbols of the rule which action triggered
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
   yylen = 0;
@@ -1823,42 +2288,42 @@ yyerrorlab:
 | yyerrlab1 -- common code for both syntax error and YYERROR.  |
 `-------------------------------------------------------------*/
 yyerrlab1:
-  yyerrstatus = 3;	/* Each real token shifted decrements this.  */
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
-      if (yyn != YYPACT_NINF)
-	{
-	  yyn += YYTERROR;
-	  if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
-	    {
-	      yyn = yytable[yyn];
-	      if (0 < yyn)
-		break;
-	    }
-	}
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
-	YYABORT;
+        YYABORT;
 
 
       yydestruct ("Error: popping",
-		  yystos[yystate], yyvsp, scanner);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, scanner, stack, varray, strings, placeholders);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
     }
 
-  if (yyn == YYFINAL)
-    YYACCEPT;
-
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -1869,53 +2334,58 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
-#ifndef yyoverflow
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (scanner, YY_("memory exhausted"));
+  yyerror (scanner, stack, varray, strings, placeholders, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
-  if (yychar != YYEOF && yychar != YYEMPTY)
-     yydestruct ("Cleanup: discarding lookahead",
-		 yytoken, &yylval, scanner);
-  /* Do not reclaim the symbols of the rule which action triggered
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, scanner, stack, varray, strings, placeholders);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
   YYPOPSTACK (yylen);
   YY_STACK_PRINT (yyss, yyssp);
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-		  yystos[*yyssp], yyvsp, scanner);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, scanner, stack, varray, strings, placeholders);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
   if (yymsg != yymsgbuf)
     YYSTACK_FREE (yymsg);
-#endif
-  /* Make sure YYID is used.  */
-  return YYID (yyresult);
+  return yyresult;
 }
 
-
-#line 242 "QL.y"
+#line 536 "QL.y"
 
 
 /***
@@ -1925,8 +2395,15 @@ int main (int argc, char* argv[]) {
 }
 }
 ***/
-void yyerror (yyscan_t scanner, char* description) {
+void yyerror (yyscan_t scanner, lifo_t *const stack, double varray[], lifo_t *const strings, lifo_t *const placeholders, char const* description) {
 	LOG (error," %s\n", description);
+	snprintf (parse_error,sizeof(parse_error),"%s",description);
 }
 
+/**
+ * The description of the last error of the parser in this thread.
+ */
+char const* last_parse_error (void) {
+	return parse_error;
+}
 
@@ -1,14 +1,14 @@
-/* A Bison parser, made by GNU Bison 2.3.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
-/* Skeleton interface for Bison's Yacc-like parsers in C
+/* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989, 1990, 2000, 2001, 2002, 2003, 2004, 2005, 2006
-   Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
-   This program is free software; you can redistribute it and/or modify
+   This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
-   the Free Software Foundation; either version 2, or (at your option)
-   any later version.
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
 
    This program is distributed in the hope that it will be useful,
    but WITHOUT ANY WARRANTY; without even the implied warranty of
@@ -16,9 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program; if not, write to the Free Software
-   Foundation, Inc., 51 Franklin Street, Fifth Floor,
-   Boston, MA 02110-1301, USA.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,54 +31,93 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
-/* Tokens.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-   /* Put the tokens into the symbol table, so that GDB and other debuggers
-      know about them.  */
-   enum yytokentype {
-     ID = 258,
-     LOOKUP = 259,
-     FROM = 260,
-     TO = 261,
-     BOUND = 262,
-     CORN = 263,
-     BITFIELD = 264,
-     INTEGER = 265,
-     REAL = 266
-   };
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+#ifndef YY_QL_QL_TAB_H_INCLUDED
+# define YY_QL_QL_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
 #endif
-/* Tokens.  */
-#define ID 258
-#define LOOKUP 259
-#define FROM 260
-#define TO 261
-#define BOUND 262
-#define CORN 263
-#define BITFIELD 264
-#define INTEGER 265
-#define REAL 266
+#if YYDEBUG
+extern int QL_debug;
+#endif
+/* "%code requires" blocks.  */
+#line 1 "QL.y"
+
+	#include"defs.h"
 
+	#ifndef YY_TYPEDEF_YY_SCANNER_T
+	#define YY_TYPEDEF_YY_SCANNER_T
+	typedef void* yyscan_t;
+	#endif
 
+#line 58 "QL.tab.h"
 
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    ID = 258,                      /* ID  */
+    LOOKUP = 259,                  /* LOOKUP  */
+    FROM = 260,                    /* FROM  */
+    TO = 261,                      /* TO  */
+    BOUND = 262,                   /* BOUND  */
+    CORN = 263,                    /* CORN  */
+    EPSILON = 264,                 /* EPSILON  */
+    PAGES = 265,                   /* PAGES  */
+    THREADS = 266,                 /* THREADS  */
+    MEMORY = 267,                  /* MEMORY  */
+    COUNT = 268,                   /* COUNT  */
+    SAMPLE = 269,                  /* SAMPLE  */
+    METRICS = 270,                 /* METRICS  */
+    LIMIT = 271,                   /* LIMIT  */
+    OFFSET = 272,                  /* OFFSET  */
+    FIELDS = 273,                  /* FIELDS  */
+    BITFIELD = 274,                /* BITFIELD  */
+    INTEGER = 275,                 /* INTEGER  */
+    REAL = 276                     /* REAL  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
 
+/* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-typedef union YYSTYPE
-#line 37 "QL.y"
+union YYSTYPE
 {
+#line 151 "QL.y"
+
 	char* str;
 	double dval;
 	int ival;
-}
-/* Line 1529 of yacc.c.  */
-#line 77 "QL.tab.h"
-	YYSTYPE;
-# define yystype YYSTYPE /* obsolescent; will be withdrawn */
-# define YYSTYPE_IS_DECLARED 1
+
+#line 102 "QL.tab.h"
+
+};
+typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
 #endif
 
 
-#include"defs.h"
-#include"lex.QL_.h"
-int QL_parse (void* scanner, lifo_t *const stack, double varray[]);
+
+
+int QL_parse (yyscan_t scanner, lifo_t *const stack, double varray[], lifo_t *const strings, lifo_t *const placeholders);
+
+/* "%code provides" blocks.  */
+#line 10 "QL.y"
+
+	#include"lex.QL_.h"
+
+	char const* last_parse_error (void);
+
+#line 122 "QL.tab.h"
+
+#endif /* !YY_QL_QL_TAB_H_INCLUDED  */
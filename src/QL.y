@@ -1,3 +1,18 @@
+%code requires {
+	#include"defs.h"
+
+	#ifndef YY_TYPEDEF_YY_SCANNER_T
+	#define YY_TYPEDEF_YY_SCANNER_T
+	typedef void* yyscan_t;
+	#endif
+}
+
+%code provides {
+	#include"lex.QL_.h"
+
+	char const* last_parse_error (void);
+}
+
 %{
 	#include<string.h>
 	#include<stdlib.h>
@@ -8,31 +23,130 @@
 	#include"QL.tab.h"
 	#include"lex.QL_.h"
 
-	#define YYERROR_VERBOSE
-	//#define YYLEX_PARAM scanner
-	//#define YYPARSE_PARAM yyscan_t scanner
+	void yyerror (yyscan_t,lifo_t *const,double[],lifo_t *const,lifo_t *const,char const*);
 
-	void yyerror (yyscan_t,char*);
+	extern int QL_lex (YYSTYPE *yylval_param, yyscan_t yyscanner);
 
+	/**
+	 * Parsing state is kept per thread as the
+	 * server parses queries concurrently.
+	 */
+	static __thread unsigned vindex = 0;
+	static __thread unsigned key_cardinality = 0;
+	static __thread unsigned predicates_cardinality = 0;
 
-	extern int QL_lex (YYSTYPE *yylval_param, yyscan_t yyscanner);
-	//int QL_parse (lifo_t *const, double[]);
-/*
-	lifo_t* stack;
-	double varray [BUFSIZ];
-
-	unsigned vindex = 0;
-	unsigned key_cardinality = 0;
-	unsigned predicates_cardinality = 0;
-*/
+	static __thread double approximation_epsilon = 0;
+	static __thread double approximation_pages = 0;
+	static __thread double query_threads = 0;
+	static __thread double query_memory = 0;
+	static __thread double query_metrics = 0;
+	static __thread unsigned query_fields = 0;
+
+	static __thread char parse_error [BUFSIZ>>2];
+
+	/**
+	 * Maps the name of a query option, e.g. an approximation
+	 * knob, to its operation code, or 0 if unknown. The flag
+	 * "count" reports the number of results in place of them,
+	 * after any offset and limit are applied.
+	 */
+	static int query_option (char const*const name) {
+		if (!strcmp (name,"eps")) return EPSILON;
+		else if (!strcmp (name,"pages")) return PAGES;
+		else if (!strcmp (name,"threads")) return THREADS;
+		else if (!strcmp (name,"memory")) return MEMORY;
+		else if (!strcmp (name,"count")) return COUNT;
+		else if (!strcmp (name,"sample")) return SAMPLE;
+		else if (!strcmp (name,"metrics")) return METRICS;
+		else if (!strcmp (name,"limit")) return LIMIT;
+		else if (!strcmp (name,"offset")) return OFFSET;
+		else if (!strcmp (name,"fields")) return FIELDS;
+		else return 0;
+	}
+
+	/**
+	 * Adds a field to those reported for each result, where
+	 * fields are listed as in "fields=objects|keys|metrics".
+	 */
+	static boolean add_query_field (char *const name) {
+		unsigned const field = !strcmp (name,"objects") ? OBJECTS_FIELD
+					: !strcmp (name,"keys") ? KEYS_FIELD
+					: !strcmp (name,"metrics") ? METRICS_FIELD : 0;
+		free (name);
+		query_fields |= field;
+		return field != 0;
+	}
+
+	/**
+	 * The argument of a prepared query an identifier stands for,
+	 * where placeholders are written as '_' followed by the number
+	 * of the argument, starting from 1, or else 0.
+	 */
+	static long placeholder_argument (char const*const name) {
+		char* end = NULL;
+		long const argument = *name == '_' ? strtol (name+1,&end,10) : 0;
+		return argument > 0 && end != NULL && *end == '\0' ? argument : 0;
+	}
+
+	/**
+	 * Notes that the next value of a key is bound to an argument
+	 * of a prepared query. Placeholders stand for values of keys
+	 * only, including the number of neighbors of a bound, since
+	 * identifiers elsewhere name heapfiles, options or fields.
+	 */
+	static boolean push_placeholder (lifo_t *const placeholders, char *const name) {
+		long const argument = placeholder_argument (name);
+		boolean const is_placeholder = argument > 0;
+		free (name);
+		if (is_placeholder) {
+			insert_into_stack (placeholders,(void*)argument);
+			insert_into_stack (placeholders,(void*)(uint64_t)vindex);
+		}
+		return is_placeholder;
+	}
+
+	/**
+	 * Pushes the trailer of a query that is popped first when
+	 * the query is processed; i.e. the terminating symbol, the
+	 * type of the join, its threshold, its approximation, its
+	 * degree of parallelism, the megabytes of its results
+	 * kept in memory (0 for the server's defaults) and the
+	 * fields reported for each of its results.
+	 */
+	static void push_query_trailer (lifo_t *const stack, double varray[], void *const join_type, double const threshold) {
+		insert_into_stack (stack,varray+vindex);
+		varray [vindex++] = approximation_epsilon;
+		varray [vindex++] = approximation_pages;
+		varray [vindex++] = query_threads;
+		varray [vindex++] = query_memory;
+		varray [vindex++] = (query_fields ? query_fields : DEFAULT_FIELDS) | (query_metrics ? METRICS_FIELD : 0);
+
+		insert_into_stack (stack,varray+vindex);
+		insert_into_stack (stack,join_type);
+		insert_into_stack (stack,(void*)';');
+		varray [vindex++] = threshold;
+	}
 %}
 
 %expect 0
-%token_table
-%pure_parser
-%name-prefix="QL_"
+%token-table
+%define api.pure
+%define parse.error verbose
+%name-prefix "QL_"
 %lex-param {yyscan_t scanner}
-%parse-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {lifo_t *const stack} {double varray[]} {lifo_t *const strings} {lifo_t *const placeholders}
+
+%initial-action {
+	vindex = 0;
+	key_cardinality = 0;
+	predicates_cardinality = 0;
+	approximation_epsilon = 0;
+	approximation_pages = 0;
+	query_threads = 0;
+	query_memory = 0;
+	query_metrics = 0;
+	query_fields = 0;
+}
 
 %union{
 	char* str;
@@ -47,10 +161,11 @@
 %type <str> SUBQUERY
 %type <str> PREDICATE
 
-%type <str> rKEY DJOIN_PRED CP_PRED
+%type <str> rKEY DJOIN_PRED CP_PRED JOIN_PRED
 %type <str> KEY
 
 %token <str> ID LOOKUP FROM TO BOUND CORN
+%token EPSILON PAGES THREADS MEMORY COUNT SAMPLE METRICS LIMIT OFFSET FIELDS
 %token <str> BITFIELD
 %token <int> INTEGER
 %token <double> REAL
@@ -66,45 +181,47 @@
 QUERY :
 	  COMMAND ';'	{
 						LOG (debug,"SINGLE COMMAND ';' ENCOUNTERED. \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,';');
-						varray [vindex++] = 0;
+						push_query_trailer (stack,varray,NULL,0);
 					}
 	| COMMAND '/' ';' {
 						LOG (debug,"SINGLE COMMAND '/;' ENCOUNTERED. \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,';');
-						varray [vindex++] = 0;
+						push_query_trailer (stack,varray,NULL,0);
 					}
 	| COMMANDS DJOIN_PRED ';' {
 						LOG (debug,"DISTANCE JOIN. \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,';');
-						varray [vindex++] = $<dval>3;
+						push_query_trailer (stack,varray,NULL,$<dval>2);
 					}
 	| COMMANDS DJOIN_PRED '/' ';' {
 						LOG (debug,"DISTANCE JOIN/ . \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,NULL);
-						insert_into_stack (stack,';');
-						varray [vindex++] = $<dval>3;
+						push_query_trailer (stack,varray,NULL,$<dval>2);
+					}
+	| COMMANDS DJOIN_PRED '?' OPTIONS ';' {
+						LOG (debug,"APPROXIMATE DISTANCE JOIN. \n");
+						push_query_trailer (stack,varray,NULL,$<dval>2);
 					}
 	| COMMANDS CP_PRED ';'	{
 						LOG (debug,"CLOSEST PAIRS. \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,(void*)0xffffffffffffffff);
-						insert_into_stack (stack,';');
-						varray [vindex++] = $<ival>3;
+						push_query_trailer (stack,varray,(void*)0xffffffffffffffff,$<ival>2);
 					}
 	| COMMANDS CP_PRED '/' ';'	{
 						LOG (debug,"CLOSEST PAIRS/ . \n");
-						insert_into_stack (stack,varray+vindex);
-						insert_into_stack (stack,(void*)0xffffffffffffffff);
-						insert_into_stack (stack,';');
-						varray [vindex++] = $<ival>3;
+						push_query_trailer (stack,varray,(void*)0xffffffffffffffff,$<ival>2);
+					}
+	| COMMANDS CP_PRED '?' OPTIONS ';'	{
+						LOG (debug,"APPROXIMATE CLOSEST PAIRS. \n");
+						push_query_trailer (stack,varray,(void*)0xffffffffffffffff,$<ival>2);
+					}
+	| COMMANDS JOIN_PRED ';'	{
+						LOG (debug,"kNN JOIN. \n");
+						push_query_trailer (stack,varray,(void*)'k',$<ival>2);
+					}
+	| COMMANDS JOIN_PRED '/' ';'	{
+						LOG (debug,"kNN JOIN/ . \n");
+						push_query_trailer (stack,varray,(void*)'k',$<ival>2);
+					}
+	| COMMANDS JOIN_PRED '?' OPTIONS ';'	{
+						LOG (debug,"kNN JOIN WITH OPTIONS. \n");
+						push_query_trailer (stack,varray,(void*)'k',$<ival>2);
 					}
 	| error 			{
 						LOG (error,"Erroneous command... \n");
@@ -151,12 +268,24 @@ cSUBQUERY:
 SUBQUERY :
 	  ID 			{
 						LOG (debug,"Single identifier subquery. \n");
+						if (placeholder_argument ($<str>1)) {
+							free ($<str>1);
+							yyerror (scanner,stack,varray,strings,placeholders,"placeholders are only allowed in keys");
+							YYABORT;
+						}
 						insert_into_stack (stack,NULL);
+						insert_into_stack (strings,(void*)stack->size);
 						insert_into_stack (stack,$<str>1);
 					}
 	| ID '?' PREDICATES {
 						LOG (debug,"Parsed subquery. \n")
+						if (placeholder_argument ($<str>1)) {
+							free ($<str>1);
+							yyerror (scanner,stack,varray,strings,placeholders,"placeholders are only allowed in keys");
+							YYABORT;
+						}
 						insert_into_stack (stack,(void*)predicates_cardinality);
+						insert_into_stack (strings,(void*)stack->size);
 						insert_into_stack (stack,$<str>1);
 					}
 ;
@@ -193,27 +322,174 @@ PREDICATE :
 						insert_into_stack (stack,(void*)key_cardinality);
 						insert_into_stack (stack,(void*)BOUND);
 					}
+	| ID '=' REAL		{
+						LOG (debug,"QUERY OPTION. \n");
+						int const option = query_option ($<str>1);
+						free ($<str>1);
+						if (!option || option == MEMORY || option == COUNT || option == METRICS || option == FIELDS) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+						insert_into_stack (stack,varray+vindex);
+						varray [vindex++] = $<dval>3;
+						insert_into_stack (stack,1);
+						insert_into_stack (stack,(void*)option);
+					}
+	| ID '=' INTEGER	{
+						LOG (debug,"QUERY OPTION. \n");
+						int const option = query_option ($<str>1);
+						free ($<str>1);
+						if (!option || option == MEMORY || option == COUNT || option == METRICS || option == FIELDS) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+						insert_into_stack (stack,varray+vindex);
+						varray [vindex++] = $<ival>3;
+						insert_into_stack (stack,1);
+						insert_into_stack (stack,(void*)option);
+					}
+	| ID				{
+						LOG (debug,"QUERY FLAG. \n");
+						int const option = query_option ($<str>1);
+						free ($<str>1);
+						if (option != COUNT) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query flag");
+							YYABORT;
+						}
+						insert_into_stack (stack,0);
+						insert_into_stack (stack,(void*)option);
+					}
+	| ID '=' FIELD_LIST	{
+						LOG (debug,"FIELDS. \n");
+						int const option = query_option ($<str>1);
+						free ($<str>1);
+						if (option != FIELDS) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+						insert_into_stack (stack,0);
+						insert_into_stack (stack,(void*)option);
+					}
 	| CORN '=' BITFIELD {
 						LOG (debug,"SKYLINE. \n");
+						insert_into_stack (strings,(void*)stack->size);
 						insert_into_stack (stack,$<str>3);
 						insert_into_stack (stack,1);
 						insert_into_stack (stack,(void*)CORN);
 					}
 ;
 
+OPTIONS :
+	  OPTIONS '&' OPTION	{}
+	| OPTION			{}
+;
+
+FIELD_LIST :
+	  FIELD_LIST ID		{
+						if (placeholder_argument ($<str>2)) {
+							free ($<str>2);
+							yyerror (scanner,stack,varray,strings,placeholders,"placeholders are only allowed in keys");
+							YYABORT;
+						}else if (!add_query_field ($<str>2)) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown field");
+							YYABORT;
+						}
+					}
+	| ID				{
+						if (placeholder_argument ($<str>1)) {
+							free ($<str>1);
+							yyerror (scanner,stack,varray,strings,placeholders,"placeholders are only allowed in keys");
+							YYABORT;
+						}else if (!add_query_field ($<str>1)) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown field");
+							YYABORT;
+						}
+					}
+;
+
+OPTION :
+	  ID '=' REAL		{
+						LOG (debug,"Join option '%s' encountered.\n",$<str>1);
+						int const option = query_option ($<str>1);
+						free ($<str>1);
+						if (option == EPSILON) {
+							approximation_epsilon = $<dval>3;
+						}else if (option == PAGES) {
+							approximation_pages = $<dval>3;
+						}else if (option == THREADS) {
+							query_threads = $<dval>3;
+						}else if (option == MEMORY) {
+							query_memory = $<dval>3;
+						}else if (option == METRICS) {
+							query_metrics = $<dval>3;
+						}else{
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+					}
+	| ID '=' INTEGER	{
+						LOG (debug,"Join option '%s' encountered.\n",$<str>1);
+						int const option = query_option ($<str>1);
+						free ($<str>1);
+						if (option == EPSILON) {
+							approximation_epsilon = $<ival>3;
+						}else if (option == PAGES) {
+							approximation_pages = $<ival>3;
+						}else if (option == THREADS) {
+							query_threads = $<ival>3;
+						}else if (option == MEMORY) {
+							query_memory = $<ival>3;
+						}else if (option == METRICS) {
+							query_metrics = $<ival>3;
+						}else{
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+					}
+	| ID '=' FIELD_LIST	{
+						LOG (debug,"Join option '%s' encountered.\n",$<str>1);
+						int const option = query_option ($<str>1);
+						free ($<str>1);
+						if (option != FIELDS) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown query option");
+							YYABORT;
+						}
+					}
+;
+
 rKEY :
 	 '%' rKEY		{}
 	| '%' KEY		{LOG (debug,"rKEY encountered.\n");}
 ;
 
 DJOIN_PRED :
-	 '/' DJOIN_PRED	{}
-	| '/' REAL		{LOG (debug,"Distance join predicate encountered.\n");}
+	 '/' DJOIN_PRED	{$<dval>$ = $<dval>2;}
+	| '/' REAL		{
+						LOG (debug,"Distance join predicate encountered.\n");
+						$<dval>$ = $<dval>2;
+					}
 ;
 
 CP_PRED :
-	 '/' CP_PRED		{}
-	| '/' INTEGER	{LOG (debug,"Closest pairs predicate encountered.\n");}
+	 '/' CP_PRED		{$<ival>$ = $<ival>2;}
+	| '/' INTEGER	{
+						LOG (debug,"Closest pairs predicate encountered.\n");
+						$<ival>$ = $<ival>2;
+					}
+;
+
+JOIN_PRED :
+	 '/' JOIN_PRED	{$<ival>$ = $<ival>2;}
+	| '/' ID '=' INTEGER	{
+						LOG (debug,"Join predicate '%s' encountered.\n",$<str>2);
+						if (strcmp ($<str>2,"knn")) {
+							free ($<str>2);
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown join predicate");
+							YYABORT;
+						}
+						free ($<str>2);
+						$<ival>$ = $<ival>4;
+					}
 ;
 
 KEY : 
@@ -227,6 +503,15 @@ KEY :
 						varray [vindex++] = $<ival>3;
 						key_cardinality++;
 					}
+	| KEY ',' ID		{
+						if (!push_placeholder (placeholders,$<str>3)) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown placeholder");
+							YYABORT;
+						}
+						insert_into_stack (stack,varray+vindex);
+						varray [vindex++] = 0;
+						key_cardinality++;
+					}
 	| REAL			{
 						insert_into_stack (stack,varray+vindex);
 						varray [vindex++] = $<dval>1;
@@ -237,6 +522,15 @@ KEY :
 						varray [vindex++] = $<ival>1;
 						key_cardinality = 1;
 					}
+	| ID			{
+						if (!push_placeholder (placeholders,$<str>1)) {
+							yyerror (scanner,stack,varray,strings,placeholders,"unknown placeholder");
+							YYABORT;
+						}
+						insert_into_stack (stack,varray+vindex);
+						varray [vindex++] = 0;
+						key_cardinality = 1;
+					}
 ;
 
 %%
@@ -248,7 +542,15 @@ int main (int argc, char* argv[]) {
 }
 }
 ***/
-void yyerror (yyscan_t scanner, char* description) {
+void yyerror (yyscan_t scanner, lifo_t *const stack, double varray[], lifo_t *const strings, lifo_t *const placeholders, char const* description) {
 	LOG (error," %s\n", description);
+	snprintf (parse_error,sizeof(parse_error),"%s",description);
+}
+
+/**
+ * The description of the last error of the parser in this thread.
+ */
+char const* last_parse_error (void) {
+	return parse_error;
 }
 
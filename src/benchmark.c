@@ -0,0 +1,456 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/resource.h>
+#include "generator.h"
+#include "indexing.h"
+#include "defs.h"
+
+uint64_t RECORDS = 100000;
+uint64_t QUERIES = 1000;
+uint32_t DIMENSIONS = 2;
+uint32_t PAGESIZE = 4096;
+uint64_t SEED = 1;
+distribution_t DISTRIBUTION = UNIFORM_DISTRIBUTION;
+char const* FOLDER = "/tmp";
+char const* DATASET = NULL;
+boolean KEEP = false;
+
+static double const selectivities [] = {.0001,.001,.01};
+static uint32_t const neighbors [] = {1,10,100};
+static double const join_ratios [] = {.1,1,10};
+static uint32_t const closest_pairs [] = {10,100,1000};
+
+#define ENTRIES(array) (sizeof(array)/sizeof(*array))
+
+/**
+ * What one workload cost; i.e. its latencies in microseconds, one
+ * per operation, and the pages of the trees it ran on read, found
+ * buffered, or written, from which point on they were measured.
+ */
+typedef struct {
+	char const* workload;
+	double parameter;
+
+	uint64_t operations;
+	uint64_t results;
+	uint64_t* latencies;
+	uint64_t started;
+
+	tree_t* trees [2];
+	tree_stats_t before [2];
+} measurement_t;
+
+static boolean is_first_workload = true;
+
+
+static
+void print_notice (void) {
+	fputs ("\n Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>\n\n",stderr);
+	fputs (" #indexing comes with ABSOLUTELY NO WARRANTY. This is free software, \n",stderr);
+	fputs (" and you are welcome to redistribute it under certain conditions.\n\n",stderr);
+}
+
+static
+void print_usage (char const*const program) {
+	printf (" ** Usage:\t %s [option] [parameter]\n", program);
+	puts ("\t\t-n --records :\t The number of records indexed by each tree.");
+	puts ("\t\t-q --queries :\t The number of operations of each workload.");
+	puts ("\t\t-d --dims :\t The number of dimensions.");
+	puts ("\t\t-b --block :\t The desired size of each block.");
+	puts ("\t\t-x --distribution :\t One of 'uniform', 'clustered' or 'skewed'.");
+	puts ("\t\t-s --seed :\t The seed from which datasets are generated.");
+	puts ("\t\t-f --folder :\t The folder where the heapfiles are created.");
+	puts ("\t\t-o --output :\t Only writes the generated dataset to the textfile given, for create#rtree.");
+	puts ("\t\t-k --keep :\t Keeps the heapfiles created.");
+	puts ("\n\t Results are printed in JSON, one object per workload, whose parameter is");
+	puts ("\t the fraction of the domain covered by range queries, the k of kNN and closest-pairs");
+	puts ("\t queries, the pairs per record expected of distance joins, the corner");
+	puts ("\t of skyline queries, and the records of updates.");
+}
+
+static
+void process_arguments (int argc,char *argv[]) {
+	char const*const short_options = "un:q:d:b:x:s:f:o:k";
+	const struct option long_options [] = {
+		{"usage",0,NULL,'u'},
+		{"records",1,NULL,'n'},
+		{"queries",1,NULL,'q'},
+		{"dims",1,NULL,'d'},
+		{"block",1,NULL,'b'},
+		{"distribution",1,NULL,'x'},
+		{"seed",1,NULL,'s'},
+		{"folder",1,NULL,'f'},
+		{"output",1,NULL,'o'},
+		{"keep",0,NULL,'k'},
+		{NULL,0,NULL,0}
+	};
+
+	int next_option;
+
+	do{
+		next_option = getopt_long (argc,argv,short_options,long_options,NULL);
+
+		switch (next_option) {
+		case 'u':
+			print_usage (argv[0]);
+			flush_log ();
+			exit (EXIT_SUCCESS);
+		case 'n':
+			RECORDS = atol (optarg);
+			break;
+		case 'q':
+			QUERIES = atol (optarg);
+			break;
+		case 'd':
+			DIMENSIONS = atoi (optarg);
+			break;
+		case 'b':
+			PAGESIZE = atoi (optarg);
+			break;
+		case 'x':
+			if (!parse_distribution (optarg,&DISTRIBUTION)) {
+				LOG (error,"[%s] Unknown distribution: %s\n",argv[0],optarg);
+				print_usage (argv[0]);
+				flush_log ();
+				exit (EXIT_FAILURE);
+			}
+			break;
+		case 's':
+			SEED = atol (optarg);
+			break;
+		case 'f':
+			FOLDER = optarg;
+			break;
+		case 'o':
+			DATASET = optarg;
+			break;
+		case 'k':
+			KEEP = true;
+			break;
+		case -1:
+			break;
+		case '?':
+			LOG (error,"[%s] Unknown option parameter: %s\n",argv[0],optarg);
+		default:
+			print_usage (argv[0]);
+			flush_log ();
+			exit (EXIT_FAILURE);
+		}
+	}while(next_option!=-1);
+}
+
+static
+uint64_t monotonic_micros (void) {
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1000000 + now.tv_nsec/1000;
+}
+
+static
+int compare_latencies (void const*const x, void const*const y) {
+	uint64_t const a = *(uint64_t const*)x;
+	uint64_t const b = *(uint64_t const*)y;
+	return a < b ? -1 : a > b;
+}
+
+static
+uint64_t percentile (uint64_t const sorted[], uint64_t const size, double const fraction) {
+	if (!size) return 0;
+	uint64_t const rank = ceil (fraction*size);
+	return sorted[rank ? rank-1 : 0];
+}
+
+/**
+ * Workloads start with no pages of their trees buffered, so that
+ * those read are comparable from one build to another.
+ */
+static
+void begin_workload (measurement_t *const measurement, char const workload[], double const parameter,
+			tree_t *const outer, tree_t *const inner, uint64_t const operations) {
+	measurement->workload = workload;
+	measurement->parameter = parameter;
+	measurement->operations = 0;
+	measurement->results = 0;
+	measurement->latencies = (uint64_t*) malloc (sizeof(uint64_t)*operations);
+	if (measurement->latencies == NULL) {
+		LOG (fatal,"[begin_workload()] Unable to allocate memory for the latencies of %lu operations...\n",operations);
+		exit (EXIT_FAILURE);
+	}
+	measurement->trees[0] = outer;
+	measurement->trees[1] = inner;
+	for (uint32_t i=0; i<2; ++i) {
+		if (measurement->trees[i] != NULL) {
+			if (measurement->trees[i]->indexed_records) {
+				flush_tree (measurement->trees[i]);
+			}
+			measurement->before[i] = measurement->trees[i]->stats;
+		}
+	}
+	measurement->started = monotonic_micros ();
+}
+
+static
+void record_operation (measurement_t *const measurement, uint64_t const started, uint64_t const results) {
+	measurement->latencies[measurement->operations++] = monotonic_micros () - started;
+	measurement->results += results;
+}
+
+static
+void end_workload (measurement_t *const measurement) {
+	double const seconds = (monotonic_micros () - measurement->started) / 1e6;
+
+	uint64_t reads = 0, hits = 0, writes = 0, splits = 0, merges = 0;
+	for (uint32_t i=0; i<2; ++i) {
+		tree_t const*const tree = measurement->trees[i];
+		if (tree != NULL && (i == 0 || tree != measurement->trees[0])) {
+			reads += tree->stats.misses - measurement->before[i].misses;
+			hits += tree->stats.hits - measurement->before[i].hits;
+			writes += tree->stats.dirty_writes - measurement->before[i].dirty_writes;
+			splits += tree->stats.splits - measurement->before[i].splits;
+			merges += tree->stats.merges - measurement->before[i].merges;
+		}
+	}
+
+	uint64_t const operations = measurement->operations;
+	uint64_t *const latencies = measurement->latencies;
+	qsort (latencies,operations,sizeof(uint64_t),compare_latencies);
+
+	struct rusage usage;
+	getrusage (RUSAGE_SELF,&usage);
+
+	printf ("%s\n\t\t{\"workload\": \"%s\", \"parameter\": %g, \"operations\": %lu, \"results\": %lu, \"seconds\": %.6f, "
+		"\"operations_per_second\": %.3f, \"results_per_second\": %.3f, "
+		"\"latency_us\": {\"p50\": %lu, \"p90\": %lu, \"p99\": %lu, \"max\": %lu}, "
+		"\"page_reads\": %lu, \"page_hits\": %lu, \"page_writes\": %lu, \"splits\": %lu, \"merges\": %lu, "
+		"\"peak_rss_kb\": %ld}",
+		is_first_workload ? "" : ",",
+		measurement->workload,measurement->parameter,operations,measurement->results,seconds,
+		seconds > 0 ? operations/seconds : 0,seconds > 0 ? measurement->results/seconds : 0,
+		percentile (latencies,operations,.5),percentile (latencies,operations,.9),
+		percentile (latencies,operations,.99),operations ? latencies[operations-1] : 0,
+		reads,hits,writes,splits,merges,usage.ru_maxrss);
+	fflush (stdout);
+
+	is_first_workload = false;
+	free (latencies);
+}
+
+static
+uint64_t consume (cursor_t *const cursor) {
+	uint64_t results = 0;
+	if (cursor != NULL) {
+		while (next_tuple (cursor)) {
+			++results;
+		}
+		delete_cursor (cursor);
+	}
+	return results;
+}
+
+static
+tree_t* build_tree (char const name[], dataset_t const*const dataset, boolean const is_measured) {
+	char heapfile [strlen(FOLDER)+strlen(name)+2];
+	snprintf (heapfile,sizeof(heapfile),"%s/%s",FOLDER,name);
+	unlink (heapfile);
+
+	tree_t *const tree = new_rtree (heapfile,PAGESIZE,DIMENSIONS,false);
+	measurement_t measurement;
+	if (is_measured) {
+		begin_workload (&measurement,"build",dataset->size,tree,NULL,1);
+	}
+	uint64_t const started = monotonic_micros ();
+	bulk_load_rtree (tree,dataset->keys,dataset->objects,dataset->size,NULL,NULL);
+	flush_tree (tree);
+	if (is_measured) {
+		record_operation (&measurement,started,dataset->size);
+		end_workload (&measurement);
+	}
+	return tree;
+}
+
+static
+void run_updates (tree_t *const tree, dataset_t const*const updates) {
+	measurement_t measurement;
+	begin_workload (&measurement,"insert",updates->size,tree,NULL,updates->size);
+	for (uint64_t i=0; i<updates->size; ++i) {
+		uint64_t const started = monotonic_micros ();
+		insert_into_rtree (tree,updates->keys+i*DIMENSIONS,RECORDS+updates->objects[i]);
+		record_operation (&measurement,started,1);
+	}
+	flush_tree (tree);
+	end_workload (&measurement);
+
+	begin_workload (&measurement,"delete",updates->size,tree,NULL,updates->size);
+	for (uint64_t i=0; i<updates->size; ++i) {
+		uint64_t const started = monotonic_micros ();
+		object_t const deleted = delete_from_rtree (tree,updates->keys+i*DIMENSIONS);
+		record_operation (&measurement,started,deleted != (object_t)-1);
+	}
+	flush_tree (tree);
+	end_workload (&measurement);
+}
+
+/**
+ * Range queries cover the given fraction of the domain with boxes
+ * centered at the keys given, and kNN queries start from them.
+ */
+static
+void run_queries (tree_t *const tree, dataset_t const*const centers) {
+	measurement_t measurement;
+	for (uint32_t s=0; s<ENTRIES(selectivities); ++s) {
+		double const side = WORKLOAD_DOMAIN * pow (selectivities[s],1.0/DIMENSIONS);
+		begin_workload (&measurement,"range",selectivities[s],tree,NULL,centers->size);
+		for (uint64_t i=0; i<centers->size; ++i) {
+			index_t lo [DIMENSIONS], hi [DIMENSIONS];
+			for (uint32_t j=0; j<DIMENSIONS; ++j) {
+				lo[j] = centers->keys[i*DIMENSIONS+j] - side/2;
+				hi[j] = centers->keys[i*DIMENSIONS+j] + side/2;
+			}
+			uint64_t const started = monotonic_micros ();
+			record_operation (&measurement,started,consume (range_cursor (tree,lo,hi)));
+		}
+		end_workload (&measurement);
+	}
+
+	for (uint32_t k=0; k<ENTRIES(neighbors); ++k) {
+		begin_workload (&measurement,"knn",neighbors[k],tree,NULL,centers->size);
+		for (uint64_t i=0; i<centers->size; ++i) {
+			uint64_t const started = monotonic_micros ();
+			record_operation (&measurement,started,consume (nearest_cursor (tree,centers->keys+i*DIMENSIONS,neighbors[k])));
+		}
+		end_workload (&measurement);
+	}
+
+	uint32_t const corners = DIMENSIONS < 2 ? 1<<DIMENSIONS : 4;
+	for (uint32_t c=0; c<corners; ++c) {
+		boolean corner [DIMENSIONS];
+		for (uint32_t j=0; j<DIMENSIONS; ++j) {
+			corner[j] = j < 2 ? (c>>j)&1 : false;
+		}
+		begin_workload (&measurement,"skyline",c,tree,NULL,1);
+		uint64_t const started = monotonic_micros ();
+		record_operation (&measurement,started,consume (skyline_cursor (tree,corner)));
+		end_workload (&measurement);
+	}
+}
+
+static
+int compare_distances (void const*const x, void const*const y) {
+	double const a = *(double const*)x;
+	double const b = *(double const*)y;
+	return a < b ? -1 : a > b;
+}
+
+/**
+ * The distance within which every outer record is joined with the
+ * given number of inner ones on average, whatever the distribution;
+ * estimated from the distances of the sample given to their nearest
+ * inner records, from the quantile of those to the first neighbor for
+ * fewer pairs than records, or else from the median to the k-th one.
+ */
+static
+double join_threshold (tree_t *const inner, dataset_t const*const sample, double const ratio) {
+	uint32_t const k = ratio < 1 ? 1 : round (ratio);
+	double distances [sample->size];
+	for (uint64_t i=0; i<sample->size; ++i) {
+		cursor_t *const cursor = nearest_cursor (inner,sample->keys+i*DIMENSIONS,k);
+		distances[i] = 0;
+		while (next_tuple (cursor)) {
+			distances[i] = cursor->distance;
+		}
+		delete_cursor (cursor);
+	}
+	qsort (distances,sample->size,sizeof(double),compare_distances);
+	return distances[(uint64_t)((ratio < 1 ? ratio : .5)*(sample->size-1))];
+}
+
+static
+void run_joins (tree_t *const outer, tree_t *const inner, dataset_t const*const sample) {
+	measurement_t measurement;
+	for (uint32_t r=0; r<ENTRIES(join_ratios); ++r) {
+		double const theta = join_threshold (inner,sample,join_ratios[r]);
+		begin_workload (&measurement,"distance_join",join_ratios[r],outer,inner,1);
+		uint64_t const started = monotonic_micros ();
+		record_operation (&measurement,started,consume (distance_join_cursor (outer,inner,theta,1<<26)));
+		end_workload (&measurement);
+	}
+
+	for (uint32_t k=0; k<ENTRIES(closest_pairs); ++k) {
+		begin_workload (&measurement,"closest_pairs",closest_pairs[k],outer,inner,1);
+		uint64_t const started = monotonic_micros ();
+		record_operation (&measurement,started,consume (closest_pairs_cursor (outer,inner,closest_pairs[k])));
+		end_workload (&measurement);
+	}
+}
+
+static
+void dispose_tree (tree_t *const tree) {
+	char heapfile [strlen(tree->filename)+1];
+	strcpy (heapfile,tree->filename);
+	delete_tree (tree);
+	if (!KEEP) {
+		unlink (heapfile);
+	}
+}
+
+int main (int argc, char* argv[]) {
+	print_notice ();
+	process_arguments (argc,argv);
+
+	if (!RECORDS || !QUERIES || !DIMENSIONS || !PAGESIZE) {
+		LOG (error,"[%s] Please specify positive numbers of records, queries, dimensions and a block-size...\n",argv[0]);
+		print_usage (argv[0]);
+		flush_log ();
+		return EXIT_FAILURE;
+	}
+
+	dataset_t *const outer_dataset = generate_dataset (DISTRIBUTION,RECORDS,DIMENSIONS,SEED,SEED);
+	if (DATASET != NULL) {
+		boolean const written = write_dataset (outer_dataset,DATASET);
+		delete_dataset (outer_dataset);
+		flush_log ();
+		return written ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	dataset_t *const inner_dataset = generate_dataset (DISTRIBUTION,RECORDS,DIMENSIONS,SEED,SEED+1);
+	dataset_t *const query_dataset = generate_dataset (DISTRIBUTION,QUERIES,DIMENSIONS,SEED,SEED+2);
+
+	printf ("{\n\t\"configuration\": {\"distribution\": \"%s\", \"records\": %lu, \"queries\": %lu, "
+		"\"dimensions\": %u, \"block\": %u, \"seed\": %lu, \"compiled\": \"%s %s\"},\n\t\"workloads\": [",
+		distribution_name (DISTRIBUTION),RECORDS,QUERIES,DIMENSIONS,PAGESIZE,SEED,__DATE__,__TIME__);
+
+	tree_t *const outer = build_tree ("benchmark.outer.rtree",outer_dataset,true);
+	tree_t *const inner = build_tree ("benchmark.inner.rtree",inner_dataset,false);
+
+	run_updates (outer,query_dataset);
+	run_queries (outer,query_dataset);
+	run_joins (outer,inner,query_dataset);
+
+	puts ("\n\t]\n}");
+
+	dispose_tree (outer);
+	dispose_tree (inner);
+	delete_dataset (outer_dataset);
+	delete_dataset (inner_dataset);
+	delete_dataset (query_dataset);
+	flush_log ();
+	return EXIT_SUCCESS;
+}
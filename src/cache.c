@@ -0,0 +1,168 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "symbol_table.h"
+#include "cache.h"
+#include "defs.h"
+
+
+static
+int compare_keys (key__t const x, key__t const y) {
+	return strcmp ((char const*const)x,(char const*const)y);
+}
+
+static
+void detach_entry (cache_t *const cache, cache_entry_t *const entry) {
+	if (entry->newer != NULL) {
+		entry->newer->older = entry->older;
+	}else{
+		cache->newest = entry->older;
+	}
+	if (entry->older != NULL) {
+		entry->older->newer = entry->newer;
+	}else{
+		cache->oldest = entry->newer;
+	}
+	entry->newer = NULL;
+	entry->older = NULL;
+}
+
+static
+void attach_entry (cache_t *const cache, cache_entry_t *const entry) {
+	entry->newer = NULL;
+	entry->older = cache->newest;
+	if (cache->newest != NULL) {
+		cache->newest->newer = entry;
+	}else{
+		cache->oldest = entry;
+	}
+	cache->newest = entry;
+}
+
+static
+void delete_entry (cache_t *const cache, cache_entry_t *const entry) {
+	detach_entry (cache,entry);
+	unset (cache->entries,(key__t)entry->key);
+	cache->size -= entry->size;
+
+	if (cache->dispose != NULL) {
+		cache->dispose (entry->value);
+	}
+	free (entry->key);
+	free (entry);
+}
+
+
+cache_t* new_cache (uint64_t const capacity, void (*dispose) (value_t const)) {
+	cache_t *const cache = (cache_t *const) malloc (sizeof(cache_t));
+	if (cache == NULL) {
+		LOG (fatal,"[new_cache()] Unable to allocate memory for new cache...\n");
+		exit (EXIT_FAILURE);
+	}
+	cache->entries = new_symbol_table (NULL,&compare_keys);
+	cache->newest = NULL;
+	cache->oldest = NULL;
+	cache->dispose = dispose;
+	cache->capacity = capacity;
+	cache->size = 0;
+	return cache;
+}
+
+void clear_cache (cache_t *const cache) {
+	while (cache->oldest != NULL) {
+		delete_entry (cache,cache->oldest);
+	}
+}
+
+void delete_cache (cache_t *const cache) {
+	clear_cache (cache);
+	delete_symbol_table (cache->entries);
+	free (cache);
+}
+
+/**
+ * Returns the value kept under the key, if any, which
+ * then becomes the most recently used one.
+ */
+value_t get_cached (cache_t *const cache, char const key[]) {
+	cache_entry_t *const entry = (cache_entry_t *const) get (cache->entries,(key__t)key);
+	if (entry == NULL) {
+		return NULL;
+	}
+	if (entry != cache->newest) {
+		detach_entry (cache,entry);
+		attach_entry (cache,entry);
+	}
+	return entry->value;
+}
+
+/**
+ * Keeps a value of the given size in bytes under the key, replacing
+ * any previous one and disposing the least recently used values to
+ * make room for it. Values larger than the whole cache are rejected
+ * and left to the caller.
+ */
+boolean set_cached (cache_t *const cache, char const key[], value_t const value, uint64_t const size) {
+	if (size > cache->capacity) {
+		return false;
+	}
+
+	cache_entry_t *const previous = (cache_entry_t *const) get (cache->entries,(key__t)key);
+	if (previous != NULL) {
+		delete_entry (cache,previous);
+	}
+	while (cache->size + size > cache->capacity) {
+		delete_entry (cache,cache->oldest);
+	}
+
+	cache_entry_t *const entry = (cache_entry_t *const) malloc (sizeof(cache_entry_t));
+	if (entry == NULL) {
+		LOG (fatal,"[set_cached()] Unable to allocate memory for new cache entry...\n");
+		exit (EXIT_FAILURE);
+	}
+	entry->key = strdup (key);
+	entry->value = value;
+	entry->size = size;
+
+	set (cache->entries,(key__t)entry->key,entry);
+	attach_entry (cache,entry);
+	cache->size += size;
+	return true;
+}
+
+void unset_cached (cache_t *const cache, char const key[]) {
+	cache_entry_t *const entry = (cache_entry_t *const) get (cache->entries,(key__t)key);
+	if (entry != NULL) {
+		delete_entry (cache,entry);
+	}
+}
+
+/**
+ * Disposes all values for which the predicate holds.
+ */
+void purge_cache (cache_t *const cache, boolean (*predicate) (value_t const, void const*const), void const*const args) {
+	for (cache_entry_t* entry = cache->oldest; entry != NULL;) {
+		cache_entry_t *const newer = entry->newer;
+		if (predicate (entry->value,args)) {
+			delete_entry (cache,entry);
+		}
+		entry = newer;
+	}
+}
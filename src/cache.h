@@ -0,0 +1,17 @@
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include "defs.h"
+
+cache_t* new_cache (uint64_t const capacity, void (*dispose) (value_t const));
+
+void clear_cache (cache_t *const cache);
+void delete_cache (cache_t *const cache);
+
+value_t get_cached (cache_t *const cache, char const key[]);
+boolean set_cached (cache_t *const cache, char const key[], value_t const value, uint64_t const size);
+void unset_cached (cache_t *const cache, char const key[]);
+
+void purge_cache (cache_t *const cache, boolean (*predicate) (value_t const, void const*const), void const*const args);
+
+#endif /* CACHE_H_ */
@@ -78,6 +78,15 @@ page_t* new_rtree_internal (tree_t const*const tree) {
 		exit (EXIT_FAILURE);
 	}
 
+	page->node.internal.counts = NULL;
+	if (tree->is_aggregate) {
+		page->node.internal.counts = (uint64_t*) malloc (tree->internal_entries*sizeof(uint64_t));
+		if (page->node.internal.counts == NULL) {
+			LOG (fatal,"[%s][new_rtree_internal()] Unable to allocate additional memory for the counts of a new block...\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+	}
+
 	return page;
 }
 
@@ -338,9 +347,13 @@ void new_root (tree_t *const tree) {
 			insert_into_priority_queue (sorted_pages,remove_head_of_queue (transposed_ids));
 		}
 
+		uint64_t root_records = 0;
 		while (sorted_pages->size) {
 			symbol_table_entry_t *const entry = (symbol_table_entry_t *const) remove_from_priority_queue (sorted_pages);
 
+			if (entry->key == 1 && tree->is_aggregate) {
+				root_records = subtree_records (tree,entry->value);
+			}
 			low_level_write_of_page_to_disk (tree,entry->value,entry->key);
 			if (((page_t*)entry->value)->header.is_leaf) {
 				assert (((page_t*)entry->value)->header.records <= tree->leaf_entries);
@@ -364,6 +377,9 @@ void new_root (tree_t *const tree) {
 			memcpy (new_root->node.internal.intervals,
 					tree->root_box,
 					tree->dimensions*sizeof(index_t));
+			if (tree->is_aggregate) {
+				new_root->node.internal.counts[0] = root_records;
+			}
 		}else{
 			//*(new_root->node.group.ranges) = *(tree->root_range);
 			memcpy (new_root->node.group.ranges,
@@ -404,6 +420,120 @@ void new_root (tree_t *const tree) {
 }
 
 
+/**
+ * Decodes a block as laid out in the heapfile into a page of its own.
+ */
+page_t* decode_rtree_page (tree_t const*const tree, void const*const buffer) {
+	page_t *const page = (page_t *const) malloc (sizeof(page_t));
+	if (page == NULL) {
+		LOG (fatal,"[%s][decode_rtree_page()] Unable to reserve additional memory to decode a block...\n",tree->filename);
+		exit (EXIT_FAILURE);
+	}
+
+	memcpy (&page->header,buffer,sizeof(header_t));
+	page->header.records = le32toh (page->header.records);
+	void const* ptr = buffer + sizeof(header_t);
+	if (page->header.is_leaf) {
+		page->node.leaf.objects = (object_t*) malloc (tree->leaf_entries*sizeof(object_t));
+		if (page->node.leaf.objects == NULL) {
+			LOG (fatal,"[%s][decode_rtree_page()] Unable to allocate additional memory for the objects of a disk-page...\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+
+		page->node.leaf.keys = (index_t*) malloc (tree->dimensions*tree->leaf_entries*sizeof(index_t));
+		if (page->node.leaf.keys == NULL) {
+			LOG (fatal,"[%s][decode_rtree_page()] Unable to allocate additional memory for the keys of a disk-page...\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+
+		memcpy (page->node.leaf.keys,ptr,sizeof(index_t)*tree->dimensions*page->header.records);
+		if (sizeof(index_t) == sizeof(uint16_t)) {
+			uint16_t* le_ptr = page->node.leaf.keys;
+			for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
+				le_ptr[i] = le16toh (le_ptr[i]);
+			}
+		}else if (sizeof(index_t) == sizeof(uint32_t)) {
+			uint32_t* le_ptr = page->node.leaf.keys;
+			for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
+				le_ptr[i] = le32toh (le_ptr[i]);
+			}
+		}else if (sizeof(index_t) == sizeof(uint64_t)) {
+			uint64_t* le_ptr = page->node.leaf.keys;
+			for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
+				le_ptr[i] = le64toh (le_ptr[i]);
+			}
+		}else{
+			LOG (fatal,"[%s][decode_rtree_page()] Unable to serialize into a global heapfile format.\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+		ptr += sizeof(index_t)*tree->dimensions*page->header.records;
+
+		memcpy (page->node.leaf.objects,ptr,sizeof(object_t)*page->header.records);
+		if (sizeof(object_t) == sizeof(uint16_t)) {
+			uint16_t* le_ptr = page->node.leaf.objects;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				le_ptr[i] = le16toh (le_ptr[i]);
+			}
+		}else if (sizeof(object_t) == sizeof(uint32_t)) {
+			uint32_t* le_ptr = page->node.leaf.objects;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				le_ptr[i] = le32toh (le_ptr[i]);
+			}
+		}else if (sizeof(object_t) == sizeof(uint64_t)) {
+			uint64_t* le_ptr = page->node.leaf.objects;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				le_ptr[i] = le64toh (le_ptr[i]);
+			}
+		}else{
+			LOG (fatal,"[%s][decode_rtree_page()] Unable to deserialize into a global heapfile format.\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+	}else{
+		page->node.internal.intervals = (interval_t*) malloc (tree->dimensions*tree->internal_entries*sizeof(interval_t));
+		if (page->node.internal.intervals == NULL) {
+			LOG (fatal,"[%s][decode_rtree_page()] Unable to allocate additional memory for the entries of a disk-page...\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+
+		memcpy (page->node.internal.intervals,ptr,sizeof(interval_t)*tree->dimensions*page->header.records);
+		if (sizeof(index_t) == sizeof(uint16_t)) {
+			uint16_t* le_ptr = page->node.internal.intervals;
+			for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
+				le_ptr[i] = le16toh (le_ptr[i]);
+			}
+		}else if (sizeof(index_t) == sizeof(uint32_t)) {
+			uint32_t* le_ptr = page->node.internal.intervals;
+			for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
+				le_ptr[i] = le32toh (le_ptr[i]);
+			}
+		}else if (sizeof(index_t) == sizeof(uint64_t)) {
+			uint64_t* le_ptr = page->node.internal.intervals;
+			for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
+				le_ptr[i] = le64toh (le_ptr[i]);
+			}
+		}else{
+			LOG (fatal,"[%s][decode_rtree_page()] Unable to deserialize into a global heapfile format.\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+		ptr += sizeof(interval_t)*tree->dimensions*page->header.records;
+
+		page->node.internal.counts = NULL;
+		if (tree->is_aggregate) {
+			page->node.internal.counts = (uint64_t*) malloc (tree->internal_entries*sizeof(uint64_t));
+			if (page->node.internal.counts == NULL) {
+				LOG (fatal,"[%s][decode_rtree_page()] Unable to allocate additional memory for the counts of a disk-page...\n",tree->filename);
+				exit (EXIT_FAILURE);
+			}
+			memcpy (page->node.internal.counts,ptr,sizeof(uint64_t)*page->header.records);
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				page->node.internal.counts[i] = le64toh (page->node.internal.counts[i]);
+			}
+		}
+	}
+	page->header.is_dirty = false;
+	return page;
+}
+
 static
 load_page_return_pair_t* load_rtree_page (tree_t *const tree, uint64_t const position) {
 	pthread_rwlock_rdlock (&tree->tree_lock);
@@ -417,6 +547,7 @@ load_page_return_pair_t* load_rtree_page (tree_t *const tree, uint64_t const pos
 			pthread_rwlock_wrlock (&tree->tree_lock);
 			uint64_t swapped = SET_PRIORITY (position);
 			pthread_rwlock_unlock (&tree->tree_lock);
+			COUNT_EVENT(tree,hits);
 
 			assert (swapped != position);
 			if (swapped != 0xffffffffffffffff) {
@@ -451,14 +582,7 @@ load_page_return_pair_t* load_rtree_page (tree_t *const tree, uint64_t const pos
 			return NULL;
 		}
 
-		page = (page_t*) malloc (sizeof(page_t));
-		if (page == NULL) {
-			LOG (fatal,"[%s][load_rtree_page()] Unable to reserve additional memory to load block %lu from the external memory...\n",tree->filename,position);
-			close (fd);
-			exit (EXIT_FAILURE);
-		}
-
-		void *const buffer = (void *const) malloc (tree->page_size), *ptr;
+		void *const buffer = (void *const) malloc (tree->page_size);
 		if (buffer == NULL) {
 			LOG (fatal,"[%s][load_rtree_page()] Unable to buffer block %lu from the external memory...\n",tree->filename,position);
 			abort ();
@@ -466,105 +590,16 @@ load_page_return_pair_t* load_rtree_page (tree_t *const tree, uint64_t const pos
 		if (read (fd,buffer,tree->page_size) < tree->page_size) {
 			LOG (warn,"[%s][load_rtree_page()] Read less than %u bytes for block %lu in '%s'...\n",tree->filename,tree->page_size,position,tree->filename);
 		}
-
-		memcpy (&page->header,buffer,sizeof(header_t));
-		page->header.records = le32toh (page->header.records);
-		ptr = buffer + sizeof(header_t);
-		if (page->header.is_leaf) {
-			page->node.leaf.objects = (object_t*) malloc (tree->leaf_entries*sizeof(object_t));
-			if (page->node.leaf.objects == NULL) {
-				LOG (fatal,"[%s][load_rtree_page()] Unable to allocate additional memory for the objects of a disk-page...\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-
-			page->node.leaf.keys = (index_t*) malloc (tree->dimensions*tree->leaf_entries*sizeof(index_t));
-			if (page->node.leaf.keys == NULL) {
-				LOG (fatal,"[%s][load_rtree_page()] Unable to allocate additional memory for the keys of a disk-page...\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-
-			memcpy (page->node.leaf.keys,ptr,sizeof(index_t)*tree->dimensions*page->header.records);
-			if (sizeof(index_t) == sizeof(uint16_t)) {
-				uint16_t* le_ptr = page->node.leaf.keys;
-				for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
-					le_ptr[i] = le16toh (le_ptr[i]);
-				}
-			}else if (sizeof(index_t) == sizeof(uint32_t)) {
-				uint32_t* le_ptr = page->node.leaf.keys;
-				for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
-					le_ptr[i] = le32toh (le_ptr[i]);
-				}
-			}else if (sizeof(index_t) == sizeof(uint64_t)) {
-				uint64_t* le_ptr = page->node.leaf.keys;
-				for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
-					le_ptr[i] = le64toh (le_ptr[i]);
-				}
-			}else{
-				LOG (fatal,"[%s][load_rtree_page()] Unable to serialize into a global heapfile format.\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-			ptr += sizeof(index_t)*tree->dimensions*page->header.records;
-
-			memcpy (page->node.leaf.objects,ptr,sizeof(object_t)*page->header.records);
-			if (sizeof(object_t) == sizeof(uint16_t)) {
-				uint16_t* le_ptr = page->node.leaf.objects;
-				for (register uint32_t i=0; i<page->header.records; ++i) {
-					le_ptr[i] = le16toh (le_ptr[i]);
-				}
-			}else if (sizeof(object_t) == sizeof(uint32_t)) {
-				uint32_t* le_ptr = page->node.leaf.objects;
-				for (register uint32_t i=0; i<page->header.records; ++i) {
-					le_ptr[i] = le32toh (le_ptr[i]);
-				}
-			}else if (sizeof(object_t) == sizeof(uint64_t)) {
-				uint64_t* le_ptr = page->node.leaf.objects;
-				for (register uint32_t i=0; i<page->header.records; ++i) {
-					le_ptr[i] = le64toh (le_ptr[i]);
-				}
-			}else{
-				LOG (fatal,"[%s][load_rtree_page()] Unable to deserialize into a global heapfile format.\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-		}else{
-			page->node.internal.intervals = (interval_t*) malloc (tree->dimensions*tree->internal_entries*sizeof(interval_t));
-			if (page->node.internal.intervals == NULL) {
-				LOG (fatal,"[%s][load_rtree_page()] Unable to allocate additional memory for the entries of a disk-page...\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-
-			memcpy (page->node.internal.intervals,ptr,sizeof(interval_t)*tree->dimensions*page->header.records);
-			if (sizeof(index_t) == sizeof(uint16_t)) {
-				uint16_t* le_ptr = page->node.internal.intervals;
-				for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
-					le_ptr[i] = le16toh (le_ptr[i]);
-				}
-			}else if (sizeof(index_t) == sizeof(uint32_t)) {
-				uint32_t* le_ptr = page->node.internal.intervals;
-				for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
-					le_ptr[i] = le32toh (le_ptr[i]);
-				}
-			}else if (sizeof(index_t) == sizeof(uint64_t)) {
-				uint64_t* le_ptr = page->node.internal.intervals;
-				for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
-					le_ptr[i] = le64toh (le_ptr[i]);
-				}
-			}else{
-				LOG (fatal,"[%s][load_rtree_page()] Unable to deserialize into a global heapfile format.\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-		}
 		close (fd);
+
+		page = decode_rtree_page (tree,buffer);
 		free (buffer);
-		page->header.is_dirty = false;
 
 		pthread_rwlock_wrlock (&tree->tree_lock);
 		++tree->io_counter;
+		COUNT_EVENT(tree,misses);
+		TRACE_EVENT(disk_reads);
+		TRACE_EVENTS(bytes_read,tree->page_size);
 		SET_PAGE(position,page);
 		assert (page_lock == NULL);
 		page_lock = (pthread_rwlock_t*) malloc (sizeof(pthread_rwlock_t));
@@ -612,6 +647,7 @@ load_page_return_pair_t* load_ntree_page (tree_t *const tree, uint64_t const pos
 			pthread_rwlock_wrlock (&tree->tree_lock);
 			uint64_t swapped = SET_PRIORITY (position);
 			pthread_rwlock_unlock (&tree->tree_lock);
+			COUNT_EVENT(tree,hits);
 
 			assert (swapped != position);
 			if (swapped != 0xffffffffffffffff) {
@@ -829,6 +865,9 @@ load_page_return_pair_t* load_ntree_page (tree_t *const tree, uint64_t const pos
 
 		pthread_rwlock_wrlock (&tree->tree_lock);
 		++tree->io_counter;
+		COUNT_EVENT(tree,misses);
+		TRACE_EVENT(disk_reads);
+		TRACE_EVENTS(bytes_read,tree->page_size);
 		SET_PAGE(position,page);
 		assert (page_lock == NULL);
 		page_lock = (pthread_rwlock_t*) malloc (sizeof(pthread_rwlock_t));
@@ -864,6 +903,13 @@ load_page_return_pair_t* load_ntree_page (tree_t *const tree, uint64_t const pos
 }
 
 load_page_return_pair_t* load_page (tree_t *const tree, uint64_t const position) {
+	if (query_context != NULL) {
+		uint32_t level = 0;
+		for (uint64_t id=position; id && level<TRACE_LEVELS-1; id=PARENT_ID(id)) {
+			++level;
+		}
+		TRACE_EVENT(visits[level]);
+	}
 	return tree->root_range == NULL ?
 			load_rtree_page (tree,position)
 			:load_ntree_page (tree,position);
@@ -886,6 +932,8 @@ void delete_rtree_internal (page_t *const page) {
 	if (page != NULL) {
 		if (page->node.internal.intervals != NULL)
 			free (page->node.internal.intervals);
+		if (page->node.internal.counts != NULL)
+			free (page->node.internal.counts);
 
 		free (page);
 	}
@@ -946,6 +994,7 @@ uint64_t flush_page (tree_t *const tree, uint64_t const page_id) {
 	}
 
 	pthread_rwlock_wrlock (page_lock);
+	COUNT_EVENT(tree,evictions);
 	if (page->header.is_dirty) {
 		low_level_write_of_page_to_disk (tree,page,page_id);
 	}
@@ -968,6 +1017,98 @@ uint64_t flush_page (tree_t *const tree, uint64_t const page_id) {
 	return page_id;
 }
 
+/**
+ * Encodes a page as laid out in the heapfile into the buffer given,
+ * returning the bytes it occupies, which may not exceed a block.
+ */
+uint64_t encode_rtree_page (tree_t const*const tree, page_t const*const page, void *const buffer) {
+	void* ptr = buffer;
+	memcpy (ptr,&page->header,sizeof(header_t));
+	((header_t *const)ptr)->records = htole32(((header_t *const)ptr)->records);
+	ptr += sizeof(header_t);
+	if (page->header.is_leaf) {
+		assert (page->header.records);
+		memcpy (ptr,page->node.leaf.keys,sizeof(index_t)*tree->dimensions*page->header.records);
+		LOG (debug,"[%s][encode_rtree_page()] About to encode %lu bytes of %u-dimensional keys.\n",tree->filename,sizeof(index_t)*tree->dimensions*page->header.records,tree->dimensions);
+		if (sizeof(index_t) == sizeof(uint16_t)) {
+			uint16_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
+				le_ptr[i] = htole16 (le_ptr[i]);
+			}
+		}else if (sizeof(index_t) == sizeof(uint32_t)) {
+			uint32_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
+				le_ptr[i] = htole32 (le_ptr[i]);
+			}
+		}else if (sizeof(index_t) == sizeof(uint64_t)) {
+			uint64_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
+				le_ptr[i] = htole64 (le_ptr[i]);
+			}
+		}else{
+			LOG (fatal,"[%s][encode_rtree_page()] Unable to serialize into a global heapfile format.\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+		ptr += sizeof(index_t)*tree->dimensions*page->header.records;
+
+		memcpy (ptr,page->node.leaf.objects,sizeof(object_t)*page->header.records);
+		LOG (debug,"[%s][encode_rtree_page()] About to encode %lu bytes of identifiers.\n",tree->filename,sizeof(object_t)*page->header.records);
+		if (sizeof(object_t) == sizeof(uint16_t)) {
+			uint16_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				le_ptr[i] = htole16 (le_ptr[i]);
+			}
+		}else if (sizeof(object_t) == sizeof(uint32_t)) {
+			uint32_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				le_ptr[i] = htole32 (le_ptr[i]);
+			}
+		}else if (sizeof(object_t) == sizeof(uint64_t)) {
+			uint64_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				le_ptr[i] = htole64 (le_ptr[i]);
+			}
+		}else{
+			LOG (fatal,"[%s][encode_rtree_page()] Unable to serialize into a global heapfile format.\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+		ptr += sizeof(object_t)*page->header.records;
+	}else{
+		assert (page->header.records);
+		memcpy (ptr,page->node.leaf.keys,sizeof(interval_t)*tree->dimensions*page->header.records);
+		LOG (debug,"[%s][encode_rtree_page()] About to encode %lu bytes of %u-dimensional boxes.\n",tree->filename,sizeof(interval_t)*tree->dimensions*page->header.records,tree->dimensions);
+		if (sizeof(index_t) == sizeof(uint16_t)) {
+			uint16_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
+				le_ptr[i] = htole16 (le_ptr[i]);
+			}
+		}else if (sizeof(index_t) == sizeof(uint32_t)) {
+			uint32_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
+				le_ptr[i] = htole32 (le_ptr[i]);
+			}
+		}else if (sizeof(index_t) == sizeof(uint64_t)) {
+			uint64_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
+				le_ptr[i] = htole64 (le_ptr[i]);
+			}
+		}else{
+			LOG (fatal,"[%s][encode_rtree_page()] Unable to serialize into a global heapfile format.\n",tree->filename);
+			exit (EXIT_FAILURE);
+		}
+		ptr += sizeof(interval_t)*tree->dimensions*page->header.records;
+
+		if (tree->is_aggregate) {
+			uint64_t* le_ptr = ptr;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				le_ptr[i] = htole64 (page->node.internal.counts[i]);
+			}
+			ptr += sizeof(uint64_t)*page->header.records;
+		}
+	}
+	return ptr - buffer;
+}
+
 static
 uint64_t low_level_write_of_rtree_page_to_disk (tree_t *const tree, page_t *const page, uint64_t const position) {
 	int fd = open (tree->filename, O_WRONLY | O_CREAT, PERMS);
@@ -982,95 +1123,19 @@ uint64_t low_level_write_of_rtree_page_to_disk (tree_t *const tree, page_t *cons
 		}
 		page->header.is_dirty = false;
 
-		void *const buffer = (void *const) malloc (tree->page_size), *ptr;
+		void *const buffer = (void *const) malloc (tree->page_size);
 		if (buffer == NULL) {
 			LOG (fatal,"[%s][low_level_write_of_rtree_page_to_disk()] Unable to allocate enough memory so as to dump block...\n",tree->filename);
 			exit (EXIT_FAILURE);
 		}
 		bzero (buffer,tree->page_size);
 
-		ptr = buffer;
-		memcpy (ptr,&page->header,sizeof(header_t));
-		((header_t *const)ptr)->records = htole32(((header_t *const)ptr)->records);
-		ptr += sizeof(header_t);
 		if (page->header.is_leaf) {
 			LOG (info,"[%s][low_level_write_of_rtree_page_to_disk()] Flushing leaf-block at position %lu with %u records.\n",tree->filename,position,page->header.records);
-			assert (page->header.records);
-			memcpy (ptr,page->node.leaf.keys,sizeof(index_t)*tree->dimensions*page->header.records);
-			LOG (debug,"[%s][low_level_write_of_rtree_page_to_disk()] About to flush %lu bytes of %u-dimensional keys.\n",tree->filename,sizeof(index_t)*tree->dimensions*page->header.records,tree->dimensions);
-			if (sizeof(index_t) == sizeof(uint16_t)) {
-				uint16_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
-					le_ptr[i] = htole16 (le_ptr[i]);
-				}
-			}else if (sizeof(index_t) == sizeof(uint32_t)) {
-				uint32_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
-					le_ptr[i] = htole32 (le_ptr[i]);
-				}
-			}else if (sizeof(index_t) == sizeof(uint64_t)) {
-				uint64_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<tree->dimensions*page->header.records; ++i) {
-					le_ptr[i] = htole64 (le_ptr[i]);
-				}
-			}else{
-				LOG (fatal,"[%s][low_level_write_of_rtree_page_to_disk()] Unable to serialize into a global heapfile format.\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-			ptr += sizeof(index_t)*tree->dimensions*page->header.records;
-
-			memcpy (ptr,page->node.leaf.objects,sizeof(object_t)*page->header.records);
-			LOG (debug,"[%s][low_level_write_of_rtree_page_to_disk()] About to flush %lu bytes of identifiers.\n",tree->filename,sizeof(object_t)*page->header.records);
-			if (sizeof(object_t) == sizeof(uint16_t)) {
-				uint16_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<page->header.records; ++i) {
-					le_ptr[i] = htole16 (le_ptr[i]);
-				}
-			}else if (sizeof(object_t) == sizeof(uint32_t)) {
-				uint32_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<page->header.records; ++i) {
-					le_ptr[i] = htole32 (le_ptr[i]);
-				}
-			}else if (sizeof(object_t) == sizeof(uint64_t)) {
-				uint64_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<page->header.records; ++i) {
-					le_ptr[i] = htole64 (le_ptr[i]);
-				}
-			}else{
-				LOG (fatal,"[%s][low_level_write_of_rtree_page_to_disk()] Unable to serialize into a global heapfile format.\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-			ptr += sizeof(object_t)*page->header.records;
 		}else{
 			LOG (info,"[%s][low_level_write_of_rtree_page_to_disk()] Flushing non-leaf block at position %lu with %u children.\n",tree->filename,position,page->header.records);
-			assert (page->header.records);
-			memcpy (ptr,page->node.leaf.keys,sizeof(interval_t)*tree->dimensions*page->header.records);
-			LOG (debug,"[%s][low_level_write_of_rtree_page_to_disk()] About to flush %lu bytes of %u-dimensional boxes.\n",tree->filename,sizeof(interval_t)*tree->dimensions*page->header.records,tree->dimensions);
-			if (sizeof(index_t) == sizeof(uint16_t)) {
-				uint16_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
-					le_ptr[i] = htole16 (le_ptr[i]);
-				}
-			}else if (sizeof(index_t) == sizeof(uint32_t)) {
-				uint32_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
-					le_ptr[i] = htole32 (le_ptr[i]);
-				}
-			}else if (sizeof(index_t) == sizeof(uint64_t)) {
-				uint64_t* le_ptr = ptr;
-				for (register uint32_t i=0; i<(tree->dimensions*page->header.records<<1); ++i) {
-					le_ptr[i] = htole64 (le_ptr[i]);
-				}
-			}else{
-				LOG (fatal,"[%s][low_level_write_of_rtree_page_to_disk()] Unable to serialize into a global heapfile format.\n",tree->filename);
-				close (fd);
-				exit (EXIT_FAILURE);
-			}
-			ptr += sizeof(interval_t)*tree->dimensions*page->header.records;
 		}
-		uint64_t bytelength = ptr - buffer;
+		uint64_t const bytelength = encode_rtree_page (tree,page,buffer);
 		if (bytelength > tree->page_size) {
 			LOG (fatal,"[%s][low_level_write_of_rtree_page_to_disk()] Over-flown block at position %lu occupying %lu bytes when block-size is %u...\n",tree->filename,position,bytelength,tree->page_size);
 			close (fd);
@@ -1261,6 +1326,9 @@ uint64_t low_level_write_of_ntree_page_to_disk (tree_t *const tree, page_t *cons
 }
 
 uint64_t low_level_write_of_page_to_disk (tree_t *const tree, page_t *const page, uint64_t const position) {
+	COUNT_EVENT(tree,dirty_writes);
+	TRACE_EVENT(disk_writes);
+	TRACE_EVENTS(bytes_written,tree->page_size);
 	return tree->root_range == NULL ?
 			low_level_write_of_rtree_page_to_disk (tree,page,position)
 			:low_level_write_of_ntree_page_to_disk (tree,page,position);
@@ -1327,6 +1395,13 @@ uint64_t flush_tree (tree_t *const tree) {
 			close (fd);
 			exit (EXIT_FAILURE);
 		}
+
+		uint16_t le_tree_flags = htole16(tree->is_aggregate ? AGGREGATE_TREE_FLAG : 0);
+		if (write (fd,&le_tree_flags,sizeof(uint16_t)) < sizeof(uint16_t)) {
+			LOG (fatal,"[%s][flush_tree()] Wrote less than %lu bytes in heapfile '%s'...\n",tree->filename,sizeof(uint16_t),tree->filename);
+			close (fd);
+			exit (EXIT_FAILURE);
+		}
 		close (fd);
 	}
 
@@ -1581,8 +1656,62 @@ void update_upwards (tree_t *const tree, uint64_t page_id) {
 	}
 }
 
+/**
+ * Number of records indexed under a block of an aggregate tree.
+ */
+
+uint64_t subtree_records (tree_t const*const tree, page_t const*const page) {
+	if (page->header.is_leaf) return page->header.records;
+
+	uint64_t records = 0;
+	for (register uint32_t i=0; i<page->header.records; ++i) {
+		records += page->node.internal.counts[i];
+	}
+	return records;
+}
+
+/**
+ * Recomputes the counts of the entries leading from the root to the
+ * given block. Unlike boxes, counts change on every insertion and
+ * deletion, so the walk never stops short of the root.
+ */
+
+void update_counts (tree_t *const tree, uint64_t page_id) {
+	if (!tree->is_aggregate || tree->root_range != NULL) return;
+
+	for (;page_id; page_id = PARENT_ID(page_id)) {
+		load_page_return_pair_t *load_pair = load_page (tree,PARENT_ID(page_id));
+		pthread_rwlock_t *const parent_lock = load_pair->page_lock;
+		page_t *const parent = load_pair->page;
+		free (load_pair);
+
+		assert (parent != NULL);
+		assert (parent_lock != NULL);
+
+		load_pair = load_page (tree,page_id);
+		pthread_rwlock_t *const page_lock = load_pair->page_lock;
+		page_t const*const page = load_pair->page;
+		free (load_pair);
+
+		assert (page != NULL);
+		assert (page_lock != NULL);
+
+		pthread_rwlock_rdlock (page_lock);
+		pthread_rwlock_wrlock (parent_lock);
+		uint64_t const records = subtree_records (tree,page);
+		uint32_t const offset = CHILD_OFFSET(page_id);
+		if (parent->node.internal.counts[offset] != records) {
+			parent->node.internal.counts[offset] = records;
+			parent->header.is_dirty = true;
+		}
+		pthread_rwlock_unlock (parent_lock);
+		pthread_rwlock_unlock (page_lock);
+	}
+}
+
 void cascade_deletion (tree_t *const tree, uint64_t const page_id, uint32_t const offset) {
 	LOG(info,"[%s][cascade_deletion()] CASCADED DELETION TO BLOCK %lu.\n",tree->filename,page_id);
+	COUNT_EVENT(tree,merges);
 
 	load_page_return_pair_t *const load_pair = load_page (tree,page_id);
 	pthread_rwlock_t *const page_lock = load_pair->page_lock;
@@ -1620,6 +1749,9 @@ void cascade_deletion (tree_t *const tree, uint64_t const page_id, uint32_t cons
 				memcpy (page->node.internal.BOX(offset),
 						page->node.internal.BOX(page->header.records-1),
 						tree->dimensions*sizeof(interval_t));
+				if (tree->is_aggregate) {
+					page->node.internal.counts[offset] = page->node.internal.counts[page->header.records-1];
+				}
 			}else{
 				//page->node.group.ranges [offset] = page->node.group.ranges [page->header.records-1];
 				memcpy (page->node.group.ranges+offset,
@@ -1846,5 +1978,6 @@ void cascade_deletion (tree_t *const tree, uint64_t const page_id, uint32_t cons
 		pthread_rwlock_unlock (page_lock);
 
 		update_upwards(tree,page_id);
+		update_counts(tree,page_id);
 	}
 }
@@ -9,14 +9,17 @@ page_t* new_leaf (tree_t const*const tree);
 page_t* new_internal (tree_t const*const tree);
 void delete_rtree_page (page_t *const page);
 void delete_ntree_page (page_t *const page);
-void delete_tree (tree_t *const);
+INDEXING_API void delete_tree (tree_t *const);
 
 load_page_return_pair_t* load_page (tree_t *const tree, uint64_t const position);
 
-uint64_t flush_tree (tree_t *const tree);
+INDEXING_API uint64_t flush_tree (tree_t *const tree);
 uint64_t flush_page (tree_t *const tree, uint64_t const page_id);
 uint64_t low_level_write_of_page_to_disk (tree_t *const tree, page_t *const page, uint64_t const position);
 
+page_t* decode_rtree_page (tree_t const*const tree, void const*const buffer);
+uint64_t encode_rtree_page (tree_t const*const tree, page_t const*const page, void *const buffer);
+
 uint64_t compute_page_priority (tree_t *const tree, uint64_t const page_id);
 
 fifo_t* transpose_subsumed_pages (tree_t *const tree, uint64_t const from, uint64_t const to);
@@ -26,6 +29,9 @@ void cascade_deletion (tree_t *const tree, uint64_t const page_id, uint32_t cons
 
 void update_upwards (tree_t *const tree, uint64_t page_id);
 
+uint64_t subtree_records (tree_t const*const tree, page_t const*const page);
+void update_counts (tree_t *const tree, uint64_t page_id);
+
 void update_root_range (tree_t *const tree);
 
 void update_rootbox (tree_t *const tree);
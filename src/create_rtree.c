@@ -20,12 +20,11 @@
 #include "unistd.h"
 #include "getopt.h"
 
-pthread_mutex_t lmx = PTHREAD_MUTEX_INITIALIZER;
-
 uint32_t DIMENSIONS;
 uint32_t PAGESIZE;
 char* HEAPFILE;
 char* DATASET;
+boolean AGGREGATE;
 
 static
 void print_notice (void) {
@@ -41,17 +40,19 @@ void print_usage (char const*const program) {
 	puts ("\t\t-b --block :\t The desired size of each block.");
 	puts ("\t\t-a --dataset :\t The path to the datafile.");
 	puts ("\t\t-t --tree :\t The path to the binary heap-file.");
+	puts ("\t\t-g --aggregate :\t Keep subtree record counts in non-leaf blocks.");
 }
 
 static
 void process_arguments (int argc,char *argv[]) {
-	char const*const short_options = "ud:b:a:t:";
+	char const*const short_options = "ud:b:a:t:g";
 	const struct option long_options [] = {
 		{"usage",0,NULL,'u'},
 		{"dims",1,NULL,'d'},
 		{"block",1,NULL,'b'},
 		{"data",1,NULL,'a'},
 		{"tree",1,NULL,'t'},
+		{"aggregate",0,NULL,'g'},
 		{NULL,0,NULL,0}
 	};
 
@@ -63,7 +64,7 @@ void process_arguments (int argc,char *argv[]) {
 		switch (next_option) {
 		case 'u':
 			print_usage (argv[0]);
-			pthread_mutex_destroy (&lmx);
+			flush_log ();
 			exit (EXIT_SUCCESS);
 		case 'd':
 			DIMENSIONS = atoi (optarg);
@@ -77,13 +78,16 @@ void process_arguments (int argc,char *argv[]) {
 		case 't':
 			HEAPFILE = optarg;
 			break;
+		case 'g':
+			AGGREGATE = true;
+			break;
 		case -1:
 			break;
 		case '?':
 			LOG (error,"[%s] Unknown option parameter: %s\n",argv[0],optarg);
 		default:
 			print_usage (argv[0]);
-			pthread_mutex_destroy (&lmx);
+			flush_log ();
 			exit (EXIT_FAILURE);
 		}
 	}while(next_option!=-1);
@@ -108,16 +112,16 @@ int main (int argc, char* argv[]) {
 
 	if (DIMENSIONS && PAGESIZE && DATASET && HEAPFILE) {
 		unlink (HEAPFILE);
-		tree_t *const tree = new_rtree (HEAPFILE,PAGESIZE,DIMENSIONS);
+		tree_t *const tree = new_rtree (HEAPFILE,PAGESIZE,DIMENSIONS,AGGREGATE);
 		insert_records_from_textfile (tree,DATASET);
 		//flush_tree (tree);
 		//delete_records_from_textfile (tree,DATASET);
 		delete_tree (tree);
-		pthread_mutex_destroy (&lmx);
+		flush_log ();
 		return EXIT_SUCCESS;
 	}else{
 		print_usage (argv[0]);
-		pthread_mutex_destroy (&lmx);
+		flush_log ();
 		return EXIT_FAILURE;
 	}
 }
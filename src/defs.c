@@ -18,6 +18,27 @@
 #include "defs.h"
 #include <math.h>
 
+__thread query_context_t* query_context = NULL;
+__thread query_context_t trace_counters;
+
+
+/**
+ * Adds the events counted by the calling thread to those of
+ * the query it works for, if any, and starts counting anew.
+ */
+void merge_trace_counters (void) {
+	if (query_context != NULL) {
+		uint64_t const*const counted = (uint64_t const*const) &trace_counters;
+		uint64_t *const merged = (uint64_t *const) query_context;
+		for (uint32_t i=0; i<sizeof(query_context_t)/sizeof(uint64_t); ++i) {
+			if (counted[i]) {
+				__atomic_add_fetch (merged+i,counted[i],__ATOMIC_RELAXED);
+			}
+		}
+	}
+	bzero (&trace_counters,sizeof(query_context_t));
+}
+
 
 boolean equal_keys (index_t const key1[],
 			index_t const key2[],
@@ -33,6 +54,7 @@ boolean equal_keys (index_t const key1[],
 boolean key_enclosed_by_box (index_t const key[],
 				 interval_t const box[],
 				 uint32_t const dimensions) {
+	TRACE_EVENT(entries_tested);
 	for (uint32_t j=0; j<dimensions; ++j) {
 		if (key[j] < box[j].start || key[j] > box[j].end) {
 			return false;
@@ -55,8 +77,10 @@ boolean box_enclosed_by_box (interval_t const small_box[],
 boolean overlapping_boxes  (interval_t const box1[],
 				interval_t const box2[],
 				uint32_t const dimensions) {
+	TRACE_EVENT(entries_tested);
 	for (uint32_t j=0; j<dimensions; ++j) {
 		if (box1[j].start > box2[j].end || box1[j].end < box2[j].start) {
+			TRACE_EVENT(nodes_pruned);
 			return false;
 		}
 	}
@@ -93,6 +117,7 @@ int maxcompare_containers (void const*const x, void const*const y) {
 double key_to_key_distance (index_t const key1[],
 				index_t const key2[],
 				uint32_t const dimensions) {
+	TRACE_EVENT(distances);
 	double distance = 0;
 	for (uint32_t j=0; j<dimensions; ++j)
 		distance += pow(key1[j]-key2[j],2);
@@ -102,6 +127,7 @@ double key_to_key_distance (index_t const key1[],
 double key_to_box_mindistance (index_t const key[],
 				interval_t const box[],
 				uint32_t const dimensions) {
+	TRACE_EVENT(distances);
 	double distance = 0;
 	for (uint32_t i=0; i<dimensions; ++i) {
 		if (key[i] < box[i].start)
@@ -115,6 +141,7 @@ double key_to_box_mindistance (index_t const key[],
 double key_to_box_maxdistance (index_t const key[],
 				interval_t const box[],
 				uint32_t const dimensions) {
+	TRACE_EVENT(distances);
 	double distance = 0;
 	for (uint32_t i=0; i<dimensions; ++i) {
 		if (key[i] < box[i].start)
@@ -137,6 +164,7 @@ double key_to_box_maxdistance (index_t const key[],
 double box_to_box_mindistance (interval_t const box1[],
 				interval_t const box2[],
 				uint32_t const dimensions) {
+	TRACE_EVENT(distances);
 	double distance = 0;
 	for (uint32_t j=0; j<dimensions; ++j) {
 		if (box1[j].end < box2[j].start)
@@ -150,6 +178,7 @@ double box_to_box_mindistance (interval_t const box1[],
 double box_to_box_maxdistance (interval_t const box1[],
 				interval_t const box2[],
 				uint32_t const dimensions) {
+	TRACE_EVENT(distances);
 	double distance = 0;
 	for (uint32_t j=0; j<dimensions; ++j) {
 		if (box1[j].end < box2[j].start)
@@ -179,6 +208,7 @@ double box_to_box_maxdistance (interval_t const box1[],
 
 boolean dominated_key  (index_t const key[], index_t const reference_point[],
 						boolean const corner[], uint32_t const dimensions) {
+	TRACE_EVENT(entries_tested);
 	for (uint32_t j=0; j<dimensions; ++j) {
 		if (corner[j]) {
 			if (reference_point[j] < key[j]) {
@@ -198,6 +228,7 @@ boolean dominated_box (interval_t const box[],
 						index_t const reference_point[],
 						boolean const corner[],
 						uint32_t const dimensions) {
+	TRACE_EVENT(entries_tested);
 	for (uint32_t j=0; j<dimensions; ++j) {
 		if (corner[j]) {
 			if (reference_point[j] < box[j].end) {
@@ -209,6 +240,7 @@ boolean dominated_box (interval_t const box[],
 			}
 		}
 	}
+	TRACE_EVENT(nodes_pruned);
 	return true;
 }
 
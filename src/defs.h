@@ -62,6 +62,9 @@ extern uint32_t PAGESIZE;
 
 #define THREAD_STACK_SIZE (getpagesize()<<6)
 
+/* the entry points of libindexing, the only symbols exported by libindexing.so */
+#define INDEXING_API __attribute__ ((visibility ("default")))
+
 
 typedef union {
 	double fval;
@@ -125,8 +128,14 @@ typedef struct {
 	index_t end;
 } interval_t;
 
+/**
+ * Aggregate trees keep the number of records indexed under
+ * each child alongside its box; counts is NULL otherwise.
+ */
+
 typedef struct {
 	interval_t* intervals;
+	uint64_t* counts;
 } internal_node_t;
 
 typedef struct {
@@ -247,8 +256,123 @@ typedef struct {
 /*** SWAP DEFINITIONS END ***/
 
 
+/*** QUERY CONTEXT DEFINITIONS BEGIN ***/
+
+#define TRACE_LEVELS 16
+
+typedef enum {PARSE_PHASE, SUBQUERY_PHASE, JOIN_PHASE, SERIALIZE_PHASE, PHASES_NUMBER} phase_t;
+
+/**
+ * What the evaluation of a single query cost, as counted by every
+ * thread working on its behalf; i.e. the pages visited per level,
+ * counting the root as level zero, those of them read from the disk,
+ * the pages written to the disk, the entries tested against the query and the subtrees pruned by it,
+ * the distances computed, the traversals restarted for finding a page
+ * being written, and the microseconds spent in each of its phases.
+ */
+typedef struct {
+	uint64_t visits [TRACE_LEVELS];
+	uint64_t disk_reads;
+	uint64_t bytes_read;
+	uint64_t disk_writes;
+	uint64_t bytes_written;
+	uint64_t entries_tested;
+	uint64_t nodes_pruned;
+	uint64_t distances;
+	uint64_t restarts;
+	uint64_t phases [PHASES_NUMBER];
+} query_context_t;
+
+/* the query the calling thread works for, if any is being traced */
+extern __thread query_context_t* query_context;
+
+/**
+ * Events are counted by each thread on its own, so that the threads
+ * of a query do not contend for its counters, and are merged into
+ * those of the query once the thread is done working on its behalf.
+ */
+extern __thread query_context_t trace_counters;
+
+#define TRACE_EVENTS(event,n)	(query_context != NULL ? (trace_counters.event += (n)) : 0)
+#define TRACE_EVENT(event)	TRACE_EVENTS(event,1)
+
+void merge_trace_counters (void);
+
+/*** QUERY CONTEXT DEFINITIONS END ***/
+
+
+/*** THREAD-POOL DEFINITIONS BEGIN ***/
+
+typedef struct work_group work_group_t;
+
+typedef void (*work_function_t) (work_group_t *const, uint32_t const lane, void *const work);
+
+/**
+ * Each lane owns a deque of pending work; its worker
+ * pops from the tail, whereas idle workers of other
+ * lanes steal from the head.
+ */
+typedef struct {
+	fifo_t* deque;
+	pthread_mutex_t lock;
+} work_lane_t;
+
+struct work_group {
+	work_lane_t* lanes;
+	uint32_t lanes_number;
+
+	work_function_t process;
+	void* args;
+
+	/* the query traced by the threads helping the group, if any */
+	query_context_t* context;
+
+	uint64_t pending;
+	uint64_t queued;
+	uint32_t helpers;
+
+	pthread_mutex_t idle_lock;
+	pthread_cond_t idle_cond;
+};
+
+typedef struct {
+	work_group_t* group;
+	uint32_t lane;
+} work_ticket_t;
+
+typedef struct {
+	pthread_t* threads;
+	uint32_t threads_number;
+
+	fifo_t* tickets;
+	boolean is_shutdown;
+
+	pthread_mutex_t lock;
+	pthread_cond_t wakeup;
+	pthread_cond_t released;
+} thread_pool_t;
+
+/*** THREAD-POOL DEFINITIONS END ***/
+
+
 /***** R-TREE DEFINITIONS BEGIN *****/
 
+/**
+ * What has happened to the pages of a tree since it was loaded; i.e.
+ * how many were found buffered or had to be read, how many were evicted
+ * or written, how many traversals restarted for finding a page being
+ * written, and how many pages were split or merged on updates.
+ */
+typedef struct {
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t evictions;
+	uint64_t dirty_writes;
+	uint64_t restarts;
+	uint64_t splits;
+	uint64_t merges;
+} tree_stats_t;
+
 typedef struct {
 	object_range_t* root_range;
 	interval_t* root_box;
@@ -270,11 +394,16 @@ typedef struct {
 	uint32_t internal_entries;
 
 	uint64_t io_counter;
+	tree_stats_t stats;
+
+	/* bumped by every insertion and deletion */
+	uint64_t version;
 
 	uint32_t page_size;
 
 	uint16_t dimensions;
 	boolean is_dirty;
+	boolean is_aggregate;
 } tree_t;
 
 
@@ -282,6 +411,8 @@ typedef struct {
 #define CHILD_OFFSET(id)	((id)==0?0:((id+tree->internal_entries-1)%tree->internal_entries))
 #define CHILD_ID(id,offset)	((id)*tree->internal_entries+(offset)+1)
 
+#define AGGREGATE_TREE_FLAG	0x0001
+
 #define SET_PAGE(x,y)		set(tree->heapfile_index,(x),(y))
 #define UNSET_PAGE(x)		((page_t*)unset(tree->heapfile_index,(x)))
 #define LOADED_PAGE(x)		((page_t*)get(tree->heapfile_index,(x)))
@@ -304,6 +435,9 @@ typedef struct {
 
 #define TREE(i)			((tree_t *const)trees->buffer[i])
 
+#define COUNT_EVENT(tree,event)	__atomic_add_fetch (&(tree)->stats.event,1,__ATOMIC_RELAXED)
+#define TRYRDLOCK(tree,lock)	(pthread_rwlock_tryrdlock (lock) ? (COUNT_EVENT(tree,restarts),TRACE_EVENT(restarts),1) : 0)
+
 #define MIN(x,y)		((x)<(y)?(x):(y))
 #define MAX(x,y)		((x)>(y)?(x):(y))
 
@@ -397,6 +531,24 @@ typedef struct {
 	uint16_t cardinality;
 } multidata_container_t;
 
+/**
+ * Knobs of approximate query processing. A node is pruned as soon
+ * as its bound is off by a factor of (1+epsilon) from the current
+ * threshold. Once max_pages pages are visited (0 for no cap), no
+ * new subtrees are expanded, but the search still follows its most
+ * promising branch down to the leaves so that some result is found.
+ * On return, bound holds the guarantee of the produced result; that
+ * is the factor by which reported distances may at most be off for
+ * top-k operators, and the distance below (resp. above) which the
+ * result of a distance join is complete.
+ */
+typedef struct {
+	double epsilon;
+	uint64_t max_pages;
+
+	double bound;
+} approximation_t;
+
 
 int mincompare_multicontainers (void const*const, void const*const);
 int maxcompare_multicontainers (void const*const, void const*const);
@@ -433,9 +585,554 @@ double pairwise_mindistance (fifo_t const*const, uint32_t);
 #define DIVERSIFICATION_HEAP_SIZE 5
 #define MAX_ITERATIONS_NUMBER 256
 
+/*
+ * Combinations of leaf entries in joins are enumerated exhaustively
+ * as long as they are that few; more than that and the entries are
+ * sorted along an axis so that only those within a window are paired.
+ */
+#define PLANE_SWEEP_MIN_COMBINATIONS 256
+
+/*
+ * Draws of a sample that may be rejected per requested tuple before
+ * the remaining tuples are drawn from the materialized range instead.
+ */
+#define SAMPLE_REJECTION_LIMIT 64
+
 /** QUERY PROCESSING DEFINITIONS END **/
 
 
+/*** SPILL DEFINITIONS BEGIN ***/
+
+/*
+ * As soon as that many sorted runs of the same level have been
+ * written, they are merged into a single run of the next level,
+ * which bounds the number of temporary files open at any time.
+ */
+#define SPILL_MERGE_FANIN 16
+
+typedef struct {
+	FILE* file;
+	multidata_container_t* head;
+	int (*compare) (void const*const,void const*const);
+	uint32_t level;
+} spill_run_t;
+
+/**
+ * Join results kept in memory up to a limit, beyond
+ * which they are written out in sorted runs to temporary
+ * files and eventually merged back in the same order.
+ */
+typedef struct {
+	priority_queue_t* memory;
+	lifo_t* runs;
+	priority_queue_t* merge;
+
+	int (*compare) (void const*const,void const*const);
+
+	uint64_t memory_limit;
+	uint64_t memory_used;
+	uint64_t size;
+
+	uint64_t scan_position;
+	uint64_t scan_run;
+	multidata_container_t* scanned;
+} spill_t;
+
+/*** SPILL DEFINITIONS END ***/
+
+
+/*** PLANNER DEFINITIONS BEGIN ***/
+
+/**
+ * The fields reported for each result; unless a query picks them,
+ * these are its objects and their keys, and not the distances among
+ * the keys, which are only meaningful for joins.
+ */
+#define OBJECTS_FIELD 1
+#define KEYS_FIELD 2
+#define METRICS_FIELD 4
+#define DEFAULT_FIELDS (OBJECTS_FIELD|KEYS_FIELD)
+
+/**
+ * Pages of results are stable across requests for as long as their
+ * tree is unchanged: ranges are paged in the order of their leaves,
+ * neighbors in order of distance from the nearest, where ties are
+ * broken by the traversal, and skylines in an order fixed by theirs.
+ */
+#define NO_LIMIT UINT64_MAX
+
+/**
+ * A subquery as parsed from a command, before it is evaluated; its
+ * result is either streamed to the operator consuming it, or it is
+ * materialized into a temporary tree only if that operator needs one.
+ * The results of reverse NN subqueries are materialized on parsing.
+ */
+typedef struct {
+	tree_t* tree;
+	lifo_t* lookups;
+
+	index_t* from;
+	index_t* to;
+	index_t* bound;
+	boolean* corner;
+
+	approximation_t approximation;
+
+	uint32_t bounded_dimensionality;
+	uint32_t projection;
+	uint32_t parallelism;
+
+	boolean is_skyline;
+	boolean is_evaluated;
+	boolean is_count;
+	boolean materialize;
+
+	uint64_t sample_size;
+	uint64_t offset;
+	uint64_t limit;
+	boolean with_keys;
+
+	uint64_t estimated_records;
+	double estimated_cost;
+} subquery_t;
+
+typedef enum {
+	NO_JOIN = 0,
+	TRAVERSAL_JOIN,
+	PROBE_JOIN,
+	NESTED_LOOP_KNN_JOIN,
+	KNN_JOIN
+} join_method_t;
+
+/**
+ * The way a command is evaluated; the operands of a join are those
+ * of the command in order, and those of a traversal join are split
+ * into consecutive groups that are joined separately before their
+ * partial results are combined. Costs are estimated in page accesses.
+ */
+typedef struct {
+	subquery_t** operands;
+	uint32_t* groups;
+
+	uint32_t cardinality;
+	uint32_t groups_number;
+
+	join_method_t method;
+	uint32_t outer;
+
+	uint64_t estimated_records;
+	double estimated_cost;
+	double traversal_cost;
+} plan_t;
+
+/*
+ * Weight of writing out a page of a temporary tree relative to reading
+ * one, which accounts for the insertions that fill it up in the first
+ * place.
+ */
+#define MATERIALIZATION_PAGE_COST 4
+
+/*** PLANNER DEFINITIONS END ***/
+
+
+/*** CACHE DEFINITIONS BEGIN ***/
+
+/**
+ * Values kept under string keys up to a budget of bytes, beyond
+ * which the least recently used ones are disposed. Entries are
+ * chained from the most to the least recently used one.
+ */
+typedef struct cache_entry {
+	char* key;
+	value_t value;
+	uint64_t size;
+
+	struct cache_entry* newer;
+	struct cache_entry* older;
+} cache_entry_t;
+
+typedef struct {
+	symbol_table_t* entries;
+
+	cache_entry_t* newest;
+	cache_entry_t* oldest;
+
+	void (*dispose) (value_t const);
+
+	uint64_t capacity;
+	uint64_t size;
+} cache_t;
+
+/**
+ * The response to a command along with the versions of the
+ * heapfiles it was computed from, for which it remains valid.
+ */
+typedef struct {
+	char* data;
+	uint64_t length;
+
+	char* message;
+
+	char** heapfiles;
+	uint64_t* versions;
+	uint32_t heapfiles_number;
+
+	boolean is_cacheable;
+} cached_response_t;
+
+/*** CACHE DEFINITIONS END ***/
+
+
+/*** STATEMENT DEFINITIONS BEGIN ***/
+
+typedef enum {PLAIN_TOKEN=0,VALUE_TOKEN,STRING_TOKEN} token_kind_t;
+
+/**
+ * A parsed query that can be processed any number of times. Its
+ * tokens are laid out as pushed by the parser, only that values
+ * are referred to by their index, and that strings are owned by
+ * the statement. Placeholders bind arguments to values.
+ */
+typedef struct {
+	void** tokens;
+	token_kind_t* kinds;
+	uint64_t tokens_number;
+
+	double* values;
+	uint32_t values_number;
+
+	uint32_t* arguments;
+	uint32_t* positions;
+	uint32_t placeholders_number;
+	uint32_t arguments_number;
+
+	boolean is_single_subquery;
+} statement_t;
+
+/* bytes of parsed commands kept for when they are repeated */
+#define STATEMENTS_CACHE_SIZE (1<<20)
+
+/*** STATEMENT DEFINITIONS END ***/
+
+
+/*** SHARED RING DEFINITIONS BEGIN ***/
+
+/**
+ * A region of shared memory mapped by a co-located client, so that
+ * large results are handed over in place while only their descriptors
+ * cross the socket. The region begins with a header of native words;
+ * i.e. the magic bytes, its capacity, the position up to which the
+ * client has consumed results, and the position up to which the server
+ * has written them, followed by the results themselves. Positions only
+ * grow and wrap around the data modulo its capacity.
+ */
+typedef struct {
+	int fd;
+	char* region;
+	uint64_t capacity;
+	boolean is_announced;
+} shared_ring_t;
+
+#define SHARED_RING_MAGIC "IDXR"
+#define SHARED_RING_CAPACITY_OFFSET 8
+#define SHARED_RING_HEAD_OFFSET 16
+#define SHARED_RING_TAIL_OFFSET 24
+#define SHARED_RING_HEADER_SIZE 64
+#define SHARED_RING_CAPACITY (1<<24)
+#define SHARED_RING_THRESHOLD (1<<12)
+
+/*** SHARED RING DEFINITIONS END ***/
+
+
+/*** WRITER DEFINITIONS BEGIN ***/
+
+/**
+ * Output is buffered in a ring of fixed size that is flushed to the
+ * file-descriptor, if any, or else appended to a string that grows as
+ * needed. The tap, if any, is handed all output as it is flushed, and
+ * each flush to the file-descriptor is framed as a chunk if so asked,
+ * or else as a frame of the binary protocol, whose payload is placed
+ * in the shared ring, if any, when large enough and there is room.
+ */
+typedef struct {
+	char* ring;
+	uint64_t head;
+	uint64_t size;
+
+	int fd;
+	char* output;
+	uint64_t output_length;
+	uint64_t output_capacity;
+
+	void (*tap) (void *const, char const*const, uint64_t const);
+	void* tap_args;
+
+	boolean is_chunked;
+	boolean is_framed;
+	uint64_t unframed;
+	shared_ring_t* shared;
+} writer_t;
+
+#define WRITER_RING_SIZE (1<<16)
+
+/**
+ * Results are encoded as JSON, unless binary encoding is asked for,
+ * where tuples are sent in blocks either row by row or column by column.
+ */
+typedef enum {JSON_FORMAT, ROWS_FORMAT, COLUMNS_FORMAT} format_t;
+
+/**
+ * Binary results are little-endian, beginning with the magic bytes,
+ * the version, the layout (0 for rows, 1 for columns), and the sizes
+ * of object-ids and coordinates. Each block of tuples then follows as
+ * its number of tuples, the objects per tuple, and their dimensions,
+ * while an empty block ends the results of each command. A trailer
+ * marked as such carries the status, io-blocks, io-mb, proc-time,
+ * and the message prefixed by its length.
+ */
+#define BINARY_MAGIC "IDXB"
+#define BINARY_VERSION 1
+#define BINARY_BLOCK_ROWS 1024
+#define BINARY_END_OF_RESULTS 0
+#define BINARY_TRAILER 0xffffffff
+
+/*** WRITER DEFINITIONS END ***/
+
+
+/*** REACTOR DEFINITIONS BEGIN ***/
+
+/**
+ * Requests are read either as HTTP, or else as frames of the binary
+ * protocol of co-located clients, depending on the listening socket.
+ */
+typedef enum {HTTP_PROTOCOL, FRAMED_PROTOCOL} protocol_t;
+
+/**
+ * Handlers return whether the connection of a request is kept
+ * alive, so that any requests pipelined after it are served next.
+ * They may keep a session of their own for as long as it lasts.
+ */
+typedef boolean (*request_handler_t) (int const fd, char request[], uint64_t const length, void **const session, void *const args);
+
+/**
+ * A socket listening for connections, whose requests are read as
+ * its protocol dictates and are served by its handler; sessions are
+ * ended along with the connections they were kept for.
+ */
+typedef struct {
+	int fd;
+	protocol_t protocol;
+	request_handler_t handler;
+	void (*end_session) (void *const);
+	void* args;
+} listener_t;
+
+/**
+ * A connection whose requests are read without blocking, until
+ * the next one is complete and can be handed to a worker. It is
+ * kept open for as long as requests keep arriving in time.
+ */
+typedef struct {
+	int fd;
+	char* buffer;
+	uint64_t length;
+	uint64_t capacity;
+	uint64_t expected_length;
+	time_t last_active;
+
+	listener_t const* listener;
+	void* session;
+} connection_t;
+
+#define REACTOR_LISTENERS 4
+
+/**
+ * Connections are accepted from up to so many listening sockets and
+ * are read by a single thread waiting on them with epoll, whereas complete requests are served by a fixed
+ * number of workers. Once as many requests are pending as the queue
+ * holds, the reactor waits for the workers before reading any more,
+ * so that new connections are left in the backlog of the socket.
+ * Connections kept alive are noted by their file-descriptors while
+ * waiting for their next request, and are closed once left idle for
+ * as many seconds as the timeout.
+ */
+typedef struct {
+	int epoll_fd;
+	listener_t listeners [REACTOR_LISTENERS];
+	uint32_t listeners_number;
+
+	pthread_t* workers;
+	uint32_t workers_number;
+
+	fifo_t* requests;
+	uint32_t capacity;
+
+	connection_t** waiting;
+	uint32_t waiting_capacity;
+	uint32_t idle_timeout;
+	pthread_mutex_t waiting_lock;
+
+	boolean is_shutdown;
+	uint32_t active_workers;
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+} reactor_t;
+
+#define REACTOR_EVENTS 256
+#define REACTOR_QUEUE_FACTOR 64
+#define REQUEST_SIZE_LIMIT (1<<30)
+#define HEADERS_SIZE_LIMIT (BUFSIZ<<3)
+#define HEADER_LINE_LIMIT BUFSIZ
+#define CONNECTION_BUFFER_SIZE (BUFSIZ<<1)
+#define CONNECTION_IDLE_TIMEOUT 15
+
+/**
+ * Framed requests begin with the length of their payload (le32), the
+ * operation, the flags, and two reserved bytes. Queries carry their
+ * URL as for HTTP, insertions and deletions their records in JSON,
+ * and bulk loads the name of their heapfile, terminated by a zero,
+ * followed by their records as posted in bulk. Results are binary,
+ * column by column if so flagged, and are sent in frames preceded by
+ * the length of their payload (le32), or else by that length marked as
+ * shared along with the position of the payload in the shared ring
+ * (le64), until an empty frame. The ring of a connection is created
+ * by its first request so flagged, and its file-descriptor is passed
+ * along with the first frame placed in it; the client moves the head
+ * of the ring past each payload once it is done with it.
+ */
+#define FRAME_HEADER_SIZE 8
+#define FRAME_QUERY 'G'
+#define FRAME_PUT 'P'
+#define FRAME_DELETE 'D'
+#define FRAME_BULK 'B'
+#define FRAME_COLUMNS 0x1
+#define FRAME_SHARED 0x2
+#define FRAME_SHARED_PAYLOAD 0x80000000
+
+/*** REACTOR DEFINITIONS END ***/
+
+
+/*** INGEST DEFINITIONS BEGIN ***/
+
+/**
+ * The records of a PUT or DELETE request, scanned in a single pass
+ * into flat arrays; i.e. the keys one after the other, each with as
+ * many coordinates as the first one, and their objects, which are
+ * zero for deletions. Records with fewer coordinates than the first
+ * one are counted as failed, while any more coordinates are ignored.
+ */
+typedef struct {
+	char heapfile [64];
+	uint32_t dimensions;
+
+	index_t* keys;
+	object_t* objects;
+	uint64_t size;
+	uint64_t capacity;
+
+	uint64_t failed;
+} ingest_t;
+
+#define INGEST_COORDINATES_LIMIT BUFSIZ
+#define INGEST_NUMBER_LIMIT 64
+#define INGEST_INITIAL_CAPACITY 1024
+
+/**
+ * Records ingested in bulk are little-endian, beginning with the same
+ * magic bytes, version, layout (0 for rows), and sizes of object-ids
+ * and coordinates as binary results, followed by the dimensionality
+ * of their keys. Each record then follows as its object and the
+ * coordinates of its key, up to the end of the body.
+ */
+#define BULK_HEADER_SIZE 12
+
+/**
+ * Bulk loads and batched insertions report every so many records
+ * how many of them have been indexed so far, along with their total.
+ */
+typedef void (*progress_t) (uint64_t const processed, uint64_t const total, void *const args);
+
+#define BULK_PROGRESS_INTERVAL (1<<16)
+
+/*** INGEST DEFINITIONS END ***/
+
+
+/*** CURSOR DEFINITIONS BEGIN ***/
+
+typedef enum {PAIRS_CURSOR, CONTAINERS_CURSOR, TUPLES_CURSOR, SPILL_CURSOR} cursor_source_t;
+
+/**
+ * The results of a query run in-process, consumed one tuple at a time.
+ * The current tuple consists of as many objects as the trees combined
+ * by the query, one after the other, with their keys likewise, along
+ * with its distance for queries ranking their results by distance.
+ * Tuples are drawn either from a queue of results or from a spill.
+ */
+typedef struct {
+	fifo_t* queue;
+	spill_t* spill;
+	cursor_source_t source;
+
+	uint32_t cardinality;
+	uint32_t dimensions;
+
+	object_t* objects;
+	index_t* keys;
+	double distance;
+} cursor_t;
+
+/*** CURSOR DEFINITIONS END ***/
+
+
+/*** STATISTICS DEFINITIONS BEGIN ***/
+
+typedef enum {LOOKUP_OPERATOR, RANGE_OPERATOR, NEAREST_OPERATOR, SKYLINE_OPERATOR, SAMPLE_OPERATOR, COUNT_OPERATOR,
+		DISTANCE_JOIN_OPERATOR, CLOSEST_PAIRS_OPERATOR, KNN_JOIN_OPERATOR,
+		INSERT_OPERATOR, DELETE_OPERATOR, BULK_OPERATOR, OPERATORS_NUMBER} operator_t;
+
+#define HISTOGRAM_PRECISION 7
+#define HISTOGRAM_MAGNITUDE 40
+#define HISTOGRAM_BUCKETS ((1<<HISTOGRAM_PRECISION)+(HISTOGRAM_MAGNITUDE-HISTOGRAM_PRECISION)*(1<<(HISTOGRAM_PRECISION-1)))
+
+/**
+ * Wall-clock latencies in microseconds, counted in buckets of high
+ * dynamic range; i.e. one per value below 2^HISTOGRAM_PRECISION, and
+ * then half as many per doubling, so that every value is reported to
+ * within 1/64 of it, up to 2^HISTOGRAM_MAGNITUDE microseconds.
+ */
+typedef struct {
+	uint64_t counts [HISTOGRAM_BUCKETS];
+	uint64_t total;
+	uint64_t sum;
+	uint64_t max;
+} histogram_t;
+
+/*** STATISTICS DEFINITIONS END ***/
+
+
+/*** WORKLOAD DEFINITIONS BEGIN ***/
+
+typedef enum {UNIFORM_DISTRIBUTION, CLUSTERED_DISTRIBUTION, SKEWED_DISTRIBUTION} distribution_t;
+
+/* the extent of every dimension of generated keys */
+#define WORKLOAD_DOMAIN		1000.0
+#define WORKLOAD_CLUSTERS	16
+
+/**
+ * Synthetic records, laid out like those given to bulk_load_rtree;
+ * i.e. the keys of all records one after the other.
+ */
+typedef struct {
+	index_t* keys;
+	object_t* objects;
+	uint64_t size;
+	uint32_t dimensions;
+} dataset_t;
+
+/*** WORKLOAD DEFINITIONS END ***/
+
+
 /*** NETWORK DEFINITIONS BEGIN ***/
 
 typedef struct {
@@ -455,46 +1152,37 @@ arc_t* new_arc (object_t const, object_t const, arc_weight_t const);
 
 enum message_t {debug=1,info,warn,error,fatal};
 
-#define logging warn
+/* messages below this level are compiled out; e.g. -DLOGGING_LEVEL=debug */
+#ifndef LOGGING_LEVEL
+#define LOGGING_LEVEL warn
+#endif
 
-#include <time.h>
-#include <pthread.h>
-extern pthread_mutex_t lmx;
-
-#define LOG(level,message...)	if (logging<=level){\
-				while (pthread_mutex_trylock(&lmx));\
-				time_t t;\
-				time (&t);\
-				struct tm *timeinfo = localtime (&t);\
-				struct timeval tv;\
-				gettimeofday (&tv,NULL);\
-				/*fprintf(stderr,"[%u/%02u/%02u %02u:%02u:%02u:%06u] ",timeinfo->tm_year+1900,timeinfo->tm_mon+1,timeinfo->tm_mday,timeinfo->tm_hour,timeinfo->tm_min,timeinfo->tm_sec,tv.tv_usec);*/\
-				fprintf(stderr,"\033[11;47;30m[%u/%02u/%02u %02u:%02u:%02u:%06u]\033[0m ",timeinfo->tm_year+1900,timeinfo->tm_mon+1,timeinfo->tm_mday,timeinfo->tm_hour,timeinfo->tm_min,timeinfo->tm_sec,tv.tv_usec);\
-				switch (level) {\
-				case debug:\
-					/*fprintf(stderr,"DEBUG "message);*/\
-					fprintf(stderr,"\033[1;34mDEBUG\033[0m "message);\
-					break;\
-				case info:\
-					/*fprintf(stderr,"INFO "message);*/\
-					fprintf(stderr,"\033[1;32mINFO\033[0m "message);\
-					break;\
-				case warn: \
-					/*fprintf(stderr,"WARNING "message);*/\
-					fprintf(stderr,"\033[1;33mWARNING\033[0m "message);\
-					break;\
-				case error: \
-					/*fprintf(stderr,"ERROR "message);*/\
-					fprintf(stderr,"\033[1;31mERROR\033[0m "message);\
-					break;\
-				case fatal: \
-					/*fprintf(stderr,"FATAL "message);*/\
-					fprintf(stderr,"\033[1;35mFATAL\033[0m "message);\
-					break;\
-				default: \
-					fprintf(stderr," "message);\
-				}\
-				pthread_mutex_unlock (&lmx);\
+#define logging LOGGING_LEVEL
+
+#define LOG_BUFFER_SIZE		(1<<16)
+#define LOG_MESSAGE_SIZE	2048
+#define LOG_DRAIN_INTERVAL	2000
+
+typedef struct {
+	uint64_t second;
+	uint64_t count;
+	uint64_t suppressed;
+	uint64_t rate;
+} log_limit_t;
+
+void log_message (enum message_t const, char const[], ...);
+void log_append (char const[], ...);
+void flush_log (void);
+
+boolean is_log_permitted (log_limit_t *const, uint64_t *const);
+
+#define LOG(level,message...)	if (LOGGING_LEVEL<=level){\
+				log_message (level,message);\
+				}
+
+/* continues the message last logged by the thread, without a header of its own */
+#define LOG_MORE(level,message...)	if (LOGGING_LEVEL<=level){\
+				log_append (message);\
 				}
 
 /** LOGGING DEFINITIONS END **/
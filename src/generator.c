@@ -0,0 +1,201 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "generator.h"
+#include "defs.h"
+
+
+static char const*const distribution_names [] = {"uniform","clustered","skewed"};
+
+/**
+ * Datasets are reproduced exactly by their seed, as the numbers
+ * drawn do not depend on the C library (splitmix64).
+ */
+uint64_t next_random (uint64_t *const state) {
+	uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/* uniformly in [0,1) */
+static
+double next_uniform (uint64_t *const state) {
+	return (next_random (state) >> 11) * (1.0/(1ULL<<53));
+}
+
+/* standard normal, by Box-Muller */
+static
+double next_gaussian (uint64_t *const state) {
+	double const u = 1 - next_uniform (state);
+	double const v = next_uniform (state);
+	return sqrt (-2*log (u)) * cos (2*M_PI*v);
+}
+
+static
+boolean in_domain (double const point[], uint32_t const dimensions) {
+	for (uint32_t j=0; j<dimensions; ++j) {
+		if (point[j] < 0 || point[j] >= WORKLOAD_DOMAIN) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Gaussian clusters of equal size and spread around centers placed
+ * uniformly, with points falling outside the domain drawn again.
+ */
+static
+void next_clustered (uint64_t *const state, double const centers[], uint32_t const dimensions, double point[]) {
+	double const*const center = centers + (next_random (state) % WORKLOAD_CLUSTERS) * dimensions;
+	do{
+		for (uint32_t j=0; j<dimensions; ++j) {
+			point[j] = center[j] + next_gaussian (state) * WORKLOAD_DOMAIN * .02;
+		}
+	}while (!in_domain (point,dimensions));
+}
+
+/**
+ * Resembles populated places; i.e. hotspots chosen with Zipfian
+ * probabilities, around which density falls off with a heavy tail,
+ * so that a few places are dense and most of the domain is sparse.
+ */
+static
+void next_skewed (uint64_t *const state, double const centers[], double const cumulative[], uint32_t const dimensions, double point[]) {
+	double const u = next_uniform (state) * cumulative[WORKLOAD_CLUSTERS-1];
+	uint32_t hotspot = 0;
+	while (cumulative[hotspot] < u) {
+		++hotspot;
+	}
+	double const*const center = centers + hotspot*dimensions;
+	do{
+		double norm = 0;
+		for (uint32_t j=0; j<dimensions; ++j) {
+			point[j] = next_gaussian (state);
+			norm += point[j]*point[j];
+		}
+		double const radius = WORKLOAD_DOMAIN * .001 / pow (1-next_uniform (state),.8);
+		norm = sqrt (norm);
+		for (uint32_t j=0; j<dimensions; ++j) {
+			point[j] = center[j] + (norm > 0 ? point[j]/norm : 0) * radius;
+		}
+	}while (!in_domain (point,dimensions));
+}
+
+/**
+ * Records numbered from one, keyed within [0,WORKLOAD_DOMAIN) on every
+ * dimension, drawn as the distribution given with the seed given. The
+ * centers of clusters and hotspots are placed by the layout given, so
+ * that datasets drawn with other seeds but the same layout join.
+ */
+dataset_t* generate_dataset (distribution_t const distribution, uint64_t const size, uint32_t const dimensions,
+				uint64_t const layout, uint64_t const seed) {
+	dataset_t *const dataset = (dataset_t *const) malloc (sizeof(dataset_t));
+	if (dataset == NULL) {
+		LOG (fatal,"[generate_dataset()] Unable to allocate memory for new dataset...\n");
+		exit (EXIT_FAILURE);
+	}
+	dataset->size = size;
+	dataset->dimensions = dimensions;
+	dataset->keys = (index_t*) malloc (sizeof(index_t)*dimensions*size);
+	dataset->objects = (object_t*) malloc (sizeof(object_t)*size);
+	if (dataset->keys == NULL || dataset->objects == NULL) {
+		LOG (fatal,"[generate_dataset()] Unable to allocate memory for %lu records...\n",size);
+		exit (EXIT_FAILURE);
+	}
+
+	uint64_t state = layout;
+	double centers [WORKLOAD_CLUSTERS*dimensions];
+	double cumulative [WORKLOAD_CLUSTERS];
+	for (uint32_t i=0; i<WORKLOAD_CLUSTERS; ++i) {
+		for (uint32_t j=0; j<dimensions; ++j) {
+			centers[i*dimensions+j] = WORKLOAD_DOMAIN * (.05 + .9*next_uniform (&state));
+		}
+		cumulative[i] = (i ? cumulative[i-1] : 0) + 1.0/(i+1);
+	}
+
+	state = seed;
+	double point [dimensions];
+	for (uint64_t i=0; i<size; ++i) {
+		switch (distribution) {
+			case CLUSTERED_DISTRIBUTION:
+				next_clustered (&state,centers,dimensions,point);
+				break;
+			case SKEWED_DISTRIBUTION:
+				next_skewed (&state,centers,cumulative,dimensions,point);
+				break;
+			default:
+				for (uint32_t j=0; j<dimensions; ++j) {
+					point[j] = WORKLOAD_DOMAIN * next_uniform (&state);
+				}
+		}
+		for (uint32_t j=0; j<dimensions; ++j) {
+			dataset->keys[i*dimensions+j] = point[j];
+		}
+		dataset->objects[i] = i+1;
+	}
+	return dataset;
+}
+
+void delete_dataset (dataset_t *const dataset) {
+	free (dataset->keys);
+	free (dataset->objects);
+	free (dataset);
+}
+
+/**
+ * Writes records as expected by create#rtree; i.e. one per line,
+ * its object followed by the coordinates of its key.
+ */
+boolean write_dataset (dataset_t const*const dataset, char const filename[]) {
+	FILE *const fptr = fopen (filename,"w");
+	if (fptr == NULL) {
+		LOG (error,"[write_dataset()] Cannot open file '%s' for writing...\n",filename);
+		return false;
+	}
+	for (uint64_t i=0; i<dataset->size; ++i) {
+		fprintf (fptr,"%lu",dataset->objects[i]);
+		for (uint32_t j=0; j<dataset->dimensions; ++j) {
+			fprintf (fptr," %f",(double)dataset->keys[i*dataset->dimensions+j]);
+		}
+		fputc ('\n',fptr);
+	}
+	if (fclose (fptr)) {
+		LOG (error,"[write_dataset()] Unable to write file '%s'...\n",filename);
+		return false;
+	}
+	return true;
+}
+
+boolean parse_distribution (char const name[], distribution_t *const distribution) {
+	for (uint32_t i=0; i<sizeof(distribution_names)/sizeof(*distribution_names); ++i) {
+		if (!strcmp (name,distribution_names[i])) {
+			*distribution = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+char const* distribution_name (distribution_t const distribution) {
+	return distribution_names[distribution];
+}
@@ -0,0 +1,17 @@
+#ifndef GENERATOR_H_
+#define GENERATOR_H_
+
+#include "defs.h"
+
+dataset_t* generate_dataset (distribution_t const distribution, uint64_t const size, uint32_t const dimensions,
+				uint64_t const layout, uint64_t const seed);
+void delete_dataset (dataset_t *const dataset);
+
+boolean write_dataset (dataset_t const*const dataset, char const filename[]);
+
+uint64_t next_random (uint64_t *const state);
+
+boolean parse_distribution (char const name[], distribution_t *const distribution);
+char const* distribution_name (distribution_t const distribution);
+
+#endif /* GENERATOR_H_ */
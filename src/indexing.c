@@ -0,0 +1,145 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "spatial_standard_queries.h"
+#include "skyline_queries.h"
+#include "indexing.h"
+#include "spill.h"
+#include "queue.h"
+#include "stack.h"
+#include "defs.h"
+
+
+static
+cursor_t* new_cursor (fifo_t *const queue, spill_t *const spill, cursor_source_t const source,
+			uint32_t const cardinality, uint32_t const dimensions) {
+	cursor_t *const cursor = (cursor_t *const) malloc (sizeof(cursor_t));
+	if (cursor == NULL) {
+		LOG (fatal,"[new_cursor()] Unable to allocate memory for new cursor...\n");
+		exit (EXIT_FAILURE);
+	}
+	cursor->queue = queue;
+	cursor->spill = spill;
+	cursor->source = source;
+	cursor->cardinality = cardinality;
+	cursor->dimensions = dimensions;
+	cursor->distance = 0;
+	cursor->objects = (object_t*) malloc (sizeof(object_t)*cardinality);
+	cursor->keys = (index_t*) malloc (sizeof(index_t)*cardinality*dimensions);
+	if (cursor->objects == NULL || cursor->keys == NULL) {
+		LOG (fatal,"[new_cursor()] Unable to allocate memory for the tuples of new cursor...\n");
+		exit (EXIT_FAILURE);
+	}
+	return cursor;
+}
+
+cursor_t* range_cursor (tree_t *const tree, index_t const lo[], index_t const hi[]) {
+	fifo_t *const result = range (tree,lo,hi,tree->dimensions);
+	if (result == NULL) {
+		return NULL;
+	}
+	return new_cursor (result,NULL,PAIRS_CURSOR,1,tree->dimensions);
+}
+
+cursor_t* nearest_cursor (tree_t *const tree, index_t const center[], uint32_t const k) {
+	return new_cursor (nearest (tree,center,k),NULL,CONTAINERS_CURSOR,1,tree->dimensions);
+}
+
+cursor_t* skyline_cursor (tree_t *const tree, boolean const corner[]) {
+	return new_cursor (skyline (tree,corner,tree->dimensions),NULL,PAIRS_CURSOR,1,tree->dimensions);
+}
+
+cursor_t* distance_join_cursor (tree_t *const outer, tree_t *const inner, double const theta, uint64_t const memory_limit) {
+	if (outer->dimensions != inner->dimensions) {
+		LOG (error,"[distance_join_cursor()] Cannot join trees of %u and %u dimensions.\n",outer->dimensions,inner->dimensions);
+		return NULL;
+	}
+	lifo_t *const trees = new_stack ();
+	insert_into_stack (trees,outer);
+	insert_into_stack (trees,inner);
+	spill_t *const result = distance_join (theta,true,false,false,trees,NULL,memory_limit);
+	delete_stack (trees);
+	return new_cursor (NULL,result,SPILL_CURSOR,2,outer->dimensions);
+}
+
+cursor_t* closest_pairs_cursor (tree_t *const outer, tree_t *const inner, uint32_t const k) {
+	if (outer->dimensions != inner->dimensions) {
+		LOG (error,"[closest_pairs_cursor()] Cannot join trees of %u and %u dimensions.\n",outer->dimensions,inner->dimensions);
+		return NULL;
+	}
+	lifo_t *const trees = new_stack ();
+	insert_into_stack (trees,outer);
+	insert_into_stack (trees,inner);
+	fifo_t *const result = x_tuples (k,true,false,false,trees,NULL);
+	delete_stack (trees);
+	return new_cursor (result,NULL,TUPLES_CURSOR,2,outer->dimensions);
+}
+
+boolean next_tuple (cursor_t *const cursor) {
+	switch (cursor->source) {
+	case PAIRS_CURSOR:
+		if (cursor->queue->size) {
+			data_pair_t *const pair = remove_head_of_queue (cursor->queue);
+			*cursor->objects = pair->object;
+			memcpy (cursor->keys,pair->key,sizeof(index_t)*cursor->dimensions);
+			free (pair->key);
+			free (pair);
+			return true;
+		}
+		return false;
+	case CONTAINERS_CURSOR:
+		if (cursor->queue->size) {
+			data_container_t *const container = remove_head_of_queue (cursor->queue);
+			*cursor->objects = container->object;
+			memcpy (cursor->keys,container->key,sizeof(index_t)*cursor->dimensions);
+			cursor->distance = container->sort_key;
+			free (container->key);
+			free (container);
+			return true;
+		}
+		return false;
+	default:;
+		multidata_container_t *const tuple = cursor->source == SPILL_CURSOR ? remove_from_spill (cursor->spill)
+							: cursor->queue->size ? remove_head_of_queue (cursor->queue) : NULL;
+		if (tuple != NULL) {
+			memcpy (cursor->objects,tuple->objects,sizeof(object_t)*cursor->cardinality);
+			memcpy (cursor->keys,tuple->keys,sizeof(index_t)*cursor->cardinality*cursor->dimensions);
+			cursor->distance = tuple->sort_key;
+			free (tuple->objects);
+			free (tuple->keys);
+			free (tuple);
+			return true;
+		}
+		return false;
+	}
+}
+
+void delete_cursor (cursor_t *const cursor) {
+	while (next_tuple (cursor));
+	if (cursor->queue != NULL) {
+		delete_queue (cursor->queue);
+	}
+	if (cursor->spill != NULL) {
+		delete_spill (cursor->spill);
+	}
+	free (cursor->objects);
+	free (cursor->keys);
+	free (cursor);
+}
@@ -0,0 +1,49 @@
+#ifndef INDEXING_H_
+#define INDEXING_H_
+
+/**
+ * The in-process interface of libindexing, through which trees are
+ * queried and modified without going through start#server. Neither
+ * HTTP nor JSON are involved, and no state is shared among the trees
+ * opened, other than the thread draining the log.
+ *
+ * Trees are opened with load_rtree, or with new_rtree which creates
+ * a heapfile unless there is one already, and are closed with
+ * delete_tree, which flushes them first. Flushing with flush_tree
+ * writes all pages modified and releases those held in memory.
+ *
+ * Records are inserted and deleted in batches with insert_batch_into_rtree
+ * and delete_batch_from_rtree, whose keys are laid out one after the
+ * other, or else with bulk_load_rtree for trees still empty. Progress
+ * is reported to the callback given, if any.
+ *
+ * Queries return cursors, whose tuples are fetched with next_tuple
+ * until it returns false; each time the objects, keys, and distance of
+ * the cursor hold those of the current tuple. Joins return tuples of
+ * two objects, the first one from the outer tree. Results of kNN and
+ * closest-pairs queries come closest first, and those of distance
+ * joins are spilled to disk beyond the memory limit given. Cursors are
+ * disposed of with delete_cursor, whether consumed or not. Queries on
+ * the same trees may run concurrently, as may modifications.
+ *
+ * These functions are all that libindexing.so exports, as marked by
+ * INDEXING_API, while the rest of the modules it is built from stay
+ * internal to it. Programs linked with libindexing.a, such as the
+ * benchmarks, may still call into those modules directly.
+ */
+
+#include "defs.h"
+#include "rtree.h"
+#include "common.h"
+
+INDEXING_API cursor_t* range_cursor (tree_t *const tree, index_t const lo[], index_t const hi[]);
+INDEXING_API cursor_t* nearest_cursor (tree_t *const tree, index_t const center[], uint32_t const k);
+INDEXING_API cursor_t* skyline_cursor (tree_t *const tree, boolean const corner[]);
+
+INDEXING_API cursor_t* distance_join_cursor (tree_t *const outer, tree_t *const inner, double const theta, uint64_t const memory_limit);
+INDEXING_API cursor_t* closest_pairs_cursor (tree_t *const outer, tree_t *const inner, uint32_t const k);
+
+INDEXING_API boolean next_tuple (cursor_t *const cursor);
+INDEXING_API void delete_cursor (cursor_t *const cursor);
+
+#endif /* INDEXING_H_ */
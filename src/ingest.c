@@ -0,0 +1,468 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ingest.h"
+#include "defs.h"
+
+
+/**
+ * A scanner over the body of a request, which is not necessarily
+ * terminated, along with room for the coordinates of one record.
+ */
+typedef struct {
+	char const* c;
+	char const* end;
+	index_t* coordinates;
+} scanner_t;
+
+static double const powers_of_ten [] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static
+void skip_whitespace (scanner_t *const scanner) {
+	while (scanner->c < scanner->end && (*scanner->c == ' ' || *scanner->c == '\t' || *scanner->c == '\n' || *scanner->c == '\r')) {
+		++scanner->c;
+	}
+}
+
+static
+boolean expect (scanner_t *const scanner, char const symbol) {
+	skip_whitespace (scanner);
+	if (scanner->c < scanner->end && *scanner->c == symbol) {
+		++scanner->c;
+		return true;
+	}
+	return false;
+}
+
+static
+boolean expect_null (scanner_t *const scanner) {
+	skip_whitespace (scanner);
+	if (scanner->end - scanner->c >= 4 && !strncmp (scanner->c,"null",4)) {
+		scanner->c += 4;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Scans a string without escapes, which are not expected in
+ * either member names or heapfile names, and returns its length.
+ */
+static
+boolean scan_string (scanner_t *const scanner, char const** string, uint64_t *const length) {
+	if (!expect (scanner,'"')) {
+		return false;
+	}
+	char const*const start = scanner->c;
+	while (scanner->c < scanner->end && *scanner->c != '"') {
+		if (*scanner->c == '\\') return false;
+		++scanner->c;
+	}
+	if (scanner->c == scanner->end) {
+		return false;
+	}
+	*string = start;
+	*length = scanner->c++ - start;
+	return true;
+}
+
+static
+boolean is_member (char const name[], uint64_t const length, char const expected[]) {
+	return length == strlen (expected) && !strncmp (name,expected,length);
+}
+
+/**
+ * Scans a number into the same double that strtod would return. As
+ * long as its significant digits fit in the 53 bits of a double and
+ * its power of ten is exact too, a single rounding gives the correctly
+ * rounded result; all other numbers are left to strtod.
+ */
+static
+boolean scan_number (scanner_t *const scanner, double *const value) {
+	skip_whitespace (scanner);
+	char const*const start = scanner->c;
+	char const* c = start;
+	char const*const end = scanner->end;
+
+	boolean const is_negative = c < end && *c == '-';
+	if (is_negative) ++c;
+
+	uint64_t mantissa = 0;
+	int32_t exponent = 0;
+	uint32_t digits = 0;
+	boolean is_exact = true;
+	for (; c < end && *c >= '0' && *c <= '9'; ++c, ++digits) {
+		if (mantissa < 100000000000000000ul) mantissa = mantissa * 10 + (*c - '0');
+		else{
+			++exponent;
+			is_exact &= *c == '0';
+		}
+	}
+	if (c < end && *c == '.') {
+		for (++c; c < end && *c >= '0' && *c <= '9'; ++c, ++digits) {
+			if (mantissa < 100000000000000000ul) {
+				mantissa = mantissa * 10 + (*c - '0');
+				--exponent;
+			}else{
+				is_exact &= *c == '0';
+			}
+		}
+	}
+	if (!digits || c - start > INGEST_NUMBER_LIMIT) {
+		return false;
+	}
+	if (c < end && (*c == 'e' || *c == 'E')) {
+		++c;
+		boolean const is_negative_exponent = c < end && *c == '-';
+		if (c < end && (*c == '-' || *c == '+')) ++c;
+		if (c == end || *c < '0' || *c > '9') {
+			return false;
+		}
+		int32_t power = 0;
+		for (; c < end && *c >= '0' && *c <= '9'; ++c) {
+			if (power < 100000) power = power * 10 + (*c - '0');
+		}
+		exponent += is_negative_exponent ? -power : power;
+	}
+	scanner->c = c;
+
+	if (is_exact && mantissa <= (1ul<<53) && exponent >= -22 && exponent <= 22) {
+		double const magnitude = exponent >= 0 ? (double) mantissa * powers_of_ten[exponent] : (double) mantissa / powers_of_ten[-exponent];
+		*value = is_negative ? -magnitude : magnitude;
+	}else{
+		char number [c-start+1];
+		memcpy (number,start,c-start);
+		number [c-start] = '\0';
+		*value = strtod (number,NULL);
+	}
+	return true;
+}
+
+/**
+ * Object-ids are scanned as integers of 64 bits, whereas a fraction
+ * is only allowed if it is zero.
+ */
+static
+boolean scan_object (scanner_t *const scanner, object_t *const object) {
+	skip_whitespace (scanner);
+	char const* c = scanner->c;
+	char const*const end = scanner->end;
+
+	uint64_t value = 0;
+	char const*const start = c;
+	for (; c < end && *c >= '0' && *c <= '9'; ++c) {
+		uint64_t const digit = *c - '0';
+		if (value > (UINT64_MAX - digit) / 10) {
+			return false;
+		}
+		value = value * 10 + digit;
+	}
+	if (c == start) {
+		return false;
+	}
+	if (c < end && *c == '.') {
+		for (++c; c < end && *c == '0'; ++c);
+		if (c < end && *c >= '1' && *c <= '9') {
+			return false;
+		}
+	}
+	scanner->c = c;
+	*object = value;
+	return true;
+}
+
+/**
+ * Scans the coordinates of a key and returns how many they are.
+ */
+static
+uint32_t scan_key (scanner_t *const scanner) {
+	if (!expect (scanner,'[')) {
+		return 0;
+	}
+	uint32_t coordinates = 0;
+	do{
+		double coordinate;
+		if (coordinates == INGEST_COORDINATES_LIMIT || !scan_number (scanner,&coordinate)) {
+			return 0;
+		}
+		scanner->coordinates [coordinates++] = coordinate;
+	}while (expect (scanner,','));
+	return expect (scanner,']') ? coordinates : 0;
+}
+
+/**
+ * Appends a record whose key was just scanned, unless
+ * it has fewer coordinates than the first record.
+ */
+static
+void append_record (ingest_t *const ingest, index_t const coordinates[], uint32_t const dimensions, object_t const object) {
+	if (!ingest->dimensions) {
+		ingest->dimensions = dimensions;
+	}else if (dimensions < ingest->dimensions) {
+		++ingest->failed;
+		return;
+	}
+
+	if (ingest->size == ingest->capacity) {
+		ingest->capacity = ingest->capacity ? ingest->capacity << 1 : INGEST_INITIAL_CAPACITY;
+		ingest->keys = (index_t*) realloc (ingest->keys,sizeof(index_t)*ingest->capacity*ingest->dimensions);
+		if (ingest->keys == NULL) {
+			LOG (fatal,"[append_record()] Unable to allocate memory for %lu keys...\n",ingest->capacity);
+			exit (EXIT_FAILURE);
+		}
+		ingest->objects = (object_t*) realloc (ingest->objects,sizeof(object_t)*ingest->capacity);
+		if (ingest->objects == NULL) {
+			LOG (fatal,"[append_record()] Unable to allocate memory for %lu objects...\n",ingest->capacity);
+			exit (EXIT_FAILURE);
+		}
+	}
+	memcpy (ingest->keys+ingest->size*ingest->dimensions,coordinates,sizeof(index_t)*ingest->dimensions);
+	ingest->objects [ingest->size++] = object;
+}
+
+/**
+ * Scans a datum of a PUT request, whose key and object may be given
+ * in either order, i.e. {"key":[...],"object":...}.
+ */
+static
+boolean scan_datum (scanner_t *const scanner, ingest_t *const ingest) {
+	if (!expect (scanner,'{')) {
+		return false;
+	}
+	uint32_t dimensions = 0;
+	object_t object = 0;
+	boolean has_object = false;
+	do{
+		char const* name;
+		uint64_t length;
+		if (!scan_string (scanner,&name,&length) || !expect (scanner,':')) {
+			return false;
+		}else if (is_member (name,length,"key") && !dimensions) {
+			if (!(dimensions = scan_key (scanner))) return false;
+		}else if (is_member (name,length,"object") && !has_object) {
+			if (!(has_object = scan_object (scanner,&object))) return false;
+		}else{
+			return false;
+		}
+	}while (expect (scanner,','));
+
+	if (!expect (scanner,'}') || !dimensions || !has_object) {
+		return false;
+	}
+	append_record (ingest,scanner->coordinates,dimensions,object);
+	return true;
+}
+
+/**
+ * Scans the records of a request, which are either the data of a
+ * PUT request or the keys of a DELETE request, or else null.
+ */
+static
+boolean scan_records (scanner_t *const scanner, ingest_t *const ingest, request_t const type) {
+	if (expect_null (scanner)) {
+		return true;
+	}else if (!expect (scanner,'[')) {
+		return false;
+	}else if (expect (scanner,']')) {
+		return true;
+	}
+	do{
+		if (type == PUT) {
+			if (!scan_datum (scanner,ingest)) return false;
+		}else{
+			uint32_t const dimensions = scan_key (scanner);
+			if (!dimensions) return false;
+			append_record (ingest,scanner->coordinates,dimensions,0);
+		}
+	}while (expect (scanner,','));
+	return expect (scanner,']');
+}
+
+/**
+ * Heapfiles are named after identifiers, possibly with dots,
+ * so that no other folder can be reached through their names.
+ */
+static
+boolean set_heapfile (ingest_t *const ingest, char const name[], uint64_t const length) {
+	if (!length || length >= sizeof(ingest->heapfile)) {
+		return false;
+	}
+	for (uint64_t i=0; i<length; ++i) {
+		char const c = name[i];
+		if (!(c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (i && ((c >= '0' && c <= '9') || c == '.')))) {
+			return false;
+		}
+	}
+	memcpy (ingest->heapfile,name,length);
+	ingest->heapfile [length] = '\0';
+	return true;
+}
+
+static
+boolean scan_heapfile (scanner_t *const scanner, ingest_t *const ingest) {
+	char const* name;
+	uint64_t length;
+	return scan_string (scanner,&name,&length) && set_heapfile (ingest,name,length);
+}
+
+static
+ingest_t* new_ingest (void) {
+	ingest_t *const ingest = (ingest_t *const) malloc (sizeof(ingest_t));
+	if (ingest == NULL) {
+		LOG (fatal,"[new_ingest()] Unable to allocate memory for new ingest...\n");
+		exit (EXIT_FAILURE);
+	}
+	*ingest->heapfile = '\0';
+	ingest->dimensions = 0;
+	ingest->keys = NULL;
+	ingest->objects = NULL;
+	ingest->size = 0;
+	ingest->capacity = 0;
+	ingest->failed = 0;
+	return ingest;
+}
+
+/**
+ * Scans the body of a PUT request, i.e. {"heapfile":"...","data":[...]},
+ * or that of a DELETE request, i.e. {"heapfile":"...","keys":[[...],...]},
+ * whose members may be given in either order. Returns NULL and reports
+ * where the body stopped making sense upon syntax errors.
+ */
+ingest_t* parse_ingest (char const json[], uint64_t const length, request_t const type, char message[]) {
+	ingest_t *const ingest = new_ingest ();
+
+	scanner_t scanner;
+	scanner.c = json;
+	scanner.end = json + length;
+	scanner.coordinates = (index_t*) malloc (sizeof(index_t)*INGEST_COORDINATES_LIMIT);
+	if (scanner.coordinates == NULL) {
+		LOG (fatal,"[parse_ingest()] Unable to allocate memory for the coordinates of a record...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	boolean is_valid = expect (&scanner,'{');
+	boolean has_records = false;
+	while (is_valid) {
+		char const* name;
+		uint64_t name_length;
+		if (!scan_string (&scanner,&name,&name_length) || !expect (&scanner,':')) {
+			is_valid = false;
+		}else if (is_member (name,name_length,"heapfile") && !*ingest->heapfile) {
+			is_valid = scan_heapfile (&scanner,ingest);
+		}else if (is_member (name,name_length,type == PUT ? "data" : "keys") && !has_records) {
+			is_valid = has_records = scan_records (&scanner,ingest,type);
+		}else{
+			is_valid = false;
+		}
+		if (!expect (&scanner,',')) break;
+	}
+	is_valid = is_valid && expect (&scanner,'}') && *ingest->heapfile;
+	skip_whitespace (&scanner);
+	is_valid = is_valid && scanner.c == scanner.end;
+	free (scanner.coordinates);
+
+	if (!is_valid) {
+		LOG (error,"[parse_ingest()] Syntax error at byte %lu of request.\n",scanner.c-json);
+		sprintf (message,"Syntax error at byte %lu; unable to parse request.",scanner.c-json);
+		delete_ingest (ingest);
+		return NULL;
+	}
+	return ingest;
+}
+
+/**
+ * Decodes records sent in bulk to the heapfile given, as laid out
+ * after their binary header; i.e. each record as its object followed
+ * by the coordinates of its key, all of them little-endian. Returns
+ * NULL and reports the problem if the header does not match, or if
+ * the body ends in the middle of a record.
+ */
+ingest_t* decode_bulk (char const heapfile[], char const data[], uint64_t const length, char message[]) {
+	ingest_t *const ingest = new_ingest ();
+	if (!set_heapfile (ingest,heapfile,strlen (heapfile))) {
+		LOG (error,"[decode_bulk()] Invalid heapfile name '%s'.\n",heapfile);
+		sprintf (message,"Invalid heapfile name.");
+		delete_ingest (ingest);
+		return NULL;
+	}
+
+	char const schema [] = {
+		BINARY_VERSION,
+		0,
+		sizeof(object_t),
+		sizeof(index_t)
+	};
+	uint32_t dimensions = 0;
+	if (length >= BULK_HEADER_SIZE) {
+		memcpy (&dimensions,data+8,sizeof(uint32_t));
+		dimensions = le32toh (dimensions);
+	}
+	if (length < BULK_HEADER_SIZE || memcmp (data,BINARY_MAGIC,4) || memcmp (data+4,schema,sizeof(schema))
+			|| !dimensions || dimensions > INGEST_COORDINATES_LIMIT) {
+		LOG (error,"[decode_bulk()] Unrecognized header of bulk request.\n");
+		sprintf (message,"Unrecognized header; unable to decode request.");
+		delete_ingest (ingest);
+		return NULL;
+	}
+
+	uint64_t const record_size = sizeof(object_t) + dimensions*sizeof(index_t);
+	if ((length-BULK_HEADER_SIZE) % record_size) {
+		uint64_t const offset = length - (length-BULK_HEADER_SIZE) % record_size;
+		LOG (error,"[decode_bulk()] Truncated record at byte %lu of request.\n",offset);
+		sprintf (message,"Truncated record at byte %lu; unable to decode request.",offset);
+		delete_ingest (ingest);
+		return NULL;
+	}
+
+	ingest->dimensions = dimensions;
+	ingest->size = ingest->capacity = (length-BULK_HEADER_SIZE) / record_size;
+	ingest->keys = (index_t*) malloc (sizeof(index_t)*ingest->capacity*dimensions);
+	ingest->objects = (object_t*) malloc (sizeof(object_t)*ingest->capacity);
+	if (ingest->capacity && (ingest->keys == NULL || ingest->objects == NULL)) {
+		LOG (fatal,"[decode_bulk()] Unable to allocate memory for %lu records...\n",ingest->capacity);
+		exit (EXIT_FAILURE);
+	}
+
+	char const* record = data + BULK_HEADER_SIZE;
+	for (uint64_t i=0; i<ingest->size; ++i) {
+		uint64_t object;
+		memcpy (&object,record,sizeof(uint64_t));
+		ingest->objects[i] = le64toh (object);
+		record += sizeof(object_t);
+
+		for (uint32_t j=0; j<dimensions; ++j) {
+			uint32_t bits;
+			memcpy (&bits,record,sizeof(uint32_t));
+			bits = le32toh (bits);
+			memcpy (ingest->keys+i*dimensions+j,&bits,sizeof(index_t));
+			record += sizeof(index_t);
+		}
+	}
+	return ingest;
+}
+
+void delete_ingest (ingest_t *const ingest) {
+	free (ingest->keys);
+	free (ingest->objects);
+	free (ingest);
+}
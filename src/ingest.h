@@ -0,0 +1,10 @@
+#ifndef INGEST_H_
+#define INGEST_H_
+
+#include "defs.h"
+
+ingest_t* parse_ingest (char const json[], uint64_t const length, request_t const type, char message[]);
+ingest_t* decode_bulk (char const heapfile[], char const data[], uint64_t const length, char message[]);
+void delete_ingest (ingest_t *const ingest);
+
+#endif /* INGEST_H_ */
@@ -0,0 +1,278 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "defs.h"
+
+
+/**
+ * Messages are formatted by the threads logging them into buffers of
+ * their own, each a ring with a single producer and a single consumer,
+ * so that logging takes no locks. A background thread drains the rings
+ * to the standard error, where it also formats the time of each message
+ * from the coarse clock read when it was logged. The buffers of exited
+ * threads are reused by those started afterwards.
+ */
+typedef struct log_buffer {
+	char data [LOG_BUFFER_SIZE];
+
+	uint64_t head;
+	uint64_t tail;
+	uint64_t dropped;
+
+	boolean is_orphan;
+	struct log_buffer* next;
+} log_buffer_t;
+
+typedef struct {
+	uint64_t micros;
+	uint32_t length;
+	uint32_t level;
+} log_record_t;
+
+static log_buffer_t* log_buffers = NULL;
+static __thread log_buffer_t* thread_log_buffer = NULL;
+
+static pthread_key_t log_buffer_key;
+static pthread_once_t logger_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t drain_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static char const*const level_tags [] = {"","\033[1;34mDEBUG\033[0m ","\033[1;32mINFO\033[0m ",
+		"\033[1;33mWARNING\033[0m ","\033[1;31mERROR\033[0m ","\033[1;35mFATAL\033[0m "};
+
+
+static
+uint64_t coarse_clock_micros (void) {
+	struct timespec now;
+	clock_gettime (CLOCK_REALTIME_COARSE,&now);
+	return now.tv_sec*1000000 + now.tv_nsec/1000;
+}
+
+static
+void copy_into_ring (log_buffer_t *const buffer, uint64_t const position, void const*const data, uint64_t const length) {
+	uint64_t const offset = position & (LOG_BUFFER_SIZE-1);
+	uint64_t const first = MIN(length,LOG_BUFFER_SIZE-offset);
+	memcpy (buffer->data+offset,data,first);
+	memcpy (buffer->data,(char const*)data+first,length-first);
+}
+
+static
+void copy_from_ring (log_buffer_t const*const buffer, uint64_t const position, void *const data, uint64_t const length) {
+	uint64_t const offset = position & (LOG_BUFFER_SIZE-1);
+	uint64_t const first = MIN(length,LOG_BUFFER_SIZE-offset);
+	memcpy (data,buffer->data+offset,first);
+	memcpy ((char*)data+first,buffer->data,length-first);
+}
+
+/**
+ * Writes out whatever the rings hold; one consumer at a time.
+ * Returns whether there was anything to write.
+ */
+static
+boolean drain_log (void) {
+	static char output [LOG_BUFFER_SIZE];
+	static time_t cached_second = -1;
+	static struct tm cached_time;
+
+	boolean drained = false;
+	uint64_t length = 0;
+
+	pthread_mutex_lock (&drain_lock);
+	for (log_buffer_t* buffer = __atomic_load_n (&log_buffers,__ATOMIC_ACQUIRE); buffer != NULL; buffer = buffer->next) {
+		uint64_t const head = __atomic_load_n (&buffer->head,__ATOMIC_ACQUIRE);
+		uint64_t tail = buffer->tail;
+		while (tail != head) {
+			log_record_t record;
+			copy_from_ring (buffer,tail,&record,sizeof(log_record_t));
+			if (length + record.length + 64 > sizeof(output)) {
+				write (STDERR_FILENO,output,length);
+				length = 0;
+			}
+			if (record.level) {
+				time_t const second = record.micros/1000000;
+				if (second != cached_second) {
+					localtime_r (&second,&cached_time);
+					cached_second = second;
+				}
+				length += sprintf (output+length,"\033[11;47;30m[%u/%02u/%02u %02u:%02u:%02u:%06u]\033[0m %s",
+						cached_time.tm_year+1900,cached_time.tm_mon+1,cached_time.tm_mday,
+						cached_time.tm_hour,cached_time.tm_min,cached_time.tm_sec,
+						(uint32_t)(record.micros%1000000),level_tags[record.level]);
+			}
+			copy_from_ring (buffer,tail+sizeof(log_record_t),output+length,record.length);
+			length += record.length;
+			tail += sizeof(log_record_t) + record.length;
+			drained = true;
+		}
+		__atomic_store_n (&buffer->tail,tail,__ATOMIC_RELEASE);
+
+		uint64_t const dropped = __atomic_exchange_n (&buffer->dropped,0,__ATOMIC_RELAXED);
+		if (dropped) {
+			if (length + 128 > sizeof(output)) {
+				write (STDERR_FILENO,output,length);
+				length = 0;
+			}
+			length += sprintf (output+length,"%s[drain_log()] Dropped %lu messages of a thread logging faster than they could be written.\n",
+						level_tags[warn],dropped);
+		}
+	}
+	if (length) {
+		write (STDERR_FILENO,output,length);
+	}
+	pthread_mutex_unlock (&drain_lock);
+	return drained;
+}
+
+static
+void* log_drainer (void* args) {
+	struct timespec const interval = {.tv_sec = 0, .tv_nsec = LOG_DRAIN_INTERVAL*1000};
+	for (;;) {
+		if (!drain_log ()) {
+			nanosleep (&interval,NULL);
+		}
+	}
+	return NULL;
+}
+
+static
+void release_log_buffer (void* buffer) {
+	__atomic_store_n (&((log_buffer_t*)buffer)->is_orphan,true,__ATOMIC_RELEASE);
+}
+
+static
+void start_logger (void) {
+	pthread_key_create (&log_buffer_key,&release_log_buffer);
+	atexit (&flush_log);
+
+	pthread_t drainer;
+	pthread_attr_t attr;
+	pthread_attr_init (&attr);
+	pthread_attr_setdetachstate (&attr,PTHREAD_CREATE_DETACHED);
+	if (pthread_create (&drainer,&attr,&log_drainer,NULL)) {
+		fprintf (stderr,"[start_logger()] Unable to start the thread writing the log; it will be written on exit...\n");
+	}
+	pthread_attr_destroy (&attr);
+}
+
+/**
+ * The ring of the calling thread; i.e. one left by an exited
+ * thread once it is drained, or else a new one.
+ */
+static
+log_buffer_t* acquire_log_buffer (void) {
+	pthread_once (&logger_once,&start_logger);
+
+	log_buffer_t* buffer = __atomic_load_n (&log_buffers,__ATOMIC_ACQUIRE);
+	for (; buffer != NULL; buffer = buffer->next) {
+		boolean is_orphan = true;
+		if (__atomic_load_n (&buffer->head,__ATOMIC_ACQUIRE) == __atomic_load_n (&buffer->tail,__ATOMIC_ACQUIRE)
+			&& __atomic_compare_exchange_n (&buffer->is_orphan,&is_orphan,false,false,__ATOMIC_ACQ_REL,__ATOMIC_RELAXED)) {
+			break;
+		}
+	}
+
+	if (buffer == NULL) {
+		buffer = (log_buffer_t*) malloc (sizeof(log_buffer_t));
+		if (buffer == NULL) {
+			fprintf (stderr,"[acquire_log_buffer()] Unable to allocate memory for the log of a thread...\n");
+			exit (EXIT_FAILURE);
+		}
+		buffer->head = 0;
+		buffer->tail = 0;
+		buffer->dropped = 0;
+		buffer->is_orphan = false;
+		buffer->next = __atomic_load_n (&log_buffers,__ATOMIC_RELAXED);
+		while (!__atomic_compare_exchange_n (&log_buffers,&buffer->next,buffer,true,__ATOMIC_RELEASE,__ATOMIC_RELAXED));
+	}
+
+	pthread_setspecific (log_buffer_key,buffer);
+	return buffer;
+}
+
+static
+void enqueue_message (uint32_t const level, char const format[], va_list args) {
+	log_buffer_t* buffer = thread_log_buffer;
+	if (buffer == NULL) {
+		buffer = thread_log_buffer = acquire_log_buffer ();
+	}
+
+	char text [LOG_MESSAGE_SIZE];
+	int const formatted = vsnprintf (text,sizeof(text),format,args);
+	if (formatted < 0) return;
+
+	log_record_t record;
+	record.micros = level ? coarse_clock_micros () : 0;
+	record.length = MIN((uint32_t)formatted,sizeof(text)-1);
+	record.level = level;
+
+	uint64_t const head = buffer->head;
+	if (head + sizeof(log_record_t) + record.length - __atomic_load_n (&buffer->tail,__ATOMIC_ACQUIRE) > LOG_BUFFER_SIZE) {
+		__atomic_add_fetch (&buffer->dropped,1,__ATOMIC_RELAXED);
+		return;
+	}
+	copy_into_ring (buffer,head,&record,sizeof(log_record_t));
+	copy_into_ring (buffer,head+sizeof(log_record_t),text,record.length);
+	__atomic_store_n (&buffer->head,head+sizeof(log_record_t)+record.length,__ATOMIC_RELEASE);
+}
+
+void log_message (enum message_t const level, char const format[], ...) {
+	va_list args;
+	va_start (args,format);
+	enqueue_message (level,format,args);
+	va_end (args);
+
+	/* what led to a fatal error is written before the process exits */
+	if (level == fatal) {
+		flush_log ();
+	}
+}
+
+void log_append (char const format[], ...) {
+	va_list args;
+	va_start (args,format);
+	enqueue_message (0,format,args);
+	va_end (args);
+}
+
+void flush_log (void) {
+	while (drain_log ());
+}
+
+/**
+ * Whether another message may be logged within the current second
+ * at the rate given by the limit, reporting how many were suppressed
+ * since the last one that was.
+ */
+boolean is_log_permitted (log_limit_t *const limit, uint64_t *const suppressed) {
+	uint64_t const second = coarse_clock_micros ()/1000000;
+	uint64_t current = __atomic_load_n (&limit->second,__ATOMIC_RELAXED);
+	if (current != second && __atomic_compare_exchange_n (&limit->second,&current,second,false,__ATOMIC_RELAXED,__ATOMIC_RELAXED)) {
+		__atomic_store_n (&limit->count,0,__ATOMIC_RELAXED);
+	}
+	if (__atomic_add_fetch (&limit->count,1,__ATOMIC_RELAXED) > limit->rate) {
+		__atomic_add_fetch (&limit->suppressed,1,__ATOMIC_RELAXED);
+		return false;
+	}
+	*suppressed = __atomic_exchange_n (&limit->suppressed,0,__ATOMIC_RELAXED);
+	return true;
+}
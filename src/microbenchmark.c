@@ -0,0 +1,599 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include <time.h>
+#include <sched.h>
+#include <getopt.h>
+#include <string.h>
+#include "priority_queue.h"
+#include "symbol_table.h"
+#include "generator.h"
+#include "common.h"
+#include "queue.h"
+#include "stack.h"
+#include "swap.h"
+#include "defs.h"
+
+#define MAX_CONFIGURATIONS	16
+
+/* each repetition runs as many passes over a kernel as last this long */
+#define REPETITION_MICROS	2000
+
+uint32_t DIMENSIONALITIES [MAX_CONFIGURATIONS] = {2,3,4,8};
+uint32_t BLOCKS [MAX_CONFIGURATIONS] = {1024,4096,16384};
+uint32_t ELEMENTS [MAX_CONFIGURATIONS] = {256,4096};
+uint32_t DIMENSIONALITIES_NUMBER = 4;
+uint32_t BLOCKS_NUMBER = 3;
+uint32_t ELEMENTS_NUMBER = 2;
+
+uint32_t WARMUP = 3;
+uint32_t REPETITIONS = 21;
+int32_t CPU = -2;
+char const* KERNEL = NULL;
+
+/**
+ * Kernels measured on the entries of one page of the dimensions and
+ * the size of block given, on whole pages, or on containers of the
+ * size given.
+ */
+typedef enum {ENTRY_SCOPE, PAGE_SCOPE, CONTAINER_SCOPE} scope_t;
+
+typedef struct {
+	uint32_t dimensions;
+	uint32_t page_size;
+	uint32_t size;
+
+	tree_t tree;
+	page_t leaf;
+	page_t internal;
+	void* leaf_block;
+	void* internal_block;
+
+	interval_t* query;
+	index_t* point;
+	multibox_container_t* multiboxes;
+
+	double* values;
+	uint64_t* identifiers;
+	symbol_table_t* table;
+	swap_t* swap;
+	uint64_t clock;
+} fixture_t;
+
+typedef struct kernel {
+	char const* name;
+	scope_t scope;
+	uint64_t (*run) (fixture_t *const, struct kernel const*const);
+	double (*multibox) (multibox_container_t const*const, uint32_t const);
+} kernel_t;
+
+/* where the results of kernels are added up, lest their calls be optimized away */
+static volatile double sink;
+
+static boolean is_first_kernel = true;
+
+
+static
+uint64_t run_key_enclosed_by_box (fixture_t *const fixture, kernel_t const*const kernel) {
+	uint64_t enclosed = 0;
+	for (uint32_t i=0; i<fixture->leaf.header.records; ++i) {
+		enclosed += key_enclosed_by_box (fixture->leaf.node.leaf.keys+i*fixture->dimensions,fixture->query,fixture->dimensions);
+	}
+	sink += enclosed;
+	return fixture->leaf.header.records;
+}
+
+static
+uint64_t run_overlapping_boxes (fixture_t *const fixture, kernel_t const*const kernel) {
+	uint64_t overlapping = 0;
+	for (uint32_t i=0; i<fixture->internal.header.records; ++i) {
+		overlapping += overlapping_boxes (fixture->internal.node.internal.intervals+i*fixture->dimensions,fixture->query,fixture->dimensions);
+	}
+	sink += overlapping;
+	return fixture->internal.header.records;
+}
+
+static
+uint64_t run_key_to_box_mindistance (fixture_t *const fixture, kernel_t const*const kernel) {
+	double distance = 0;
+	for (uint32_t i=0; i<fixture->internal.header.records; ++i) {
+		distance += key_to_box_mindistance (fixture->point,fixture->internal.node.internal.intervals+i*fixture->dimensions,fixture->dimensions);
+	}
+	sink += distance;
+	return fixture->internal.header.records;
+}
+
+/* on tuples of three consecutive boxes of an internal page */
+static
+uint64_t run_multibox_distance (fixture_t *const fixture, kernel_t const*const kernel) {
+	uint64_t const tuples = fixture->internal.header.records-2;
+	double distance = 0;
+	for (uint64_t i=0; i<tuples; ++i) {
+		distance += kernel->multibox (fixture->multiboxes+i,0);
+	}
+	sink += distance;
+	return tuples;
+}
+
+static
+uint64_t run_encode_leaf (fixture_t *const fixture, kernel_t const*const kernel) {
+	sink += encode_rtree_page (&fixture->tree,&fixture->leaf,fixture->leaf_block);
+	return 1;
+}
+
+static
+uint64_t run_decode_leaf (fixture_t *const fixture, kernel_t const*const kernel) {
+	page_t *const page = decode_rtree_page (&fixture->tree,fixture->leaf_block);
+	sink += page->header.records;
+	delete_rtree_page (page);
+	return 1;
+}
+
+static
+uint64_t run_encode_internal (fixture_t *const fixture, kernel_t const*const kernel) {
+	sink += encode_rtree_page (&fixture->tree,&fixture->internal,fixture->internal_block);
+	return 1;
+}
+
+static
+uint64_t run_decode_internal (fixture_t *const fixture, kernel_t const*const kernel) {
+	page_t *const page = decode_rtree_page (&fixture->tree,fixture->internal_block);
+	sink += page->header.records;
+	delete_rtree_page (page);
+	return 1;
+}
+
+static
+int compare_values (void const*const x, void const*const y) {
+	double const a = *(double const*)x;
+	double const b = *(double const*)y;
+	return a < b ? -1 : a > b;
+}
+
+static
+uint64_t run_priority_queue (fixture_t *const fixture, kernel_t const*const kernel) {
+	priority_queue_t *const queue = new_priority_queue (&compare_values);
+	for (uint32_t i=0; i<fixture->size; ++i) {
+		insert_into_priority_queue (queue,fixture->values+i);
+	}
+	double total = 0;
+	while (queue->size) {
+		total += *(double*)remove_from_priority_queue (queue);
+	}
+	delete_priority_queue (queue);
+	sink += total;
+	return fixture->size;
+}
+
+static
+uint64_t run_queue_growth (fixture_t *const fixture, kernel_t const*const kernel) {
+	fifo_t *const queue = new_queue ();
+	for (uint32_t i=0; i<fixture->size; ++i) {
+		insert_at_tail_of_queue (queue,fixture->values+i);
+	}
+	sink += queue->size;
+	delete_queue (queue);
+	return fixture->size;
+}
+
+static
+uint64_t run_stack_growth (fixture_t *const fixture, kernel_t const*const kernel) {
+	lifo_t *const stack = new_stack ();
+	for (uint32_t i=0; i<fixture->size; ++i) {
+		insert_into_stack (stack,fixture->values+i);
+	}
+	sink += stack->size;
+	delete_stack (stack);
+	return fixture->size;
+}
+
+static
+uint64_t run_symbol_table_set (fixture_t *const fixture, kernel_t const*const kernel) {
+	symbol_table_t *const table = new_symbol_table_primitive (NULL);
+	for (uint32_t i=0; i<fixture->size; ++i) {
+		set (table,fixture->identifiers[i],fixture->values+i);
+	}
+	sink += table->size;
+	delete_symbol_table (table);
+	return fixture->size;
+}
+
+static
+uint64_t run_symbol_table_get (fixture_t *const fixture, kernel_t const*const kernel) {
+	double total = 0;
+	for (uint32_t i=0; i<fixture->size; ++i) {
+		total += *(double*)get (fixture->table,fixture->identifiers[i]);
+	}
+	sink += total;
+	return fixture->size;
+}
+
+/* on as many pages as it holds, of which half are found in it */
+static
+uint64_t run_set_priority (fixture_t *const fixture, kernel_t const*const kernel) {
+	uint64_t swapped = 0;
+	for (uint32_t i=0; i<fixture->size; ++i) {
+		swapped += set_priority (fixture->swap,fixture->identifiers[i]%(fixture->size<<1),++fixture->clock) != 0xffffffffffffffff;
+	}
+	sink += swapped;
+	return fixture->size;
+}
+
+static kernel_t const kernels [] = {
+	{"key_enclosed_by_box",ENTRY_SCOPE,&run_key_enclosed_by_box,NULL},
+	{"overlapping_boxes",ENTRY_SCOPE,&run_overlapping_boxes,NULL},
+	{"key_to_box_mindistance",ENTRY_SCOPE,&run_key_to_box_mindistance,NULL},
+	{"max_mindistance_ordered_multibox",ENTRY_SCOPE,&run_multibox_distance,&max_mindistance_ordered_multibox},
+	{"min_maxdistance_ordered_multibox",ENTRY_SCOPE,&run_multibox_distance,&min_maxdistance_ordered_multibox},
+	{"avg_mindistance_ordered_multibox",ENTRY_SCOPE,&run_multibox_distance,&avg_mindistance_ordered_multibox},
+	{"avg_maxdistance_ordered_multibox",ENTRY_SCOPE,&run_multibox_distance,&avg_maxdistance_ordered_multibox},
+	{"max_mindistance_pairwise_multibox",ENTRY_SCOPE,&run_multibox_distance,&max_mindistance_pairwise_multibox},
+	{"min_maxdistance_pairwise_multibox",ENTRY_SCOPE,&run_multibox_distance,&min_maxdistance_pairwise_multibox},
+	{"avg_mindistance_pairwise_multibox",ENTRY_SCOPE,&run_multibox_distance,&avg_mindistance_pairwise_multibox},
+	{"avg_maxdistance_pairwise_multibox",ENTRY_SCOPE,&run_multibox_distance,&avg_maxdistance_pairwise_multibox},
+	{"encode_leaf_page",PAGE_SCOPE,&run_encode_leaf,NULL},
+	{"decode_leaf_page",PAGE_SCOPE,&run_decode_leaf,NULL},
+	{"encode_internal_page",PAGE_SCOPE,&run_encode_internal,NULL},
+	{"decode_internal_page",PAGE_SCOPE,&run_decode_internal,NULL},
+	{"priority_queue",CONTAINER_SCOPE,&run_priority_queue,NULL},
+	{"queue_growth",CONTAINER_SCOPE,&run_queue_growth,NULL},
+	{"stack_growth",CONTAINER_SCOPE,&run_stack_growth,NULL},
+	{"symbol_table_set",CONTAINER_SCOPE,&run_symbol_table_set,NULL},
+	{"symbol_table_get",CONTAINER_SCOPE,&run_symbol_table_get,NULL},
+	{"swap_set_priority",CONTAINER_SCOPE,&run_set_priority,NULL}
+};
+
+
+/**
+ * An internal and a leaf page as full as the block allows, sized
+ * as new_rtree does, their blocks encoded, and a query box covering
+ * half of the domain on each dimension around its center.
+ */
+static
+void new_page_fixture (fixture_t *const fixture, uint32_t const dimensions, uint32_t const page_size) {
+	bzero (fixture,sizeof(fixture_t));
+	fixture->dimensions = dimensions;
+	fixture->page_size = page_size;
+
+	tree_t *const tree = &fixture->tree;
+	tree->filename = "microbenchmark";
+	tree->dimensions = dimensions;
+	tree->page_size = page_size;
+	tree->is_aggregate = false;
+	tree->internal_entries = (page_size-sizeof(header_t)) / (sizeof(interval_t)*dimensions);
+	tree->leaf_entries = (page_size-sizeof(header_t)) / (sizeof(index_t)*dimensions + sizeof(object_t));
+
+	dataset_t *const keys = generate_dataset (UNIFORM_DISTRIBUTION,tree->leaf_entries,dimensions,1,1);
+	fixture->leaf.header.is_leaf = true;
+	fixture->leaf.header.records = tree->leaf_entries;
+	fixture->leaf.node.leaf.keys = keys->keys;
+	fixture->leaf.node.leaf.objects = keys->objects;
+	free (keys);
+
+	dataset_t *const corners = generate_dataset (UNIFORM_DISTRIBUTION,tree->internal_entries<<1,dimensions,1,2);
+	interval_t *const boxes = (interval_t *const) malloc (sizeof(interval_t)*dimensions*tree->internal_entries);
+	if (boxes == NULL) {
+		LOG (fatal,"[new_page_fixture()] Unable to allocate memory for the boxes of a page...\n");
+		exit (EXIT_FAILURE);
+	}
+	for (uint32_t i=0; i<tree->internal_entries; ++i) {
+		for (uint32_t j=0; j<dimensions; ++j) {
+			index_t const center = corners->keys[(i<<1)*dimensions+j];
+			index_t const extent = corners->keys[((i<<1)+1)*dimensions+j] * .05;
+			boxes[i*dimensions+j].start = center - extent;
+			boxes[i*dimensions+j].end = center + extent;
+		}
+	}
+	delete_dataset (corners);
+	fixture->internal.header.is_leaf = false;
+	fixture->internal.header.records = tree->internal_entries;
+	fixture->internal.node.internal.intervals = boxes;
+	fixture->internal.node.internal.counts = NULL;
+
+	fixture->query = (interval_t*) malloc (sizeof(interval_t)*dimensions);
+	fixture->point = (index_t*) malloc (sizeof(index_t)*dimensions);
+	fixture->multiboxes = (multibox_container_t*) malloc (sizeof(multibox_container_t)*tree->internal_entries);
+	fixture->leaf_block = calloc (1,page_size);
+	fixture->internal_block = calloc (1,page_size);
+	if (fixture->query == NULL || fixture->point == NULL || fixture->multiboxes == NULL
+		|| fixture->leaf_block == NULL || fixture->internal_block == NULL) {
+		LOG (fatal,"[new_page_fixture()] Unable to allocate memory for the fixture of a page...\n");
+		exit (EXIT_FAILURE);
+	}
+	for (uint32_t j=0; j<dimensions; ++j) {
+		fixture->query[j].start = WORKLOAD_DOMAIN/4;
+		fixture->query[j].end = 3*WORKLOAD_DOMAIN/4;
+		fixture->point[j] = WORKLOAD_DOMAIN/2;
+	}
+	for (uint32_t i=0; i+2<tree->internal_entries; ++i) {
+		fixture->multiboxes[i].boxes = boxes + i*dimensions;
+		fixture->multiboxes[i].page_ids = NULL;
+		fixture->multiboxes[i].sort_key = 0;
+		fixture->multiboxes[i].dimensions = dimensions;
+		fixture->multiboxes[i].cardinality = 3;
+	}
+	encode_rtree_page (tree,&fixture->leaf,fixture->leaf_block);
+	encode_rtree_page (tree,&fixture->internal,fixture->internal_block);
+}
+
+static
+void delete_page_fixture (fixture_t *const fixture) {
+	free (fixture->leaf.node.leaf.keys);
+	free (fixture->leaf.node.leaf.objects);
+	free (fixture->internal.node.internal.intervals);
+	free (fixture->query);
+	free (fixture->point);
+	free (fixture->multiboxes);
+	free (fixture->leaf_block);
+	free (fixture->internal_block);
+}
+
+static
+void new_container_fixture (fixture_t *const fixture, uint32_t const size) {
+	bzero (fixture,sizeof(fixture_t));
+	fixture->size = size;
+	fixture->values = (double*) malloc (sizeof(double)*size);
+	fixture->identifiers = (uint64_t*) malloc (sizeof(uint64_t)*size);
+	if (fixture->values == NULL || fixture->identifiers == NULL) {
+		LOG (fatal,"[new_container_fixture()] Unable to allocate memory for %u elements...\n",size);
+		exit (EXIT_FAILURE);
+	}
+	uint64_t state = 1;
+	fixture->table = new_symbol_table_primitive (NULL);
+	for (uint32_t i=0; i<size; ++i) {
+		fixture->identifiers[i] = next_random (&state);
+		fixture->values[i] = (next_random (&state) >> 11) * (1.0/(1ULL<<53));
+		set (fixture->table,fixture->identifiers[i],fixture->values+i);
+	}
+	fixture->swap = new_swap (size);
+}
+
+static
+void delete_container_fixture (fixture_t *const fixture) {
+	free (fixture->values);
+	free (fixture->identifiers);
+	delete_symbol_table (fixture->table);
+	delete_swap (fixture->swap);
+}
+
+
+static
+uint64_t monotonic_nanos (void) {
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1000000000 + now.tv_nsec;
+}
+
+static
+int compare_samples (void const*const x, void const*const y) {
+	double const a = *(double const*)x;
+	double const b = *(double const*)y;
+	return a < b ? -1 : a > b;
+}
+
+/**
+ * Runs a kernel a few times unmeasured, then finds how many passes
+ * over it last REPETITION_MICROS, and reports the nanoseconds each
+ * operation took in every repetition of that many passes.
+ */
+static
+void measure_kernel (kernel_t const*const kernel, fixture_t *const fixture) {
+	uint64_t operations = 0;
+	for (uint32_t i=0; i<WARMUP; ++i) {
+		operations = kernel->run (fixture,kernel);
+	}
+
+	uint64_t passes = 1;
+	for (;;) {
+		uint64_t const started = monotonic_nanos ();
+		for (uint64_t i=0; i<passes; ++i) {
+			operations = kernel->run (fixture,kernel);
+		}
+		if (monotonic_nanos () - started >= REPETITION_MICROS*1000) break;
+		passes <<= 1;
+	}
+
+	double samples [REPETITIONS];
+	for (uint32_t r=0; r<REPETITIONS; ++r) {
+		uint64_t const started = monotonic_nanos ();
+		for (uint64_t i=0; i<passes; ++i) {
+			kernel->run (fixture,kernel);
+		}
+		samples[r] = (monotonic_nanos () - started) / (double)(passes*operations);
+	}
+	qsort (samples,REPETITIONS,sizeof(double),compare_samples);
+
+	printf ("%s\n\t\t{\"kernel\": \"%s\", ",is_first_kernel ? "" : ",",kernel->name);
+	if (kernel->scope == CONTAINER_SCOPE) {
+		printf ("\"size\": %u, ",fixture->size);
+	}else{
+		printf ("\"dimensions\": %u, \"page_size\": %u, ",fixture->dimensions,fixture->page_size);
+	}
+	printf ("\"operations\": %lu, \"passes\": %lu, \"repetitions\": %u, "
+		"\"ns_per_operation\": {\"min\": %.3f, \"median\": %.3f, \"max\": %.3f}}",
+		operations,passes,REPETITIONS,samples[0],samples[REPETITIONS>>1],samples[REPETITIONS-1]);
+	fflush (stdout);
+	is_first_kernel = false;
+}
+
+static
+boolean is_selected (kernel_t const*const kernel, scope_t const scope) {
+	return kernel->scope == scope && (KERNEL == NULL || strstr (kernel->name,KERNEL) != NULL);
+}
+
+/**
+ * Keeps the process on one processor, so that repetitions are not
+ * disturbed by migrations, on the one given, or else on the one
+ * it runs on, unless the processor given is negative.
+ */
+static
+void pin_processor (void) {
+	if (CPU == -1) return;
+	int32_t const cpu = CPU < 0 ? sched_getcpu () : CPU;
+	cpu_set_t cpus;
+	CPU_ZERO (&cpus);
+	CPU_SET (cpu,&cpus);
+	if (sched_setaffinity (0,sizeof(cpu_set_t),&cpus)) {
+		LOG (warn,"[pin_processor()] Unable to pin the process on processor %d; timings may vary more.\n",cpu);
+		CPU = -1;
+	}else{
+		CPU = cpu;
+	}
+}
+
+
+static
+void print_notice (void) {
+	fputs ("\n Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>\n\n",stderr);
+	fputs (" #indexing comes with ABSOLUTELY NO WARRANTY. This is free software, \n",stderr);
+	fputs (" and you are welcome to redistribute it under certain conditions.\n\n",stderr);
+}
+
+static
+void print_usage (char const*const program) {
+	printf (" ** Usage:\t %s [option] [parameter]\n", program);
+	puts ("\t\t-d --dims :\t The comma-separated dimensionalities of page entries.");
+	puts ("\t\t-b --blocks :\t The comma-separated block-sizes of pages.");
+	puts ("\t\t-e --elements :\t The comma-separated numbers of elements of containers.");
+	puts ("\t\t-k --kernel :\t Only runs the kernels whose name contains the one given.");
+	puts ("\t\t-w --warmup :\t The unmeasured runs of each kernel.");
+	puts ("\t\t-r --repetitions :\t The measured repetitions of each kernel.");
+	puts ("\t\t-c --cpu :\t The processor to run on; by default the one started on, or none if negative.");
+	puts ("\n\t Results are printed in JSON, one object per kernel and configuration,");
+	puts ("\t with the least, the median and the most nanoseconds an operation took.");
+}
+
+static
+uint32_t parse_list (char const argument[], uint32_t list[]) {
+	uint32_t size = 0;
+	for (char const* token = argument; *token && size < MAX_CONFIGURATIONS; ++size) {
+		char* end;
+		list[size] = strtoul (token,&end,10);
+		if (end == token || !list[size]) {
+			return 0;
+		}
+		token = *end == ',' ? end+1 : end;
+	}
+	return size;
+}
+
+static
+void process_arguments (int argc,char *argv[]) {
+	char const*const short_options = "ud:b:e:k:w:r:c:";
+	const struct option long_options [] = {
+		{"usage",0,NULL,'u'},
+		{"dims",1,NULL,'d'},
+		{"blocks",1,NULL,'b'},
+		{"elements",1,NULL,'e'},
+		{"kernel",1,NULL,'k'},
+		{"warmup",1,NULL,'w'},
+		{"repetitions",1,NULL,'r'},
+		{"cpu",1,NULL,'c'},
+		{NULL,0,NULL,0}
+	};
+
+	int next_option;
+
+	do{
+		next_option = getopt_long (argc,argv,short_options,long_options,NULL);
+
+		switch (next_option) {
+		case 'u':
+			print_usage (argv[0]);
+			flush_log ();
+			exit (EXIT_SUCCESS);
+		case 'd':
+			DIMENSIONALITIES_NUMBER = parse_list (optarg,DIMENSIONALITIES);
+			break;
+		case 'b':
+			BLOCKS_NUMBER = parse_list (optarg,BLOCKS);
+			break;
+		case 'e':
+			ELEMENTS_NUMBER = parse_list (optarg,ELEMENTS);
+			break;
+		case 'k':
+			KERNEL = optarg;
+			break;
+		case 'w':
+			WARMUP = atoi (optarg);
+			break;
+		case 'r':
+			REPETITIONS = atoi (optarg);
+			break;
+		case 'c':
+			CPU = atoi (optarg);
+			if (CPU < 0) CPU = -1;
+			break;
+		case -1:
+			break;
+		case '?':
+			LOG (error,"[%s] Unknown option parameter: %s\n",argv[0],optarg);
+		default:
+			print_usage (argv[0]);
+			flush_log ();
+			exit (EXIT_FAILURE);
+		}
+	}while(next_option!=-1);
+}
+
+int main (int argc, char* argv[]) {
+	print_notice ();
+	process_arguments (argc,argv);
+
+	if (!DIMENSIONALITIES_NUMBER || !BLOCKS_NUMBER || !ELEMENTS_NUMBER || !REPETITIONS) {
+		LOG (error,"[%s] Please specify positive dimensionalities, block-sizes, numbers of elements and repetitions...\n",argv[0]);
+		print_usage (argv[0]);
+		flush_log ();
+		return EXIT_FAILURE;
+	}
+	pin_processor ();
+
+	printf ("{\n\t\"configuration\": {\"warmup\": %u, \"repetitions\": %u, \"repetition_us\": %u, \"cpu\": %d, "
+		"\"index_bytes\": %lu, \"compiled\": \"%s %s\"},\n\t\"kernels\": [",
+		WARMUP,REPETITIONS,REPETITION_MICROS,CPU,sizeof(index_t),__DATE__,__TIME__);
+
+	fixture_t fixture;
+	for (uint32_t d=0; d<DIMENSIONALITIES_NUMBER; ++d) {
+		for (uint32_t b=0; b<BLOCKS_NUMBER; ++b) {
+			if (BLOCKS[b] < sizeof(header_t) + 3*sizeof(interval_t)*DIMENSIONALITIES[d]) {
+				LOG (warn,"[%s] Skipping blocks of %u bytes, too small for 3 entries of %u dimensions.\n",argv[0],BLOCKS[b],DIMENSIONALITIES[d]);
+				continue;
+			}
+			new_page_fixture (&fixture,DIMENSIONALITIES[d],BLOCKS[b]);
+			for (uint32_t k=0; k<sizeof(kernels)/sizeof(*kernels); ++k) {
+				if (is_selected (kernels+k,ENTRY_SCOPE) || is_selected (kernels+k,PAGE_SCOPE)) {
+					measure_kernel (kernels+k,&fixture);
+				}
+			}
+			delete_page_fixture (&fixture);
+		}
+	}
+	for (uint32_t s=0; s<ELEMENTS_NUMBER; ++s) {
+		new_container_fixture (&fixture,ELEMENTS[s]);
+		for (uint32_t k=0; k<sizeof(kernels)/sizeof(*kernels); ++k) {
+			if (is_selected (kernels+k,CONTAINER_SCOPE)) {
+				measure_kernel (kernels+k,&fixture);
+			}
+		}
+		delete_container_fixture (&fixture);
+	}
+
+	puts ("\n\t]\n}");
+	flush_log ();
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,416 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "planner.h"
+#include "stack.h"
+#include "defs.h"
+
+
+static
+double tree_leaves (tree_t const*const tree, double const records) {
+	return records > 0 ? ceil (records/tree->leaf_entries) : 0;
+}
+
+static
+double tree_height (tree_t const*const tree, double const records) {
+	double height = 1;
+	for (double pages = tree_leaves (tree,records); pages > 1; pages /= tree->internal_entries) {
+		++height;
+	}
+	return height;
+}
+
+/**
+ * The fraction of the indexed area of a tree that overlaps with a
+ * range, assuming that its records are uniformly distributed.
+ */
+static
+double range_selectivity (tree_t *const tree, index_t const from[], index_t const to[]) {
+	double selectivity = 1;
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	for (uint32_t j=0; j<tree->dimensions; ++j) {
+		double const lo = MAX(from[j],tree->root_box[j].start);
+		double const hi = MIN(to[j],tree->root_box[j].end);
+		if (lo > hi) {
+			selectivity = 0;
+			break;
+		}else if (tree->root_box[j].end > tree->root_box[j].start) {
+			selectivity *= (hi-lo)/((double)tree->root_box[j].end-tree->root_box[j].start);
+		}
+	}
+	pthread_rwlock_unlock (&tree->tree_lock);
+	return selectivity;
+}
+
+/**
+ * The fraction of the indexed area of a tree within the given
+ * distance from a point, along the given leading dimensions.
+ */
+static
+double ball_fraction (tree_t *const tree, double const radius, uint32_t const dimensions) {
+	double fraction = 1;
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	for (uint32_t j=0; j<dimensions && j<tree->dimensions; ++j) {
+		double const extent = (double)tree->root_box[j].end - tree->root_box[j].start;
+		if (extent > 2*radius) {
+			fraction *= 2*radius/extent;
+		}
+	}
+	pthread_rwlock_unlock (&tree->tree_lock);
+	return fraction;
+}
+
+static
+uint64_t tree_records (tree_t *const tree) {
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	uint64_t const records = tree->indexed_records;
+	pthread_rwlock_unlock (&tree->tree_lock);
+	return records;
+}
+
+/**
+ * True if only some of the results of a subquery are asked for.
+ */
+boolean is_paged_subquery (subquery_t const*const subquery) {
+	return subquery->offset || subquery->limit != NO_LIMIT;
+}
+
+/**
+ * How many of the results of a subquery its page reaches into,
+ * i.e. its offset and its limit, if any, or else NO_LIMIT.
+ */
+uint64_t paged_reach (subquery_t const*const subquery) {
+	return subquery->limit > NO_LIMIT - subquery->offset ? NO_LIMIT : subquery->offset + subquery->limit;
+}
+
+/**
+ * True if the result of a subquery is the tree it is posed
+ * against, which can be used as is wherever a tree is needed.
+ */
+boolean is_base_subquery (subquery_t const*const subquery) {
+	if (subquery->lookups->size || subquery->bounded_dimensionality || subquery->is_skyline || subquery->sample_size || is_paged_subquery (subquery)) {
+		return false;
+	}
+
+	tree_t *const tree = subquery->tree;
+	boolean covers = true;
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	for (uint32_t j=0; j<tree->dimensions; ++j) {
+		if (subquery->from[j] > tree->root_box[j].start || subquery->to[j] < tree->root_box[j].end) {
+			covers = false;
+			break;
+		}
+	}
+	pthread_rwlock_unlock (&tree->tree_lock);
+	return covers;
+}
+
+/**
+ * True if the result of a subquery is just a range of the tree it is
+ * posed against that only restricts the given leading dimensions, so
+ * that it can be probed in place instead of being materialized.
+ */
+boolean is_range_subquery (subquery_t const*const subquery, uint32_t const dimensions) {
+	if (subquery->lookups->size || subquery->bounded_dimensionality || subquery->is_skyline || subquery->sample_size || is_paged_subquery (subquery)) {
+		return false;
+	}
+
+	tree_t *const tree = subquery->tree;
+	boolean restricted = false;
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	for (uint32_t j=dimensions; j<tree->dimensions; ++j) {
+		if (subquery->from[j] > tree->root_box[j].start || subquery->to[j] < tree->root_box[j].end) {
+			restricted = true;
+			break;
+		}
+	}
+	pthread_rwlock_unlock (&tree->tree_lock);
+	return !restricted;
+}
+
+/**
+ * Estimates the number of results of a subquery and the pages it
+ * takes to stream them, from the statistics of its tree.
+ */
+static
+void estimate_subquery (subquery_t *const subquery) {
+	tree_t *const tree = subquery->tree;
+
+	double const records = tree_records (tree);
+	double const selectivity = range_selectivity (tree,subquery->from,subquery->to);
+	double const height = tree_height (tree,records);
+
+	double estimate = records * selectivity;
+	double cost = height + selectivity * tree_leaves (tree,records);
+
+	if (subquery->lookups->size) {
+		estimate = MIN(estimate,subquery->lookups->size);
+		cost = subquery->lookups->size * height + MATERIALIZATION_PAGE_COST * tree_leaves (tree,estimate);
+	}
+
+	if (subquery->is_skyline) {
+		uint32_t const dimensions = subquery->projection ? subquery->projection : tree->dimensions;
+		double skyline = 1;
+		for (uint32_t i=1; i<dimensions && estimate > 1; ++i) {
+			skyline *= log(estimate)/i;
+		}
+		estimate = MIN(estimate,MAX(1,skyline));
+		if (subquery->bounded_dimensionality) {
+			estimate = MIN(estimate,*subquery->bound);
+		}
+	}else if (subquery->bounded_dimensionality) {
+		estimate = MIN(estimate,*subquery->bound);
+		cost = (subquery->lookups->size ? cost : height) + tree_leaves (tree,estimate);
+	}
+
+	if (subquery->sample_size) {
+		estimate = estimate > 0 ? subquery->sample_size : 0;
+		if (tree->is_aggregate && !subquery->lookups->size && !subquery->bounded_dimensionality && !subquery->is_skyline) {
+			cost = MIN(cost,height*subquery->sample_size);
+		}
+	}
+
+	if (is_paged_subquery (subquery)) {
+		estimate = MIN(MAX(estimate-subquery->offset,0),subquery->limit);
+		if (!subquery->lookups->size && !subquery->bounded_dimensionality && !subquery->is_skyline && !subquery->sample_size) {
+			cost = height + tree_leaves (tree,MIN(records*selectivity,subquery->offset+(double)subquery->limit));
+		}
+	}
+
+	subquery->estimated_records = ceil (estimate);
+	subquery->estimated_cost = cost;
+}
+
+/**
+ * Pages taken to make a tree available for the result of a subquery.
+ */
+static
+double tree_cost (subquery_t const*const subquery) {
+	if (is_base_subquery (subquery)) return 0;
+	else return subquery->estimated_cost
+		+ MATERIALIZATION_PAGE_COST * tree_leaves (subquery->tree,subquery->estimated_records);
+}
+
+/**
+ * Pages taken to look up the inner operand of a probe join once its
+ * tree is available; that is one root-to-leaf path and the leaves
+ * holding the records that each outer record is paired with.
+ */
+static
+double probe_cost (subquery_t *const inner, uint32_t const dimensions, double const radius, uint32_t const k) {
+	boolean const in_place = is_range_subquery (inner,dimensions);
+	double const records = in_place ? tree_records (inner->tree) : inner->estimated_records;
+	double const leaves = tree_leaves (inner->tree,records);
+	double const matching = k ? ceil ((double)k/inner->tree->leaf_entries) : ball_fraction (inner->tree,radius,dimensions) * leaves;
+	return tree_height (inner->tree,records) + MAX(1,matching);
+}
+
+void segment_plan (plan_t *const plan, uint64_t const operand_sizes[], uint64_t const memory_limit) {
+	plan->groups_number = 0;
+	for (uint32_t i=0; i<plan->cardinality;) {
+		uint64_t operands_size = 0;
+		uint32_t group_size = 0;
+		while (i < plan->cardinality
+			&& (group_size < 2 || !memory_limit || memory_limit >= operands_size + operand_sizes[i])) {
+			operands_size += operand_sizes[i++];
+			++group_size;
+		}
+		plan->groups[plan->groups_number++] = group_size;
+	}
+}
+
+/**
+ * Decides how a command is to be evaluated given its subqueries in
+ * order. Joins of two subqueries closer than a distance, or of their
+ * closest pairs, probe the tree of one subquery with each result of
+ * the other one if that takes fewer page accesses than materializing
+ * both and traversing their trees synchronously. Subqueries are only
+ * materialized when a tree of their results is needed and their
+ * results are not the very tree they are posed against.
+ */
+plan_t* plan_command (subquery_t *const operands[], uint32_t const cardinality,
+			boolean const is_closest_pairs, boolean const is_knn_join,
+			double const threshold, boolean const is_approximate, uint64_t const memory_limit) {
+
+	plan_t *const plan = (plan_t *const) malloc (sizeof(plan_t));
+	if (plan == NULL) {
+		LOG (fatal,"[plan_command()] Unable to allocate additional memory for a new query plan...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	plan->operands = (subquery_t**) malloc (cardinality*sizeof(subquery_t*));
+	plan->groups = (uint32_t*) malloc (cardinality*sizeof(uint32_t));
+	if (plan->operands == NULL || plan->groups == NULL) {
+		LOG (fatal,"[plan_command()] Unable to allocate additional memory for a new query plan...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	plan->cardinality = cardinality;
+	plan->groups_number = 0;
+	plan->outer = 0;
+
+	uint64_t operand_sizes [cardinality];
+	for (uint32_t i=0; i<cardinality; ++i) {
+		plan->operands[i] = operands[i];
+		estimate_subquery (operands[i]);
+		operands[i]->materialize = cardinality > 1 && !is_base_subquery (operands[i]);
+		operand_sizes[i] = operands[i]->estimated_records
+			* (operands[i]->tree->dimensions*sizeof(index_t)+sizeof(object_t));
+	}
+
+	if (cardinality < 2) {
+		plan->method = NO_JOIN;
+		plan->estimated_records = cardinality ? operands[0]->estimated_records : 0;
+		plan->estimated_cost = cardinality ? operands[0]->estimated_cost : 0;
+		plan->traversal_cost = plan->estimated_cost;
+		return plan;
+	}
+
+	uint32_t dimensions = UINT_MAX;
+	for (uint32_t i=0; i<cardinality; ++i) {
+		if (operands[i]->tree->dimensions < dimensions) {
+			dimensions = operands[i]->tree->dimensions;
+		}
+	}
+
+	boolean const closest = threshold >= 0;
+	double const distance = fabs (threshold);
+	uint32_t const k = is_closest_pairs || is_knn_join ? distance : 0;
+
+	if (is_knn_join) {
+		plan->method = KNN_JOIN;
+		plan->estimated_records = operands[0]->estimated_records * MIN(k,operands[1]->estimated_records);
+		plan->estimated_cost = tree_cost (operands[0]) + tree_cost (operands[1])
+					+ operands[0]->estimated_records * probe_cost (operands[1],dimensions,0,k);
+		plan->traversal_cost = plan->estimated_cost;
+		segment_plan (plan,operand_sizes,0);
+		return plan;
+	}
+
+	plan->method = TRAVERSAL_JOIN;
+	plan->traversal_cost = 0;
+	plan->estimated_records = 1;
+	for (uint32_t i=0; i<cardinality; ++i) {
+		tree_t *const tree = operands[i]->tree;
+		double const records = operands[i]->materialize ? operands[i]->estimated_records : tree_records (tree);
+		plan->traversal_cost += tree_cost (operands[i]) + (is_closest_pairs
+					? tree_height (tree,records) + ceil ((double)k/tree->leaf_entries)
+					: tree_leaves (tree,records));
+		plan->estimated_records *= operands[i]->estimated_records;
+		if (i && !is_closest_pairs && closest) {
+			plan->estimated_records *= ball_fraction (tree,distance,dimensions);
+		}
+	}
+	if (is_closest_pairs) {
+		plan->estimated_records = MIN(k,plan->estimated_records);
+	}
+	plan->estimated_cost = plan->traversal_cost;
+
+	if (cardinality == 2 && closest && !is_approximate && (k || !is_closest_pairs)) {
+		for (uint32_t outer=0; outer<2; ++outer) {
+			subquery_t *const inner = operands[1-outer];
+			double const cost = operands[outer]->estimated_cost
+					+ (is_range_subquery (inner,dimensions) ? 0 : tree_cost (inner))
+					+ operands[outer]->estimated_records * probe_cost (inner,dimensions,distance,k);
+
+			if (cost < plan->estimated_cost) {
+				plan->method = is_closest_pairs ? NESTED_LOOP_KNN_JOIN : PROBE_JOIN;
+				plan->estimated_cost = cost;
+				plan->outer = outer;
+			}
+		}
+
+		if (plan->method != TRAVERSAL_JOIN) {
+			subquery_t *const inner = operands[1-plan->outer];
+			operands[plan->outer]->materialize = false;
+			inner->materialize = !is_range_subquery (inner,dimensions);
+		}
+	}
+
+	segment_plan (plan,operand_sizes,plan->method == TRAVERSAL_JOIN ? memory_limit : 0);
+
+	LOG (info,"[plan_command()] Planned %u-way join with estimated cost %.2lf against %.2lf of a synchronous traversal.\n",
+		cardinality,plan->estimated_cost,plan->traversal_cost);
+
+	return plan;
+}
+
+static
+char const* subquery_operation (subquery_t const*const subquery) {
+	if (subquery->is_count) return "count";
+	else if (subquery->sample_size) return "sample";
+	else if (is_paged_subquery (subquery)) return "page";
+	else if (subquery->is_skyline) return "skyline";
+	else if (subquery->bounded_dimensionality) return "bounded search";
+	else if (subquery->lookups->size) return "lookup";
+	else if (is_base_subquery (subquery)) return "scan";
+	else return "range";
+}
+
+static
+char const* join_method_name (join_method_t const method) {
+	switch (method) {
+		case TRAVERSAL_JOIN: return "traversal";
+		case PROBE_JOIN: return "probe";
+		case NESTED_LOOP_KNN_JOIN: return "nested-loop kNN";
+		case KNN_JOIN: return "kNN join";
+		default: return "none";
+	}
+}
+
+/**
+ * Describes a plan in the rows of a response; one for each subquery
+ * and a last one for the way their results are combined. The plan is
+ * to be explained before its subqueries are evaluated.
+ */
+char* explain_plan (plan_t const*const plan) {
+	uint64_t const buffer_size = (plan->cardinality+1) * (BUFSIZ+(1<<8));
+	char *const buffer = (char *const) malloc (buffer_size*sizeof(char));
+	if (buffer == NULL) {
+		LOG (fatal,"[explain_plan()] Unable to allocate additional memory for the explanation of a plan...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	char* row = buffer;
+	for (uint32_t i=0; i<plan->cardinality; ++i) {
+		subquery_t const*const operand = plan->operands[i];
+		row += sprintf (row,"\t{ \"operand\": %u, \"heapfile\": \"%.*s\", \"operation\": \"%s\", "
+					"\"records\": %lu, \"estimated_records\": %lu, \"estimated_cost\": %.2lf, \"materialize\": %s },\n",
+					i,BUFSIZ>>1,operand->tree->filename,subquery_operation (operand),
+					tree_records (operand->tree),operand->estimated_records,operand->estimated_cost,
+					operand->materialize?"true":"false");
+	}
+
+	row += sprintf (row,"\t{ \"join\": \"%s\", \"outer\": %u, \"groups\": [",join_method_name (plan->method),plan->outer);
+	for (uint32_t i=0; i<plan->groups_number; ++i) {
+		row += sprintf (row,"%s%u",i?",":"",plan->groups[i]);
+	}
+	sprintf (row,"], \"estimated_records\": %lu, \"estimated_cost\": %.2lf, \"traversal_cost\": %.2lf },\n",
+		plan->estimated_records,plan->estimated_cost,plan->traversal_cost);
+
+	return buffer;
+}
+
+void delete_plan (plan_t *const plan) {
+	free (plan->operands);
+	free (plan->groups);
+	free (plan);
+}
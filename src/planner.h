@@ -0,0 +1,21 @@
+#ifndef PLANNER_H_
+#define PLANNER_H_
+
+#include "defs.h"
+
+boolean is_paged_subquery (subquery_t const*const subquery);
+uint64_t paged_reach (subquery_t const*const subquery);
+boolean is_base_subquery (subquery_t const*const subquery);
+boolean is_range_subquery (subquery_t const*const subquery, uint32_t const dimensions);
+
+plan_t* plan_command (subquery_t *const operands[], uint32_t const cardinality,
+			boolean const is_closest_pairs, boolean const is_knn_join,
+			double const threshold, boolean const is_approximate, uint64_t const memory_limit);
+
+void segment_plan (plan_t *const plan, uint64_t const operand_sizes[], uint64_t const memory_limit);
+
+char* explain_plan (plan_t const*const plan);
+
+void delete_plan (plan_t *const plan);
+
+#endif /* PLANNER_H_ */
@@ -20,138 +20,200 @@
 #include<string.h>
 #include<limits.h>
 #include<unistd.h>
+#include<time.h>
+#include<ctype.h>
 #include"QL.tab.h"
-#include"PUT.tab.h"
-#include"DELETE.tab.h"
 #include"symbol_table.h"
 #include"skyline_queries.h"
 #include"spatial_standard_queries.h"
 #include"priority_queue.h"
+#include"spill.h"
+#include"planner.h"
+#include"cache.h"
+#include"statement.h"
+#include"writer.h"
+#include"ingest.h"
+#include"stats.h"
 #include"common.h"
 #include"queue.h"
 #include"stack.h"
 #include"rtree.h"
 #include"defs.h"
 
-#define MEMORY_BOUND 1<<20
-
 symbol_table_t* server_trees = NULL;
 pthread_rwlock_t server_lock = PTHREAD_RWLOCK_INITIALIZER;
 
-static fifo_t* process_command (lifo_t *const, char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter);
-static tree_t* process_reverse_NN_query (lifo_t *const, char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter);
-static tree_t* process_subquery (lifo_t *const, char const folder[], char message[], uint64_t *const io_blocks_counter);
+cache_t* server_responses = NULL;
+pthread_mutex_t responses_lock = PTHREAD_MUTEX_INITIALIZER;
+
+symbol_table_t* server_statements = NULL;
+cache_t* parsed_commands = NULL;
+pthread_mutex_t statements_lock = PTHREAD_MUTEX_INITIALIZER;
+
+uint32_t PARALLELISM = 1;
+uint64_t MEMORY_LIMIT = 1<<26;
+uint64_t CACHE_LIMIT = 1<<26;
+uint64_t SLOW_QUERY_LIMIT = 0;
+uint64_t SLOW_QUERY_RATE = 10;
+
+static fifo_t* process_command (lifo_t *const, char const folder[], char message[], spill_t **const spilled, boolean const explain, boolean const analyze, char **const reported, uint32_t *const fields);
+static tree_t* process_reverse_NN_query (lifo_t *const, char const folder[], char message[]);
+static tree_t* process_subquery (lifo_t *const, char const folder[], char message[]);
+static subquery_t* new_subquery (tree_t *const);
+static void delete_subquery (subquery_t *const);
+static subquery_t* parse_subquery (lifo_t *const, char const folder[], char message[]);
+static fifo_t* evaluate_subquery (subquery_t *const, char message[]);
+static tree_t* materialize_subquery (subquery_t *const, char message[]);
+static char* count_subquery (subquery_t *const, char message[]);
 static fifo_t* top_level_in_mem_closest_pairs (uint32_t const k, boolean const less_than_theta, boolean const pairwise, boolean const use_avg, lifo_t *const partial_results, boolean const has_tail);
-static fifo_t* top_level_in_mem_distance_join (double const theta, boolean const less_than_theta, boolean const pairwise, boolean const use_avg, lifo_t *const partial_results, boolean const has_tail);
+static spill_t* top_level_distance_join (double const theta, boolean const less_than_theta, boolean const pairwise, boolean const use_avg, lifo_t *const partial_results, boolean const has_tail, uint64_t const memory_limit);
+static multidata_container_t* next_join_result (fifo_t *const result, spill_t *const spilled);
 static tree_t* create_temp_rtree (fifo_t *const partial_result, uint32_t const page_size, uint32_t const dimensions);
 static tree_t* get_rtree (char const*const filepath);
+static void release_rtree (tree_t *const tree);
+static void report_approximation (char message[], approximation_t const*const, boolean const is_ratio, boolean const less_than);
+static char* lookup_response (char const key[], char message[], writer_t *const output);
+static cached_response_t* new_response (char const command[], char const folder[]);
+static void send_response (writer_t *const output, char const data[], uint64_t const length, cached_response_t *const response);
+static void record_response (void *const response, char const*const data, uint64_t const length);
+static void store_response (char const key[], cached_response_t *const response, char const message[]);
+static void delete_response (value_t const response);
+static void invalidate_responses (char const heapfile[]);
+static statement_t* parse_statement (char const command[], char message[]);
+static boolean load_statement (char const command[], char message[], lifo_t *const stack, double varray[], boolean *const is_single_subquery);
+static char* prepare_statement (char const command[], char message[]);
+static void encode_results (writer_t *const writer, format_t const format, fifo_t *const result, spill_t *const spilled, boolean const is_single_subquery, boolean const with_keys);
+static operator_t subquery_operator (subquery_t const*const subquery);
+static uint64_t discard_results (fifo_t *const result, spill_t *const spilled, boolean const is_single_subquery);
+static char* append_rows (char *const rows, char *const more);
 static int strcompare (key__t x, key__t y) {
 	return strcmp ((char const*const)x,(char const*const)y);
 }
 
-int process_rest_request (char const json[], char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter, request_t const type) {
-	LOG (info,"[process_rest_request()] Now processing JSON request: %s\n",json)
-	get_rtree (NULL);
+/**
+ * Traces a request on behalf of the calling thread and of every
+ * thread helping it, until the request ends; then returns when.
+ */
+static
+uint64_t begin_trace (query_context_t *const context) {
+	bzero (context,sizeof(query_context_t));
+	bzero (&trace_counters,sizeof(query_context_t));
+	query_context = context;
+	return wall_clock_micros();
+}
 
-	char heapfile [64];
-	index_t varray [BUFSIZ];
-	lifo_t *const data_entries = new_stack();
+/**
+ * Adds up the pages a request read and wrote to the given counters, and logs
+ * what it cost if it took longer than SLOW_QUERY_LIMIT milliseconds,
+ * for up to SLOW_QUERY_RATE such requests per second.
+ */
+static
+void end_trace (query_context_t const*const context, char const request[], uint64_t const started,
+			uint64_t *const io_blocks_counter, double *const io_mb_counter) {
+	merge_trace_counters ();
+	query_context = NULL;
+	*io_blocks_counter += context->disk_reads + context->disk_writes;
+	*io_mb_counter += (context->bytes_read + context->bytes_written)/((double)(1<<20));
+
+	uint64_t const elapsed = (wall_clock_micros()-started)/1000;
+	if (SLOW_QUERY_LIMIT && elapsed >= SLOW_QUERY_LIMIT) {
+		static log_limit_t slow_queries = {.second = 0, .count = 0, .suppressed = 0};
+		slow_queries.rate = SLOW_QUERY_RATE;
+
+		uint64_t suppressed = 0;
+		if (!is_log_permitted (&slow_queries,&suppressed)) {
+			return;
+		}
+		if (suppressed) {
+			LOG (warn,"[end_trace()] Suppressed the log of %lu more slow requests.\n",suppressed);
+		}
 
-	yyscan_t scanner;
-	YY_BUFFER_STATE buffer = null;
-
-	int parser_rval = 0;
-	if (type == PUT) {
-		PUT_lex_init (&scanner);
-		buffer = PUT__scan_string (json,scanner);
-		parser_rval = PUT_parse (scanner,data_entries,varray,heapfile);
-		PUT__delete_buffer (buffer,scanner);
-		PUT_lex_destroy (scanner);
-	}else{
-		DELETE_lex_init (&scanner);
-		buffer = DELETE__scan_string (json,scanner);
-		parser_rval = DELETE_parse (scanner,data_entries,varray,heapfile);
-		DELETE__delete_buffer (buffer,scanner);
-		DELETE_lex_destroy (scanner);
+		uint64_t visits = 0;
+		for (uint32_t i=0; i<TRACE_LEVELS; ++i) {
+			visits += context->visits[i];
+		}
+		LOG (warn,"[end_trace()] Slow request '%s' took %lu ms; it visited %lu pages, read %lu from the disk, "
+			"wrote %lu to the disk, tested %lu entries, pruned %lu subtrees, computed %lu distances and restarted %lu traversals, "
+			"while spending %lu us parsing, %lu us on subqueries, %lu us joining and %lu us serializing.\n",
+			request,elapsed,visits,context->disk_reads,context->disk_writes,context->entries_tested,context->nodes_pruned,
+			context->distances,context->restarts,context->phases[PARSE_PHASE],context->phases[SUBQUERY_PHASE],
+			context->phases[JOIN_PHASE],context->phases[SERIALIZE_PHASE]);
 	}
+}
 
-	if (parser_rval) {
-		LOG (error,"[process_rest_request()] Syntax error; unable to parse request: '%s'\n",json);
-		strcat (message,"Syntax error; unable to parse request.");
+static
+int apply_rest_request (char const json[], uint64_t const length, char const folder[], char message[], request_t const type) {
+	LOG (info,"[process_rest_request()] Now processing JSON request of %lu bytes.\n",length)
+	uint64_t const started = wall_clock_micros();
+	get_rtree (NULL);
+
+	ingest_t *const ingest = parse_ingest (json,length,type,message);
+	if (ingest == NULL) {
 		return EXIT_FAILURE;
 	}
 
-	char *const filepath = (char *const) malloc (sizeof(char)*(strlen(folder)+strlen(heapfile)+2));
+	char *const filepath = (char *const) malloc (sizeof(char)*(strlen(folder)+strlen(ingest->heapfile)+2));
 	strcpy (filepath,folder);
 	if (folder[strlen(folder)-1]!='/') {
 		strcat (filepath,"/");
 	}
-	LOG (debug,"[process_rest_request()] HEAPFILE: '%s'. \n",heapfile);
-	strcat (filepath,heapfile);
+	LOG (debug,"[process_rest_request()] HEAPFILE: '%s'. \n",ingest->heapfile);
+	strcat (filepath,ingest->heapfile);
 
 	boolean delete_new_tree = false;
 	tree_t *tree = get_rtree (filepath);
 	if (tree == NULL) {
 		if (type == PUT) {
-			if (data_entries->size) {
-				uint16_t dimensionality = 0xffff;
-				for (register uint64_t i=0; i<data_entries->size; ++i) {
-					data_pair_t *const data_pair = (data_pair_t *const) data_entries->buffer[i];
-					if (dimensionality > data_pair->dimensions) {
-						dimensionality = data_pair->dimensions;
-					}
-				}
-				tree = new_rtree (filepath,1024,dimensionality);
+			if (ingest->size) {
+				tree = new_rtree (filepath,1024,ingest->dimensions,false);
 				delete_new_tree = true;
 				free (filepath);
 			}else{
 				LOG (error,"[process_rest_request()] No entries found for heapfile '%s'.\n",filepath);
 				sprintf (message,"No entries found for heapfile '%s'.",filepath);
 				free (filepath);
+				delete_ingest (ingest);
 				return EXIT_FAILURE;
 			}
 		}else{
 			LOG (error,"[process_rest_request()] Unable to access heapfile '%s'.\n",filepath);
 			sprintf (message,"Unable to access heapfile '%s'.",filepath);
 			free (filepath);
+			delete_ingest (ingest);
 			return EXIT_FAILURE;
 		}
 	}
 
-	uint64_t failed_entries = 0;
+	uint64_t failed_entries = ingest->failed;
 	uint64_t successful_entries = 0;
-	lifo_t *const failed = new_stack();
-	while (data_entries->size) {
-		data_pair_t *const data_pair = remove_from_stack (data_entries);
-		if (data_pair->dimensions >= tree->dimensions) {
-			if (type == PUT) {
-				insert_into_rtree (tree,data_pair->key,data_pair->object);
-			}else{
-				delete_from_rtree (tree,data_pair->key);
+	if (ingest->dimensions >= tree->dimensions) {
+		/* keys of more dimensions than the tree are cut down in place, to be laid out as batches expect */
+		if (ingest->dimensions > tree->dimensions) {
+			for (uint64_t i=1; i<ingest->size; ++i) {
+				memmove (ingest->keys+i*tree->dimensions,ingest->keys+i*ingest->dimensions,sizeof(index_t)*tree->dimensions);
 			}
-			++successful_entries;
-			free (data_pair->key);
-			free (data_pair);
+		}
+
+		if (delete_new_tree) {
+			bulk_load_rtree (tree,ingest->keys,ingest->objects,ingest->size,NULL,NULL);
+		}else if (type == PUT) {
+			insert_batch_into_rtree (tree,ingest->keys,ingest->objects,ingest->size,NULL,NULL);
 		}else{
-			insert_into_stack (failed,data_pair);
-			++failed_entries;
+			delete_batch_from_rtree (tree,ingest->keys,ingest->size,NULL,NULL);
 		}
+		successful_entries = ingest->size;
+	}else{
+		failed_entries += ingest->size;
 	}
-	while (failed->size) {
-		data_pair_t *const data_pair = remove_from_stack (failed);
 
-		free (data_pair->key);
-		free (data_pair);
+	if (successful_entries) {
+		invalidate_responses (tree->filename);
 	}
 
 	LOG (debug,"[process_rest_request()] Successfully processed %lu data entries out of %lu.\n",successful_entries,successful_entries+failed_entries);
 	sprintf (message,"Successfully processed %lu data entries out of %lu.",successful_entries,successful_entries+failed_entries);
 
-	*io_mb_counter += tree->io_counter * tree->page_size;
-	*io_blocks_counter += tree->io_counter;
-
-	delete_stack (data_entries);
-	delete_stack (failed);
+	delete_ingest (ingest);
 
 	if (delete_new_tree) {
 		delete_tree (tree);
@@ -162,277 +224,895 @@ int process_rest_request (char const json[], char const folder[], char message[]
 			delete_tree (tree);
 		}
 	}
+	record_latency (type == PUT ? INSERT_OPERATOR : DELETE_OPERATOR,wall_clock_micros()-started);
+	return EXIT_SUCCESS;
+}
+
+int process_rest_request (char const json[], uint64_t const length, char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter, request_t const type) {
+	query_context_t context;
+	uint64_t const started = begin_trace (&context);
+	int const rval = apply_rest_request (json,length,folder,message,type);
+	end_trace (&context,type == PUT ? "PUT" : "DELETE",started,io_blocks_counter,io_mb_counter);
+	return rval;
+}
+
+/**
+ * The progress of a bulk request is streamed to its client as
+ * a list of the records indexed so far, each out of their total.
+ */
+typedef struct {
+	writer_t* output;
+	uint64_t reports;
+} bulk_progress_t;
+
+static
+void report_bulk_progress (uint64_t const processed, uint64_t const total, void *const args) {
+	bulk_progress_t *const progress = (bulk_progress_t *const) args;
+	LOG (info,"[report_bulk_progress()] Indexed %lu data entries out of %lu.\n",processed,total);
+	if (progress->output != NULL) {
+		write_string (progress->output,progress->reports++ ? ",\n\t{ \"records\": " : "\n\t{ \"records\": ");
+		write_unsigned (progress->output,processed);
+		write_string (progress->output,", \"of\": ");
+		write_unsigned (progress->output,total);
+		write_string (progress->output," }");
+		flush_writer (progress->output);
+	}
+}
+
+/**
+ * Indexes the records of a bulk request; i.e. bulk-loads them into
+ * a new heapfile if there is none by the name given, or else inserts
+ * them in batch. Progress is reported through the output given, if any.
+ */
+static
+int apply_bulk_request (char const heapfile[], char const data[], uint64_t const length, char const folder[], char message[],
+			writer_t *const output) {
+	LOG (info,"[process_bulk_request()] Now processing bulk request of %lu bytes.\n",length)
+	uint64_t const started = wall_clock_micros();
+	get_rtree (NULL);
+
+	ingest_t *const ingest = decode_bulk (heapfile,data,length,message);
+	if (ingest == NULL) {
+		if (output != NULL) {
+			write_string (output,"null,\n");
+		}
+		return EXIT_FAILURE;
+	}
+
+	char *const filepath = (char *const) malloc (sizeof(char)*(strlen(folder)+strlen(ingest->heapfile)+2));
+	strcpy (filepath,folder);
+	if (folder[strlen(folder)-1]!='/') {
+		strcat (filepath,"/");
+	}
+	strcat (filepath,ingest->heapfile);
+
+	tree_t* tree = get_rtree (filepath);
+	boolean const is_new_tree = tree == NULL;
+	if ((is_new_tree && !ingest->size) || (!is_new_tree && tree->dimensions != ingest->dimensions)) {
+		if (is_new_tree) {
+			LOG (error,"[process_bulk_request()] No entries found for heapfile '%s'.\n",filepath);
+			sprintf (message,"No entries found for heapfile '%s'.",filepath);
+		}else{
+			LOG (error,"[process_bulk_request()] Records of %u dimensions cannot be indexed by heapfile '%s' of %u.\n",ingest->dimensions,filepath,tree->dimensions);
+			sprintf (message,"Records of %u dimensions cannot be indexed by heapfile '%s' of %u.",ingest->dimensions,filepath,tree->dimensions);
+		}
+		if (output != NULL) {
+			write_string (output,"null,\n");
+		}
+		free (filepath);
+		delete_ingest (ingest);
+		return EXIT_FAILURE;
+	}
+
+	bulk_progress_t progress;
+	progress.output = output;
+	progress.reports = 0;
+	if (output != NULL) {
+		write_string (output,"[ ");
+	}
+	if (is_new_tree) {
+		tree = new_rtree (filepath,1024,ingest->dimensions,false);
+		bulk_load_rtree (tree,ingest->keys,ingest->objects,ingest->size,&report_bulk_progress,&progress);
+	}else{
+		insert_batch_into_rtree (tree,ingest->keys,ingest->objects,ingest->size,&report_bulk_progress,&progress);
+	}
+	if (output != NULL) {
+		write_string (output,"\n\t],\n");
+	}
+	free (filepath);
+
+	if (ingest->size) {
+		invalidate_responses (tree->filename);
+	}
+
+	LOG (debug,"[process_bulk_request()] Successfully processed %lu data entries out of %lu.\n",ingest->size,ingest->size);
+	sprintf (message,"Successfully processed %lu data entries out of %lu.",ingest->size,ingest->size);
+
+	delete_ingest (ingest);
+
+	if (is_new_tree) {
+		delete_tree (tree);
+	}else{
+		flush_tree (tree);
+	}
+	record_latency (BULK_OPERATOR,wall_clock_micros()-started);
 	return EXIT_SUCCESS;
 }
 
-char* qprocessor (char command[], char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter, int fd) {
+int process_bulk_request (char const heapfile[], char const data[], uint64_t const length, char const folder[], char message[],
+			uint64_t *const io_blocks_counter, double *const io_mb_counter, writer_t *const output) {
+	query_context_t context;
+	uint64_t const started = begin_trace (&context);
+	int const rval = apply_bulk_request (heapfile,data,length,folder,message,output);
+	end_trace (&context,heapfile,started,io_blocks_counter,io_mb_counter);
+	return rval;
+}
+
+/**
+ * Reports the counters of every heapfile the server keeps open,
+ * followed by the latencies of the operators evaluated so far;
+ * i.e. as lines of text, or else as the members of a JSON object.
+ */
+void report_statistics (writer_t *const writer, boolean const as_text) {
+	if (!as_text) {
+		write_string (writer,"\"trees\":[");
+	}
+	pthread_rwlock_rdlock (&server_lock);
+	if (server_trees != NULL) {
+		fifo_t *const server_tree_entries = get_entries (server_trees);
+		for (boolean is_first = true; server_tree_entries->size; is_first = false) {
+			symbol_table_entry_t *const entry = remove_head_of_queue (server_tree_entries);
+			write_tree_statistics (writer,entry->value,as_text,is_first);
+			free (entry);
+		}
+		delete_queue (server_tree_entries);
+	}
+	pthread_rwlock_unlock (&server_lock);
+	if (!as_text) {
+		write_string (writer,"],\"operators\":[");
+	}
+	write_latency_statistics (writer,as_text);
+	if (!as_text) {
+		write_string (writer,"]");
+	}
+}
+
+static
+char* process_query (char command[], char const folder[], char message[], writer_t *const output, format_t const format) {
 	LOG (info,"[qprocessor()] Will now initiate the processing of command '%s'.\n",command);
+
+	/* commands repeated with their heapfiles unchanged are answered from the cache */
+	char *const key = (char *const) malloc (sizeof(char)*(strlen(command)+16));
+	char* normalized = key;
+	if (format != JSON_FORMAT) {
+		normalized = stpcpy (key,format == COLUMNS_FORMAT ? "/binary/columns" : "/binary");
+	}
+	for (char const* c = command; *c != '\0'; ++c) {
+		if (!isspace (*c)) {
+			*normalized++ = *c;
+		}
+	}
+	while (normalized > key && (normalized[-1] == ';' || normalized[-1] == '/')) {
+		--normalized;
+	}
+	*normalized = '\0';
+
+	char *const cached = lookup_response (key,message,output);
+	if (cached != NULL) {
+		LOG (info,"[qprocessor()] Responding to command '%s' from the cache.\n",key);
+		free (key);
+		return cached;
+	}
+
+	/* an EXPLAIN query reports how its commands would be evaluated instead */
+	boolean const explain = !strncmp (command,"/explain/",9);
+	if (explain) {
+		command += 8;
+	}
+
+	/* and an EXPLAIN ANALYZE one also evaluates them, reporting what that cost */
+	boolean const analyze = explain && !strncmp (command,"/analyze/",9);
+	if (analyze) {
+		command += 8;
+	}
+
+	uint64_t phase_started = wall_clock_micros();
 	get_rtree (NULL);
 	double varray [BUFSIZ];
 	lifo_t *const stack = new_stack();
 
-	yyscan_t scanner;
-	QL_lex_init (&scanner);
-	YY_BUFFER_STATE command_buffer = QL__scan_string (command,scanner);
-	int parser_rval = QL_parse (scanner,stack,varray);
-	QL__delete_buffer (command_buffer,scanner);
-	QL_lex_destroy (scanner);
-
-	if (parser_rval) {
-		LOG (error,"[qprocessor()] Syntax error; unable to parse query: '%s'\n",command);
-		strcat (message,"Syntax error; unable to parse query.");
-		char *null_string = "null,\n";
-		if (fd) {
-			if (write (fd,null_string,sizeof(null_string)) < sizeof(null_string)) {
-				LOG (error,"[qprocessor()] Error while sending data using file-descriptor %u.\n",fd);
-			}
+	/* a PREPARE query only keeps its command to be executed later on */
+	boolean const prepare = !strncmp (command,"/prepare/",9);
+	char *buffer = prepare ? prepare_statement (command+9,message) : NULL;
+
+	boolean is_single_subquery = false;
+	if (format != JSON_FORMAT && (explain || prepare)) {
+		LOG (error,"[qprocessor()] Only query results can be encoded in binary: '%s'\n",command);
+		strcpy (message,"Only query results can be encoded in binary.");
+		delete_stack (stack);
+		free (buffer);
+		free (key);
+		return NULL;
+	}else if (prepare ? buffer == NULL : !load_statement (command,message,stack,varray,&is_single_subquery)) {
+		LOG (error,"[qprocessor()] Unable to process query: '%s'\n",command);
+		if (output != NULL && format == JSON_FORMAT) {
+			write_string (output,"null,\n");
 		}
+		delete_stack (stack);
+		free (key);
 		return NULL;
 	}
 
-	srand48(time(NULL));
-	char *buffer = NULL;
+	cached_response_t *const response = new_response (command,folder);
+	if (analyze) {
+		response->is_cacheable = false;
+	}
+	trace_phase (PARSE_PHASE,phase_started);
+
 	//pthread_rwlock_init (&server_lock,NULL);
+	writer_t* writer = NULL;
 	while (stack->size) {
-		fifo_t *const result = process_command (stack,folder,message,io_blocks_counter,io_mb_counter);
-
-		if (result == NULL) {
-			char *null_string = "null,\n";
-			if (fd) {
-				if (write (fd,null_string,sizeof(null_string)) < sizeof(null_string)) {
-					LOG (error,"[qprocessor()] Error while sending data using file-descriptor %u.\n",fd);
-				}
+		spill_t* spilled = NULL;
+		char* reported = NULL;
+		uint32_t fields = DEFAULT_FIELDS;
+		fifo_t *const result = process_command (stack,folder,message,&spilled,explain,analyze,&reported,&fields);
+
+		if (analyze && result != NULL) {
+			uint64_t const rows = discard_results (result,spilled,is_single_subquery);
+			merge_trace_counters ();
+			reported = append_rows (reported,explain_trace (query_context,rows));
+			spilled = NULL;
+		}
+		phase_started = wall_clock_micros();
+
+		if (result == NULL || (reported != NULL && format != JSON_FORMAT)) {
+			if (result != NULL) {
+				LOG (error,"[qprocessor()] Only query results can be encoded in binary.\n");
+				strcpy (message,"Only query results can be encoded in binary.");
+				delete_queue (result);
+				free (reported);
+			}
+			if (writer == output) {
+				tap_writer (output,NULL,NULL);
+			}else if (writer != NULL) {
+				free (delete_writer (writer));
+			}
+			if (output != NULL && format == JSON_FORMAT) {
+				write_string (output,"null,\n");
 			}
 			LOG (error,"[qprocessor()] Early return from query processor due to bad command...\n");
+			delete_response (response);
 			delete_stack (stack);
+			free (key);
 			return NULL;
 		}
 
-		uint64_t buffer_size = BUFSIZ<<1;
-		buffer = (char *const) malloc (sizeof(char)*buffer_size);
-		char *guard = buffer + buffer_size;
-		char* result_string = buffer;
+		if (writer == NULL && output != NULL) {
+			writer = output;
+			tap_writer (output,record_response,response);
+		}else if (writer == NULL) {
+			writer = new_writer (0,record_response,response);
+		}
 
-		uint64_t rid = 0;
-		*result_string = '\0';
-		result_string = strcat (result_string,"[ \n");
-		result_string += strlen(result_string);
+		if (format != JSON_FORMAT) {
+			LOG (info,"[qprocessor()] Encoding results in binary...\n");
+			encode_results (writer,format,result,spilled,is_single_subquery,(fields & KEYS_FIELD) != 0);
+			delete_queue (result);
+			trace_phase (SERIALIZE_PHASE,phase_started);
+			continue;
+		}
 
-		if (strchr(command,'/') == strrchr(command,'/')) {
+		uint64_t rid = 0;
+		write_string (writer,"[ ");
+
+		if (reported != NULL) {
+			uint64_t const reportedlen = strlen (reported);
+			write_string (writer,"\n");
+			write_bytes (writer,reported,reportedlen > 2 ? reportedlen - 2 : 0);
+			free (reported);
+		}else if (is_single_subquery) {
 			LOG (info,"[qprocessor()] Processed query returned %lu tuples. \n",result->size);
 			while (result->size) {
 				data_pair_t *const tuple = remove_tail_of_queue (result);
 
-				if (guard - result_string < BUFSIZ) {
-					uint64_t resultlen = strlen(buffer);
-					if (fd) {
-						if (write (fd,buffer,resultlen*sizeof(char)) < resultlen*sizeof(char)) {
-							LOG (error,"[qprocessor()] Error while sending data using file-descriptor %u.\n",fd);
-						}
-						bzero (buffer,sizeof(buffer));
-						result_string = buffer;
-						*result_string = '\0';
-					}else{
-						char *const old_buffer = buffer;
-						buffer_size <<= 1;
-						buffer = (char *const) malloc (sizeof(char)*buffer_size);
-						guard = buffer + buffer_size;
-
-						strcpy (buffer,old_buffer);
-						free (old_buffer);
-
-						result_string = buffer + resultlen;
+				write_string (writer,rid ? ",\n\t{ \"rid\": " : "\n\t{ \"rid\": ");
+				write_unsigned (writer,rid++);
+				if (fields & OBJECTS_FIELD) {
+					write_string (writer,", \"objects\": [");
+					write_unsigned (writer,tuple->object);
+					write_bytes (writer,"]",1);
+				}
+				if (fields & KEYS_FIELD) {
+					write_string (writer,", \"keys\": [[");
+					for (uint32_t j=0; j<tuple->dimensions; ++j) {
+						if (j) write_bytes (writer,",",1);
+						write_float (writer,tuple->key[j]);
 					}
+					write_bytes (writer,"]]",2);
 				}
+				write_string (writer," }");
 
-				sprintf (result_string,"\t{ \"rid\": %lu, ",rid++);
-				result_string += strlen(result_string);
-
-				sprintf (result_string,"\"objects\": [%lu], ",tuple->object);
-				result_string += strlen(result_string);
-
-				result_string = strcat (result_string,"\"keys\": [[");
-				result_string += strlen (result_string);
+				free (tuple->key);
+				free (tuple);
+			}
+		}else{
+			LOG (info,"[qprocessor()] Processed join returned %lu tuples. \n",spilled != NULL ? spilled->size : result->size);
+			for (multidata_container_t* tuple; (tuple = next_join_result (result,spilled)) != NULL;) {
+				write_string (writer,rid ? ",\n\t{ \"rid\": " : "\n\t{ \"rid\": ");
+				write_unsigned (writer,rid++);
+				if (fields & OBJECTS_FIELD) {
+					write_string (writer,", \"objects\": [");
+					for (uint32_t i=0; i<tuple->cardinality; ++i) {
+						if (i) write_bytes (writer,",",1);
+						write_unsigned (writer,tuple->objects[i]);
+					}
+					write_bytes (writer,"]",1);
+				}
+				if (fields & KEYS_FIELD) {
+					write_string (writer,", \"keys\": [");
+					for (uint32_t i=0; i<tuple->cardinality; ++i) {
+						write_string (writer,i ? ",[" : "[");
+						for (uint32_t j=0; j<tuple->dimensions; ++j) {
+							if (j) write_bytes (writer,",",1);
+							write_float (writer,tuple->keys[i*tuple->dimensions+j]);
+						}
+						write_bytes (writer,"]",1);
+					}
+					write_bytes (writer,"]",1);
+				}
 
-				for (uint32_t j=0; j<tuple->dimensions; ++j) {
-					sprintf (result_string,"%12lf,",(double)tuple->key[j]);
-					result_string += strlen(result_string);
+				/* distances among the keys of each tuple are only computed when asked for */
+				if (fields & METRICS_FIELD) {
+					write_string (writer,", \"mindistance_ordered\": ");
+					write_float (writer,mindistance_ordered_multikey(tuple,0));
+					write_string (writer,", \"mindistance_pairwise\": ");
+					write_float (writer,mindistance_pairwise_multikey(tuple,0));
+					write_string (writer,", \"avgdistance_ordered\": ");
+					write_float (writer,avgdistance_ordered_multikey(tuple,0));
+					write_string (writer,", \"avgdistance_pairwise\": ");
+					write_float (writer,avgdistance_pairwise_multikey(tuple,0));
+					write_string (writer,", \"maxdistance_ordered\": ");
+					write_float (writer,maxdistance_ordered_multikey(tuple,0));
+					write_string (writer,", \"maxdistance_pairwise\": ");
+					write_float (writer,maxdistance_pairwise_multikey(tuple,0));
 				}
+				write_string (writer," }");
 
-				result_string--;
-				*result_string = ']';
-				result_string++;
-				*result_string = ']';
-				result_string++;
-				*result_string = ',';
-				result_string++;
-				*result_string = '\0';
+				free (tuple->objects);
+				free (tuple->keys);
+				free (tuple);
+			}
 
+			if (spilled != NULL) {
+				delete_spill (spilled);
+			}
+		}
+		delete_queue (result);
 
-				result_string = strcat (result_string," \"mindistance_ordered\": 0.0,");
-				result_string += strlen (result_string);
+		write_string (writer,"\n\t],\n");
+		trace_phase (SERIALIZE_PHASE,phase_started);
+	}
 
-				result_string = strcat (result_string," \"mindistance_pairwise\": 0.0,");
-				result_string += strlen (result_string);
+	delete_stack (stack);
+/*
+	fifo_t *const server_tree_entries = get_entries (server_trees);
+	while (server_tree_entries->size) {
+		symbol_table_entry_t *const entry = remove_tail_of_queue (server_tree_entries);
+		delete_tree (entry->value);
+		free (entry->key);
+		free (entry);
+	}
+	delete_symbol_table (server_trees);
 
-				result_string = strcat (result_string," \"avgdistance_ordered\": 0.0,");
-				result_string += strlen (result_string);
+	pthread_rwlock_destroy (&server_lock);
+*/
+	if (writer != NULL || buffer != NULL) {
+		if (*message) {
+			char *const notes = strdup (message);
+			sprintf (message,"Successful operation. %s",notes);
+			free (notes);
+		}else{
+			strcpy (message,"Successful operation.");
+		}
+		if (writer == output && writer != NULL) {
+			tap_writer (output,NULL,NULL);
+			buffer = strdup ("");
+		}else if (writer != NULL) {
+			buffer = delete_writer (writer);
+		}else{
+			send_response (output,buffer,strlen(buffer),response);
+			if (output != NULL) {
+				*buffer = '\0';
+			}
+		}
+		store_response (key,response,message);
+	}else{
+		strcpy (message,"Syntax error.");
+		delete_response (response);
+	}
+	free (key);
+	return buffer;
+}
 
-				result_string = strcat (result_string," \"avgdistance_pairwise\": 0.0,");
-				result_string += strlen (result_string);
+char* qprocessor (char command[], char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter, writer_t *const output, format_t const format) {
+	query_context_t context;
+	uint64_t const started = begin_trace (&context);
+	char *const result = process_query (command,folder,message,output,format);
+	end_trace (&context,command,started,io_blocks_counter,io_mb_counter);
+	return result;
+}
 
-				result_string = strcat (result_string," \"maxdistance_ordered\": 0.0,");
-				result_string += strlen (result_string);
+/**
+ * Disposes of the results of an analyzed command, returning how many there were.
+ */
+static
+uint64_t discard_results (fifo_t *const result, spill_t *const spilled, boolean const is_single_subquery) {
+	uint64_t rows = 0;
+	if (is_single_subquery) {
+		for (; result->size; ++rows) {
+			data_pair_t *const pair = remove_tail_of_queue (result);
+			free (pair->key);
+			free (pair);
+		}
+	}else{
+		for (multidata_container_t* tuple; (tuple = next_join_result (result,spilled)) != NULL; ++rows) {
+			free (tuple->objects);
+			free (tuple->keys);
+			free (tuple);
+		}
+		if (spilled != NULL) {
+			delete_spill (spilled);
+		}
+	}
+	return rows;
+}
 
-				result_string = strcat (result_string," \"maxdistance_pairwise\": 0.0");
-				result_string += strlen (result_string);
+/**
+ * Appends the rows of a report to those of another, if any.
+ */
+static
+char* append_rows (char *const rows, char *const more) {
+	if (rows == NULL) {
+		return more;
+	}
+	char *const appended = (char *const) realloc (rows,sizeof(char)*(strlen(rows)+strlen(more)+1));
+	if (appended == NULL) {
+		LOG (fatal,"[append_rows()] Unable to allocate additional memory for the rows of a report...\n");
+		exit (EXIT_FAILURE);
+	}
+	strcat (appended,more);
+	free (more);
+	return appended;
+}
 
-				result_string = strcat (result_string," },\n");
-				result_string += strlen (result_string);
+/**
+ * Encodes the tuples of a result in binary blocks followed by
+ * an empty block, while disposing of them along the way; blocks
+ * without keys are encoded as if the tuples had no dimensions.
+ */
+static
+void encode_results (writer_t *const writer, format_t const format, fifo_t *const result, spill_t *const spilled, boolean const is_single_subquery, boolean const with_keys) {
+	uint32_t rows = 0;
+	uint32_t cardinality = 0;
+	uint32_t dimensions = 0;
+	object_t* objects = NULL;
+	index_t* keys = NULL;
+
+	while (!is_single_subquery || result->size) {
+		data_pair_t* pair = NULL;
+		multidata_container_t* tuple = NULL;
+		if (is_single_subquery) {
+			pair = remove_tail_of_queue (result);
+		}else if ((tuple = next_join_result (result,spilled)) == NULL) {
+			break;
+		}
 
+		if (objects == NULL) {
+			cardinality = pair != NULL ? 1 : tuple->cardinality;
+			dimensions = !with_keys ? 0 : pair != NULL ? pair->dimensions : tuple->dimensions;
+			objects = (object_t*) malloc (sizeof(object_t)*BINARY_BLOCK_ROWS*cardinality);
+			keys = (index_t*) malloc (sizeof(index_t)*BINARY_BLOCK_ROWS*cardinality*dimensions);
+			if (objects == NULL || (keys == NULL && dimensions)) {
+				LOG (fatal,"[encode_results()] Unable to allocate memory for binary block...\n");
+				exit (EXIT_FAILURE);
+			}
+		}
 
-				free (tuple->key);
-				free (tuple);
+		if (pair != NULL) {
+			objects [rows] = pair->object;
+			if (dimensions) {
+				memcpy (keys+rows*dimensions,pair->key,sizeof(index_t)*dimensions);
 			}
+			free (pair->key);
+			free (pair);
 		}else{
-			LOG (info,"[qprocessor()] Processed join returned %lu tuples. \n",result->size);
-			while (result->size) {
-				multidata_container_t *const tuple = remove_tail_of_queue (result);
+			memcpy (objects+rows*cardinality,tuple->objects,sizeof(object_t)*cardinality);
+			if (dimensions) {
+				memcpy (keys+rows*cardinality*dimensions,tuple->keys,sizeof(index_t)*cardinality*dimensions);
+			}
+			free (tuple->objects);
+			free (tuple->keys);
+			free (tuple);
+		}
 
-				if (guard - result_string < BUFSIZ) {
-					uint64_t resultlen = strlen(buffer);
-					if (fd) {
-						if (write (fd,buffer,resultlen*sizeof(char)) < resultlen*sizeof(char)) {
-							LOG (error,"[qprocessor()] Error while sending data using file-descriptor %u.\n",fd);
-						}
-						bzero (buffer,sizeof(buffer));
-						result_string = buffer;
-						*result_string = '\0';
-					}else{
-						char *const old_buffer = buffer;
-						buffer_size <<= 1;
-						buffer = (char *const) malloc (sizeof(char)*buffer_size);
-						guard = buffer + buffer_size;
+		if (++rows == BINARY_BLOCK_ROWS) {
+			write_block (writer,format,rows,cardinality,dimensions,objects,keys);
+			rows = 0;
+		}
+	}
+	if (rows) {
+		write_block (writer,format,rows,cardinality,dimensions,objects,keys);
+	}
+	write_le32 (writer,BINARY_END_OF_RESULTS);
 
-						strcpy (buffer,old_buffer);
-						free (old_buffer);
+	free (objects);
+	free (keys);
+	if (spilled != NULL) {
+		delete_spill (spilled);
+	}
+}
 
-						result_string = buffer + resultlen;
-					}
-				}
+/**
+ * Copies the data of a valid cached response to a command and
+ * writes them to the output, if any. Responses are valid as long
+ * as the heapfiles they were computed from are not modified since.
+ */
+static
+char* lookup_response (char const key[], char message[], writer_t *const output) {
+	pthread_mutex_lock (&responses_lock);
+	cached_response_t *const response = server_responses != NULL ? get_cached (server_responses,key) : NULL;
+	if (response == NULL) {
+		pthread_mutex_unlock (&responses_lock);
+		return NULL;
+	}
 
-				sprintf (result_string,"\t{ \"rid\": %lu, ",rid++);
-				result_string += strlen(result_string);
+	pthread_rwlock_rdlock (&server_lock);
+	boolean is_valid = server_trees != NULL;
+	for (uint32_t i=0; is_valid && i<response->heapfiles_number; ++i) {
+		tree_t *const tree = get (server_trees,(key__t)response->heapfiles[i]);
+		is_valid = tree != NULL && __atomic_load_n (&tree->version,__ATOMIC_SEQ_CST) == response->versions[i];
+	}
+	pthread_rwlock_unlock (&server_lock);
 
-				result_string = strcat (result_string,"\"objects\": [");
-				result_string += strlen(result_string);
-				for (uint32_t i=0; i<tuple->cardinality; ++i) {
-					sprintf (result_string,"%lu,",tuple->objects[i]);
-					result_string += strlen(result_string);
-				}
+	if (!is_valid) {
+		unset_cached (server_responses,key);
+		pthread_mutex_unlock (&responses_lock);
+		return NULL;
+	}
 
-				result_string--;
-				*result_string = '\0';
-				result_string = strcat (result_string,"], \"keys\": [");
-				result_string += strlen (result_string);
+	char *const data = (char *const) malloc (sizeof(char)*(response->length+1));
+	if (data == NULL) {
+		LOG (fatal,"[lookup_response()] Unable to allocate memory for cached response...\n");
+		exit (EXIT_FAILURE);
+	}
+	memcpy (data,response->data,response->length);
+	data [response->length] = '\0';
+	strcpy (message,response->message);
+	pthread_mutex_unlock (&responses_lock);
+
+	if (output != NULL) {
+		write_bytes (output,data,response->length);
+		*data = '\0';
+	}
+	return data;
+}
 
-				for (uint32_t i=0; i<tuple->cardinality; ++i) {
-					*result_string = '[';
-					result_string++;
+/**
+ * Notes the versions of the heapfiles a command refers to before it
+ * is evaluated, so that its response is only cached for these. Those
+ * are the components of the command path that are not thresholds.
+ */
+static
+cached_response_t* new_response (char const command[], char const folder[]) {
+	cached_response_t *const response = (cached_response_t *const) malloc (sizeof(cached_response_t));
+	if (response == NULL) {
+		LOG (fatal,"[new_response()] Unable to allocate memory for new response...\n");
+		exit (EXIT_FAILURE);
+	}
+	response->data = NULL;
+	response->length = 0;
+	response->message = NULL;
+	response->heapfiles = NULL;
+	response->versions = NULL;
+	response->heapfiles_number = 0;
+	response->is_cacheable = CACHE_LIMIT > 0 && strstr (command,"sample=") == NULL
+				&& strncmp (command,"/prepare/",9) && strncmp (command,"/execute/",9);
+
+	for (char const* c = command; response->is_cacheable && *c != '\0'; ++c) {
+		if (*c != '/' && *c != '%') continue;
+
+		uint64_t const length = strcspn (c+1,"/%?;");
+		if (!length || !(isalpha (c[1]) || c[1] == '_') || memchr (c+1,'=',length) != NULL) continue;
+
+		char *const filepath = (char *const) malloc (sizeof(char)*(strlen(folder)+length+2));
+		strcpy (filepath,folder);
+		if (folder[strlen(folder)-1]!='/') {
+			strcat (filepath,"/");
+		}
+		strncat (filepath,c+1,length);
 
-					for (uint32_t j=0; j<tuple->dimensions; ++j) {
-						sprintf (result_string,"%12lf,",(double)tuple->keys[i*tuple->dimensions+j]);
-						result_string += strlen(result_string);
-					}
+		tree_t *const tree = get_rtree (filepath);
+		if (tree == NULL) {
+			response->is_cacheable = false;
+			free (filepath);
+			break;
+		}
 
-					result_string--;
-					*result_string = ']';
-					result_string++;
-					*result_string = ',';
-					result_string++;
-				}
+		response->heapfiles = (char**) realloc (response->heapfiles,sizeof(char*)*(response->heapfiles_number+1));
+		response->versions = (uint64_t*) realloc (response->versions,sizeof(uint64_t)*(response->heapfiles_number+1));
+		response->heapfiles [response->heapfiles_number] = filepath;
+		response->versions [response->heapfiles_number] = __atomic_load_n (&tree->version,__ATOMIC_SEQ_CST);
+		response->heapfiles_number++;
+		c += length;
+	}
+	return response;
+}
 
-				result_string--;
-				*result_string = '\0';
-				result_string = strcat (result_string,"],");
-				result_string += strlen (result_string);
+/**
+ * Writes data to the output, if any, while also
+ * recording them in the response to be cached.
+ */
+static
+void send_response (writer_t *const output, char const data[], uint64_t const length, cached_response_t *const response) {
+	if (output != NULL) {
+		write_bytes (output,data,length);
+	}
+	record_response (response,data,length);
+}
 
+/**
+ * Records data sent in the response to be cached, unless these
+ * would not fit in the cache anyway.
+ */
+static
+void record_response (void *const args, char const*const data, uint64_t const length) {
+	cached_response_t *const response = (cached_response_t *const) args;
+	if (response->is_cacheable && response->length + length > CACHE_LIMIT) {
+		response->is_cacheable = false;
+		free (response->data);
+		response->data = NULL;
+		response->length = 0;
+	}
+	if (response->is_cacheable) {
+		response->data = (char*) realloc (response->data,sizeof(char)*(response->length+length));
+		if (response->data == NULL) {
+			LOG (fatal,"[record_response()] Unable to allocate memory for cached response...\n");
+			exit (EXIT_FAILURE);
+		}
+		memcpy (response->data+response->length,data,length);
+		response->length += length;
+	}
+}
 
-				result_string = strcat (result_string," \"mindistance_ordered\": ");
-				result_string += strlen (result_string);
-				sprintf (result_string,"%8lf,",mindistance_ordered_multikey(tuple,0));
-				result_string += strlen (result_string);
+static
+void store_response (char const key[], cached_response_t *const response, char const message[]) {
+	if (!response->is_cacheable) {
+		delete_response (response);
+		return;
+	}
+	response->message = strdup (message);
 
-				result_string = strcat (result_string," \"mindistance_pairwise\": ");
-				result_string += strlen (result_string);
-				sprintf (result_string,"%8lf,",mindistance_pairwise_multikey(tuple,0));
-				result_string += strlen (result_string);
+	uint64_t size = sizeof(cached_response_t) + strlen(key) + response->length + strlen(message);
+	for (uint32_t i=0; i<response->heapfiles_number; ++i) {
+		size += strlen (response->heapfiles[i]) + sizeof(char*) + sizeof(uint64_t);
+	}
 
-				result_string = strcat (result_string," \"avgdistance_ordered\": ");
-				result_string += strlen (result_string);
-				sprintf (result_string,"%8lf,",avgdistance_ordered_multikey(tuple,0));
-				result_string += strlen (result_string);
+	pthread_mutex_lock (&responses_lock);
+	if (server_responses == NULL) {
+		server_responses = new_cache (CACHE_LIMIT,&delete_response);
+	}
+	if (!set_cached (server_responses,key,response,size)) {
+		delete_response (response);
+	}
+	pthread_mutex_unlock (&responses_lock);
+}
 
-				result_string = strcat (result_string," \"avgdistance_pairwise\": ");
-				result_string += strlen (result_string);
-				sprintf (result_string,"%8lf,",avgdistance_pairwise_multikey(tuple,0));
-				result_string += strlen (result_string);
+static
+void delete_response (value_t const value) {
+	cached_response_t *const response = (cached_response_t *const) value;
+	for (uint32_t i=0; i<response->heapfiles_number; ++i) {
+		free (response->heapfiles[i]);
+	}
+	free (response->heapfiles);
+	free (response->versions);
+	free (response->message);
+	free (response->data);
+	free (response);
+}
 
-				result_string = strcat (result_string," \"maxdistance_ordered\": ");
-				result_string += strlen (result_string);
-				sprintf (result_string,"%8lf,",maxdistance_ordered_multikey(tuple,0));
-				result_string += strlen (result_string);
+static
+boolean refers_to_heapfile (value_t const value, void const*const heapfile) {
+	cached_response_t const*const response = (cached_response_t const*const) value;
+	for (uint32_t i=0; i<response->heapfiles_number; ++i) {
+		if (!strcmp (response->heapfiles[i],(char const*const)heapfile)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Drops the cached responses computed from a heapfile once it is modified.
+ */
+static
+void invalidate_responses (char const heapfile[]) {
+	pthread_mutex_lock (&responses_lock);
+	if (server_responses != NULL) {
+		purge_cache (server_responses,&refers_to_heapfile,heapfile);
+	}
+	pthread_mutex_unlock (&responses_lock);
+}
 
-				result_string = strcat (result_string," \"maxdistance_pairwise\": ");
-				result_string += strlen (result_string);
-				sprintf (result_string,"%8lf",maxdistance_pairwise_multikey(tuple,0));
-				result_string += strlen (result_string);
+/**
+ * Parses a command into a statement that can be processed many times.
+ */
+static
+statement_t* parse_statement (char const command[], char message[]) {
+	double varray [BUFSIZ];
+	lifo_t *const stack = new_stack();
+	lifo_t *const strings = new_stack();
+	lifo_t *const placeholders = new_stack();
 
-				result_string = strcat (result_string," },\n");
-				result_string += strlen (result_string);
+	yyscan_t scanner;
+	QL_lex_init (&scanner);
+	YY_BUFFER_STATE command_buffer = QL__scan_string (command,scanner);
+	int const parser_rval = QL_parse (scanner,stack,varray,strings,placeholders);
+	QL__delete_buffer (command_buffer,scanner);
+	QL_lex_destroy (scanner);
 
+	statement_t* statement = NULL;
+	if (parser_rval) {
+		LOG (error,"[parse_statement()] Syntax error; unable to parse query: '%s'\n",command);
+		sprintf (message+strlen(message),"Syntax error; unable to parse query: %s.",last_parse_error ());
+	}else{
+		statement = new_statement (command,stack,varray,strings,placeholders);
+	}
 
-				free (tuple->objects);
-				free (tuple->keys);
-				free (tuple);
-			}
+	while (strings->size) {
+		uint64_t const position = (uint64_t) remove_from_stack (strings);
+		if (position < stack->size) {
+			free (stack->buffer[position]);
+		}
+	}
+	delete_stack (placeholders);
+	delete_stack (strings);
+	delete_stack (stack);
+	return statement;
+}
+
+static
+void dispose_statement (value_t const statement) {
+	delete_statement ((statement_t *const) statement);
+}
+
+/**
+ * Pushes the tokens of a command onto the stack to be processed. The
+ * command is only parsed if it was not recently, unless it executes a
+ * prepared query with the arguments following its name.
+ */
+static
+boolean load_statement (char const command[], char message[], lifo_t *const stack, double varray[], boolean *const is_single_subquery) {
+	if (!strncmp (command,"/execute/",9)) {
+		char const* c = command + 9;
+		uint64_t const length = strcspn (c,"/;");
+		char name [length+1];
+		strncpy (name,c,length);
+		name [length] = '\0';
+		c += length;
+
+		double arguments [BUFSIZ>>3];
+		uint32_t arguments_number = 0;
+		if (*c == '/') {
+			do {
+				char* end = NULL;
+				arguments [arguments_number++] = strtod (c+1,&end);
+				if (end == c+1) break;
+				c = end;
+			}while (*c == ',' && arguments_number < (BUFSIZ>>3));
+		}
+		if (*c != ';' && *c != '\0') {
+			LOG (error,"[load_statement()] Unable to parse the arguments of prepared query '%s'.\n",name);
+			sprintf (message,"Unable to parse the arguments of prepared query '%s'.",name);
+			return false;
 		}
 
-		result_string -= 2;
-		*result_string = '\0';
-		result_string = strcat (result_string,"\n\t],\n");
-		result_string += strlen (result_string);
-		*result_string = '\0';
+		pthread_mutex_lock (&statements_lock);
+		statement_t const*const statement = server_statements != NULL ? get (server_statements,(key__t)name) : NULL;
+		if (statement == NULL) {
+			pthread_mutex_unlock (&statements_lock);
+			LOG (error,"[load_statement()] Unknown prepared query '%s'.\n",name);
+			sprintf (message,"Unknown prepared query '%s'.",name);
+			return false;
+		}
+		if (statement->arguments_number != arguments_number) {
+			pthread_mutex_unlock (&statements_lock);
+			LOG (error,"[load_statement()] Prepared query '%s' takes %u arguments.\n",name,statement->arguments_number);
+			sprintf (message,"Prepared query '%s' takes %u arguments.",name,statement->arguments_number);
+			return false;
+		}
+		instantiate_statement (statement,arguments,stack,varray);
+		*is_single_subquery = statement->is_single_subquery;
+		pthread_mutex_unlock (&statements_lock);
+		return true;
+	}
 
-		LOG (info,"[qprocessor()] RESPONSE:\n%s",buffer);
+	pthread_mutex_lock (&statements_lock);
+	statement_t* statement = parsed_commands != NULL ? get_cached (parsed_commands,command) : NULL;
+	if (statement != NULL) {
+		instantiate_statement (statement,NULL,stack,varray);
+		*is_single_subquery = statement->is_single_subquery;
+		pthread_mutex_unlock (&statements_lock);
+		return true;
+	}
+	pthread_mutex_unlock (&statements_lock);
+
+	statement = parse_statement (command,message);
+	if (statement == NULL) {
+		return false;
+	}else if (statement->placeholders_number) {
+		LOG (error,"[load_statement()] Placeholders are only allowed in prepared queries.\n");
+		strcpy (message,"Placeholders are only allowed in prepared queries.");
+		delete_statement (statement);
+		return false;
 	}
+	instantiate_statement (statement,NULL,stack,varray);
+	*is_single_subquery = statement->is_single_subquery;
 
-	delete_stack (stack);
-/*
-	fifo_t *const server_tree_entries = get_entries (server_trees);
-	while (server_tree_entries->size) {
-		symbol_table_entry_t *const entry = remove_tail_of_queue (server_tree_entries);
-		delete_tree (entry->value);
-		free (entry->key);
-		free (entry);
+	pthread_mutex_lock (&statements_lock);
+	if (parsed_commands == NULL) {
+		parsed_commands = new_cache (STATEMENTS_CACHE_SIZE,&dispose_statement);
 	}
-	delete_symbol_table (server_trees);
+	if (!set_cached (parsed_commands,command,statement,statement_size (statement))) {
+		delete_statement (statement);
+	}
+	pthread_mutex_unlock (&statements_lock);
+	return true;
+}
 
-	pthread_rwlock_destroy (&server_lock);
-*/
-	if (buffer != NULL) {
-		strcpy (message,"Successful operation.");
-		if (fd) {
-			uint64_t resultlen = strlen(buffer);
-			if (write (fd,buffer,resultlen*sizeof(char)) < resultlen*sizeof(char)) {
-				LOG (error,"[qprocessor()] Error while sending data using file-descriptor %u.\n",fd);
-			}
-			bzero (buffer,sizeof(buffer));
-			*buffer = '\0';
-		}
-	}else{
-		strcpy (message,"Syntax error.");
+/**
+ * Keeps a query under a name for it to be executed any number of times
+ * with different arguments for its placeholders, i.e. '/prepare/<name>'
+ * followed by the query, and then '/execute/<name>/<argument>,...'.
+ * Placeholders, i.e. '_1', '_2' and so on, stand for values of keys
+ * only, the number of neighbors of a bound included; thresholds, the
+ * number of pairs of a join and options are given literally.
+ */
+static
+char* prepare_statement (char const command[], char message[]) {
+	uint64_t const length = strcspn (command,"/;");
+	if (!length || command[length] != '/') {
+		LOG (error,"[prepare_statement()] Prepared queries are to be named.\n");
+		strcpy (message,"Prepared queries are to be named.");
+		return NULL;
+	}
+
+	statement_t *const statement = parse_statement (command+length,message);
+	if (statement == NULL) {
+		return NULL;
 	}
+
+	char *const name = strndup (command,length);
+	uint32_t const arguments_number = statement->arguments_number;
+
+	pthread_mutex_lock (&statements_lock);
+	if (server_statements == NULL) {
+		server_statements = new_symbol_table (NULL,&strcompare);
+	}
+	statement_t *const previous = get (server_statements,(key__t)name);
+	set (server_statements,(key__t)name,statement);
+	pthread_mutex_unlock (&statements_lock);
+
+	if (previous != NULL) {
+		delete_statement (previous);
+		free (name);
+	}
+
+	char *const buffer = (char *const) malloc (sizeof(char)*(length+BUFSIZ));
+	if (buffer == NULL) {
+		LOG (fatal,"[prepare_statement()] Unable to allocate memory for response...\n");
+		exit (EXIT_FAILURE);
+	}
+	sprintf (buffer,"[ \n\t{ \"statement\": \"%.*s\", \"arguments\": %u }\n\t],\n",(int)length,command,arguments_number);
 	return buffer;
 }
 
@@ -454,8 +1134,9 @@ void shandler (int signal_number) {
 
 
 static
-fifo_t* process_command (lifo_t *const stack, char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter) {
+fifo_t* process_command (lifo_t *const stack, char const folder[], char message[], spill_t **const spilled, boolean const explain, boolean const analyze, char **const reported, uint32_t *const fields) {
 	signal(SIGFPE,shandler);
+	uint64_t phase_started = wall_clock_micros();
 	if (stack->size) {
 		if (remove_from_stack (stack) != (void*)';') {
 			LOG (error,"[process_command()] Syntax error: Command was not ended properly.\n");
@@ -465,181 +1146,331 @@ fifo_t* process_command (lifo_t *const stack, char const folder[], char message[
 		}
 
 		boolean is_closest_pairs_operation = false;
-		if (remove_from_stack (stack) != NULL) {
+		boolean is_knn_join_operation = false;
+		void *const join_type = remove_from_stack (stack);
+		if (join_type == (void*)'k') {
+			is_knn_join_operation = true;
+		}else if (join_type != NULL) {
 			is_closest_pairs_operation = true;
 		}
 
 		double threshold = *((double*)remove_from_stack (stack));
 		LOG (debug,"[process_command()] Threshold parameter is equal to %lf. \n",threshold);
 
+		double const*const approximation_parameters = remove_from_stack (stack);
+		approximation_t approximation = {
+			.epsilon = approximation_parameters[0],
+			.max_pages = approximation_parameters[1],
+			.bound = 1
+		};
+		boolean const is_approximate = approximation.epsilon > 0 || approximation.max_pages;
+		uint32_t const parallelism = approximation_parameters[2] ? approximation_parameters[2] : PARALLELISM;
+		uint64_t const memory_limit = approximation_parameters[3] ? approximation_parameters[3]*(1<<20) : MEMORY_LIMIT;
+		*fields = approximation_parameters[4];
+
 
 		/**
-		 * Compute sub-queries.
+		 * Parse sub-queries and plan their evaluation.
 		 */
-		lifo_t *const subq_trees = new_stack();
+		lifo_t *const parsed = new_stack();
 		while (stack->size) {
-			tree_t *subq_tree = NULL;
-			uint64_t sub_io_blocks_counter = 0;
+			subquery_t* subquery = NULL;
 			if (peek_at_stack (stack) == (void*)'/') {
-				subq_tree = process_subquery (stack,folder,message,&sub_io_blocks_counter);
+				subquery = parse_subquery (stack,folder,message);
 			}else if (peek_at_stack (stack) == (void*)'%') {
-				subq_tree = process_reverse_NN_query (stack,folder,message,&sub_io_blocks_counter,io_mb_counter);
+				tree_t *const rnn_tree = process_reverse_NN_query (stack,folder,message);
+				subquery = rnn_tree != NULL ? new_subquery (rnn_tree) : NULL;
 			}else{
 				break;
 			}
 
-			if (subq_tree != NULL) {
-				*io_mb_counter += (sub_io_blocks_counter * subq_tree->page_size)/((double)(1<<20));
-				*io_blocks_counter += sub_io_blocks_counter;
+			if (subquery == NULL) {
+				while (parsed->size) {
+					delete_subquery (remove_from_stack (parsed));
+				}
+				delete_stack (parsed);
+				return NULL;
+			}
+			insert_into_stack (parsed,subquery);
+		}
 
-				flush_tree (subq_tree);
-				insert_into_stack (subq_trees,subq_tree);
-				LOG (info,"[process_command()] Processed subquery returned %lu tuples. \n",subq_tree->indexed_records);
+		uint32_t const cardinality = parsed->size;
+		if (!cardinality || (is_knn_join_operation && cardinality != 2)) {
+			if (is_knn_join_operation) {
+				LOG (error,"[process_command()] A kNN join is defined over exactly two subqueries.\n");
+				strcpy (message,"A kNN join is defined over exactly two subqueries.");
 			}else{
-				delete_stack (subq_trees);
-				return NULL;
+				LOG (error,"[process_command()] Syntax error: Command does not contain any subqueries.\n");
+				strcpy (message,"Syntax error: Command does not contain any subqueries.");
+			}
+			while (parsed->size) {
+				delete_subquery (remove_from_stack (parsed));
+			}
+			delete_stack (parsed);
+			return NULL;
+		}
+
+		subquery_t* operands [cardinality];
+		boolean is_count_operation = false;
+		for (uint32_t i=0; i<cardinality; ++i) {
+			operands[i] = remove_from_stack (parsed);
+			is_count_operation |= operands[i]->is_count;
+		}
+		delete_stack (parsed);
+
+		if (is_count_operation && cardinality > 1) {
+			LOG (error,"[process_command()] Only the results of a single subquery can be counted.\n");
+			strcpy (message,"Only the results of a single subquery can be counted.");
+			for (uint32_t i=0; i<cardinality; ++i) {
+				delete_subquery (operands[i]);
 			}
+			return NULL;
+		}
+
+		uint64_t const started = wall_clock_micros();
+		operator_t const join_operator = is_closest_pairs_operation ? CLOSEST_PAIRS_OPERATOR : DISTANCE_JOIN_OPERATOR;
+		plan_t *const plan = plan_command (operands,cardinality,is_closest_pairs_operation,is_knn_join_operation,
+						threshold,is_approximate,memory_limit);
+
+		if (explain) {
+			*reported = explain_plan (plan);
+		}
+		if (explain && !analyze) {
+			for (uint32_t i=0; i<cardinality; ++i) {
+				delete_subquery (operands[i]);
+			}
+			delete_plan (plan);
+			return new_queue();
+		}
+		phase_started = trace_phase (PARSE_PHASE,phase_started);
+
+		if (plan->method == NO_JOIN && is_count_operation) {
+			delete_plan (plan);
+			*reported = append_rows (*reported,count_subquery (*operands,message));
+			trace_phase (SUBQUERY_PHASE,phase_started);
+			record_latency (COUNT_OPERATOR,wall_clock_micros()-started);
+			return new_queue();
+		}else if (plan->method == NO_JOIN) {
+			delete_plan (plan);
+			(*operands)->with_keys = (*fields & KEYS_FIELD) != 0;
+			operator_t const operator = subquery_operator (*operands);
+			fifo_t *const result = evaluate_subquery (*operands,message);
+			trace_phase (SUBQUERY_PHASE,phase_started);
+			record_latency (operator,wall_clock_micros()-started);
+			LOG (info,"[process_command()] Processed subquery returned %lu tuples. \n",result->size);
+			return result;
 		}
 
 
 		/**
 		 * Join the results from all subqueries.
 		 */
-		fifo_t *result = NULL;
-		if (subq_trees->size > 1) {
-			boolean closest = true;
-			boolean use_avg = false;
-			boolean pairwise = false;
-
-			if (threshold < 0) {
-				threshold = -threshold;
-				closest = false;
+		fifo_t *result = NULL;
+		if (plan->method == KNN_JOIN) {
+			delete_plan (plan);
+
+			tree_t *const outer = materialize_subquery (operands[0],message);
+			tree_t *const inner = materialize_subquery (operands[1],message);
+			phase_started = trace_phase (SUBQUERY_PHASE,phase_started);
+
+			LOG (info,"[process_command()] Executing %u-NN join of '%s' with '%s'...\n",(uint32_t)threshold,outer->filename,inner->filename);
+			result = knn_join (outer,inner,threshold,parallelism);
+			trace_phase (JOIN_PHASE,phase_started);
+
+			release_rtree (outer);
+			if (inner != outer) {
+				release_rtree (inner);
+			}
+
+			record_latency (KNN_JOIN_OPERATOR,wall_clock_micros()-started);
+			return result;
+		}
+
+		boolean closest = true;
+		boolean use_avg = false;
+		boolean pairwise = false;
+
+		if (threshold < 0) {
+			threshold = -threshold;
+			closest = false;
+		}
+
+		/**
+		 * Probe the inner operand with each result of the outer one,
+		 * reporting the combinations in the order of the subqueries.
+		 */
+		if (plan->method == PROBE_JOIN || plan->method == NESTED_LOOP_KNN_JOIN) {
+			subquery_t *const outer = operands[plan->outer];
+			subquery_t *const inner = operands[1-plan->outer];
+
+			boolean const outer_first = !plan->outer;
+			boolean const is_probe = plan->method == PROBE_JOIN;
+			boolean const materialize_inner = inner->materialize;
+			uint32_t const dimensions = MIN(outer->tree->dimensions,inner->tree->dimensions);
+			delete_plan (plan);
+
+			LOG (info,"[process_command()] Probing '%s' with the results from '%s'...\n",inner->tree->filename,outer->tree->filename);
+
+			uint32_t const inner_dimensions = inner->tree->dimensions;
+			index_t lo [inner_dimensions];
+			index_t hi [inner_dimensions];
+			for (uint32_t j=0; j<inner_dimensions; ++j) {
+				lo[j] = materialize_inner ? -INDEX_T_MAX : inner->from[j];
+				hi[j] = materialize_inner ? INDEX_T_MAX : inner->to[j];
+			}
+
+			tree_t *const inner_tree = materialize_inner ? materialize_subquery (inner,message) : inner->tree;
+			fifo_t *const outer_results = evaluate_subquery (outer,message);
+			phase_started = trace_phase (SUBQUERY_PHASE,phase_started);
+
+			if (is_probe) {
+				*spilled = probe_distance_join (outer_results,outer_first,inner_tree,lo,hi,threshold,dimensions,memory_limit);
+				result = new_queue();
+			}else{
+				result = probe_closest_pairs (outer_results,outer_first,inner_tree,lo,hi,threshold,dimensions);
+			}
+
+			if (materialize_inner) {
+				release_rtree (inner_tree);
+			}else{
+				delete_subquery (inner);
+			}
+
+			trace_phase (JOIN_PHASE,phase_started);
+			record_latency (join_operator,wall_clock_micros()-started);
+			return result;
+		}
+
+		/**
+		 * Otherwise, traverse the trees of the subqueries synchronously
+		 * in groups split once the exact sizes of their results are known.
+		 */
+		lifo_t *const subq_trees = new_stack();
+		uint64_t operand_sizes [cardinality];
+		for (uint32_t i=cardinality; i>0; --i) {
+			tree_t *const subq_tree = materialize_subquery (operands[i-1],message);
+			operand_sizes[i-1] = subq_tree->indexed_records * (subq_tree->dimensions*sizeof(index_t)+sizeof(object_t));
+			insert_into_stack (subq_trees,subq_tree);
+			LOG (info,"[process_command()] Processed subquery returned %lu tuples. \n",subq_tree->indexed_records);
+		}
+		segment_plan (plan,operand_sizes,memory_limit);
+
+		lifo_t* partial_results = new_stack();
+		boolean has_tail = false;
+		uint32_t group = 0;
+		do{
+			lifo_t *const to_be_joined = new_stack();
+			while (subq_trees->size && to_be_joined->size < plan->groups[group]) {
+				insert_into_stack (to_be_joined,remove_from_stack (subq_trees));
 			}
+			++group;
 
+			LOG (info,"[process_command()] Executing join %lu...\n",partial_results->size);
 
-			lifo_t* partial_results = new_stack();
-			boolean has_tail = false;
-			do{
-				uint64_t cartesian_size = 0;
-				lifo_t *const to_be_joined = new_stack();
-
-				while (subq_trees->size && 
-					(to_be_joined->size < 2 
-					|| MEMORY_BOUND >= cartesian_size 
-						+ ((tree_t *const)peek_at_stack (subq_trees))->indexed_records 
-						* (((tree_t *const)peek_at_stack (subq_trees))->dimensions)
-						* sizeof(index_t)+sizeof(object_t))) {
+			approximation_t partial_approximation = approximation;
+			void* partial_result = NULL;
+			if (is_closest_pairs_operation) {
+				partial_result = parallel_x_tuples (threshold,closest,use_avg,pairwise,to_be_joined,is_approximate?&partial_approximation:NULL,parallelism);
+			}else{
+				partial_result = parallel_distance_join (threshold,closest,pairwise,use_avg,to_be_joined,is_approximate?&partial_approximation:NULL,memory_limit,parallelism);
+			}
 
-					tree_t *const top = remove_from_stack (subq_trees);
-					cartesian_size += top->dimensions * top->indexed_records;
-					insert_into_stack (to_be_joined,top);
+			if (is_approximate) {
+				if (!partial_results->size) {
+					approximation.bound = partial_approximation.bound;
+				}else if (is_closest_pairs_operation || !closest) {
+					approximation.bound = MAX(approximation.bound,partial_approximation.bound);
+				}else{
+					approximation.bound = MIN(approximation.bound,partial_approximation.bound);
 				}
+			}
 
-				LOG (info,"[process_command()] Executing join %lu...\n",partial_results->size);
-
-				fifo_t *const partial_result = is_closest_pairs_operation
-					? x_tuples (threshold,closest,use_avg,pairwise,to_be_joined)
-					: distance_join (threshold,closest,pairwise,use_avg,to_be_joined);
+			while (to_be_joined->size) {
+				tree_t *const joined_tree = remove_from_stack(to_be_joined);
 
-				while (to_be_joined->size) {
-					tree_t *const joined_tree = remove_from_stack(to_be_joined);
+				if (joined_tree != NULL) {
+					release_rtree (joined_tree);
+				}else{
+					LOG (error,"[process_command()] Error while finalizing join operands.\n");
+					strcat (message,"Error while finalizing join operands.");
+				}
+			}
+			delete_stack (to_be_joined);
 
-					if (joined_tree != NULL) {
-						pthread_rwlock_wrlock (&joined_tree->tree_lock);
-						*io_blocks_counter += joined_tree->io_counter;
-						*io_mb_counter += (joined_tree->io_counter * joined_tree->page_size)/((double)(1<<20));
-						joined_tree->io_counter = 0;
-						pthread_rwlock_unlock (&joined_tree->tree_lock);
+			insert_into_stack (partial_results,partial_result);
 
-						if (get_rtree(joined_tree->filename)==NULL) {
-							delete_tree (joined_tree);
-						}
-					}else{
-						LOG (error,"[process_command()] Error while finalizing join operands.\n");
-						strcat (message,"Error while finalizing join operands.");
-					}
+			if (subq_trees->size == 1) {
+				tree_t *const remaining_tree = remove_from_stack(subq_trees);
+				index_t from [remaining_tree->dimensions];
+				index_t to [remaining_tree->dimensions];
+				for (uint32_t i=0; i<remaining_tree->dimensions; ++i) {
+					from[i] = -INDEX_T_MAX;
+					to[i] = INDEX_T_MAX;
 				}
-				delete_stack (to_be_joined);
+				insert_into_stack (partial_results,range(remaining_tree,from,to,remaining_tree->dimensions));
 
-				insert_into_stack (partial_results,partial_result);
+				release_rtree (remaining_tree);
+				has_tail = true;
+			}
+		}while (subq_trees->size);
 
-				if (subq_trees->size == 1) {
-					tree_t *const remaining_tree = remove_from_stack(subq_trees);
-					index_t from [remaining_tree->dimensions];
-					index_t to [remaining_tree->dimensions];
-					for (uint32_t i=0; i<remaining_tree->dimensions; ++i) {
-						from[i] = -INDEX_T_MAX;
-						to[i] = INDEX_T_MAX;
-					}
-					insert_into_stack (partial_results,range(remaining_tree,from,to,remaining_tree->dimensions));
+		/**
+		 * Results of distance joins are handed over as spilled,
+		 * whereas those of closest-tuples joins are just k.
+		 */
+		fifo_t* top_level_list = NULL;
+		if (partial_results->size > 1) {
+			if (is_closest_pairs_operation) {
+				top_level_list = top_level_in_mem_closest_pairs (threshold,closest,pairwise,use_avg,partial_results,has_tail);
+			}else{
+				*spilled = top_level_distance_join (threshold,closest,pairwise,use_avg,partial_results,has_tail,memory_limit);
+			}
 
-					if (get_rtree(remaining_tree->filename)==NULL) {
-						delete_tree (remaining_tree);
+			for (boolean is_tail = has_tail; partial_results->size; is_tail = false) {
+				void *const partial_result = remove_from_stack (partial_results);
+				if (is_tail) {
+					while (((fifo_t *const)partial_result)->size) {
+						data_pair_t *const tuple = remove_tail_of_queue (partial_result);
+						free (tuple->key);
+						free (tuple);
 					}
-					has_tail = true;
-				}
-			}while (subq_trees->size);
-
-			fifo_t* top_level_list = NULL;
-			if (partial_results->size > 1) {
-				top_level_list = is_closest_pairs_operation
-						? top_level_in_mem_closest_pairs (threshold,closest,pairwise,use_avg,partial_results,has_tail)
-						: top_level_in_mem_distance_join (threshold,closest,pairwise,use_avg,partial_results,has_tail);
-				while (partial_results->size) {
-					fifo_t *const partial_result = remove_from_stack (partial_results);
-					while (partial_result->size) {
-						if (partial_results->size && has_tail) {
-							data_pair_t *const tuple = remove_tail_of_queue (partial_result);
-							free (tuple->key);
-							free (tuple);
-						}else{
-							multidata_container_t *const tuple = remove_tail_of_queue (partial_result);
-							free (tuple->objects);
-							free (tuple->keys);
-							free (tuple);
-						}
+					delete_queue (partial_result);
+				}else if (is_closest_pairs_operation) {
+					while (((fifo_t *const)partial_result)->size) {
+						multidata_container_t *const tuple = remove_tail_of_queue (partial_result);
+						free (tuple->objects);
+						free (tuple->keys);
+						free (tuple);
 					}
 					delete_queue (partial_result);
+				}else{
+					delete_spill (partial_result);
 				}
-			}else{
-				assert (partial_results->size);
+			}
+		}else{
+			assert (partial_results->size);
+			if (is_closest_pairs_operation) {
 				top_level_list = remove_from_stack (partial_results);
+			}else{
+				*spilled = remove_from_stack (partial_results);
 			}
-
-			delete_stack (partial_results);
-			delete_stack (subq_trees);
-
-			assert (!subq_trees->size);
-
-			return top_level_list;
 		}
 
-		assert (subq_trees->size);
-		assert (subq_trees->size == 1);
-
-		tree_t *const subq_tree = remove_from_stack (subq_trees);
-		index_t from [subq_tree->dimensions];
-		index_t to [subq_tree->dimensions];
-		for (uint32_t i=0; i<subq_tree->dimensions; ++i) {
-			from [i] = -INDEX_T_MAX;
-			to [i] = INDEX_T_MAX;
+		if (top_level_list == NULL) {
+			top_level_list = new_queue();
 		}
 
-		result = range (subq_tree,from,to,subq_tree->dimensions);
-		if (result->size != subq_tree->indexed_records) {
-			LOG (error,"[process_command()] Result-size: %lu, Tree-size: %lu \n",result->size,subq_tree->indexed_records);
-		}
-		assert (result->size == subq_tree->indexed_records);
+		delete_stack (partial_results);
+		delete_stack (subq_trees);
+		delete_plan (plan);
 
-		while (subq_trees->size) {
-			tree_t *const to_be_removed = remove_from_stack(subq_trees);
-			if (get_rtree(to_be_removed->filename)==NULL) {
-				delete_tree (to_be_removed);
-			}
+		if (is_approximate) {
+			report_approximation (message,&approximation,is_closest_pairs_operation,closest);
 		}
-		delete_stack (subq_trees);
 
-		return result;
+		trace_phase (JOIN_PHASE,phase_started);
+		record_latency (join_operator,wall_clock_micros()-started);
+		return top_level_list;
 	}else{
 		strcpy (message,"Syntax error: No query has been parsed to be processed.");
 		LOG (error,"[process_command()] Syntax error: Command has not been parsed to be processed.\n");
@@ -766,108 +1597,129 @@ fifo_t* top_level_in_mem_closest_pairs (uint32_t const k, boolean const less_tha
 }
 
 
+/**
+ * Combines the partial results of distance joins, and possibly the records
+ * of a last tree, in nested loops that rescan spilled partial results as
+ * many times as needed; the combinations are spilled in their turn too.
+ */
 static
-fifo_t* top_level_in_mem_distance_join (double const theta, boolean const less_than_theta, boolean const pairwise, boolean const use_avg, lifo_t *const partial_results, boolean const has_tail) {
+spill_t* top_level_distance_join (double const theta, boolean const less_than_theta, boolean const pairwise, boolean const use_avg, lifo_t *const partial_results, boolean const has_tail, uint64_t const memory_limit) {
+	spill_t *const results = new_spill (less_than_theta?&mincompare_multicontainers:&maxcompare_multicontainers,memory_limit);
+
 	if (less_than_theta && theta < 0) {
-		LOG (warn,"[top_level_in_mem_distance_join()] No point for negative distances in joins...\n");
-		return new_queue();
+		LOG (warn,"[top_level_distance_join()] No point for negative distances in joins...\n");
+		return results;
 	}
 
 	uint64_t const outer_cardinality = partial_results->size;
 	uint64_t inner_cardinality = 0;
 	uint32_t dimensions = UINT_MAX;
 
-	for (uint64_t i=0; i<partial_results->size; ++i) {
-		fifo_t *const partial_result = partial_results->buffer[i];
-		if (partial_result->size) {
-			if (has_tail && i == partial_results->size-1) {
-				++inner_cardinality;
-			}else{
-				inner_cardinality += ((multidata_container_t *const)partial_result->buffer[partial_result->head])->cardinality;
-				uint32_t const dimensionality_i = ((multidata_container_t *const)partial_result->buffer[partial_result->head])->dimensions;
-				if (dimensionality_i < dimensions) {
-					dimensions = dimensionality_i;
-				}
+	fifo_t *const tail = has_tail ? partial_results->buffer[outer_cardinality-1] : NULL;
+	uint64_t tail_offset = 0;
+
+	multidata_container_t const* current [outer_cardinality];
+	for (uint64_t i=0; i<outer_cardinality; ++i) {
+		if (has_tail && i == outer_cardinality-1) {
+			if (!tail->size) {
+				LOG (error,"[top_level_distance_join()] Partial result-set %lu contains no records...\n",i);
+				return results;
 			}
+			++inner_cardinality;
 		}else{
-			LOG (error,"[top_level_in_mem_distance_join()] Partial result-set %lu contains no records...\n",i);
-			return new_queue();
+			rewind_spill (partial_results->buffer[i]);
+			current[i] = scan_spill (partial_results->buffer[i]);
+			if (current[i] == NULL) {
+				LOG (error,"[top_level_distance_join()] Partial result-set %lu contains no records...\n",i);
+				return results;
+			}
+			inner_cardinality += current[i]->cardinality;
+			if (current[i]->dimensions < dimensions) {
+				dimensions = current[i]->dimensions;
+			}
 		}
 	}
 
-	priority_queue_t* data_combinations = new_priority_queue (less_than_theta?&maxcompare_multicontainers:&mincompare_multicontainers);
-
-	uint64_t offsets [outer_cardinality];
-	bzero (offsets,outer_cardinality*sizeof(uint64_t));
-
-	for (uint64_t j=0,i=0;;++j) {
-		if (offsets[i] >= ((fifo_t *const)partial_results->buffer[i])->size) {
-			offsets[i++] = 0;
-			if (i >= outer_cardinality)
-				break;
-		}else{
-			multidata_container_t *const dest_container = (multidata_container_t *const) malloc (sizeof(multidata_container_t));
-
-			dest_container->keys = (index_t*) malloc (inner_cardinality*dimensions*sizeof(index_t));
-			dest_container->objects = (object_t*) malloc (inner_cardinality*sizeof(object_t));
-			dest_container->cardinality = 0;
-			dest_container->dimensions = dimensions;
+	for (;;) {
+		multidata_container_t *const dest_container = (multidata_container_t *const) malloc (sizeof(multidata_container_t));
 
-			for (uint32_t offset=0; offset<outer_cardinality; ++offset) {
-				if (has_tail && offset == outer_cardinality - 1) {
-					data_pair_t const*const src_container = ((fifo_t *const)partial_results->buffer[offset])->buffer[offsets[offset]];
-					dest_container->objects[dest_container->cardinality] = src_container->object;
+		dest_container->keys = (index_t*) malloc (inner_cardinality*dimensions*sizeof(index_t));
+		dest_container->objects = (object_t*) malloc (inner_cardinality*sizeof(object_t));
+		dest_container->cardinality = 0;
+		dest_container->dimensions = dimensions;
 
-					memcpy (dest_container->keys+dest_container->cardinality*dimensions,
-						src_container->key,
-						dimensions*sizeof(index_t));
+		for (uint32_t offset=0; offset<outer_cardinality; ++offset) {
+			if (has_tail && offset == outer_cardinality - 1) {
+				data_pair_t const*const src_container = get_queue_element (tail,tail_offset);
+				dest_container->objects[dest_container->cardinality] = src_container->object;
 
-					dest_container->cardinality++;
-				}else{
-					multidata_container_t const*const src_container = ((fifo_t *const)partial_results->buffer[offset])->buffer[offsets[offset]];
+				memcpy (dest_container->keys+dest_container->cardinality*dimensions,
+					src_container->key,
+					dimensions*sizeof(index_t));
 
-					memcpy (dest_container->objects+dest_container->cardinality,
-						src_container->objects,
-						src_container->cardinality*sizeof(object_t));
+				dest_container->cardinality++;
+			}else{
+				multidata_container_t const*const src_container = current[offset];
 
-					for (uint32_t c=0; c<src_container->cardinality; ++c) {
-						memcpy (dest_container->keys+(dest_container->cardinality+c)*dimensions,
-							src_container->keys+c*src_container->dimensions,
-							dimensions*sizeof(index_t));
-					}
+				memcpy (dest_container->objects+dest_container->cardinality,
+					src_container->objects,
+					src_container->cardinality*sizeof(object_t));
 
-					dest_container->cardinality += src_container->cardinality;
+				for (uint32_t c=0; c<src_container->cardinality; ++c) {
+					memcpy (dest_container->keys+(dest_container->cardinality+c)*dimensions,
+						src_container->keys+c*src_container->dimensions,
+						dimensions*sizeof(index_t));
 				}
+
+				dest_container->cardinality += src_container->cardinality;
 			}
+		}
 
-			assert (dest_container->cardinality == inner_cardinality);
+		assert (dest_container->cardinality == inner_cardinality);
 
-			dest_container->sort_key = use_avg?
-					(pairwise?avgdistance_pairwise_multikey(dest_container,0):avgdistance_ordered_multikey(dest_container,0))
-					:(less_than_theta?
-					(pairwise?maxdistance_pairwise_multikey(dest_container,0):maxdistance_ordered_multikey(dest_container,0))
-					:(pairwise?mindistance_pairwise_multikey(dest_container,0):mindistance_ordered_multikey(dest_container,0)));
+		dest_container->sort_key = use_avg?
+				(pairwise?avgdistance_pairwise_multikey(dest_container,0):avgdistance_ordered_multikey(dest_container,0))
+				:(less_than_theta?
+				(pairwise?maxdistance_pairwise_multikey(dest_container,0):maxdistance_ordered_multikey(dest_container,0))
+				:(pairwise?mindistance_pairwise_multikey(dest_container,0):mindistance_ordered_multikey(dest_container,0)));
 
-			if (less_than_theta ? dest_container->sort_key <= theta : dest_container->sort_key >= theta) {
-					insert_into_priority_queue (data_combinations,dest_container);
+		if (less_than_theta ? dest_container->sort_key <= theta : dest_container->sort_key >= theta) {
+			insert_into_spill (results,dest_container);
+		}else{
+			free (dest_container->objects);
+			free (dest_container->keys);
+			free (dest_container);
+		}
+
+		/* advances to the next combination, with the first partial result changing fastest */
+		uint64_t i = 0;
+		for (; i<outer_cardinality; ++i) {
+			if (has_tail && i == outer_cardinality-1) {
+				if (++tail_offset < tail->size) break;
+				tail_offset = 0;
 			}else{
-					free (dest_container->objects);
-					free (dest_container->keys);
-					free (dest_container);
+				current[i] = scan_spill (partial_results->buffer[i]);
+				if (current[i] != NULL) break;
+				rewind_spill (partial_results->buffer[i]);
+				current[i] = scan_spill (partial_results->buffer[i]);
 			}
-			i=0;
 		}
-		++offsets[i];
+		if (i == outer_cardinality) break;
 	}
 
-	fifo_t* result = new_queue();
-	while (data_combinations->size) {
-		insert_at_tail_of_queue(result,remove_from_priority_queue(data_combinations));
-	}
+	return results;
+}
 
-	delete_priority_queue (data_combinations);
 
-	return result;
+/**
+ * The next tuple of a join to be reported, either
+ * from its result-set or from its spilled results.
+ */
+static
+multidata_container_t* next_join_result (fifo_t *const result, spill_t *const spilled) {
+	if (spilled != NULL) return remove_from_spill (spilled);
+	else if (result->size) return remove_tail_of_queue (result);
+	else return NULL;
 }
 
 
@@ -888,7 +1740,7 @@ tree_t* get_rtree (char const*const filepath) {
 			pthread_rwlock_wrlock (&server_lock);
 			tree = load_rtree (filepath);
 			if (tree != NULL) {
-				set (server_trees,filepath,tree);
+				set (server_trees,tree->filename,tree);
 				LOG (info,"[get_rtree()] Loaded from the disk R#-Tree: '%s'\n",tree->filename);
 			}
 			pthread_rwlock_unlock (&server_lock);
@@ -902,28 +1754,67 @@ tree_t* get_rtree (char const*const filepath) {
 	}
 }
 
+/**
+ * Appends to the message the guarantee that comes with an approximate
+ * result; either a factor for top-k results or the distance up to which
+ * the results of a distance join are complete.
+ */
+static
+void report_approximation (char message[], approximation_t const*const approximation, boolean const is_ratio, boolean const less_than) {
+	char report [BUFSIZ];
+	if (is_ratio) {
+		sprintf (report,"Approximate result with distances guaranteed to be within a factor of %.4lf from the exact ones.",approximation->bound);
+	}else if (less_than) {
+		sprintf (report,"Approximate result guaranteed to contain all tuples within distance %lf.",approximation->bound);
+	}else{
+		sprintf (report,"Approximate result guaranteed to contain all tuples farther than distance %lf.",approximation->bound);
+	}
+
+	LOG (info,"[report_approximation()] %s\n",report);
+	if (*message) {
+		strcat (message," ");
+	}
+	strcat (message,report);
+}
+
+/**
+ * Temporary trees holding intermediate results are
+ * removed from the disk once they are of no more use,
+ * while trees served by the server are left intact.
+ */
+static
+void release_rtree (tree_t *const tree) {
+	pthread_rwlock_rdlock (&server_lock);
+	boolean const is_server_tree = server_trees != NULL && get (server_trees,tree->filename) == tree;
+	pthread_rwlock_unlock (&server_lock);
+
+	if (!is_server_tree) {
+		char *const filename = strdup (tree->filename);
+		delete_tree (tree);
+		unlink (filename);
+		free (filename);
+	}
+}
+
 static
-tree_t* process_reverse_NN_query (lifo_t *const stack, char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter) {
+tree_t* process_reverse_NN_query (lifo_t *const stack, char const folder[], char message[]) {
 	if (remove_from_stack (stack) == (void*)'%') {
 		uint32_t kcardinality = remove_from_stack (stack);
 		index_t key [kcardinality];
 		for (register uint32_t i=kcardinality; i>0; --i) {
 			double* tmp = remove_from_stack (stack);
-			if (logging <= debug) fprintf (stderr,"%lf ",*tmp);
+			LOG_MORE (debug,"%lf ",*tmp);
 			key [i-1] = *tmp;
 		}
 
 		lifo_t *const feature_trees = new_stack ();
 		while (peek_at_stack (stack) == (void*)'%') {
-			unsigned sub_io_blocks_counter = 0;
-			tree_t *const feature_tree = process_subquery (stack,folder,message,&sub_io_blocks_counter);
+			tree_t *const feature_tree = process_subquery (stack,folder,message);
 
 			if (feature_tree == NULL) {
 				while (feature_trees->size) {
 					tree_t *const to_be_removed = remove_from_stack(feature_trees);
-					if (get_rtree(to_be_removed->filename)==NULL) {
-						delete_tree (to_be_removed);
-					}
+					release_rtree (to_be_removed);
 				}
 				delete_stack (feature_trees);
 
@@ -934,9 +1825,7 @@ tree_t* process_reverse_NN_query (lifo_t *const stack, char const folder[], char
 			if (feature_tree->dimensions > kcardinality) {
 				while (feature_trees->size) {
 					tree_t *const to_be_removed = remove_from_stack(feature_trees);
-					if (get_rtree(to_be_removed->filename)==NULL) {
-						delete_tree (to_be_removed);
-					}
+					release_rtree (to_be_removed);
 				}
 				delete_stack (feature_trees);
 
@@ -945,9 +1834,6 @@ tree_t* process_reverse_NN_query (lifo_t *const stack, char const folder[], char
 				return NULL;
 			}
 
-			*io_mb_counter += (sub_io_blocks_counter * feature_tree->page_size)/((double)(1<<20));
-			*io_blocks_counter += sub_io_blocks_counter;
-
 			insert_into_stack(feature_trees,feature_tree);
 		}
 
@@ -957,8 +1843,7 @@ tree_t* process_reverse_NN_query (lifo_t *const stack, char const folder[], char
 			return NULL;
 		}
 
-		uint64_t sub_io_blocks_counter = 0;
-		tree_t *const data_tree = process_subquery (stack,folder,message,&sub_io_blocks_counter);
+		tree_t *const data_tree = process_subquery (stack,folder,message);
 
 		if (data_tree == NULL) {
 			strcpy (message,"Unable to retrieve the data-tree for the RNN query.");
@@ -974,17 +1859,6 @@ tree_t* process_reverse_NN_query (lifo_t *const stack, char const folder[], char
 		fifo_t *const result_list = multichromatic_reverse_nearest_neighbors (key,data_tree,feature_trees,kcardinality);
 		tree_t *const result_tree = create_temp_rtree (result_list,data_tree->page_size,data_tree->dimensions);
 
-		*io_mb_counter += (data_tree->io_counter * data_tree->page_size)/((double)(1<<20));
-		*io_blocks_counter += data_tree->io_counter;
-		data_tree->io_counter = 0;
-
-		for (uint32_t itree=0; itree<feature_trees->size; ++itree) {
-			tree_t *const feature_tree = (tree_t *const) feature_trees->buffer[itree];
-			*io_mb_counter += (feature_tree->io_counter * feature_tree->page_size)/((double)(1<<20));
-			*io_blocks_counter += feature_tree->io_counter;
-			feature_tree->io_counter = 0;
-		}
-
 		delete_stack (feature_trees);
 		return result_tree;
 	}else{
@@ -996,10 +1870,82 @@ tree_t* process_reverse_NN_query (lifo_t *const stack, char const folder[], char
 }
 
 static
-tree_t* process_subquery (lifo_t *const stack, char const folder[], char message[], uint64_t *const io_counter) {
+subquery_t* new_subquery (tree_t *const tree) {
+	subquery_t *const subquery = (subquery_t *const) malloc (sizeof(subquery_t));
+	if (subquery == NULL) {
+		LOG (fatal,"[new_subquery()] Unable to allocate additional memory for a new subquery...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	subquery->tree = tree;
+	subquery->lookups = new_stack();
+
+	subquery->from = (index_t*) malloc (tree->dimensions*sizeof(index_t));
+	subquery->to = (index_t*) malloc (tree->dimensions*sizeof(index_t));
+	subquery->bound = (index_t*) malloc ((tree->dimensions+1)*sizeof(index_t));
+	subquery->corner = (boolean*) malloc (tree->dimensions*sizeof(boolean));
+
+	if (subquery->from == NULL || subquery->to == NULL || subquery->bound == NULL || subquery->corner == NULL) {
+		LOG (fatal,"[new_subquery()] Unable to allocate additional memory for a new subquery...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	bzero (subquery->corner,tree->dimensions*sizeof(boolean));
+	for (uint32_t i=0; i<tree->dimensions; ++i) {
+		subquery->from [i] = -INDEX_T_MAX;
+		subquery->to [i] = INDEX_T_MAX;
+	}
+
+	subquery->approximation.epsilon = 0;
+	subquery->approximation.max_pages = 0;
+	subquery->approximation.bound = 1;
+
+	subquery->bounded_dimensionality = 0;
+	subquery->projection = 0;
+	subquery->parallelism = PARALLELISM;
+
+	subquery->is_skyline = false;
+	subquery->is_count = false;
+	subquery->materialize = false;
+
+	subquery->sample_size = 0;
+	subquery->offset = 0;
+	subquery->limit = NO_LIMIT;
+	subquery->with_keys = true;
+
+	subquery->estimated_records = 0;
+	subquery->estimated_cost = 0;
+
+	return subquery;
+}
+
+/**
+ * Frees a subquery along with the tree it is posed
+ * against, unless that is a tree served by the server.
+ */
+static
+void delete_subquery (subquery_t *const subquery) {
+	while (subquery->lookups->size) {
+		free (remove_from_stack (subquery->lookups));
+	}
+	delete_stack (subquery->lookups);
+
+	if (subquery->tree != NULL) {
+		release_rtree (subquery->tree);
+	}
+
+	free (subquery->from);
+	free (subquery->to);
+	free (subquery->bound);
+	free (subquery->corner);
+	free (subquery);
+}
+
+static
+subquery_t* parse_subquery (lifo_t *const stack, char const folder[], char message[]) {
 	if (peek_at_stack (stack) == (void*)'/' || peek_at_stack (stack) == (void*)'%') {
 		char start_symbol = (char) remove_from_stack (stack);
-		LOG (debug,"[process_subquery()] UNROLLING NEW SUBQUERY... \n");
+		LOG (debug,"[parse_subquery()] UNROLLING NEW SUBQUERY... \n");
 
 		char *const filename = remove_from_stack (stack);
 		char *const filepath = (char *const) malloc (sizeof(char)*(strlen(folder)+strlen(filename)+2));
@@ -1007,12 +1953,12 @@ tree_t* process_subquery (lifo_t *const stack, char const folder[], char message
 		if (folder[strlen(folder)-1]!='/') {
 			strcat (filepath,"/");
 		}
-		LOG (debug,"[process_subquery()] HEAPFILE: '%s'. \n",filename);
+		LOG (debug,"[parse_subquery()] HEAPFILE: '%s'. \n",filename);
 		strcat (filepath,filename);
 		free (filename);
 
 		if (sigsetjmp(fpejmp,1)) {
-			LOG (error,"[process_subquery()] Cannot perform operation on invalid heapfile %s.\n",filepath);
+			LOG (error,"[parse_subquery()] Cannot perform operation on invalid heapfile %s.\n",filepath);
 			sprintf (message,"Cannot perform an operation on invalid heapfile '%s'.",filepath);
 			clear_stack (stack);
 			return NULL;
@@ -1021,35 +1967,20 @@ tree_t* process_subquery (lifo_t *const stack, char const folder[], char message
 		tree_t* tree = get_rtree (filepath);
 		if (tree == NULL) {
 			sprintf (message,"Cannot perform an operation on heapfile '%s' because it does not exist.",filepath);
-			LOG (error,"[process_subquery()] Cannot perform an operation on heapfile '%s' because it does not exist.\n",filepath);
+			LOG (error,"[parse_subquery()] Cannot perform an operation on heapfile '%s' because it does not exist.\n",filepath);
 			clear_stack (stack);
 			return NULL;
 		}
 		free (filepath);
 
-		index_t from [tree->dimensions];
-		index_t to [tree->dimensions];
-
-		boolean corner [tree->dimensions];
-		index_t bound [tree->dimensions+1];
-
-		bzero (corner,tree->dimensions*sizeof(boolean));
-		for (uint32_t i=0; i<tree->dimensions; ++i) {
-			from [i] = -INDEX_T_MAX;
-			to [i] = INDEX_T_MAX;
-		}
-
-		lifo_t *const lookups = new_stack();
+		subquery_t *const subquery = new_subquery (tree);
 
+		index_t *const from = subquery->from;
+		index_t *const to = subquery->to;
+		index_t *const bound = subquery->bound;
+		boolean *const corner = subquery->corner;
 
-		boolean is_skyline = false;
-		uint32_t bounded_dimensionality = 0;
-
-		uint32_t projection = 0;
 		uint32_t const pcardinality = remove_from_stack (stack);
-		if (!pcardinality) {
-			return tree;
-		}
 		for (uint32_t j=0; j<pcardinality; ++j) {
 			uint32_t const operation = remove_from_stack (stack);
 			uint32_t kcardinality = remove_from_stack(stack);
@@ -1058,15 +1989,15 @@ tree_t* process_subquery (lifo_t *const stack, char const folder[], char message
 				case LOOKUP:
 					LOG (debug,"LOOKUP ");
 					index_t *const lookup = (index_t *const) malloc (tree->dimensions*sizeof(index_t));
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
+					LOG_MORE (debug," (%u) ",kcardinality);
 					if (tree->dimensions < kcardinality) {
 						kcardinality = tree->dimensions;
 					}
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
+					LOG_MORE (debug," (%u) ",kcardinality);
 					uint32_t i=0;
 					for (i=0; i<kcardinality; ++i) {
 						double* tmp = remove_from_stack (stack);
-						if (logging <= debug) fprintf (stderr,"%lf ",*tmp);
+						LOG_MORE (debug,"%lf ",*tmp);
 						lookup[kcardinality-i-1] = *tmp;
 					}
 
@@ -1079,20 +2010,21 @@ tree_t* process_subquery (lifo_t *const stack, char const folder[], char message
 								lookup[k] = to[k];
 							}
 						}
+						free (lookup);
 					}else{
-						insert_into_stack (lookups,lookup);
+						insert_into_stack (subquery->lookups,lookup);
 					}
 					break;
 				case FROM:
 					LOG (debug,"FROM ");
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
+					LOG_MORE (debug," (%u) ",kcardinality);
 					if (tree->dimensions < kcardinality) {
 						kcardinality = tree->dimensions;
 					}
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
+					LOG_MORE (debug," (%u) ",kcardinality);
 					for (uint32_t i=0; i<kcardinality; ++i) {
 						double* tmp = remove_from_stack (stack);
-						if (logging <= debug) fprintf (stderr,"%lf ",*tmp);
+						LOG_MORE (debug,"%lf ",*tmp);
 						if (*tmp > from[kcardinality-1-i]) {
 							from[kcardinality-1-i] = *tmp;
 						}
@@ -1100,14 +2032,14 @@ tree_t* process_subquery (lifo_t *const stack, char const folder[], char message
 					break;
 				case TO:
 					LOG (debug,"TO ");
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
+					LOG_MORE (debug," (%u) ",kcardinality);
 					if (tree->dimensions < kcardinality) {
 						kcardinality = tree->dimensions;
 					}
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
+					LOG_MORE (debug," (%u) ",kcardinality);
 					for (uint32_t i=0; i<kcardinality; ++i) {
 							double* tmp = remove_from_stack (stack);
-							if (logging <= debug) fprintf (stderr,"%lf ",*tmp);
+							LOG_MORE (debug,"%lf ",*tmp);
 							if (*tmp < to[kcardinality-1-i]) {
 								to[kcardinality-1-i] = *tmp;
 							}
@@ -1115,167 +2047,345 @@ tree_t* process_subquery (lifo_t *const stack, char const folder[], char message
 					break;
 				case BOUND:
 					LOG (debug,"BOUND ");
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
+					LOG_MORE (debug," (%u) ",kcardinality);
 					if (tree->dimensions+1 < kcardinality) {
 						kcardinality = tree->dimensions+1;
 					}
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
-					bounded_dimensionality = kcardinality;
+					LOG_MORE (debug," (%u) ",kcardinality);
+					subquery->bounded_dimensionality = kcardinality;
 					for (uint32_t i=0; i<kcardinality; ++i) {
 						double* tmp = remove_from_stack (stack);
-						if (logging <= debug) fprintf (stderr,"%lf ",*tmp);
+						LOG_MORE (debug,"%lf ",*tmp);
 						bound[kcardinality-1-i] = *tmp;
 					}
 					break;
 				case CORN:
-					is_skyline = true;
+					subquery->is_skyline = true;
 					char *const bitfield = remove_from_stack (stack);
 					LOG (debug,"SKYLINE - BITFIELD '%s'",bitfield);
 
 					kcardinality = strlen (bitfield);
-					projection = kcardinality;
-					if (logging <= debug) fprintf (stderr," (%u) ",kcardinality);
+					subquery->projection = kcardinality;
+					LOG_MORE (debug," (%u) ",kcardinality);
 					for (uint32_t i=0; i<kcardinality; ++i) {
 						if (bitfield[i]=='O' || bitfield[i]=='o') {
 							corner[i] = false;
 						}else if (bitfield[i]=='I' || bitfield[i]=='i') {
 							corner[i] = true;
 						}else{
-							LOG (error,"[process_subquery()] Unable to parse bitfield '%s'...\n",bitfield)
-							is_skyline = false;
+							LOG (error,"[parse_subquery()] Unable to parse bitfield '%s'...\n",bitfield)
+							subquery->is_skyline = false;
 							break;
 						}
 					}
+					free (bitfield);
+					break;
+				case EPSILON:
+					LOG (debug,"EPSILON ");
+					subquery->approximation.epsilon = *((double*)remove_from_stack (stack));
+					LOG_MORE (debug,"%lf ",subquery->approximation.epsilon);
+					break;
+				case PAGES:
+					LOG (debug,"PAGES ");
+					subquery->approximation.max_pages = *((double*)remove_from_stack (stack));
+					LOG_MORE (debug,"%lu ",subquery->approximation.max_pages);
+					break;
+				case THREADS:
+					LOG (debug,"THREADS ");
+					subquery->parallelism = *((double*)remove_from_stack (stack));
+					LOG_MORE (debug,"%u ",subquery->parallelism);
+					break;
+				case COUNT:
+					LOG (debug,"COUNT ");
+					subquery->is_count = true;
+					break;
+				case SAMPLE:
+					LOG (debug,"SAMPLE ");
+					subquery->sample_size = *((double*)remove_from_stack (stack));
+					LOG_MORE (debug,"%lu ",subquery->sample_size);
+					break;
+				case LIMIT:
+					LOG (debug,"LIMIT ");
+					subquery->limit = *((double*)remove_from_stack (stack));
+					LOG_MORE (debug,"%lu ",subquery->limit);
+					break;
+				case OFFSET:
+					LOG (debug,"OFFSET ");
+					subquery->offset = *((double*)remove_from_stack (stack));
+					LOG_MORE (debug,"%lu ",subquery->offset);
+					break;
+				case FIELDS:
+					LOG (debug,"FIELDS ");
 					break;
 				default:
-					LOG (error,"[process_subquery()] Unknown operation...\n");
+					LOG (error,"[parse_subquery()] Unknown operation...\n");
 			}
 
 			if (logging <= debug) {
-				fprintf (stderr,"\n");
+				log_append ("\n");
 			}
 		}
 
+		return subquery;
+	}else{
+		LOG (error,"[parse_subquery()] Syntax error: Was expecting the start of a new subquery.\n");
+		strcpy (message,"Syntax error.");
+		clear_stack (stack);
+		return NULL;
+	}
+}
 
-		LOG (debug,"[process_subquery()] Result computation to take place now...\n");
-
-		boolean delete_rtree_flag = false;
-		tree_t* result_tree = NULL;
-		if (lookups->size) {
-			fifo_t *const lookups_result_list = new_queue();
-			LOG (debug,"[process_subquery()] lookups stack-size: %lu \n",lookups->size);
-
-			while (lookups->size) {
-				index_t *const lookup = remove_from_stack (lookups);
-				LOG (debug,"[process_subquery()] lookup-key: ( %12lf %12lf ) \n",(double)lookup[0],(double)lookup[1]);
-
-				fifo_t *const partial = find_all_in_rtree (tree,lookup,tree->dimensions);
-				LOG (debug,"[process_subquery()] Adding %lu new tuples in the result...\n",partial->size);
-
-				while (partial->size) {
-					data_pair_t *const pair = (data_pair_t*) malloc (sizeof(data_pair_t));
-					pair->key = (index_t*) malloc (sizeof(index_t)*tree->dimensions);
-					memcpy (pair->key,lookup,sizeof(index_t)*tree->dimensions);
-
-					pair->object = remove_tail_of_queue (partial);
-					insert_at_tail_of_queue (lookups_result_list,pair);
-				}
+/**
+ * The operator whose latencies the evaluation of a subquery is timed for.
+ */
+static
+operator_t subquery_operator (subquery_t const*const subquery) {
+	if (subquery->lookups->size) {
+		return LOOKUP_OPERATOR;
+	}else if (subquery->is_skyline) {
+		return SKYLINE_OPERATOR;
+	}else if (subquery->bounded_dimensionality) {
+		return NEAREST_OPERATOR;
+	}else if (subquery->sample_size) {
+		return SAMPLE_OPERATOR;
+	}else{
+		return RANGE_OPERATOR;
+	}
+}
 
-				free (lookup);
-				delete_queue (partial);
+/**
+ * Computes the result of a subquery and frees it.
+ */
+static
+fifo_t* evaluate_subquery (subquery_t *const subquery, char message[]) {
+	LOG (debug,"[evaluate_subquery()] Result computation to take place now...\n");
+
+	tree_t* tree = subquery->tree;
+	uint32_t const dimensions = tree->dimensions;
+
+	index_t const*const from = subquery->from;
+	index_t const*const to = subquery->to;
+	index_t const*const bound = subquery->bound;
+	uint32_t const bounded_dimensionality = subquery->bounded_dimensionality;
+	boolean const is_plain_range = !subquery->lookups->size && !bounded_dimensionality && !subquery->is_skyline && !subquery->sample_size;
+
+	/* neighbors are paged from the nearest, so none beyond the page are searched for */
+	uint64_t const neighbors = !bounded_dimensionality ? 0 : subquery->sample_size ? (uint64_t) *bound : MIN((uint64_t) *bound,paged_reach (subquery));
+
+	boolean delete_rtree_flag = false;
+	fifo_t* result_list = NULL;
+	if (subquery->lookups->size) {
+		fifo_t *const lookups_result_list = new_queue();
+		LOG (debug,"[evaluate_subquery()] lookups stack-size: %lu \n",subquery->lookups->size);
+
+		while (subquery->lookups->size) {
+			index_t *const lookup = remove_from_stack (subquery->lookups);
+			LOG (debug,"[evaluate_subquery()] lookup-key: ( %12lf %12lf ) \n",(double)lookup[0],(double)lookup[1]);
+
+			fifo_t *const partial = find_all_in_rtree (tree,lookup,dimensions);
+			LOG (debug,"[evaluate_subquery()] Adding %lu new tuples in the result...\n",partial->size);
+
+			while (partial->size) {
+				data_pair_t *const pair = (data_pair_t*) malloc (sizeof(data_pair_t));
+				pair->key = (index_t*) malloc (sizeof(index_t)*dimensions);
+				memcpy (pair->key,lookup,sizeof(index_t)*dimensions);
+
+				pair->object = remove_tail_of_queue (partial);
+				pair->dimensions = dimensions;
+				insert_at_tail_of_queue (lookups_result_list,pair);
 			}
 
-			if (lookups_result_list->size) {
-				LOG (info,"[process_subquery()] Creating materialized view for the result consisting of %lu records... \n",lookups_result_list->size);
+			free (lookup);
+			delete_queue (partial);
+		}
 
-				pthread_rwlock_wrlock (&tree->tree_lock);
-				*io_counter = tree->io_counter;
-				tree->io_counter = 0;
-				pthread_rwlock_unlock (&tree->tree_lock);
+		if (lookups_result_list->size) {
+			LOG (info,"[evaluate_subquery()] Creating materialized view for the result consisting of %lu records... \n",lookups_result_list->size);
+			tree = create_temp_rtree (lookups_result_list,tree->page_size,dimensions);
+			delete_rtree_flag = true;
+		}else{
+			result_list = lookups_result_list;
+		}
+	}
 
-				tree = create_temp_rtree (lookups_result_list,tree->page_size,tree->dimensions);
-				delete_rtree_flag = true;
+	if (result_list != NULL) {
+		LOG (info,"[evaluate_subquery()] Lookups returned no tuples.\n");
+	}else if (bounded_dimensionality && !subquery->is_skyline) {
+		approximation_t *const approximation = &subquery->approximation;
+		boolean const is_approximate = approximation->epsilon > 0 || approximation->max_pages;
+		fifo_t *const bounded_result_list = parallel_bounded_search (tree,from,to,bound+1,neighbors,bounded_dimensionality-1,
+															is_approximate?approximation:NULL,subquery->parallelism);
+		if (bounded_result_list != NULL) {
+			LOG (info,"[evaluate_subquery()] Bounded search result contains %lu tuples.\n",bounded_result_list->size);
+
+			/* results are reported from the tail, so the nearest neighbor is placed last */
+			result_list = new_queue();
+			while (bounded_result_list->size) {
+				data_container_t *const before = remove_head_of_queue (bounded_result_list);
+				data_pair_t *const after = (data_pair_t *const) malloc (sizeof(data_pair_t));
+				after->dimensions = before->dimensions;
+				after->object = before->object;
+				after->key = before->key;
+				insert_at_head_of_queue (result_list,after);
+				free (before);
 			}
+			delete_queue (bounded_result_list);
 		}
 
-		if (bounded_dimensionality && !is_skyline) {
-			fifo_t *const bounded_result_list = bounded_search (tree,from,to,bound+1,*bound,bounded_dimensionality-1);
-			LOG (info,"[process_subquery()] Bounded search result contains %lu tuples.\n",bounded_result_list->size);
+		if (is_approximate) {
+			report_approximation (message,approximation,true,true);
+		}
+	}else if (subquery->is_skyline) {
+		fifo_t *const skyline_result_list = skyline_constrained (tree,subquery->corner,from,to,subquery->projection);
+		LOG (info,"[evaluate_subquery()] Skyline result contains %lu tuples.\n",skyline_result_list->size);
 
-			result_tree = create_temp_rtree (bounded_result_list,tree->page_size,tree->dimensions);
-		}else if (is_skyline) {
-			fifo_t *const skyline_result_list = skyline_constrained (tree,corner,from,to,projection);
-			LOG (info,"[process_subquery()] Skyline result contains %lu tuples.\n",skyline_result_list->size);
+		if (bounded_dimensionality) {
+			priority_queue_t* max_heap = new_priority_queue(&maxcompare_containers);
 
-			if (bounded_dimensionality) {
-				priority_queue_t* max_heap = new_priority_queue(&maxcompare_containers);
+			while (skyline_result_list->size) {
+				data_pair_t *sky_tuple = remove_tail_of_queue (skyline_result_list);
 
-				while (skyline_result_list->size) {
-					data_pair_t *sky_tuple = remove_tail_of_queue (skyline_result_list);
+				data_container_t *const sort_tuple = (data_container_t*) malloc (sizeof(data_container_t));
 
-					data_container_t *const sort_tuple = (data_container_t*) malloc (sizeof(data_container_t));
+				sort_tuple->object = sky_tuple->object;
+				sort_tuple->key = sky_tuple->key;
+				sort_tuple->sort_key = key_to_key_distance (bound+1,sky_tuple->key,bounded_dimensionality-1);
 
-					sort_tuple->object = sky_tuple->object;
-					sort_tuple->key = sky_tuple->key;
-					sort_tuple->sort_key = key_to_key_distance (bound+1,sky_tuple->key,bounded_dimensionality-1);
+				if (max_heap->size < neighbors) {
+					sort_tuple->dimensions = dimensions;
+					insert_into_priority_queue (max_heap,sort_tuple);
+				}else{
+					if (sort_tuple->sort_key < ((data_container_t*)peek_priority_queue(max_heap))->sort_key) {
+						data_container_t* temp = remove_from_priority_queue (max_heap);
+						free (temp->key);
+						free (temp);
 
-					if (max_heap->size < *bound) {
-						sort_tuple->dimensions = tree->dimensions;
+						sort_tuple->dimensions = dimensions;
 						insert_into_priority_queue (max_heap,sort_tuple);
 					}else{
-						if (sort_tuple->sort_key < ((data_container_t*)peek_priority_queue(max_heap))->sort_key) {
-							data_container_t* temp = remove_from_priority_queue (max_heap);
-							free (temp->key);
-							free (temp);
-
-							sort_tuple->dimensions = tree->dimensions;
-							insert_into_priority_queue (max_heap,sort_tuple);
-						}else{
-							free (sort_tuple->key);
-							free (sort_tuple);
-						}
+						free (sort_tuple->key);
+						free (sort_tuple);
 					}
-					free (sky_tuple);
 				}
+				free (sky_tuple);
+			}
 
-				clear_queue (skyline_result_list);
+			clear_queue (skyline_result_list);
 
-				while (max_heap->size) {
-					data_container_t *const before = remove_from_priority_queue (max_heap);
-					data_pair_t *const after = (data_pair_t *const) malloc (sizeof(data_pair_t));
-					insert_at_tail_of_queue (skyline_result_list,after);
-					after->dimensions = before->dimensions;
-					after->object = before->object;
-					after->key = before->key;
-					free (before);
-				}
-				delete_priority_queue (max_heap);
+			while (max_heap->size) {
+				data_container_t *const before = remove_from_priority_queue (max_heap);
+				data_pair_t *const after = (data_pair_t *const) malloc (sizeof(data_pair_t));
+				insert_at_tail_of_queue (skyline_result_list,after);
+				after->dimensions = before->dimensions;
+				after->object = before->object;
+				after->key = before->key;
+				free (before);
 			}
-			result_tree = create_temp_rtree (skyline_result_list,tree->page_size,tree->dimensions);
-		}else{
-			fifo_t *const range_result_list = range (tree,from,to,tree->dimensions);
-			LOG (info,"[process_subquery()] Range query result contains %lu tuples.\n",range_result_list->size);
-			result_tree = create_temp_rtree (range_result_list,tree->page_size,tree->dimensions);
+			delete_priority_queue (max_heap);
+		}
+		result_list = skyline_result_list;
+	}else if (subquery->sample_size) {
+		result_list = sample_range (tree,from,to,subquery->sample_size);
+		if (result_list != NULL) {
+			LOG (info,"[evaluate_subquery()] Range sample contains %lu tuples.\n",result_list->size);
+		}
+	}else if (is_paged_subquery (subquery) || !subquery->with_keys) {
+		result_list = paged_range (tree,from,to,dimensions,subquery->offset,subquery->limit,subquery->with_keys);
+		if (result_list != NULL) {
+			LOG (info,"[evaluate_subquery()] Paged range contains %lu tuples.\n",result_list->size);
+		}
+	}else{
+		result_list = parallel_range (tree,from,to,dimensions,subquery->parallelism);
+		if (result_list != NULL) {
+			LOG (info,"[evaluate_subquery()] Range query result contains %lu tuples.\n",result_list->size);
 		}
+	}
 
-		delete_stack (lookups);
-		if (delete_rtree_flag) {
-			if (get_rtree(tree->filename)==NULL) {
-				delete_tree (tree);
-			}
-		}else{
-			pthread_rwlock_wrlock (&tree->tree_lock);
-			*io_counter = tree->io_counter;
-			tree->io_counter = 0;
-			pthread_rwlock_unlock (&tree->tree_lock);
+	if (result_list == NULL) {
+		result_list = new_queue();
+	}else if (subquery->sample_size && (bounded_dimensionality || subquery->is_skyline)) {
+		unsigned short seed [3] = {time(NULL),pthread_self(),getpid()};
+		result_list = sample_results (result_list,subquery->sample_size,seed);
+	}
+
+	/* only plain ranges are paged while they are traversed */
+	if (is_paged_subquery (subquery) && !is_plain_range) {
+		result_list = page_results (result_list,subquery->offset,subquery->limit);
+	}
+
+	if (delete_rtree_flag) {
+		release_rtree (tree);
+	}
+
+	delete_subquery (subquery);
+	return result_list;
+}
+
+/**
+ * A tree of the results of a subquery, which is the tree the
+ * subquery is posed against if that is all there is to it, or
+ * else a temporary one; in either case the subquery is freed.
+ */
+static
+tree_t* materialize_subquery (subquery_t *const subquery, char message[]) {
+	if (is_base_subquery (subquery)) {
+		tree_t *const tree = subquery->tree;
+		subquery->tree = NULL;
+		delete_subquery (subquery);
+		return tree;
+	}
+
+	uint32_t const page_size = subquery->tree->page_size;
+	uint32_t const dimensions = subquery->tree->dimensions;
+
+	fifo_t *const result_list = evaluate_subquery (subquery,message);
+	LOG (info,"[materialize_subquery()] Creating materialized view for the result consisting of %lu records... \n",result_list->size);
+
+	tree_t *const result_tree = create_temp_rtree (result_list,page_size,dimensions);
+	flush_tree (result_tree);
+	return result_tree;
+}
+
+/**
+ * Reports in a row of the response the number of results of a
+ * subquery, which is freed. Ranges are counted in place, while
+ * the results of any other subquery are computed and counted.
+ */
+static
+char* count_subquery (subquery_t *const subquery, char message[]) {
+	uint64_t count = 0;
+	if (subquery->lookups->size || subquery->bounded_dimensionality || subquery->is_skyline || subquery->sample_size) {
+		fifo_t *const result_list = evaluate_subquery (subquery,message);
+		count = result_list->size;
+		while (result_list->size) {
+			data_pair_t *const tuple = remove_head_of_queue (result_list);
+			free (tuple->key);
+			free (tuple);
 		}
-		return result_tree;
+		delete_queue (result_list);
 	}else{
-		LOG (error,"[process_subquery()] Syntax error: Was expecting the start of a new subquery.\n");
-		strcpy (message,"Syntax error.");
-		clear_stack (stack);
-		return NULL;
+		/* the range is only counted up to the last record of the page asked for */
+		uint64_t const reach = subquery->limit > NO_LIMIT - subquery->offset ? NO_LIMIT : subquery->offset + subquery->limit;
+		count = count_range (subquery->tree,subquery->from,subquery->to,reach);
+		count = count > subquery->offset ? MIN(count-subquery->offset,subquery->limit) : 0;
+
+		delete_subquery (subquery);
+	}
+	LOG (info,"[count_subquery()] Subquery has %lu results.\n",count);
+
+	char *const row = (char *const) malloc (sizeof(char)*64);
+	if (row == NULL) {
+		LOG (fatal,"[count_subquery()] Unable to allocate additional memory for the count of a subquery...\n");
+		exit (EXIT_FAILURE);
 	}
+	sprintf (row,"\t{ \"count\": %lu },\n",count);
+	return row;
+}
+
+static
+tree_t* process_subquery (lifo_t *const stack, char const folder[], char message[]) {
+	subquery_t *const subquery = parse_subquery (stack,folder,message);
+	return subquery != NULL ? materialize_subquery (subquery,message) : NULL;
 }
 
 
@@ -1285,12 +2395,14 @@ tree_t* process_subquery (lifo_t *const stack, char const folder[], char message
  */
 static
 tree_t* create_temp_rtree (fifo_t *const partial_result, uint32_t const page_size, uint32_t const dimensions) {
-        char filename[32];
-        strcpy (filename,"/tmp/tree.");
-        sprintf (filename+10,"%lx",lrand48());
-        assert (strlen(filename)<32);
+        static uint64_t temp_rtrees_counter = 0;
+
+        char filename[64];
+        sprintf (filename,"/tmp/tree.%d.%lx",getpid(),__sync_fetch_and_add(&temp_rtrees_counter,1));
+        assert (strlen(filename)<64);
+        unlink (filename);
 
-        tree_t *const tree = new_rtree (filename,page_size,dimensions);
+        tree_t *const tree = new_rtree (filename,page_size,dimensions,false);
 
         while (partial_result->size) {
                 data_pair_t *const data_pair = remove_tail_of_queue (partial_result);
@@ -1,8 +1,24 @@
 #ifndef __QPROCESSOR_H__
 #define __QPROCESSOR_H__
 
-int process_rest_request (char const json[], char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter, request_t const type);
-char* qprocessor (char command[], char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter, int fd);
+/* default degree of intra-query parallelism */
+extern uint32_t PARALLELISM;
+
+/* default memory in bytes for the results of a join before they are spilled to disk */
+extern uint64_t MEMORY_LIMIT;
+
+/* bytes of responses kept for repeated queries */
+extern uint64_t CACHE_LIMIT;
+
+/* milliseconds after which requests are logged with what they cost, unless zero */
+extern uint64_t SLOW_QUERY_LIMIT;
+extern uint64_t SLOW_QUERY_RATE;
+
+int process_rest_request (char const json[], uint64_t const length, char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter, request_t const type);
+int process_bulk_request (char const heapfile[], char const data[], uint64_t const length, char const folder[], char message[],
+			uint64_t *const io_blocks_counter, double *const io_mb_counter, writer_t *const output);
+void report_statistics (writer_t *const writer, boolean const as_text);
+char* qprocessor (char command[], char const folder[], char message[], uint64_t *const io_blocks_counter, double *const io_mb_counter, writer_t *const output, format_t const format);
 
 #endif
 
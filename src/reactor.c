@@ -0,0 +1,616 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <strings.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "reactor.h"
+#include "queue.h"
+#include "defs.h"
+
+
+static
+void set_blocking (int const fd, boolean const is_blocking) {
+	int const flags = fcntl (fd,F_GETFL,0);
+	if (flags < 0 || fcntl (fd,F_SETFL,is_blocking ? flags & ~O_NONBLOCK : flags | O_NONBLOCK) < 0) {
+		LOG (error,"[set_blocking()] Unable to change the blocking mode of file-descriptor %u.\n",fd);
+	}
+}
+
+static
+void delete_connection (connection_t *const connection) {
+	if (connection->session != NULL && connection->listener->end_session != NULL) {
+		connection->listener->end_session (connection->session);
+	}
+	close (connection->fd);
+	free (connection->buffer);
+	free (connection);
+}
+
+static
+time_t seconds_elapsed (void) {
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC,&now);
+	return now.tv_sec;
+}
+
+/**
+ * Waits on a connection for its next request, if any, which
+ * is then read by the reactor. Waiting connections are noted
+ * by their file-descriptors so that idle ones can be closed.
+ */
+static
+void watch_connection (reactor_t *const reactor, connection_t *const connection) {
+	pthread_mutex_lock (&reactor->waiting_lock);
+	if (connection->fd >= reactor->waiting_capacity) {
+		uint32_t const capacity = MAX(reactor->waiting_capacity<<1,connection->fd+1);
+		reactor->waiting = (connection_t**) realloc (reactor->waiting,sizeof(connection_t*)*capacity);
+		if (reactor->waiting == NULL) {
+			LOG (fatal,"[watch_connection()] Unable to allocate memory for %u waiting connections...\n",capacity);
+			exit (EXIT_FAILURE);
+		}
+		bzero (reactor->waiting+reactor->waiting_capacity,sizeof(connection_t*)*(capacity-reactor->waiting_capacity));
+		reactor->waiting_capacity = capacity;
+	}
+	connection->last_active = seconds_elapsed ();
+	reactor->waiting [connection->fd] = connection;
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = connection;
+	if (epoll_ctl (reactor->epoll_fd,EPOLL_CTL_ADD,connection->fd,&event)) {
+		LOG (error,"[watch_connection()] Unable to wait on file-descriptor %u.\n",connection->fd);
+		reactor->waiting [connection->fd] = NULL;
+		delete_connection (connection);
+	}
+	pthread_mutex_unlock (&reactor->waiting_lock);
+}
+
+static
+void unwatch_connection (reactor_t *const reactor, connection_t *const connection) {
+	pthread_mutex_lock (&reactor->waiting_lock);
+	reactor->waiting [connection->fd] = NULL;
+	epoll_ctl (reactor->epoll_fd,EPOLL_CTL_DEL,connection->fd,NULL);
+	pthread_mutex_unlock (&reactor->waiting_lock);
+}
+
+/**
+ * Closes the connections that have been waiting
+ * for a request for longer than the idle timeout.
+ */
+static
+void close_idle_connections (reactor_t *const reactor) {
+	time_t const now = seconds_elapsed ();
+	pthread_mutex_lock (&reactor->waiting_lock);
+	for (uint32_t fd=0; fd<reactor->waiting_capacity; ++fd) {
+		connection_t *const connection = reactor->waiting [fd];
+		if (connection != NULL && now - connection->last_active >= reactor->idle_timeout) {
+			LOG (info,"[close_idle_connections()] Closing idle connection of file-descriptor %u.\n",fd);
+			reactor->waiting [fd] = NULL;
+			epoll_ctl (reactor->epoll_fd,EPOLL_CTL_DEL,fd,NULL);
+			delete_connection (connection);
+		}
+	}
+	pthread_mutex_unlock (&reactor->waiting_lock);
+}
+
+/**
+ * Where the body of a request begins, once its headers
+ * have been read in full, or else NULL.
+ */
+static
+char const* headers_end (char const buffer[]) {
+	for (char const* line = strchr (buffer,'\n'); line != NULL; line = strchr (line+1,'\n')) {
+		if (line[1] == '\n') return line + 2;
+		else if (line[1] == '\r' && line[2] == '\n') return line + 3;
+	}
+	return NULL;
+}
+
+/**
+ * The value of the first header of a request by the given name,
+ * if any, where the request is read up to where its body begins.
+ */
+static
+char const* find_header (char const buffer[], char const*const body, char const name[]) {
+	uint64_t const length = strlen (name);
+	for (char const* line = strchr (buffer,'\n'); line != NULL && line < body; line = strchr (line+1,'\n')) {
+		if (!strncasecmp (line+1,name,length) && line[1+length] == ':') {
+			char const* value = line + 2 + length;
+			while (*value == ' ' || *value == '\t') ++value;
+			return value;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * The length of a request once its headers have been read in full;
+ * i.e. that of its headers and of its body, if any, or else 0.
+ */
+static
+uint64_t request_length (char const buffer[]) {
+	char const*const body = headers_end (buffer);
+	if (body == NULL) {
+		return 0;
+	}
+	char const*const content_length = find_header (buffer,body,"content-length");
+	return (body - buffer) + (content_length != NULL ? strtoull (content_length,NULL,10) : 0);
+}
+
+/**
+ * Makes the buffer of a connection at least as large as the given
+ * capacity; if memory runs out, the buffer is left as it was.
+ */
+static
+boolean reserve_buffer (connection_t *const connection, uint64_t const capacity) {
+	if (connection->capacity < capacity) {
+		char *const buffer = (char*) realloc (connection->buffer,sizeof(char)*capacity);
+		if (buffer == NULL) {
+			LOG (error,"[reserve_buffer()] Unable to allocate memory for the request of file-descriptor %u...\n",connection->fd);
+			return false;
+		}
+		connection->buffer = buffer;
+		connection->capacity = capacity;
+	}
+	return true;
+}
+
+/**
+ * Answers a request that cannot be served with the given status,
+ * if it came over HTTP; its connection is to be closed after.
+ */
+static
+void reject_request (int const fd, listener_t const*const listener, char const status[]) {
+	if (listener->protocol == HTTP_PROTOCOL) {
+		char response [BUFSIZ];
+		int const length = snprintf (response,sizeof(response),"HTTP/1.1 %s\r\nConnection: close\r\nContent-Length: 0\r\n\r\n",status);
+		if (write (fd,response,length) < 0) {
+			LOG (warn,"[reject_request()] Unable to respond to file-descriptor %u.\n",fd);
+		}
+	}
+}
+
+/**
+ * The length of a framed request once the header of its frame has
+ * been read; i.e. that of the header and of its payload, or else 0.
+ */
+static
+uint64_t frame_length (char const buffer[], uint64_t const length) {
+	if (length < FRAME_HEADER_SIZE) {
+		return 0;
+	}
+	uint32_t payload_length;
+	memcpy (&payload_length,buffer,sizeof(uint32_t));
+	return FRAME_HEADER_SIZE + (uint64_t) le32toh (payload_length);
+}
+
+/**
+ * Once the headers of a request are read, its length is noted, so
+ * that its body is read in place as the buffer grows to fit it.
+ * Clients waiting for the server to accept their bodies are told
+ * to go on, unless their requests exceed the size limit.
+ */
+static
+void expect_request (connection_t *const connection) {
+	if (connection->listener->protocol == FRAMED_PROTOCOL) {
+		connection->expected_length = frame_length (connection->buffer,connection->length);
+		return;
+	}
+
+	char const*const body = headers_end (connection->buffer);
+	if (body == NULL || body - connection->buffer > HEADERS_SIZE_LIMIT) {
+		return;
+	}
+
+	connection->expected_length = request_length (connection->buffer);
+	if (connection->expected_length > REQUEST_SIZE_LIMIT) {
+		return;
+	}
+
+	char const*const expect = find_header (connection->buffer,body,"expect");
+	if (connection->length < connection->expected_length && expect != NULL && !strncasecmp (expect,"100-continue",12)) {
+		char const interim[] = "HTTP/1.1 100 Continue\r\n\r\n";
+		if (write (connection->fd,interim,sizeof(interim)-1) < 0) {
+			LOG (warn,"[expect_request()] Unable to let file-descriptor %u send its request body.\n",connection->fd);
+		}
+	}
+}
+
+/**
+ * Whether the headers of the next request of a connection are yet to
+ * end after as many bytes as their limit, regardless of its body.
+ */
+static
+boolean has_oversized_headers (connection_t const*const connection) {
+	return connection->listener->protocol == HTTP_PROTOCOL
+		&& !connection->expected_length && connection->length > HEADERS_SIZE_LIMIT;
+}
+
+/**
+ * Queues a complete request for the workers, waiting
+ * for one of them to take a pending request if full.
+ */
+static
+void dispatch_request (reactor_t *const reactor, connection_t *const connection) {
+	pthread_mutex_lock (&reactor->lock);
+	while (reactor->requests->size >= reactor->capacity) {
+		LOG (warn,"[dispatch_request()] All %u request slots are taken; waiting for a worker...\n",reactor->capacity);
+		pthread_cond_wait (&reactor->not_full,&reactor->lock);
+	}
+	insert_at_tail_of_queue (reactor->requests,connection);
+	pthread_cond_signal (&reactor->not_empty);
+	pthread_mutex_unlock (&reactor->lock);
+}
+
+static
+void accept_connections (reactor_t *const reactor, listener_t const*const listener) {
+	for (;;) {
+		struct sockaddr_storage remote_address;
+		socklen_t address_length = sizeof (remote_address);
+		int const fd = accept (listener->fd,(struct sockaddr*)&remote_address,&address_length);
+		if (fd < 0) {
+			if (errno == EINTR) continue;
+			else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				LOG (error,"[accept_connections()] Error while accepting new connection...\n");
+			}
+			return;
+		}
+		set_blocking (fd,false);
+		if (remote_address.ss_family == AF_INET) {
+			LOG (info,"[accept_connections()] Server accepted new connection from '%s'.\n",inet_ntoa(((struct sockaddr_in*)&remote_address)->sin_addr));
+
+			/* responses are sent as soon as written, since the next request may be waiting on them */
+			int const no_delay = 1;
+			setsockopt (fd,IPPROTO_TCP,TCP_NODELAY,&no_delay,sizeof(no_delay));
+		}else{
+			LOG (info,"[accept_connections()] Server accepted new local connection.\n");
+		}
+
+		connection_t *const connection = (connection_t *const) malloc (sizeof(connection_t));
+		char *const buffer = (char*) malloc (sizeof(char)*CONNECTION_BUFFER_SIZE);
+		if (connection == NULL || buffer == NULL) {
+			LOG (error,"[accept_connections()] Unable to allocate memory for new connection...\n");
+			free (connection);
+			free (buffer);
+			reject_request (fd,listener,"503 Service Unavailable");
+			close (fd);
+			continue;
+		}
+		connection->fd = fd;
+		connection->listener = listener;
+		connection->session = NULL;
+		connection->length = 0;
+		connection->expected_length = 0;
+		connection->capacity = CONNECTION_BUFFER_SIZE;
+		connection->buffer = buffer;
+		*connection->buffer = '\0';
+
+		watch_connection (reactor,connection);
+	}
+}
+
+/**
+ * Reads whatever is available from a connection and dispatches
+ * it once its next request is complete, along with any requests
+ * pipelined after it. The buffer doubles as bytes arrive, though
+ * never beyond the length of the request expected. Connections
+ * closed beforehand are dropped, while requests exceeding the
+ * size limit or the memory available are rejected.
+ */
+static
+void read_connection (reactor_t *const reactor, connection_t *const connection) {
+	boolean is_closed = false;
+	boolean is_out_of_memory = false;
+	for (;;) {
+		if (connection->capacity - connection->length < BUFSIZ
+			&& (connection->expected_length <= connection->length || connection->capacity <= connection->expected_length)) {
+			uint64_t const capacity = connection->expected_length > connection->length ?
+						MIN(connection->capacity<<1,connection->expected_length+1) : connection->capacity<<1;
+			if (!reserve_buffer (connection,capacity)) {
+				is_out_of_memory = true;
+				break;
+			}
+		}
+
+		ssize_t const bytes_read = read (connection->fd,connection->buffer+connection->length,connection->capacity-connection->length-1);
+		if (bytes_read > 0) {
+			connection->length += bytes_read;
+			connection->buffer [connection->length] = '\0';
+			connection->last_active = seconds_elapsed ();
+			if (!connection->expected_length) {
+				expect_request (connection);
+				if (has_oversized_headers (connection) || connection->expected_length > REQUEST_SIZE_LIMIT) {
+					break;
+				}
+			}
+		}else if (bytes_read < 0 && errno == EINTR) {
+			continue;
+		}else if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+			break;
+		}else{
+			is_closed = true;
+			break;
+		}
+	}
+
+	uint64_t const length = connection->expected_length;
+	if (has_oversized_headers (connection)) {
+		LOG (warn,"[read_connection()] Headers of the request of file-descriptor %u exceed %u bytes.\n",connection->fd,HEADERS_SIZE_LIMIT);
+		unwatch_connection (reactor,connection);
+		reject_request (connection->fd,connection->listener,"431 Request Header Fields Too Large");
+		delete_connection (connection);
+	}else if (length > REQUEST_SIZE_LIMIT || connection->length > REQUEST_SIZE_LIMIT) {
+		LOG (error,"[read_connection()] Request of file-descriptor %u exceeds %u bytes.\n",connection->fd,REQUEST_SIZE_LIMIT);
+		unwatch_connection (reactor,connection);
+		reject_request (connection->fd,connection->listener,"413 Payload Too Large");
+		delete_connection (connection);
+	}else if (is_out_of_memory) {
+		unwatch_connection (reactor,connection);
+		reject_request (connection->fd,connection->listener,"503 Service Unavailable");
+		delete_connection (connection);
+	}else if (length && connection->length >= length) {
+		unwatch_connection (reactor,connection);
+		set_blocking (connection->fd,true);
+		dispatch_request (reactor,connection);
+	}else if (is_closed) {
+		LOG (info,"[read_connection()] Connection of file-descriptor %u was closed before a request was read.\n",connection->fd);
+		unwatch_connection (reactor,connection);
+		delete_connection (connection);
+	}
+}
+
+/**
+ * Serves the complete requests of a connection in the order
+ * they were sent, and waits on it for more if it is kept alive.
+ */
+static
+void serve_connection (reactor_t *const reactor, connection_t *const connection) {
+	boolean keep_alive = true;
+	for (uint64_t length = connection->expected_length;
+			keep_alive && length && connection->length >= length;
+			length = connection->expected_length) {
+		char const next = connection->buffer [length];
+		connection->buffer [length] = '\0';
+		keep_alive = connection->listener->handler (connection->fd,connection->buffer,length,&connection->session,connection->listener->args);
+		connection->buffer [length] = next;
+
+		connection->length -= length;
+		memmove (connection->buffer,connection->buffer+length,connection->length+1);
+		connection->expected_length = 0;
+		expect_request (connection);
+	}
+
+	if (keep_alive) {
+		/* a buffer that fails to shrink is simply kept as large as it is */
+		if (connection->capacity > CONNECTION_BUFFER_SIZE && MAX(connection->length,connection->expected_length) < CONNECTION_BUFFER_SIZE) {
+			char *const buffer = (char*) realloc (connection->buffer,sizeof(char)*CONNECTION_BUFFER_SIZE);
+			if (buffer != NULL) {
+				connection->buffer = buffer;
+				connection->capacity = CONNECTION_BUFFER_SIZE;
+			}
+		}
+		set_blocking (connection->fd,false);
+		watch_connection (reactor,connection);
+	}else{
+		delete_connection (connection);
+	}
+}
+
+static
+void* reactor_worker (void* args) {
+	reactor_t *const reactor = (reactor_t *const) args;
+
+	pthread_mutex_lock (&reactor->lock);
+	while (!reactor->is_shutdown) {
+		if (reactor->requests->size) {
+			connection_t *const connection = remove_head_of_queue (reactor->requests);
+			pthread_cond_signal (&reactor->not_full);
+			++reactor->active_workers;
+			pthread_mutex_unlock (&reactor->lock);
+
+			serve_connection (reactor,connection);
+
+			pthread_mutex_lock (&reactor->lock);
+			--reactor->active_workers;
+		}else{
+			pthread_cond_wait (&reactor->not_empty,&reactor->lock);
+		}
+	}
+	pthread_mutex_unlock (&reactor->lock);
+
+	return NULL;
+}
+
+
+reactor_t* new_reactor (uint32_t const workers_number, uint32_t const capacity, uint32_t const idle_timeout) {
+	reactor_t *const reactor = (reactor_t *const) malloc (sizeof(reactor_t));
+	if (reactor == NULL) {
+		LOG (fatal,"[new_reactor()] Unable to allocate memory for new reactor...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	reactor->epoll_fd = epoll_create1 (0);
+	if (reactor->epoll_fd < 0) {
+		LOG (fatal,"[new_reactor()] Unable to create epoll instance...\n");
+		exit (EXIT_FAILURE);
+	}
+	reactor->listeners_number = 0;
+
+	reactor->requests = new_queue();
+	reactor->capacity = capacity;
+	reactor->is_shutdown = false;
+	reactor->active_workers = 0;
+
+	reactor->waiting = NULL;
+	reactor->waiting_capacity = 0;
+	reactor->idle_timeout = idle_timeout;
+	pthread_mutex_init (&reactor->waiting_lock,NULL);
+
+	pthread_mutex_init (&reactor->lock,NULL);
+	pthread_cond_init (&reactor->not_empty,NULL);
+	pthread_cond_init (&reactor->not_full,NULL);
+
+	reactor->workers = (pthread_t*) malloc (workers_number*sizeof(pthread_t));
+	if (reactor->workers == NULL) {
+		LOG (fatal,"[new_reactor()] Unable to allocate memory for %u workers...\n",workers_number);
+		exit (EXIT_FAILURE);
+	}
+	reactor->workers_number = workers_number;
+
+	pthread_attr_t attr;
+	pthread_attr_init (&attr);
+	pthread_attr_setstacksize (&attr,THREAD_STACK_SIZE);
+	for (register uint32_t i=0; i<workers_number; ++i) {
+		if (pthread_create (reactor->workers+i,&attr,&reactor_worker,reactor)) {
+			LOG (fatal,"[new_reactor()] Unable to create worker thread %u...\n",i);
+			exit (EXIT_FAILURE);
+		}
+	}
+	pthread_attr_destroy (&attr);
+
+	return reactor;
+}
+
+void delete_reactor (reactor_t *const reactor) {
+	pthread_mutex_lock (&reactor->lock);
+	reactor->is_shutdown = true;
+	pthread_cond_broadcast (&reactor->not_empty);
+	pthread_mutex_unlock (&reactor->lock);
+
+	for (register uint32_t i=0; i<reactor->workers_number; ++i) {
+		pthread_join (reactor->workers[i],NULL);
+	}
+
+	while (reactor->requests->size) {
+		delete_connection (remove_head_of_queue (reactor->requests));
+	}
+	delete_queue (reactor->requests);
+	free (reactor->workers);
+
+	for (uint32_t fd=0; fd<reactor->waiting_capacity; ++fd) {
+		if (reactor->waiting[fd] != NULL) {
+			delete_connection (reactor->waiting[fd]);
+		}
+	}
+	free (reactor->waiting);
+	pthread_mutex_destroy (&reactor->waiting_lock);
+
+	pthread_mutex_destroy (&reactor->lock);
+	pthread_cond_destroy (&reactor->not_empty);
+	pthread_cond_destroy (&reactor->not_full);
+
+	close (reactor->epoll_fd);
+	free (reactor);
+}
+
+/**
+ * Connections of a listening socket are accepted once the reactor
+ * runs; their requests are read as the protocol given dictates and
+ * are served by the handler given, which may keep a session for each
+ * connection that is ended along with it.
+ */
+void listen_reactor (reactor_t *const reactor, int const listen_fd, protocol_t const protocol,
+			request_handler_t const handler, void (*end_session) (void *const), void *const args) {
+	if (reactor->listeners_number == REACTOR_LISTENERS) {
+		LOG (error,"[listen_reactor()] Unable to listen on more than %u sockets.\n",REACTOR_LISTENERS);
+		return;
+	}
+	listener_t *const listener = reactor->listeners + reactor->listeners_number;
+	listener->fd = listen_fd;
+	listener->protocol = protocol;
+	listener->handler = handler;
+	listener->end_session = end_session;
+	listener->args = args;
+
+	set_blocking (listen_fd,false);
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = listener;
+	if (epoll_ctl (reactor->epoll_fd,EPOLL_CTL_ADD,listen_fd,&event)) {
+		LOG (error,"[listen_reactor()] Unable to wait on listening file-descriptor %u.\n",listen_fd);
+		return;
+	}
+	reactor->listeners_number++;
+}
+
+/**
+ * Reports how many requests are waiting for a worker and
+ * how many workers are busy serving one.
+ */
+void measure_reactor (reactor_t *const reactor, uint64_t *const queued, uint32_t *const active) {
+	pthread_mutex_lock (&reactor->lock);
+	*queued = reactor->requests->size;
+	*active = reactor->active_workers;
+	pthread_mutex_unlock (&reactor->lock);
+}
+
+/**
+ * The listener whose socket an event was for,
+ * or else NULL if it was for a connection.
+ */
+static
+listener_t const* find_listener (reactor_t const*const reactor, void const*const ptr) {
+	for (uint32_t i=0; i<reactor->listeners_number; ++i) {
+		if (ptr == reactor->listeners+i) {
+			return reactor->listeners+i;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Accepts and reads connections of the listening sockets until
+ * waiting on them fails; requests are served meanwhile, while
+ * idle connections are looked for about once every second.
+ */
+void run_reactor (reactor_t *const reactor) {
+	signal (SIGPIPE,SIG_IGN);
+
+	time_t last_sweep = seconds_elapsed ();
+	struct epoll_event events [REACTOR_EVENTS];
+	for (;;) {
+		int const ready = epoll_wait (reactor->epoll_fd,events,REACTOR_EVENTS,1000);
+		if (ready < 0) {
+			if (errno == EINTR) continue;
+			LOG (error,"[run_reactor()] Error while waiting on connections...\n");
+			return;
+		}
+
+		for (register int i=0; i<ready; ++i) {
+			listener_t const*const listener = find_listener (reactor,events[i].data.ptr);
+			if (listener != NULL) {
+				accept_connections (reactor,listener);
+			}else{
+				read_connection (reactor,events[i].data.ptr);
+			}
+		}
+
+		if (seconds_elapsed () != last_sweep) {
+			close_idle_connections (reactor);
+			last_sweep = seconds_elapsed ();
+		}
+	}
+}
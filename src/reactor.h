@@ -0,0 +1,15 @@
+#ifndef REACTOR_H_
+#define REACTOR_H_
+
+#include "defs.h"
+
+reactor_t* new_reactor (uint32_t const workers_number, uint32_t const capacity, uint32_t const idle_timeout);
+void delete_reactor (reactor_t *const reactor);
+
+void listen_reactor (reactor_t *const reactor, int const listen_fd, protocol_t const protocol,
+			request_handler_t const handler, void (*end_session) (void *const), void *const args);
+void run_reactor (reactor_t *const reactor);
+
+void measure_reactor (reactor_t *const reactor, uint64_t *const queued, uint32_t *const active);
+
+#endif /* REACTOR_H_ */
@@ -46,6 +46,15 @@ void print_box (boolean stream,tree_t const*const tree, interval_t* box) {
 	fprintf(stream?stderr:stdout,".\n",tree->filename);
 }
 
+static
+void append_internal_entry (tree_t const*const tree, page_t *const page, page_t const*const source, uint32_t const offset) {
+	memcpy (page->node.internal.BOX(page->header.records),source->node.internal.BOX(offset),tree->dimensions*sizeof(interval_t));
+	if (tree->is_aggregate) {
+		page->node.internal.counts[page->header.records] = source->node.internal.counts[offset];
+	}
+	page->header.records++;
+}
+
 /*
 static
 int truncate_heapfile (tree_t const*const tree) {
@@ -109,17 +118,25 @@ tree_t* load_rtree (char const filename[]) {
 		close (fd);
 		exit (EXIT_FAILURE);
 	}
+	uint16_t flags = 0;
+	if (read (fd,&flags,sizeof(uint16_t)) < sizeof(uint16_t)) {
+		flags = 0;
+	}
 	close (fd);
 
 	tree->dimensions = le16toh(tree->dimensions);
 	tree->page_size = le32toh(tree->page_size);
 	tree->tree_size = le64toh(tree->tree_size);
 	tree->indexed_records = le64toh(tree->indexed_records);
+	tree->is_aggregate = le16toh(flags) & AGGREGATE_TREE_FLAG ? true : false;
 
 	tree->io_counter = 0;
+	bzero (&tree->stats,sizeof(tree_stats_t));
+	tree->version = 0;
 	tree->is_dirty = false;
 
-	tree->internal_entries = (tree->page_size-sizeof(header_t)) / (sizeof(interval_t)*tree->dimensions);
+	tree->internal_entries = (tree->page_size-sizeof(header_t))
+				/ (sizeof(interval_t)*tree->dimensions + (tree->is_aggregate?sizeof(uint64_t):0));
 	tree->leaf_entries = (tree->page_size-sizeof(header_t)) / (sizeof(index_t)*tree->dimensions + sizeof(object_t));
 
 
@@ -156,7 +173,7 @@ tree_t* load_rtree (char const filename[]) {
 	return tree;
 }
 
-tree_t* new_rtree (char const filename[], uint32_t const page_size, uint32_t const dimensions) {
+tree_t* new_rtree (char const filename[], uint32_t const page_size, uint32_t const dimensions, boolean const is_aggregate) {
 	umask ( S_IRWXO | S_IWGRP);
 	tree_t *const tree = (tree_t *const) malloc (sizeof(tree_t));
 	if (tree == NULL) {
@@ -173,6 +190,7 @@ tree_t* new_rtree (char const filename[], uint32_t const page_size, uint32_t con
 		tree->page_size = page_size;
 		tree->indexed_records = 0;
 		tree->tree_size = 0;
+		tree->is_aggregate = is_aggregate;
 	}else{
 		lseek (fd,0,SEEK_SET);
 		if (read (fd,&tree->dimensions,sizeof(uint16_t)) < sizeof(uint16_t)) {
@@ -191,18 +209,26 @@ tree_t* new_rtree (char const filename[], uint32_t const page_size, uint32_t con
 			LOG (fatal,"[%s][new_rtree()] Read less than %lu bytes from heapfile '%s'...\n",tree->filename,sizeof(uint64_t),filename);
 			abort();
 		}
+		uint16_t flags = 0;
+		if (read (fd,&flags,sizeof(uint16_t)) < sizeof(uint16_t)) {
+			flags = 0;
+		}
 		close (fd);
 
 		tree->dimensions = le16toh(tree->dimensions);
 		tree->page_size = le32toh(tree->page_size);
 		tree->tree_size = le64toh(tree->tree_size);
 		tree->indexed_records = le64toh(tree->indexed_records);
+		tree->is_aggregate = le16toh(flags) & AGGREGATE_TREE_FLAG ? true : false;
 
 		tree->is_dirty = false;
 	}
 
 	tree->io_counter = 0;
-	tree->internal_entries = (tree->page_size-sizeof(header_t)) / (sizeof(interval_t)*tree->dimensions);
+	bzero (&tree->stats,sizeof(tree_stats_t));
+	tree->version = 0;
+	tree->internal_entries = (tree->page_size-sizeof(header_t))
+				/ (sizeof(interval_t)*tree->dimensions + (tree->is_aggregate?sizeof(uint64_t):0));
 	tree->leaf_entries = (tree->page_size-sizeof(header_t)) / (sizeof(index_t)*tree->dimensions + sizeof(object_t));
 
 	LOG (info,"[%s][new_rtree()] Configuration uses blocks of %u bytes.\n",filename,tree->page_size);
@@ -244,6 +270,7 @@ uint64_t split_internal (tree_t *const tree, uint64_t pos, fifo_t *const incepti
 
 static
 uint64_t halve_internal (tree_t *const tree, uint64_t position, fifo_t *const inception_queue) {
+	COUNT_EVENT(tree,splits);
 	if (verbose_splits) {
 		puts ("==============================================================");
 	}
@@ -368,7 +395,7 @@ uint64_t halve_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 		index_t lo_hi_bound = ((box_container_t const*const)peek_priority_queue (lo_priority_queue))->box[j].end;
 		while (lo_priority_queue->size > (overloaded_page->header.records>>1)) {
 			box_container_t const*const top = (box_container_t const*const) remove_from_priority_queue (lo_priority_queue);
-			memcpy(lo_lo_page->node.internal.BOX(lo_lo_page->header.records++),top->box,tree->dimensions*sizeof(interval_t));
+			append_internal_entry (tree,lo_lo_page,overloaded_page,top->id);
 			if (top->box[j].end > lo_hi_bound) lo_hi_bound = top->box[j].end;
 			insert_into_stack (lo_lo_pages,top->id);
 			free (top);
@@ -379,7 +406,7 @@ uint64_t halve_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 		index_t lo_lo_bound = ((box_container_t const*const)peek_priority_queue (lo_priority_queue))->box[j].start;
 		while (lo_priority_queue->size) {
 			box_container_t const*const top = (box_container_t const*const) remove_from_priority_queue (lo_priority_queue);
-			memcpy(lo_hi_page->node.internal.BOX(lo_hi_page->header.records++),top->box,tree->dimensions*sizeof(interval_t));
+			append_internal_entry (tree,lo_hi_page,overloaded_page,top->id);
 			if (top->box[j].start < lo_lo_bound) lo_lo_bound = top->box[j].start;
 			insert_into_stack (lo_hi_pages,top->id);
 			free (top);
@@ -392,7 +419,7 @@ uint64_t halve_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 		index_t hi_hi_bound = ((box_container_t const*const)peek_priority_queue (hi_priority_queue))->box[j].end;
 		while (hi_priority_queue->size > (overloaded_page->header.records>>1)) {
 			box_container_t const*const top = (box_container_t const*const) remove_from_priority_queue (hi_priority_queue);
-			memcpy (hi_lo_page->node.internal.BOX(hi_lo_page->header.records++),top->box,tree->dimensions*sizeof(interval_t));
+			append_internal_entry (tree,hi_lo_page,overloaded_page,top->id);
 			if (top->box[j].end > hi_hi_bound) hi_hi_bound = top->box[j].end;
 			insert_into_stack (hi_lo_pages,top->id);
 			free (top);
@@ -403,7 +430,7 @@ uint64_t halve_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 		index_t hi_lo_bound = ((box_container_t const*const)peek_priority_queue (hi_priority_queue))->box[j].start;
 		while (hi_priority_queue->size) {
 			box_container_t const*const top = (box_container_t const*const) remove_from_priority_queue (hi_priority_queue);
-			memcpy (hi_hi_page->node.internal.BOX(hi_hi_page->header.records++),top->box,tree->dimensions*sizeof(interval_t));
+			append_internal_entry (tree,hi_hi_page,overloaded_page,top->id);
 			if (top->box[j].start < hi_lo_bound) hi_lo_bound = top->box[j].start;
 			insert_into_stack (hi_hi_pages,top->id);
 			free (top);
@@ -666,6 +693,11 @@ uint64_t halve_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 		}
 	}
 
+	if (tree->is_aggregate) {
+		parent->node.internal.counts[lo_offset] = subtree_records (tree,lo_page);
+		parent->node.internal.counts[hi_offset] = subtree_records (tree,hi_page);
+	}
+
 	if (verbose_splits) {
 		print_box(false,tree,parent->node.internal.BOX(lo_offset));
 		print_box(false,tree,parent->node.internal.BOX(hi_offset));
@@ -758,6 +790,7 @@ uint64_t halve_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 
 static
 uint64_t split_internal (tree_t *const tree, uint64_t position, fifo_t *const inception_queue) {
+	COUNT_EVENT(tree,splits);
 	if (verbose_splits) {
 		puts ("==============================================================");
 	}
@@ -965,7 +998,7 @@ uint64_t split_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 			old_child = CHILD_ID(position,i);
 			if (box_ptr[splitdim].end <= splitzone.start) {
 				new_child = new_id = CHILD_ID(position,lo_page->header.records);
-				memcpy(lo_page->node.internal.BOX(lo_page->header.records++),box_ptr,tree->dimensions*sizeof(interval_t));
+				append_internal_entry (tree,lo_page,overloaded_page,i);
 				LOG (info,"[%s][split_internal()] Block with id %lu is now under %lu with new id %lu.\n",tree->filename,old_child,position,new_id);
 				if (!update_flag && inception == old_child) {
 					insert_at_head_of_queue (inception_queue,new_id);
@@ -993,7 +1026,7 @@ uint64_t split_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 				delete_queue (tmp_queue);
 			}else if (box_ptr[splitdim].start >= splitzone.end) {
 				new_child = new_id = CHILD_ID(hi_id,hi_page->header.records);
-				memcpy(hi_page->node.internal.BOX(hi_page->header.records++),box_ptr,tree->dimensions*sizeof(interval_t));
+				append_internal_entry (tree,hi_page,overloaded_page,i);
 				LOG (info,"[%s][split_internal()] Block with id %lu is now under %lu with new id %lu.\n",tree->filename,old_child,hi_id,new_id);
 				if (!update_flag && inception == old_child) {
 					insert_at_head_of_queue (inception_queue,new_id);
@@ -1048,11 +1081,10 @@ uint64_t split_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 			while (hi_page->header.records+hi_overlap->size < fairness_threshold*(tree->internal_entries>>1)) {
 				box_container_t *const box_container =  (box_container_t *const) remove_from_priority_queue (lo_overlap->size?lo_overlap:hi_overlap);
 				old_child = CHILD_ID(position,box_container->id);
-				interval_t* box_ptr = box_container->box;
 				free (box_container);
 
 				new_child = new_id = CHILD_ID(hi_id,hi_page->header.records);
-				memcpy(hi_page->node.internal.BOX(hi_page->header.records++),box_ptr,tree->dimensions*sizeof(interval_t));
+				append_internal_entry (tree,hi_page,overloaded_page,CHILD_OFFSET(old_child));
 				LOG (info,"[%s][split_internal()] Block with id %lu is now under %lu with new id %lu.\n",tree->filename,old_child,hi_id,new_id);
 				if (!update_flag && inception == old_child) {
 					insert_at_head_of_queue (inception_queue,new_id);
@@ -1084,11 +1116,10 @@ uint64_t split_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 			while (lo_page->header.records+lo_overlap->size < fairness_threshold*(tree->internal_entries>>1)) {
 				box_container_t *const box_container =  (box_container_t *const) remove_from_priority_queue (hi_overlap->size?hi_overlap:lo_overlap);
 				old_child = CHILD_ID(position,box_container->id);
-				interval_t* box_ptr = box_container->box;
 				free (box_container);
 
 				new_child = new_id = CHILD_ID(position,lo_page->header.records);
-				memcpy(lo_page->node.internal.BOX(lo_page->header.records++),box_ptr,tree->dimensions*sizeof(interval_t));
+				append_internal_entry (tree,lo_page,overloaded_page,CHILD_OFFSET(old_child));
 				LOG (info,"[%s][split_internal()] Block with id %lu is now under %lu with new id %lu.\n",tree->filename,old_child,position,new_id);
 				if (!update_flag && inception == old_child) {
 					insert_at_head_of_queue (inception_queue,new_id);
@@ -1120,11 +1151,10 @@ uint64_t split_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 		while (lo_overlap->size) {
 			box_container_t *const box_container = (box_container_t *const) remove_from_priority_queue (lo_overlap);
 			old_child = CHILD_ID(position,box_container->id);
-			interval_t* box_ptr = box_container->box;
 			free (box_container);
 
 			new_child = new_id = CHILD_ID(position,lo_page->header.records);
-			memcpy(lo_page->node.internal.BOX(lo_page->header.records++),box_ptr,tree->dimensions*sizeof(interval_t));
+			append_internal_entry (tree,lo_page,overloaded_page,CHILD_OFFSET(old_child));
 			LOG (info,"[%s][split_internal()] Block with id %lu is now under %lu with new id %lu.\n",tree->filename,old_child,position,new_id);
 			if (!update_flag && inception == old_child) {
 				insert_at_head_of_queue (inception_queue,new_id);
@@ -1155,11 +1185,10 @@ uint64_t split_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 		while (hi_overlap->size) {
 			box_container_t *const box_container = (box_container_t *const) remove_from_priority_queue (hi_overlap);
 			old_child = CHILD_ID(position,box_container->id);
-			interval_t* box_ptr = box_container->box;
 			free (box_container);
 
 			new_child = new_id = CHILD_ID(hi_id,hi_page->header.records);
-			memcpy(hi_page->node.internal.BOX(hi_page->header.records++),box_ptr,tree->dimensions*sizeof(interval_t));
+			append_internal_entry (tree,hi_page,overloaded_page,CHILD_OFFSET(old_child));
 			LOG (info,"[%s][split_internal()] Block with id %lu is now under %lu with new id %lu.\n",tree->filename,old_child,hi_id,new_id);
 			if (!update_flag && inception == old_child) {
 				insert_at_head_of_queue (inception_queue,new_id);
@@ -1266,6 +1295,10 @@ uint64_t split_internal (tree_t *const tree, uint64_t position, fifo_t *const in
 					parent->node.internal.INTERVALS(hi_offset,j).end = hi_page->node.internal.INTERVALS(i,j).end;
 			}
 		}
+		if (tree->is_aggregate) {
+			parent->node.internal.counts[lo_offset] = subtree_records (tree,lo_page);
+			parent->node.internal.counts[hi_offset] = subtree_records (tree,hi_page);
+		}
 		parent->header.is_dirty = true;
 		parent->header.records++;
 
@@ -1387,6 +1420,7 @@ index_t expansion_volume (index_t const key[], interval_t const box[], uint32_t
 
 static
 uint64_t split_leaf (tree_t *const tree, uint64_t position, index_t const key[]) {
+	COUNT_EVENT(tree,splits);
 	uint64_t parent_id = PARENT_ID(position);
 
 	load_page_return_pair_t *load_pair = load_page (tree,parent_id);
@@ -1585,6 +1619,10 @@ uint64_t split_leaf (tree_t *const tree, uint64_t position, index_t const key[])
 
 		free (top);
 	}
+	if (tree->is_aggregate) {
+		parent->node.internal.counts[lo_offset] = lo_page->header.records;
+		parent->node.internal.counts[hi_offset] = hi_page->header.records;
+	}
 	parent->header.is_dirty = true;
 	parent->header.records++;
 
@@ -1767,6 +1805,7 @@ object_t delete_from_rtree (tree_t *const tree, index_t const key[]) {
 
 					pthread_rwlock_wrlock (&tree->tree_lock);
 					tree->indexed_records--;
+					tree->version++;
 					pthread_rwlock_unlock (&tree->tree_lock);
 
 
@@ -1784,6 +1823,7 @@ object_t delete_from_rtree (tree_t *const tree, index_t const key[]) {
 						pthread_rwlock_unlock (page_lock);
 
 						update_upwards(tree,page_id);
+						update_counts(tree,page_id);
 					}
 
 					delete_stack (browse);
@@ -1844,12 +1884,12 @@ void process_records_from_textfile (tree_t *const tree, char const filename[], b
 				}
 
 				if (logging <= info) {
-					fprintf (stderr,"%12lf ",(double)coordinates[i]);
+					log_append ("%12lf ",(double)coordinates[i]);
 				}
 			}
 
 			if (logging <= info) {
-				fprintf (stderr,").\n",tree->filename);
+				log_append (").\n");
 			}
 
 			uint64_t previous_records = tree->indexed_records;
@@ -1944,6 +1984,7 @@ void insert_into_rtree (tree_t *const tree, index_t const key[], object_t const
 	pthread_rwlock_wrlock (&tree->tree_lock);
 	tree->is_dirty = true;
 	tree->indexed_records++;
+	tree->version++;
 	pthread_rwlock_unlock (&tree->tree_lock);
 
 	uint64_t minload = 0xffffffffffffffff;
@@ -2080,6 +2121,7 @@ void insert_into_rtree (tree_t *const tree, index_t const key[], object_t const
 		pthread_rwlock_unlock (minleaf_lock);
 
 		if (!minpos) update_rootbox (tree);
+		else update_counts (tree,minpos);
 	}else{
 		expand:;
 		priority_queue_t* volume_expansion_priority_queue = new_priority_queue (&compare_expansion_dummy);
@@ -2168,6 +2210,8 @@ LOG (info,"[%s][insert_into_rtree()] DONE SPLIT FOR BLOCK WITH NEW ID %lu.\n",tr
 
 				pthread_rwlock_unlock (page_lock);
 
+				update_counts (tree,position);
+
 				for (uint64_t parent_id = PARENT_ID(position); position; parent_id = PARENT_ID(position)) {
 					load_page_return_pair_t *const load_pair = load_page (tree,parent_id);
 					pthread_rwlock_t *const parent_lock = load_pair->page_lock;
@@ -2249,3 +2293,254 @@ LOG (info,"[%s][insert_into_rtree()] DONE SPLIT FOR BLOCK WITH NEW ID %lu.\n",tr
 		}
 	}
 }
+
+
+typedef struct {
+	index_t coordinate;
+	uint64_t record;
+} tile_entry_t;
+
+static
+int compare_tile_entries (void const*const xcontainer, void const*const ycontainer) {
+	tile_entry_t const*const x = (tile_entry_t const*const) xcontainer;
+	tile_entry_t const*const y = (tile_entry_t const*const) ycontainer;
+	if (x->coordinate < y->coordinate) return -1;
+	else if (x->coordinate > y->coordinate) return 1;
+	else if (x->record < y->record) return -1;
+	else if (x->record > y->record) return 1;
+	else return 0;
+}
+
+/**
+ * Sort-Tile-Recursive partitioning of records into groups, whose bounds
+ * are given as offsets of their first entries. The entries of the groups
+ * given are sorted along the current dimension and cut into slabs of
+ * whole groups, each of which is tiled in turn along the next dimension.
+ */
+static
+void tile_records (tile_entry_t entries[], uint64_t const bounds[], uint64_t const first_group, uint64_t const groups,
+			index_t const keys[], uint32_t const dimensions, uint32_t const dimension) {
+	uint64_t const from = bounds[first_group];
+	uint64_t const to = bounds[first_group+groups];
+	if (groups < 2 || to-from < 2) {
+		return;
+	}
+
+	for (uint64_t i=from; i<to; ++i) {
+		entries[i].coordinate = keys[entries[i].record*dimensions+dimension];
+	}
+	qsort (entries+from,to-from,sizeof(tile_entry_t),&compare_tile_entries);
+
+	if (dimension+1 < dimensions) {
+		uint64_t slabs = ceil (pow (groups,1.0/(dimensions-dimension)));
+		if (slabs > groups) {
+			slabs = groups;
+		}
+		uint64_t group = first_group;
+		for (uint64_t s=0; s<slabs; ++s) {
+			uint64_t const slab_groups = groups/slabs + (s < groups%slabs ? 1 : 0);
+			tile_records (entries,bounds,group,slab_groups,keys,dimensions,dimension+1);
+			group += slab_groups;
+		}
+	}
+}
+
+/**
+ * Cuts the records given into as many groups of nearly equal size,
+ * tiled so that each one covers a compact region of the domain.
+ */
+static
+void tile_groups (tile_entry_t entries[], uint64_t bounds[], uint64_t const size, uint64_t const groups,
+			index_t const keys[], uint32_t const dimensions) {
+	for (uint64_t g=0; g<=groups; ++g) {
+		bounds[g] = g*size/groups;
+	}
+	tile_records (entries,bounds,0,groups,keys,dimensions,0);
+}
+
+static
+tile_entry_t* new_tile_entries (tree_t const*const tree, uint64_t const size) {
+	tile_entry_t *const entries = (tile_entry_t *const) malloc (sizeof(tile_entry_t)*(size?size:1));
+	if (entries == NULL) {
+		LOG (fatal,"[%s][new_tile_entries()] Unable to allocate memory for the order of %lu records...\n",tree->filename,size);
+		exit (EXIT_FAILURE);
+	}
+	for (uint64_t i=0; i<size; ++i) {
+		entries[i].record = i;
+	}
+	return entries;
+}
+
+
+typedef struct {
+	tree_t* tree;
+	index_t const* keys;
+	object_t const* objects;
+	tile_entry_t* entries;
+	uint64_t size;
+	uint64_t processed;
+	uint64_t pages;
+	progress_t progress;
+	void* args;
+} bulk_load_t;
+
+static
+void report_progress (bulk_load_t *const load, uint64_t const records) {
+	uint64_t const previous = load->processed;
+	load->processed += records;
+	if (load->progress != NULL && (previous/BULK_PROGRESS_INTERVAL != load->processed/BULK_PROGRESS_INTERVAL
+							|| load->processed == load->size)) {
+		load->progress (load->processed,load->size,load->args);
+	}
+}
+
+/**
+ * Writes directly to the heapfile the subtree of the height given
+ * rooted at the page given, which indexes the entries given, and
+ * sets the box enclosing them. Subtrees are tiled into as few pages
+ * as they fit, whose children are tiled in turn in the same way.
+ */
+static
+void pack_subtree (bulk_load_t *const load, tile_entry_t entries[], uint64_t const size,
+			uint64_t const page_id, uint32_t const height, interval_t box[]) {
+	tree_t *const tree = load->tree;
+	for (uint16_t j=0; j<tree->dimensions; ++j) {
+		box[j].start = INDEX_T_MAX;
+		box[j].end = -INDEX_T_MAX;
+	}
+
+	page_t* page = NULL;
+	if (!height) {
+		assert (size <= tree->leaf_entries);
+		page = new_leaf (tree);
+		for (uint64_t i=0; i<size; ++i) {
+			index_t const*const key = load->keys + entries[i].record*tree->dimensions;
+			insert_into_leaf (tree,page,key,load->objects[entries[i].record]);
+			for (uint16_t j=0; j<tree->dimensions; ++j) {
+				if (key[j] < box[j].start) box[j].start = key[j];
+				if (key[j] > box[j].end) box[j].end = key[j];
+			}
+		}
+		report_progress (load,size);
+	}else{
+		uint64_t capacity = tree->leaf_entries;
+		for (uint32_t h=1; h<height; ++h) {
+			capacity *= tree->internal_entries;
+		}
+		uint64_t const children = (size+capacity-1) / capacity;
+		assert (children <= tree->internal_entries);
+
+		uint64_t bounds [children+1];
+		tile_groups (entries,bounds,size,children,load->keys,tree->dimensions);
+
+		page = new_internal (tree);
+		for (uint32_t i=0; i<children; ++i) {
+			interval_t *const child_box = page->node.internal.BOX(i);
+			pack_subtree (load,entries+bounds[i],bounds[i+1]-bounds[i],CHILD_ID(page_id,i),height-1,child_box);
+			if (tree->is_aggregate) {
+				page->node.internal.counts[i] = bounds[i+1]-bounds[i];
+			}
+			for (uint16_t j=0; j<tree->dimensions; ++j) {
+				if (child_box[j].start < box[j].start) box[j].start = child_box[j].start;
+				if (child_box[j].end > box[j].end) box[j].end = child_box[j].end;
+			}
+			page->header.records++;
+		}
+	}
+
+	low_level_write_of_page_to_disk (tree,page,page_id);
+	delete_rtree_page (page);
+	load->pages++;
+}
+
+/**
+ * Builds an empty tree bottom-up out of the records given, instead of
+ * inserting them one by one. The records are tiled top-down into the
+ * fewest levels they fit in, and every page is written straight to the
+ * heapfile, so that none of them needs to be held in memory.
+ */
+void bulk_load_rtree (tree_t *const tree, index_t const keys[], object_t const objects[], uint64_t const size,
+			progress_t const progress, void *const args) {
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	uint64_t const indexed_records = tree->indexed_records;
+	pthread_rwlock_unlock (&tree->tree_lock);
+
+	if (indexed_records || tree->root_range != NULL) {
+		LOG (warn,"[%s][bulk_load_rtree()] Inserting in batch into non-empty tree instead.\n",tree->filename);
+		insert_batch_into_rtree (tree,keys,objects,size,progress,args);
+		return;
+	}else if (!size) {
+		return;
+	}
+
+	uint32_t height = 0;
+	for (uint64_t capacity = tree->leaf_entries; capacity < size; capacity *= tree->internal_entries) {
+		++height;
+	}
+	LOG (info,"[%s][bulk_load_rtree()] Bulk-loading %lu records into a tree of height %u.\n",tree->filename,size,height);
+
+	bulk_load_t load;
+	load.tree = tree;
+	load.keys = keys;
+	load.objects = objects;
+	load.entries = new_tile_entries (tree,size);
+	load.size = size;
+	load.processed = 0;
+	load.pages = 0;
+	load.progress = progress;
+	load.args = args;
+
+	interval_t box [tree->dimensions];
+	pack_subtree (&load,load.entries,size,0,height,box);
+	free (load.entries);
+
+	pthread_rwlock_wrlock (&tree->tree_lock);
+	page_t *const root = UNSET_PAGE (0);
+	pthread_rwlock_t *const root_lock = UNSET_LOCK (0);
+	UNSET_PRIORITY (0);
+
+	tree->tree_size = load.pages;
+	tree->indexed_records = size;
+	tree->is_dirty = true;
+	tree->version++;
+	pthread_rwlock_unlock (&tree->tree_lock);
+
+	if (root != NULL) {
+		delete_rtree_page (root);
+	}
+	if (root_lock != NULL) {
+		pthread_rwlock_destroy (root_lock);
+		free (root_lock);
+	}
+	update_rootbox (tree);
+
+	LOG (info,"[%s][bulk_load_rtree()] Done writing %lu blocks.\n",tree->filename,load.pages);
+}
+
+/**
+ * Inserts the records given one at a time, in the order given,
+ * reporting progress every BULK_PROGRESS_INTERVAL records.
+ */
+void insert_batch_into_rtree (tree_t *const tree, index_t const keys[], object_t const objects[], uint64_t const size,
+			progress_t const progress, void *const args) {
+	for (uint64_t i=0; i<size; ++i) {
+		insert_into_rtree (tree,keys+i*tree->dimensions,objects[i]);
+		if (progress != NULL && ((i+1) % BULK_PROGRESS_INTERVAL == 0 || i+1 == size)) {
+			progress (i+1,size,args);
+		}
+	}
+}
+
+/**
+ * Deletes the records indexed by the keys given one by one,
+ * reporting progress in the same way as batched insertions.
+ */
+void delete_batch_from_rtree (tree_t *const tree, index_t const keys[], uint64_t const size,
+			progress_t const progress, void *const args) {
+	for (uint64_t i=0; i<size; ++i) {
+		delete_from_rtree (tree,keys+i*tree->dimensions);
+		if (progress != NULL && ((i+1) % BULK_PROGRESS_INTERVAL == 0 || i+1 == size)) {
+			progress (i+1,size,args);
+		}
+	}
+}
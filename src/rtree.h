@@ -3,12 +3,16 @@
 
 #include "defs.h"
 
-tree_t* load_rtree (char const[]);
-tree_t* new_rtree (char const[], uint32_t const pagesize, uint32_t const dims);
+INDEXING_API tree_t* load_rtree (char const[]);
+INDEXING_API tree_t* new_rtree (char const[], uint32_t const pagesize, uint32_t const dims, boolean const aggregate);
 
 object_t delete_from_rtree (tree_t *const, index_t const[]);
 void insert_into_rtree (tree_t *const, index_t const[], object_t const);
 
+INDEXING_API void bulk_load_rtree (tree_t *const, index_t const keys[], object_t const objects[], uint64_t const size, progress_t const, void *const args);
+INDEXING_API void insert_batch_into_rtree (tree_t *const, index_t const keys[], object_t const objects[], uint64_t const size, progress_t const, void *const args);
+INDEXING_API void delete_batch_from_rtree (tree_t *const, index_t const keys[], uint64_t const size, progress_t const, void *const args);
+
 void insert_records_from_textfile (tree_t *const, char const[]);
 void delete_records_from_textfile (tree_t *const, char const[]);
 
@@ -0,0 +1,107 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "shared_ring.h"
+#include "defs.h"
+
+
+/**
+ * The region is created under a name of its own, which is removed
+ * right away; i.e. it is reached only through its file-descriptor,
+ * which is passed to the client, and is gone once both unmap it.
+ */
+shared_ring_t* new_shared_ring (uint64_t const capacity) {
+	static uint64_t rings_counter = 0;
+
+	char name [64];
+	snprintf (name,sizeof(name),"/indexing.%d.%lx",getpid(),__sync_fetch_and_add(&rings_counter,1));
+	int const fd = shm_open (name,O_RDWR|O_CREAT|O_EXCL,S_IRUSR|S_IWUSR);
+	if (fd < 0) {
+		LOG (error,"[new_shared_ring()] Unable to create shared memory '%s'.\n",name);
+		return NULL;
+	}
+	shm_unlink (name);
+
+	if (ftruncate (fd,SHARED_RING_HEADER_SIZE+capacity)) {
+		LOG (error,"[new_shared_ring()] Unable to reserve %lu bytes of shared memory.\n",SHARED_RING_HEADER_SIZE+capacity);
+		close (fd);
+		return NULL;
+	}
+	char *const region = (char *const) mmap (NULL,SHARED_RING_HEADER_SIZE+capacity,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+	if (region == MAP_FAILED) {
+		LOG (error,"[new_shared_ring()] Unable to map %lu bytes of shared memory.\n",SHARED_RING_HEADER_SIZE+capacity);
+		close (fd);
+		return NULL;
+	}
+
+	shared_ring_t *const ring = (shared_ring_t *const) malloc (sizeof(shared_ring_t));
+	if (ring == NULL) {
+		LOG (fatal,"[new_shared_ring()] Unable to allocate memory for new shared ring...\n");
+		exit (EXIT_FAILURE);
+	}
+	ring->fd = fd;
+	ring->region = region;
+	ring->capacity = capacity;
+	ring->is_announced = false;
+
+	memcpy (region,SHARED_RING_MAGIC,4);
+	*(uint64_t*)(region+SHARED_RING_CAPACITY_OFFSET) = capacity;
+	return ring;
+}
+
+void delete_shared_ring (shared_ring_t *const ring) {
+	munmap (ring->region,SHARED_RING_HEADER_SIZE+ring->capacity);
+	close (ring->fd);
+	free (ring);
+}
+
+/**
+ * Copies a payload given in segments to the tail of the ring, unless
+ * it would overwrite results the client is yet to consume. Returns
+ * whether it was placed, along with the position where it begins.
+ */
+boolean put_into_shared_ring (shared_ring_t *const ring, struct iovec const segments[], uint32_t const count,
+			uint64_t const length, uint64_t *const position) {
+	uint64_t *const head = (uint64_t *const) (ring->region+SHARED_RING_HEAD_OFFSET);
+	uint64_t *const tail = (uint64_t *const) (ring->region+SHARED_RING_TAIL_OFFSET);
+
+	uint64_t const start = *tail;
+	if (start + length - __atomic_load_n (head,__ATOMIC_ACQUIRE) > ring->capacity) {
+		return false;
+	}
+
+	char *const data = ring->region + SHARED_RING_HEADER_SIZE;
+	uint64_t offset = start % ring->capacity;
+	for (uint32_t i=0; i<count; ++i) {
+		char const* source = (char const*) segments[i].iov_base;
+		for (uint64_t remaining = segments[i].iov_len; remaining;) {
+			uint64_t const chunk = MIN(remaining,ring->capacity-offset);
+			memcpy (data+offset,source,chunk);
+			source += chunk;
+			remaining -= chunk;
+			offset = (offset + chunk) % ring->capacity;
+		}
+	}
+
+	__atomic_store_n (tail,start+length,__ATOMIC_RELEASE);
+	*position = start;
+	return true;
+}
@@ -0,0 +1,13 @@
+#ifndef SHARED_RING_H_
+#define SHARED_RING_H_
+
+#include <sys/uio.h>
+#include "defs.h"
+
+shared_ring_t* new_shared_ring (uint64_t const capacity);
+void delete_shared_ring (shared_ring_t *const ring);
+
+boolean put_into_shared_ring (shared_ring_t *const ring, struct iovec const segments[], uint32_t const count,
+			uint64_t const length, uint64_t *const position);
+
+#endif /* SHARED_RING_H_ */
@@ -125,7 +125,7 @@ fifo_t* skyline_constrained (tree_t *const tree, boolean const corner[],
 		assert (page != NULL);
 		assert (page_lock != NULL);
 
-		if (pthread_rwlock_tryrdlock (page_lock)) {
+		if (TRYRDLOCK (tree,page_lock)) {
 			while (browse->size) {
 				free (remove_from_priority_queue (browse));
 			}
@@ -175,6 +175,7 @@ fifo_t* skyline_constrained (tree_t *const tree, boolean const corner[],
 	                		pair->key = (index_t *const) malloc (tree->dimensions*sizeof(index_t));
 	                		memcpy (pair->key,leaf_entry->key,tree->dimensions*sizeof(index_t));
 	                		pair->object = leaf_entry->object;
+	                		pair->dimensions = tree->dimensions;
 
 	                		insert_into_stack (skyline,pair);
 	                }
@@ -400,7 +401,7 @@ fifo_t* multiskyline_join (lifo_t *const trees, boolean const corner[]) {
 
 			assert (page_lock != NULL);
 
-			if (pthread_rwlock_tryrdlock (page_lock)) {
+			if (TRYRDLOCK (TREE(i),page_lock)) {
 				while (browse->size) {
 					multibox_container_t* tmp = remove_from_priority_queue (browse);
 					free (tmp->page_ids);
@@ -486,7 +487,7 @@ fifo_t* multiskyline_join (lifo_t *const trees, boolean const corner[]) {
 				page_locks[i] = page_lock;
 				pages[i] = page;
 
-				if (pthread_rwlock_tryrdlock (page_lock)) {
+				if (TRYRDLOCK (TREE(i),page_lock)) {
 					while (browse->size) {
 						multibox_container_t* tmp = remove_from_priority_queue (browse);
 						free (tmp->page_ids);
@@ -712,7 +713,7 @@ fifo_t* multiskyline (lifo_t *const trees, boolean const corner[]) {
 
 			assert (page_lock != NULL);
 
-			if (pthread_rwlock_tryrdlock (page_lock)) {
+			if (TRYRDLOCK (TREE(i),page_lock)) {
 				for (unsigned j=0; j<cardinality; ++j) {
 					while (browse[j]->size) {
 						free (remove_from_priority_queue (browse[j]));
@@ -16,10 +16,15 @@
  */
 
 #include <pthread.h>
+#include <unistd.h>
+#include <math.h>
+#include <time.h>
 #include "rtree.h"
 #include "spatial_standard_queries.h"
 #include "priority_queue.h"
 #include "symbol_table.h"
+#include "thread_pool.h"
+#include "spill.h"
 #include "common.h"
 #include "queue.h"
 #include "stack.h"
@@ -38,17 +43,17 @@ object_t find_any_in_rtree (tree_t *const tree, index_t const key[], uint32_t pr
 		LOG (warn,"Query key ( ");
 		if (logging <= warn) {
 			for (uint32_t i=0; i < tree->dimensions; ++i) {
-				fprintf (stderr, "%12lf ", (double)key[i]);
+				log_append ("%12lf ", (double)key[i]);
 			}
-			fprintf (stderr,") does not belong in the indexed area...\n");
+			log_append (") does not belong in the indexed area...\n");
 		}
 
 		LOG (warn,"Root-box: \n");
 		if (logging <= warn) {
 			for (uint32_t i=0; i < tree->dimensions; ++i) {
-				fprintf (stderr, "\t\t( %12lf %12lf )\n", (double)tree->root_box[i].start, (double)tree->root_box[i].end);
+				log_append ("\t\t( %12lf %12lf )\n", (double)tree->root_box[i].start, (double)tree->root_box[i].end);
 			}
-			fprintf (stderr,"\n");
+			log_append ("\n");
 		}
 
 		return -1;
@@ -71,7 +76,7 @@ object_t find_any_in_rtree (tree_t *const tree, index_t const key[], uint32_t pr
 			assert (page != NULL);
 			assert (page_lock != NULL);
 
-			if (pthread_rwlock_tryrdlock (page_lock)) {
+			if (TRYRDLOCK (tree,page_lock)) {
 				clear_queue (browse);
 				goto reset_search_operation;
 			}else{
@@ -99,8 +104,8 @@ object_t find_any_in_rtree (tree_t *const tree, index_t const key[], uint32_t pr
 		LOG (warn,"Unable to retrieve any record associated with key ( ");
 		if (logging <= warn) {
 			for (uint32_t i=0; i<tree->dimensions; ++i)
-				fprintf (stderr,"%12lf ",(double)key[i]);
-			fprintf (stderr,")...\n");
+				log_append ("%12lf ",(double)key[i]);
+			log_append (")...\n");
 		}
 
 		return -1;
@@ -120,17 +125,17 @@ fifo_t* find_all_in_rtree (tree_t *const tree, index_t const key[], uint32_t pro
 		LOG (warn,"Query key ( ");
 		if (logging <= warn) {
 			for (uint32_t i=0; i < tree->dimensions; ++i) {
-				fprintf (stderr, "%12lf ", (double)key[i]);
+				log_append ("%12lf ", (double)key[i]);
 			}
-			fprintf (stderr,") does not belong in the indexed area...\n");
+			log_append (") does not belong in the indexed area...\n");
 		}
 
 		LOG (warn,"Root-box: \n");
 		if (logging <= warn) {
 			for (uint32_t i=0; i < tree->dimensions; ++i) {
-				fprintf (stderr, "\t\t( %12lf %12lf )\n", (double)tree->root_box[i].start, (double)tree->root_box[i].end);
+				log_append ("\t\t( %12lf %12lf )\n", (double)tree->root_box[i].start, (double)tree->root_box[i].end);
 			}
-			fprintf (stderr,"\n");
+			log_append ("\n");
 		}
 
 		return new_queue();
@@ -153,7 +158,7 @@ fifo_t* find_all_in_rtree (tree_t *const tree, index_t const key[], uint32_t pro
 		assert (page != NULL);
 		assert (page_lock != NULL);
 
-		if (pthread_rwlock_tryrdlock (page_lock)) {
+		if (TRYRDLOCK (tree,page_lock)) {
 			clear_queue (browse);
 			goto reset_search_operation;
 		}else{
@@ -181,9 +186,9 @@ fifo_t* find_all_in_rtree (tree_t *const tree, index_t const key[], uint32_t pro
 		LOG (warn,"Unable to retrieve any records associated with key ( ");
 		if (logging <= warn) {
 			for (uint32_t i=0; i<tree->dimensions; ++i) {
-				fprintf (stderr,"%12lf ",(double)key[i]);
+				log_append ("%12lf ",(double)key[i]);
 			}
-			fprintf (stderr,")...\n");
+			log_append (")...\n");
 		}
 	}
 
@@ -231,7 +236,7 @@ fifo_t* range (tree_t *const tree, index_t const lo[], index_t const hi[], uint3
 		assert (page != NULL);
 		assert (page_lock != NULL);
 
-		if (pthread_rwlock_tryrdlock (page_lock)) {
+		if (TRYRDLOCK (tree,page_lock)) {
 			clear_queue (browse);
 			goto reset_search_operation;
 		}else{
@@ -266,16 +271,387 @@ fifo_t* range (tree_t *const tree, index_t const lo[], index_t const hi[], uint3
 }
 
 
+/**
+ * Counts the records in a range. Subtrees of an aggregate tree
+ * that fall entirely in the range are counted by their stored
+ * counts without being visited. The tree is browsed depth-first
+ * and counting stops as soon as the count reaches the given
+ * reach (NO_LIMIT to count all), beyond which it is not exact.
+ */
+uint64_t count_range (tree_t *const tree, index_t const lo[], index_t const hi[], uint64_t const reach) {
+	interval_t query [tree->dimensions];
+	for (uint32_t j=0; j<tree->dimensions; ++j) {
+		if (lo[j]>hi[j]) {
+			LOG (error,"Erroneous range query specified...\n");
+			return 0;
+		}
+		query[j].start = lo[j];
+		query[j].end = hi[j];
+	}
+
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	if (!overlapping_boxes (query,tree->root_box,tree->dimensions)){
+		pthread_rwlock_unlock (&tree->tree_lock);
+		return 0;
+	}else pthread_rwlock_unlock (&tree->tree_lock);
+
+	uint64_t count = 0;
+	lifo_t *const browse = new_stack();
+
+	reset_count_operation:
+	count = 0;
+	insert_into_stack (browse,0);
+
+	while (browse->size && count < reach) {
+		uint64_t const page_id = remove_from_stack (browse);
+
+		load_page_return_pair_t *const load_pair = load_page (tree,page_id);
+		pthread_rwlock_t *const page_lock = load_pair->page_lock;
+		page_t const*const page = load_pair->page;
+		free (load_pair);
+
+		assert (page != NULL);
+		assert (page_lock != NULL);
+
+		if (TRYRDLOCK (tree,page_lock)) {
+			clear_stack (browse);
+			goto reset_count_operation;
+		}else{
+			if (page->header.is_leaf) {
+				for (register uint32_t i=0; i<page->header.records; ++i) {
+					if (key_enclosed_by_box (page->node.leaf.KEY(i),query,tree->dimensions)) {
+						++count;
+					}
+				}
+			}else{
+				/* children are pushed last to first so that they are visited in the order of paged_range() */
+				for (register int64_t i=page->header.records-1; i>=0; --i) {
+					if (tree->is_aggregate && box_enclosed_by_box (page->node.internal.BOX(i),query,tree->dimensions)) {
+						count += page->node.internal.counts[i];
+					}else if (overlapping_boxes (query,page->node.internal.BOX(i),tree->dimensions)) {
+						insert_into_stack (browse,CHILD_ID(page_id,i));
+					}
+				}
+			}
+
+			pthread_rwlock_unlock (page_lock);
+		}
+	}
+
+	delete_stack (browse);
+
+	return count;
+}
+
+/**
+ * Same as range(), only results come in the order of the leaves that
+ * hold them, skipping as many as the offset and stopping as soon as
+ * the limit is reached. On aggregate trees, subtrees that fall within
+ * the range before the offset is reached are skipped by their stored
+ * counts. Keys are copied only if asked for. The first result is at
+ * the tail of the queue, which is where results are consumed from.
+ */
+fifo_t* paged_range (tree_t *const tree, index_t const lo[], index_t const hi[], uint32_t proj_dimensions,
+			uint64_t const offset, uint64_t const limit, boolean const with_keys) {
+	if (tree->dimensions < proj_dimensions) {
+		proj_dimensions = tree->dimensions;
+	}
+
+	interval_t query [tree->dimensions];
+	for (uint32_t j=0; j<tree->dimensions; ++j) {
+		if (lo[j]>hi[j]) {
+			LOG (error,"Erroneous range query specified...\n");
+			return NULL;
+		}
+		query[j].start = lo[j];
+		query[j].end = hi[j];
+	}
+
+	fifo_t *const result = new_queue();
+
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	if (!limit || !overlapping_boxes (query,tree->root_box,proj_dimensions)){
+		pthread_rwlock_unlock (&tree->tree_lock);
+		return result;
+	}else pthread_rwlock_unlock (&tree->tree_lock);
+
+	lifo_t *const browse = new_stack();
+	uint64_t skipped = 0;
+
+	reset_search_operation:
+	skipped = 0;
+	insert_into_stack (browse,0);
+
+	while (browse->size && result->size < limit) {
+		uint64_t const page_id = remove_from_stack (browse);
+
+		load_page_return_pair_t *const load_pair = load_page (tree,page_id);
+		pthread_rwlock_t *const page_lock = load_pair->page_lock;
+		page_t const*const page = load_pair->page;
+		free (load_pair);
+
+		assert (page != NULL);
+		assert (page_lock != NULL);
+
+		if (TRYRDLOCK (tree,page_lock)) {
+			clear_stack (browse);
+			while (result->size) {
+				data_pair_t *const pair = remove_tail_of_queue (result);
+				free (pair->key);
+				free (pair);
+			}
+			goto reset_search_operation;
+		}else{
+			if (page->header.is_leaf) {
+				for (register uint32_t i=0; i<page->header.records && result->size < limit; ++i) {
+					if (key_enclosed_by_box (page->node.leaf.KEY(i),query,proj_dimensions)) {
+						if (skipped < offset) {
+							++skipped;
+							continue;
+						}
+
+						data_pair_t *const pair = (data_pair_t *const) malloc (sizeof(data_pair_t));
+						if (with_keys) {
+							pair->key = (index_t *const) malloc (sizeof(index_t)*tree->dimensions);
+							memcpy (pair->key,page->node.leaf.KEY(i),sizeof(index_t)*tree->dimensions);
+						}else{
+							pair->key = NULL;
+						}
+						pair->object = page->node.leaf.objects[i];
+						pair->dimensions = tree->dimensions;
+
+						insert_at_head_of_queue (result,pair);
+					}
+				}
+			}else{
+				/* leading children that fall before the offset are skipped altogether */
+				uint32_t first = 0;
+				for (; first<page->header.records; ++first) {
+					if (!overlapping_boxes (query,page->node.internal.BOX(first),proj_dimensions)) {
+						continue;
+					}else if (tree->is_aggregate && skipped + page->node.internal.counts[first] <= offset
+						&& box_enclosed_by_box (page->node.internal.BOX(first),query,proj_dimensions)) {
+						skipped += page->node.internal.counts[first];
+					}else{
+						break;
+					}
+				}
+
+				/* the rest are pushed last to first so that they are visited in order */
+				for (register int64_t i=page->header.records-1; i>=(int64_t)first; --i) {
+					if (overlapping_boxes (query,page->node.internal.BOX(i),proj_dimensions)) {
+						insert_into_stack (browse,CHILD_ID(page_id,i));
+					}
+				}
+			}
+
+			pthread_rwlock_unlock (page_lock);
+		}
+	}
+
+	delete_stack (browse);
+
+	return result;
+}
+
+/**
+ * Keeps the given number of results after skipping as many as the
+ * offset, counting from the tail of a list of results that is consumed,
+ * which is where results are reported from; i.e. neighbors are paged
+ * from the nearest, and skylines in an order fixed by their traversal.
+ */
+fifo_t* page_results (fifo_t *const results, uint64_t const offset, uint64_t const limit) {
+	fifo_t *const page = new_queue();
+	for (uint64_t i=0; results->size; ++i) {
+		data_pair_t *const pair = remove_tail_of_queue (results);
+		if (i >= offset && page->size < limit) {
+			insert_at_head_of_queue (page,pair);
+		}else{
+			free (pair->key);
+			free (pair);
+		}
+	}
+	delete_queue (results);
+	return page;
+}
+
+/**
+ * Draws uniformly with replacement the given number of tuples
+ * from a list of results, which is consumed in the process.
+ */
+fifo_t* sample_results (fifo_t *const results, uint64_t const size, unsigned short seed[3]) {
+	fifo_t *const sample = new_queue();
+	if (results->size) {
+		uint64_t const population_size = results->size;
+		data_pair_t* *const population = (data_pair_t**) malloc (population_size*sizeof(data_pair_t*));
+		if (population == NULL) {
+			LOG (fatal,"[sample_results()] Unable to allocate additional memory for the population of a sample...\n");
+			exit (EXIT_FAILURE);
+		}
+		for (uint64_t i=0; results->size; ++i) {
+			population[i] = remove_head_of_queue (results);
+		}
+
+		for (uint64_t i=0; i<size; ++i) {
+			data_pair_t const*const drawn = population [(uint64_t)(erand48 (seed) * population_size)];
+
+			data_pair_t *const pair = (data_pair_t *const) malloc (sizeof(data_pair_t));
+			pair->key = (index_t *const) malloc (sizeof(index_t)*drawn->dimensions);
+			memcpy (pair->key,drawn->key,sizeof(index_t)*drawn->dimensions);
+			pair->object = drawn->object;
+			pair->dimensions = drawn->dimensions;
+
+			insert_at_tail_of_queue (sample,pair);
+		}
+
+		for (uint64_t i=0; i<population_size; ++i) {
+			free (population[i]->key);
+			free (population[i]);
+		}
+		free (population);
+	}
+	delete_queue (results);
+	return sample;
+}
+
+/**
+ * Draws uniformly with replacement the given number of records
+ * from a range. On aggregate trees each draw is a random walk from
+ * the root choosing children in proportion to their counts, and is
+ * accepted so that all records in the range are equally likely;
+ * otherwise, when the walks would visit more pages than the leaves
+ * that hold the range, and whenever draws are rejected too often, the
+ * range is materialized and sampled instead.
+ */
+fifo_t* sample_range (tree_t *const tree, index_t const lo[], index_t const hi[], uint64_t const size) {
+	interval_t query [tree->dimensions];
+	for (uint32_t j=0; j<tree->dimensions; ++j) {
+		if (lo[j]>hi[j]) {
+			LOG (error,"Erroneous range query specified...\n");
+			return NULL;
+		}
+		query[j].start = lo[j];
+		query[j].end = hi[j];
+	}
+
+	unsigned short seed [3] = {time(NULL),pthread_self(),getpid()};
+
+	if (!tree->is_aggregate) {
+		return sample_results (range (tree,lo,hi,tree->dimensions),size,seed);
+	}
+
+	uint64_t const population = size ? count_range (tree,lo,hi,NO_LIMIT) : 0;
+	uint64_t height = 1;
+	for (uint64_t pages = tree->indexed_records/tree->leaf_entries; pages > 1; pages /= tree->internal_entries) {
+		++height;
+	}
+
+	if (!population) {
+		return new_queue();
+	}else if (size*height >= population/tree->leaf_entries) {
+		return sample_results (range (tree,lo,hi,tree->dimensions),size,seed);
+	}
+
+	fifo_t *const sample = new_queue();
+	uint64_t rejections = 0;
+	while (sample->size < size && rejections < SAMPLE_REJECTION_LIMIT*size) {
+		uint64_t page_id = 0;
+		double acceptance = 1;
+		data_pair_t* drawn = NULL;
+
+		while (true) {
+			load_page_return_pair_t *const load_pair = load_page (tree,page_id);
+			pthread_rwlock_t *const page_lock = load_pair->page_lock;
+			page_t const*const page = load_pair->page;
+			free (load_pair);
+
+			assert (page != NULL);
+			assert (page_lock != NULL);
+
+			if (TRYRDLOCK (tree,page_lock)) break;
+
+			if (page->header.is_leaf) {
+				if (page->header.records) {
+					uint32_t const i = erand48 (seed) * page->header.records;
+					if (key_enclosed_by_box (page->node.leaf.KEY(i),query,tree->dimensions)
+						&& erand48 (seed) < acceptance) {
+						drawn = (data_pair_t *const) malloc (sizeof(data_pair_t));
+						drawn->key = (index_t *const) malloc (sizeof(index_t)*tree->dimensions);
+						memcpy (drawn->key,page->node.leaf.KEY(i),sizeof(index_t)*tree->dimensions);
+						drawn->object = page->node.leaf.objects[i];
+						drawn->dimensions = tree->dimensions;
+					}
+				}
+				pthread_rwlock_unlock (page_lock);
+				break;
+			}
+
+			uint64_t records = 0, overlapping = 0;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				records += page->node.internal.counts[i];
+				if (overlapping_boxes (query,page->node.internal.BOX(i),tree->dimensions)) {
+					overlapping += page->node.internal.counts[i];
+				}
+			}
+
+			if (!overlapping) {
+				pthread_rwlock_unlock (page_lock);
+				break;
+			}
+			if (page_id) {
+				acceptance *= overlapping / (double) records;
+			}
+
+			uint64_t const pick = erand48 (seed) * overlapping;
+			uint64_t child_id = page_id, cumulative = 0;
+			for (register uint32_t i=0; i<page->header.records; ++i) {
+				if (overlapping_boxes (query,page->node.internal.BOX(i),tree->dimensions)) {
+					cumulative += page->node.internal.counts[i];
+					if (pick < cumulative) {
+						child_id = CHILD_ID(page_id,i);
+						break;
+					}
+				}
+			}
+			pthread_rwlock_unlock (page_lock);
+
+			if (child_id == page_id) break;
+			page_id = child_id;
+		}
+
+		if (drawn != NULL) {
+			insert_at_tail_of_queue (sample,drawn);
+		}else{
+			++rejections;
+		}
+	}
+
+	if (sample->size < size) {
+		LOG (info,"[sample_range()] Drawing the last %lu tuples out of %lu from the materialized range.\n",size-sample->size,size);
+		fifo_t *const rest = sample_results (range (tree,lo,hi,tree->dimensions),size-sample->size,seed);
+		while (rest->size) {
+			insert_at_tail_of_queue (sample,remove_head_of_queue (rest));
+		}
+		delete_queue (rest);
+	}
+	return sample;
+}
+
 
 fifo_t* bounded_search (tree_t *const tree,
 		index_t const lo[], index_t const hi[],
 		index_t const center[], uint32_t const k,
-		uint32_t proj_dimensions) {
+		uint32_t proj_dimensions,
+		approximation_t *const approximation) {
 
 	if (tree->dimensions < proj_dimensions) {
 		proj_dimensions = tree->dimensions;
 	}
 
+	if (approximation != NULL) {
+		approximation->bound = 1;
+	}
+
 	if (k==0) return new_queue();
 	interval_t query [tree->dimensions];
 	for (uint32_t j=0; j<tree->dimensions; ++j) {
@@ -287,11 +663,31 @@ fifo_t* bounded_search (tree_t *const tree,
 		query[j].end = hi[j];
 	}
 
+	double const relaxation = approximation != NULL && approximation->epsilon > 0 ? 1+approximation->epsilon : 1;
+	uint64_t const max_pages = approximation != NULL ? approximation->max_pages : 0;
+
 	priority_queue_t *const browse = new_priority_queue(&mincompare_containers);
 	priority_queue_t *const data = new_priority_queue(&maxcompare_containers);
 
+	/* the smallest distance from any part of the tree left unexplored */
+	double unexplored = DBL_MAX;
+	uint64_t visited_pages = 0;
+
+	/* past the cap on pages, only the nearest child is followed down to a first leaf */
+	box_container_t* descent = NULL;
+	boolean has_reached_leaf = false;
+
 	reset_search_operation:;
 
+	while (data->size) {
+		data_container_t *const temp = remove_from_priority_queue (data);
+		free (temp->key);
+		free (temp);
+	}
+	unexplored = DBL_MAX;
+	visited_pages = 0;
+	has_reached_leaf = false;
+
 	box_container_t* container = (box_container_t*) malloc (sizeof(box_container_t));
 
 	container->box = tree->root_box;
@@ -300,10 +696,19 @@ fifo_t* bounded_search (tree_t *const tree,
 
 	insert_into_priority_queue (browse,container);
 
-	for (index_t threshold=INDEX_T_MAX;browse->size;) {
-		container = remove_from_priority_queue (browse);
+	for (index_t threshold=INDEX_T_MAX;browse->size || descent != NULL;) {
+		container = descent != NULL ? descent : remove_from_priority_queue (browse);
+		descent = NULL;
 
-		if (container->sort_key > threshold) {
+		boolean const is_capped = max_pages && visited_pages >= max_pages;
+		if (container->sort_key * relaxation > threshold
+			|| (is_capped && has_reached_leaf)) {
+
+			if (container->sort_key < unexplored) {
+				unexplored = container->sort_key;
+			}
+
+			TRACE_EVENTS(nodes_pruned,1+browse->size);
 			free (container);
 			while (browse->size) {
 				free (remove_from_priority_queue (browse));
@@ -322,13 +727,15 @@ fifo_t* bounded_search (tree_t *const tree,
 		assert (page != NULL);
 		assert (page_lock != NULL);
 
-		if (pthread_rwlock_tryrdlock (page_lock)) {
+		if (TRYRDLOCK (tree,page_lock)) {
 			while (browse->size) {
 				free (remove_from_priority_queue (browse));
 			}
 			goto reset_search_operation;
 		}else{
+			++visited_pages;
 			if (page->header.is_leaf) {
+				has_reached_leaf = true;
 				for (register uint32_t i=0; i<page->header.records; ++i) {
 					if (key_enclosed_by_box (page->node.leaf.KEY(i),query,proj_dimensions)) {
 						data_container_t *const data_container = (data_container_t *const) malloc (sizeof(data_container_t));
@@ -367,14 +774,35 @@ fifo_t* bounded_search (tree_t *const tree,
 			}else{
 				for (register uint32_t i=0; i<page->header.records; ++i) {
 					if (overlapping_boxes (query,page->node.internal.BOX(i),proj_dimensions)) {
-						container = (box_container_t*) malloc (sizeof(box_container_t));
-
-						container->id = CHILD_ID(page_id,i);
-						container->box = page->node.internal.BOX(i);
-						container->sort_key = key_to_box_mindistance (center,page->node.internal.BOX(i),proj_dimensions);
+						double const sort_key = key_to_box_mindistance (center,page->node.internal.BOX(i),proj_dimensions);
+
+						if (sort_key * relaxation < threshold) {
+							container = (box_container_t*) malloc (sizeof(box_container_t));
+
+							container->id = CHILD_ID(page_id,i);
+							container->box = page->node.internal.BOX(i);
+							container->sort_key = sort_key;
+
+							if (!is_capped) {
+								insert_into_priority_queue (browse,container);
+								continue;
+							}else if (descent == NULL || sort_key < descent->sort_key) {
+								box_container_t *const temp = descent;
+								descent = container;
+								if (temp == NULL) continue;
+								container = temp;
+							}
 
-						if (container->sort_key < threshold) {
-							insert_into_priority_queue (browse,container);
+							TRACE_EVENT(nodes_pruned);
+							if (container->sort_key < unexplored) {
+								unexplored = container->sort_key;
+							}
+							free (container);
+						}else{
+							TRACE_EVENT(nodes_pruned);
+							if (sort_key < unexplored) {
+								unexplored = sort_key;
+							}
 						}
 					}
 				}
@@ -384,6 +812,23 @@ fifo_t* bounded_search (tree_t *const tree,
 		}
 	}
 
+	if (approximation != NULL) {
+		/**
+		 * Every point closer than the unexplored part of the tree
+		 * has been examined, hence the i-th reported distance is at
+		 * most farthest/unexplored times the exact i-th distance,
+		 * even if fewer than k were found before the cap on pages.
+		 */
+		double const farthest = data->size ? ((data_container_t*)peek_priority_queue(data))->sort_key : 0;
+		if (unexplored == DBL_MAX || (data->size && farthest <= unexplored)) {
+			approximation->bound = 1;
+		}else if (!data->size || unexplored <= 0) {
+			approximation->bound = INFINITY;
+		}else{
+			approximation->bound = farthest / unexplored;
+		}
+	}
+
 	fifo_t *const result = new_queue();
 	while (data->size) {
 		insert_at_head_of_queue (result,remove_from_priority_queue(data));
@@ -402,55 +847,493 @@ fifo_t* nearest (tree_t *const tree, index_t const query[], uint32_t const k) {
 		from [i] = -INDEX_T_MAX;
 		to [i] = INDEX_T_MAX;
 	}
-	return bounded_search (tree, from, to, query, k, tree->dimensions);
+	return bounded_search (tree, from, to, query, k, tree->dimensions, NULL);
 }
 
 
-
 /**
- * It dynamically constructs a Voronoi cell around the query point for each of the
- * feature-trees, the intersection of which is applied over the data-tree as a
- * polygon query, and the results are returned to the user. The query-center does
- * not necessarily have to be indexed in the database in this.
+ * Loads and read-locks a page on behalf of a worker of a parallel
+ * search. Loading is serialized among the workers of the search so
+ * that none evicts a page that another has loaded but not locked yet.
+ * It returns NULL if the page is being modified at the same time.
  */
+static
+page_t const* acquire_page (tree_t *const tree, uint64_t const page_id,
+				pthread_mutex_t *const io_lock, pthread_rwlock_t **const page_lock) {
+	pthread_mutex_lock (io_lock);
+	load_page_return_pair_t *const load_pair = load_page (tree,page_id);
+	page_t const*const page = load_pair->page;
+	*page_lock = load_pair->page_lock;
+	free (load_pair);
+
+	assert (page != NULL);
+	assert (*page_lock != NULL);
+
+	boolean const is_locked = !TRYRDLOCK (tree,*page_lock);
+	pthread_mutex_unlock (io_lock);
+
+	return is_locked ? page : NULL;
+}
 
-fifo_t* multichromatic_reverse_nearest_neighbors (index_t const query[],
-						tree_t *const data_tree,
-						lifo_t *const feature_trees,
-						uint32_t proj_dimensions) {
+static
+uint32_t available_lanes (thread_pool_t const*const pool, uint32_t const parallelism) {
+	return parallelism > pool->threads_number+1 ? pool->threads_number+1 : parallelism;
+}
 
-	if (data_tree->dimensions < proj_dimensions) {
-		proj_dimensions = data_tree->dimensions;
-	}
-	for (uint32_t itree=0; itree<feature_trees->size; ++itree) {
-		tree_t *const tree = (tree_t *const) feature_trees->buffer[itree];
-		if (tree->dimensions < proj_dimensions) {
-			proj_dimensions = tree->dimensions;
-		}
-	}
 
-	lifo_t* cells[feature_trees->size];
-	priority_queue_t *const browse = new_priority_queue (&mincompare_containers);
+typedef struct {
+	tree_t* tree;
+	interval_t const* query;
+	uint32_t proj_dimensions;
 
-	for (uint32_t itree=0; itree<feature_trees->size; ++itree) {
-		tree_t *const tree = (tree_t *const) feature_trees->buffer[itree];
+	fifo_t** results;
 
-		cells[itree] = new_stack();
+	pthread_mutex_t io_lock;
+	boolean is_reset;
+} parallel_range_t;
 
-		reset_inner_search_operation:;
+static
+void parallel_range_visit (work_group_t *const group, uint32_t const lane, void *const work) {
+	parallel_range_t *const search = (parallel_range_t *const) group->args;
+	tree_t *const tree = search->tree;
 
-		box_container_t* container = (box_container_t*) malloc (sizeof(box_container_t));
+	uint64_t const page_id = ((box_container_t*)work)->id;
+	free (work);
 
-		container->box = tree->root_box;
-		container->sort_key = 0;
-		container->id = 0;
+	if (__atomic_load_n (&search->is_reset,__ATOMIC_SEQ_CST)) return;
 
-		insert_into_priority_queue (browse,container);
+	pthread_rwlock_t* page_lock = NULL;
+	page_t const*const page = acquire_page (tree,page_id,&search->io_lock,&page_lock);
+	if (page == NULL) {
+		__atomic_store_n (&search->is_reset,true,__ATOMIC_SEQ_CST);
+		return;
+	}
 
+	if (page->header.is_leaf) {
+		for (register uint32_t i=0; i<page->header.records; ++i) {
+			if (key_enclosed_by_box (page->node.leaf.KEY(i),search->query,search->proj_dimensions)) {
+				data_pair_t *const pair = (data_pair_t *const) malloc (sizeof(data_pair_t));
 
-		while (browse->size) {
-			container = remove_from_priority_queue (browse);
-			uint64_t const page_id = container->id;
+				pair->key = (index_t *const) malloc (sizeof(index_t)*tree->dimensions);
+				memcpy (pair->key,page->node.leaf.KEY(i),sizeof(index_t)*tree->dimensions);
+				pair->object = page->node.leaf.objects[i];
+				pair->dimensions = tree->dimensions;
+
+				insert_at_tail_of_queue (search->results[lane],pair);
+			}
+		}
+	}else{
+		for (register uint32_t i=0; i<page->header.records; ++i) {
+			if (overlapping_boxes (search->query,page->node.internal.BOX(i),search->proj_dimensions)) {
+				box_container_t *const container = (box_container_t *const) malloc (sizeof(box_container_t));
+
+				container->id = CHILD_ID(page_id,i);
+				container->box = page->node.internal.BOX(i);
+				container->sort_key = 0;
+
+				push_work (group,lane,container);
+			}
+		}
+	}
+
+	pthread_rwlock_unlock (page_lock);
+}
+
+/**
+ * Same as range(), only subtrees are handed to the lanes of a work-group
+ * of the shared pool; each lane collects its own results, that are merged
+ * in the end. A parallelism of less than two falls back to range().
+ */
+fifo_t* parallel_range (tree_t *const tree, index_t const lo[], index_t const hi[], uint32_t proj_dimensions, uint32_t const parallelism) {
+	if (parallelism < 2) {
+		return range (tree,lo,hi,proj_dimensions);
+	}
+
+	if (tree->dimensions < proj_dimensions) {
+		proj_dimensions = tree->dimensions;
+	}
+
+	interval_t query [tree->dimensions];
+	for (uint32_t j=0; j<tree->dimensions; ++j) {
+		if (lo[j]>hi[j]) {
+			LOG (error,"Erroneous range query specified...\n");
+			return NULL;
+		}
+		query[j].start = lo[j];
+		query[j].end = hi[j];
+	}
+
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	if (!overlapping_boxes (query,tree->root_box,proj_dimensions)){
+		pthread_rwlock_unlock (&tree->tree_lock);
+
+		LOG (warn,"Query does not overlap with indexed area...\n");
+		return new_queue();
+	}else pthread_rwlock_unlock (&tree->tree_lock);
+
+	thread_pool_t *const pool = shared_thread_pool ();
+	uint32_t const lanes = available_lanes (pool,parallelism);
+
+	parallel_range_t search;
+	search.tree = tree;
+	search.query = query;
+	search.proj_dimensions = proj_dimensions;
+	search.results = (fifo_t**) malloc (lanes*sizeof(fifo_t*));
+	if (search.results == NULL) {
+		LOG (fatal,"[parallel_range()] Unable to allocate memory for the results of %u lanes...\n",lanes);
+		exit (EXIT_FAILURE);
+	}
+	for (register uint32_t i=0; i<lanes; ++i) {
+		search.results[i] = new_queue();
+	}
+	pthread_mutex_init (&search.io_lock,NULL);
+
+	work_group_t *const group = new_work_group (lanes,&parallel_range_visit,&search);
+
+	reset_search_operation:
+	search.is_reset = false;
+
+	box_container_t *const container = (box_container_t *const) malloc (sizeof(box_container_t));
+	container->box = tree->root_box;
+	container->sort_key = 0;
+	container->id = 0;
+
+	push_work (group,0,container);
+	run_work_group (pool,group);
+
+	if (search.is_reset) {
+		for (register uint32_t i=0; i<lanes; ++i) {
+			while (search.results[i]->size) {
+				data_pair_t *const pair = remove_head_of_queue (search.results[i]);
+				free (pair->key);
+				free (pair);
+			}
+		}
+		goto reset_search_operation;
+	}
+
+	fifo_t *const result = search.results[0];
+	for (register uint32_t i=1; i<lanes; ++i) {
+		while (search.results[i]->size) {
+			insert_at_tail_of_queue (result,remove_head_of_queue (search.results[i]));
+		}
+		delete_queue (search.results[i]);
+	}
+
+	delete_work_group (group);
+	pthread_mutex_destroy (&search.io_lock);
+	free (search.results);
+
+	return result;
+}
+
+
+typedef struct {
+	tree_t* tree;
+	interval_t const* query;
+	index_t const* center;
+	uint32_t proj_dimensions;
+	uint32_t k;
+
+	double relaxation;
+	uint64_t max_pages;
+
+	priority_queue_t** candidates;
+
+	double threshold;
+	double unexplored;
+	uint64_t visited_pages;
+	boolean has_reached_leaf;
+
+	pthread_mutex_t io_lock;
+	boolean is_reset;
+} parallel_bounded_search_t;
+
+static
+int farthest_container_first (void const*const x, void const*const y) {
+	double const sort_key_x = (*(box_container_t *const*)x)->sort_key;
+	double const sort_key_y = (*(box_container_t *const*)y)->sort_key;
+	return sort_key_x < sort_key_y ? 1 : sort_key_x > sort_key_y ? -1 : 0;
+}
+
+static
+void parallel_bounded_search_visit (work_group_t *const group, uint32_t const lane, void *const work) {
+	parallel_bounded_search_t *const search = (parallel_bounded_search_t *const) group->args;
+	tree_t *const tree = search->tree;
+
+	uint64_t const page_id = ((box_container_t*)work)->id;
+	double const sort_key = ((box_container_t*)work)->sort_key;
+	free (work);
+
+	if (__atomic_load_n (&search->is_reset,__ATOMIC_SEQ_CST)) return;
+
+	/* past the cap on pages, lanes only follow their nearest child down to a first leaf */
+	boolean const is_capped = search->max_pages && __sync_fetch_and_add (&search->visited_pages,1) >= search->max_pages;
+	if (sort_key * search->relaxation > read_shared_value (&search->threshold)
+		|| (is_capped && __atomic_load_n (&search->has_reached_leaf,__ATOMIC_SEQ_CST))) {
+		update_shared_minimum (&search->unexplored,sort_key);
+		TRACE_EVENT(nodes_pruned);
+		return;
+	}
+
+	pthread_rwlock_t* page_lock = NULL;
+	page_t const*const page = acquire_page (tree,page_id,&search->io_lock,&page_lock);
+	if (page == NULL) {
+		__atomic_store_n (&search->is_reset,true,__ATOMIC_SEQ_CST);
+		return;
+	}
+
+	if (page->header.is_leaf) {
+		__atomic_store_n (&search->has_reached_leaf,true,__ATOMIC_SEQ_CST);
+		priority_queue_t *const data = search->candidates[lane];
+		for (register uint32_t i=0; i<page->header.records; ++i) {
+			if (key_enclosed_by_box (page->node.leaf.KEY(i),search->query,search->proj_dimensions)) {
+				double const distance = key_to_key_distance (search->center,page->node.leaf.KEY(i),search->proj_dimensions);
+
+				if (distance >= read_shared_value (&search->threshold)
+					|| (data->size == search->k && distance >= ((data_container_t*)peek_priority_queue(data))->sort_key)) {
+					continue;
+				}
+
+				if (data->size == search->k) {
+					data_container_t *const temp = remove_from_priority_queue (data);
+					free (temp->key);
+					free (temp);
+				}
+
+				data_container_t *const data_container = (data_container_t *const) malloc (sizeof(data_container_t));
+
+				data_container->key = (index_t *const) malloc (sizeof(index_t)*tree->dimensions);
+				memcpy (data_container->key,page->node.leaf.KEY(i),sizeof(index_t)*tree->dimensions);
+
+				data_container->object = page->node.leaf.objects[i];
+				data_container->dimensions = tree->dimensions;
+				data_container->sort_key = distance;
+
+				insert_into_priority_queue (data,data_container);
+
+				if (data->size == search->k) {
+					update_shared_minimum (&search->threshold,((data_container_t*)peek_priority_queue(data))->sort_key);
+				}
+			}
+		}
+	}else{
+		/* the nearest child is pushed last so that the lane pops it first */
+		box_container_t* children [page->header.records];
+		uint32_t children_number = 0;
+
+		double const threshold = read_shared_value (&search->threshold);
+		for (register uint32_t i=0; i<page->header.records; ++i) {
+			if (overlapping_boxes (search->query,page->node.internal.BOX(i),search->proj_dimensions)) {
+				double const child_sort_key = key_to_box_mindistance (search->center,page->node.internal.BOX(i),search->proj_dimensions);
+
+				if (child_sort_key * search->relaxation < threshold) {
+					box_container_t *const container = (box_container_t *const) malloc (sizeof(box_container_t));
+
+					container->id = CHILD_ID(page_id,i);
+					container->box = page->node.internal.BOX(i);
+					container->sort_key = child_sort_key;
+
+					children [children_number++] = container;
+				}else{
+					update_shared_minimum (&search->unexplored,child_sort_key);
+					TRACE_EVENT(nodes_pruned);
+				}
+			}
+		}
+
+		qsort (children,children_number,sizeof(box_container_t*),&farthest_container_first);
+		for (register uint32_t i=0; i<children_number; ++i) {
+			if (is_capped && i+1 < children_number) {
+				update_shared_minimum (&search->unexplored,children[i]->sort_key);
+				TRACE_EVENT(nodes_pruned);
+				free (children[i]);
+			}else{
+				push_work (group,lane,children[i]);
+			}
+		}
+	}
+
+	pthread_rwlock_unlock (page_lock);
+}
+
+/**
+ * Same as bounded_search(), only subtrees are handed to the lanes of a
+ * work-group of the shared pool. Each lane keeps its own k best candidates
+ * and the lanes share the smallest of their k-th distances as the pruning
+ * threshold, which bounds the k-th distance of the merged result as well.
+ * A parallelism of less than two falls back to bounded_search().
+ */
+fifo_t* parallel_bounded_search (tree_t *const tree,
+		index_t const lo[], index_t const hi[],
+		index_t const center[], uint32_t const k,
+		uint32_t proj_dimensions,
+		approximation_t *const approximation,
+		uint32_t const parallelism) {
+
+	if (parallelism < 2) {
+		return bounded_search (tree,lo,hi,center,k,proj_dimensions,approximation);
+	}
+
+	if (tree->dimensions < proj_dimensions) {
+		proj_dimensions = tree->dimensions;
+	}
+
+	if (approximation != NULL) {
+		approximation->bound = 1;
+	}
+
+	if (k==0) return new_queue();
+	interval_t query [tree->dimensions];
+	for (uint32_t j=0; j<tree->dimensions; ++j) {
+		if (lo[j]>hi[j]) {
+			LOG (error,"Erroneous range query specified...\n");
+			return NULL;
+		}
+		query[j].start = lo[j];
+		query[j].end = hi[j];
+	}
+
+	thread_pool_t *const pool = shared_thread_pool ();
+	uint32_t const lanes = available_lanes (pool,parallelism);
+
+	parallel_bounded_search_t search;
+	search.tree = tree;
+	search.query = query;
+	search.center = center;
+	search.proj_dimensions = proj_dimensions;
+	search.k = k;
+	search.relaxation = approximation != NULL && approximation->epsilon > 0 ? 1+approximation->epsilon : 1;
+	search.max_pages = approximation != NULL ? approximation->max_pages : 0;
+	search.candidates = (priority_queue_t**) malloc (lanes*sizeof(priority_queue_t*));
+	if (search.candidates == NULL) {
+		LOG (fatal,"[parallel_bounded_search()] Unable to allocate memory for the candidates of %u lanes...\n",lanes);
+		exit (EXIT_FAILURE);
+	}
+	for (register uint32_t i=0; i<lanes; ++i) {
+		search.candidates[i] = new_priority_queue (&maxcompare_containers);
+	}
+	pthread_mutex_init (&search.io_lock,NULL);
+
+	work_group_t *const group = new_work_group (lanes,&parallel_bounded_search_visit,&search);
+
+	reset_search_operation:
+	for (register uint32_t i=0; i<lanes; ++i) {
+		while (search.candidates[i]->size) {
+			data_container_t *const temp = remove_from_priority_queue (search.candidates[i]);
+			free (temp->key);
+			free (temp);
+		}
+	}
+	search.threshold = INDEX_T_MAX;
+	search.unexplored = DBL_MAX;
+	search.visited_pages = 0;
+	search.has_reached_leaf = false;
+	search.is_reset = false;
+
+	box_container_t *const container = (box_container_t *const) malloc (sizeof(box_container_t));
+	container->box = tree->root_box;
+	container->sort_key = 0;
+	container->id = 0;
+
+	push_work (group,0,container);
+	run_work_group (pool,group);
+
+	if (search.is_reset) {
+		goto reset_search_operation;
+	}
+
+	priority_queue_t *const data = search.candidates[0];
+	for (register uint32_t i=1; i<lanes; ++i) {
+		while (search.candidates[i]->size) {
+			data_container_t *const data_container = remove_from_priority_queue (search.candidates[i]);
+			if (data->size < k) {
+				insert_into_priority_queue (data,data_container);
+			}else if (data_container->sort_key
+					< ((data_container_t*)peek_priority_queue(data))->sort_key) {
+				data_container_t *const temp = remove_from_priority_queue (data);
+				free (temp->key);
+				free (temp);
+
+				insert_into_priority_queue (data,data_container);
+			}else{
+				free (data_container->key);
+				free (data_container);
+			}
+		}
+		delete_priority_queue (search.candidates[i]);
+	}
+
+	if (approximation != NULL) {
+		double const farthest = data->size ? ((data_container_t*)peek_priority_queue(data))->sort_key : 0;
+		if (search.unexplored == DBL_MAX || (data->size && farthest <= search.unexplored)) {
+			approximation->bound = 1;
+		}else if (!data->size || search.unexplored <= 0) {
+			approximation->bound = INFINITY;
+		}else{
+			approximation->bound = farthest / search.unexplored;
+		}
+	}
+
+	fifo_t *const result = new_queue();
+	while (data->size) {
+		insert_at_head_of_queue (result,remove_from_priority_queue(data));
+	}
+
+	delete_priority_queue (data);
+	delete_work_group (group);
+	pthread_mutex_destroy (&search.io_lock);
+	free (search.candidates);
+
+	return result;
+}
+
+
+
+/**
+ * It dynamically constructs a Voronoi cell around the query point for each of the
+ * feature-trees, the intersection of which is applied over the data-tree as a
+ * polygon query, and the results are returned to the user. The query-center does
+ * not necessarily have to be indexed in the database in this.
+ */
+
+fifo_t* multichromatic_reverse_nearest_neighbors (index_t const query[],
+						tree_t *const data_tree,
+						lifo_t *const feature_trees,
+						uint32_t proj_dimensions) {
+
+	if (data_tree->dimensions < proj_dimensions) {
+		proj_dimensions = data_tree->dimensions;
+	}
+	for (uint32_t itree=0; itree<feature_trees->size; ++itree) {
+		tree_t *const tree = (tree_t *const) feature_trees->buffer[itree];
+		if (tree->dimensions < proj_dimensions) {
+			proj_dimensions = tree->dimensions;
+		}
+	}
+
+	lifo_t* cells[feature_trees->size];
+	priority_queue_t *const browse = new_priority_queue (&mincompare_containers);
+
+	for (uint32_t itree=0; itree<feature_trees->size; ++itree) {
+		tree_t *const tree = (tree_t *const) feature_trees->buffer[itree];
+
+		cells[itree] = new_stack();
+
+		reset_inner_search_operation:;
+
+		box_container_t* container = (box_container_t*) malloc (sizeof(box_container_t));
+
+		container->box = tree->root_box;
+		container->sort_key = 0;
+		container->id = 0;
+
+		insert_into_priority_queue (browse,container);
+
+
+		while (browse->size) {
+			container = remove_from_priority_queue (browse);
+			uint64_t const page_id = container->id;
 			free (container);
 
 			load_page_return_pair_t *const load_pair = load_page (tree,page_id);
@@ -461,7 +1344,7 @@ fifo_t* multichromatic_reverse_nearest_neighbors (index_t const query[],
 			assert (page != NULL);
 			assert (page_lock != NULL);
 
-			if (pthread_rwlock_tryrdlock (page_lock)) {
+			if (TRYRDLOCK (tree,page_lock)) {
 				while (browse->size) {
 					free (remove_from_priority_queue (browse));
 				}
@@ -556,7 +1439,7 @@ fifo_t* multichromatic_reverse_nearest_neighbors (index_t const query[],
 		assert (page != NULL);
 		assert (page_lock != NULL);
 
-		if (pthread_rwlock_tryrdlock (page_lock)) {
+		if (TRYRDLOCK (tree,page_lock)) {
 			clear_queue (result_browse);
 			goto reset_search_operation;
 		}else{
@@ -657,7 +1540,7 @@ fifo_t* distance_join_ordered (double const theta,
 	va_end (args);
 
 	boolean const pairwise = false;
-	fifo_t *const result = distance_join (theta,less_than_theta,pairwise,use_avg,trees);
+	fifo_t *const result = transform_spill_into_queue (distance_join (theta,less_than_theta,pairwise,use_avg,trees,NULL,0));
 
 	delete_stack (trees);
 	return result;
@@ -687,7 +1570,7 @@ fifo_t* distance_join_pairwise (double const theta,
 	va_end (args);
 
 	boolean const pairwise = true;
-	fifo_t *const result = distance_join (theta,less_than_theta,pairwise,use_avg,trees);
+	fifo_t *const result = transform_spill_into_queue (distance_join (theta,less_than_theta,pairwise,use_avg,trees,NULL,0));
 
 	delete_stack (trees);
 	return result;
@@ -695,124 +1578,541 @@ fifo_t* distance_join_pairwise (double const theta,
 
 
 
-fifo_t* distance_join (double const theta,
-			boolean const less_than_theta,
-			boolean const pairwise,
-			boolean const use_avg,
-			lifo_t *const trees) {
-
-	if (!trees->size) return new_queue();
-	if (less_than_theta && theta < 0) {
-		LOG (warn,"No point for negative distances in predicate joins...\n");
-		return new_queue();
-	}
+static
+void delete_multibox_container (multibox_container_t *const container) {
+	free (container->page_ids);
+	free (container->boxes);
+	free (container);
+}
 
-	uint32_t const cardinality = trees->size;
-	uint32_t dimensions = UINT_MAX;
-	for (uint32_t i=0; i<trees->size; ++i) {
-		if (((tree_t *const)trees->buffer[i])->dimensions < dimensions) {
-			dimensions = ((tree_t *const)trees->buffer[i])->dimensions;
-		}
-	}
+static
+void delete_multidata_container (multidata_container_t *const container) {
+	free (container->objects);
+	free (container->keys);
+	free (container);
+}
 
-	lifo_t *const browse = new_stack();
-	priority_queue_t *const data_combinations = new_priority_queue (less_than_theta?&maxcompare_multicontainers:&mincompare_multicontainers);
+/**
+ * Lower bound of the distance of any combination
+ * of points that a combination of boxes encloses.
+ */
+static
+double multibox_mindistance (multibox_container_t const*const container, boolean const use_avg, boolean const pairwise) {
+	return use_avg ?
+		(pairwise ? avg_mindistance_pairwise_multibox(container,0) : avg_mindistance_ordered_multibox(container,0))
+		:(pairwise ? max_mindistance_pairwise_multibox(container,0) : max_mindistance_ordered_multibox(container,0));
+}
 
-	reset_search_operation:;
-	multibox_container_t* container = (multibox_container_t*) malloc (sizeof(multibox_container_t));
+/**
+ * Upper bound of the distance of any combination
+ * of points that a combination of boxes encloses.
+ */
+static
+double multibox_maxdistance (multibox_container_t const*const container, boolean const use_avg, boolean const pairwise) {
+	return use_avg ?
+		(pairwise ? avg_maxdistance_pairwise_multibox(container,0) : avg_maxdistance_ordered_multibox(container,0))
+		:(pairwise ? min_maxdistance_pairwise_multibox(container,0) : min_maxdistance_ordered_multibox(container,0));
+}
 
-	container->boxes = (interval_t *const) malloc (cardinality*dimensions*sizeof(interval_t));
-	container->page_ids = (uint64_t*const) malloc (cardinality*sizeof(uint64_t));
-	container->cardinality = cardinality;
-	container->dimensions = dimensions;
+/**
+ * The combination of boxes that differs from the given one in
+ * that its i-th box is replaced by one of the children thereof.
+ */
+static
+multibox_container_t* new_child_multibox_container (multibox_container_t const*const container, uint32_t const i,
+						uint64_t const child_id, interval_t const child_box[]) {
+	uint32_t const cardinality = container->cardinality;
+	uint32_t const dimensions = container->dimensions;
 
-	bzero (container->page_ids,cardinality*sizeof(uint64_t));
+	multibox_container_t *const new_container = (multibox_container_t *const) malloc (sizeof(multibox_container_t));
 
-	for (uint32_t i=0; i<cardinality; ++i) {
-		pthread_rwlock_rdlock (&TREE(i)->tree_lock);
+	new_container->page_ids = (uint64_t *const) malloc (cardinality*sizeof(uint64_t));
+	memcpy (new_container->page_ids,container->page_ids,cardinality*sizeof(uint64_t));
+	new_container->page_ids[i] = child_id;
 
-		memcpy (container->boxes+i*dimensions,
-				TREE(i)->root_box,
-				dimensions*sizeof(interval_t));
+	new_container->boxes = (interval_t *const) malloc (cardinality*dimensions*sizeof(interval_t));
+	memcpy (new_container->boxes,container->boxes,cardinality*dimensions*sizeof(interval_t));
+	memcpy (new_container->boxes+i*dimensions,child_box,dimensions*sizeof(interval_t));
 
-		pthread_rwlock_unlock (&TREE(i)->tree_lock);
-	}
+	new_container->cardinality = cardinality;
+	new_container->dimensions = dimensions;
+	new_container->sort_key = container->sort_key;
 
-	insert_into_stack (browse,container);
+	return new_container;
+}
 
-	while (browse->size) {
-		container = remove_from_stack (browse);
 
-		boolean all_leaves = true;
-		for (uint32_t i=0; i<container->cardinality; ++i) {
-			uint64_t const page_id = container->page_ids[i];
-			page_t const*const page = load_page (TREE(i),page_id);
+typedef struct {
+	index_t coordinate;
+	uint32_t offset;
+} sweep_entry_t;
 
-			pthread_rwlock_rdlock (&TREE(i)->tree_lock);
-			pthread_rwlock_t *const page_lock = (pthread_rwlock_t *const) get(TREE(i)->page_locks,page_id);
-			pthread_rwlock_unlock (&TREE(i)->tree_lock);
+/**
+ * Consumes a combination of leaf entries and returns the
+ * (possibly tightened) window for the ones to follow.
+ */
+typedef double (*combination_visitor_t) (multidata_container_t *const, void *const);
+
+typedef struct {
+	lifo_t* trees;
+	page_t const** pages;
+	sweep_entry_t** entries;
+	uint32_t* offsets;
+
+	uint32_t cardinality;
+	uint32_t dimensions;
+
+	boolean pairwise;
+	boolean sweep;
+	double window;
+
+	combination_visitor_t visit;
+	void* args;
+} leaf_combinations_t;
+
+static
+int compare_sweep_entries (void const*const x, void const*const y) {
+	if (((sweep_entry_t const*)x)->coordinate < ((sweep_entry_t const*)y)->coordinate) return -1;
+	else if (((sweep_entry_t const*)x)->coordinate > ((sweep_entry_t const*)y)->coordinate) return 1;
+	else return 0;
+}
 
-			assert (page_lock != NULL);
+static
+void visit_leaf_combination (leaf_combinations_t *const combinations) {
+	lifo_t *const trees = combinations->trees;
+	uint32_t const cardinality = combinations->cardinality;
+	uint32_t const dimensions = combinations->dimensions;
 
-			if (pthread_rwlock_tryrdlock (page_lock)) {
-				while (browse->size) {
-					multibox_container_t* temp = remove_from_stack (browse);
+	multidata_container_t *const data_container = (multidata_container_t *const) malloc (sizeof(multidata_container_t));
 
-					free (temp->page_ids);
-					free (temp->boxes);
-					free (temp);
+	data_container->keys = (index_t *const) malloc (cardinality*dimensions*sizeof(index_t));
+	data_container->objects = (object_t *const) malloc (cardinality*sizeof(object_t));
+	data_container->cardinality = cardinality;
+	data_container->dimensions = dimensions;
+
+	for (uint32_t i=0; i<cardinality; ++i) {
+		uint32_t const offset = combinations->offsets[i];
+		data_container->objects[i] = combinations->pages[i]->node.leaf.objects[offset];
+
+		memcpy (data_container->keys+i*dimensions,
+				combinations->pages[i]->node.leaf.keys+offset*TREE(i)->dimensions,
+				dimensions*sizeof(index_t));
+	}
+
+	double const window = combinations->visit (data_container,combinations->args);
+	if (combinations->sweep) {
+		combinations->window = window;
+	}
+}
+
+/**
+ * Picks an entry from the i-th leaf for every combination of entries
+ * already picked from the preceding ones. When sweeping, only entries
+ * within the window from the previous entry along the sweep axis are
+ * considered, or from all previous entries for pairwise distances.
+ */
+static
+void sweep_leaf_combinations (leaf_combinations_t *const combinations, uint32_t const i,
+				double const previous, double const lowest, double const highest) {
+
+	sweep_entry_t const*const entries = combinations->entries[i];
+	uint32_t const records = combinations->pages[i]->header.records;
+
+	double const lo_reference = combinations->pairwise ? highest : previous;
+	double const hi_reference = combinations->pairwise ? lowest : previous;
+
+	uint32_t position = 0;
+	if (i && combinations->sweep) {
+		uint32_t upper = records;
+		while (position < upper) {
+			uint32_t const middle = position + ((upper-position)>>1);
+			if (entries[middle].coordinate < lo_reference - combinations->window) {
+				position = middle+1;
+			}else{
+				upper = middle;
+			}
+		}
+	}
+
+	for (; position<records; ++position) {
+		double const coordinate = entries[position].coordinate;
+		if (i && combinations->sweep) {
+			if (coordinate > hi_reference + combinations->window) break;
+			if (coordinate < lo_reference - combinations->window) continue;
+		}
+
+		combinations->offsets[i] = entries[position].offset;
+		if (i+1 < combinations->cardinality) {
+			sweep_leaf_combinations (combinations,i+1,coordinate,
+						i ? MIN(lowest,coordinate) : coordinate,
+						i ? MAX(highest,coordinate) : coordinate);
+		}else{
+			visit_leaf_combination (combinations);
+		}
+	}
+}
+
+/**
+ * Enumerates the combinations of entries from a combination of leaves, one
+ * entry from each leaf. Given a finite window, that is an upper bound on the
+ * distance of consecutive entries (or of any two for pairwise distances) in
+ * a qualifying combination, and enough combinations, a plane-sweep along the
+ * axis where entries are spread the most skips most of the non-qualifying
+ * ones; otherwise all of them are visited.
+ */
+static
+void enumerate_leaf_combinations (lifo_t *const trees, page_t const* pages[], uint32_t const dimensions,
+				boolean const pairwise, double const window,
+				combination_visitor_t const visit, void *const args) {
+
+	uint32_t const cardinality = trees->size;
+
+	uint64_t combinations_number = 1;
+	for (uint32_t i=0; i<cardinality; ++i) {
+		if (!pages[i]->header.records) return;
+		combinations_number *= pages[i]->header.records;
+	}
+
+	boolean const sweep = cardinality > 1 && isfinite(window) && combinations_number > PLANE_SWEEP_MIN_COMBINATIONS;
+
+	uint32_t axis = 0;
+	if (sweep) {
+		double max_extent = -1;
+		for (uint32_t j=0; j<dimensions; ++j) {
+			index_t lo = INDEX_T_MAX;
+			index_t hi = -INDEX_T_MAX;
+			for (uint32_t i=0; i<cardinality; ++i) {
+				for (register uint32_t offset=0; offset<pages[i]->header.records; ++offset) {
+					index_t const coordinate = pages[i]->node.leaf.keys[offset*TREE(i)->dimensions+j];
+					if (coordinate < lo) lo = coordinate;
+					if (coordinate > hi) hi = coordinate;
 				}
+			}
+			if (hi-lo > max_extent) {
+				max_extent = hi-lo;
+				axis = j;
+			}
+		}
+	}
+
+	sweep_entry_t* entries [cardinality];
+	for (uint32_t i=0; i<cardinality; ++i) {
+		entries[i] = (sweep_entry_t*) malloc (pages[i]->header.records*sizeof(sweep_entry_t));
+		for (register uint32_t offset=0; offset<pages[i]->header.records; ++offset) {
+			entries[i][offset].coordinate = pages[i]->node.leaf.keys[offset*TREE(i)->dimensions+axis];
+			entries[i][offset].offset = offset;
+		}
+		if (sweep) {
+			qsort (entries[i],pages[i]->header.records,sizeof(sweep_entry_t),&compare_sweep_entries);
+		}
+	}
+
+	uint32_t offsets [cardinality];
+
+	leaf_combinations_t combinations = {
+		.trees = trees,
+		.pages = pages,
+		.entries = entries,
+		.offsets = offsets,
+		.cardinality = cardinality,
+		.dimensions = dimensions,
+		.pairwise = pairwise,
+		.sweep = sweep,
+		.window = window,
+		.visit = visit,
+		.args = args
+	};
+
+	sweep_leaf_combinations (&combinations,0,0,0,0);
+
+	for (uint32_t i=0; i<cardinality; ++i) {
+		free (entries[i]);
+	}
+}
+
+/**
+ * The largest distance two consecutive entries (or any two for pairwise
+ * distances) may have in a combination of the given aggregate distance.
+ */
+static
+double combination_window (double const distance, uint32_t const cardinality, boolean const use_avg, boolean const pairwise) {
+	if (cardinality < 2) return INFINITY;
+	else if (!use_avg) return distance;
+	else if (pairwise) return distance*cardinality*(cardinality-1)/2;
+	else return distance*(cardinality-1);
+}
+
+
+/**
+ * Orders combinations by their distance and then by their objects, so
+ * that ties are resolved the same way regardless of the order in which
+ * the combinations are produced, e.g. by the workers of a parallel join.
+ */
+static
+int compare_combinations (multidata_container_t const*const x, multidata_container_t const*const y) {
+	if (x->sort_key < y->sort_key) return -1;
+	else if (x->sort_key > y->sort_key) return 1;
+
+	for (uint32_t i=0; i<x->cardinality; ++i) {
+		if (x->objects[i] < y->objects[i]) return -1;
+		else if (x->objects[i] > y->objects[i]) return 1;
+	}
+	return 0;
+}
+
+static
+int mincompare_combinations (void const*const x, void const*const y) {
+	return compare_combinations (x,y);
+}
+
+static
+int maxcompare_combinations (void const*const x, void const*const y) {
+	return compare_combinations (y,x);
+}
+
+
+typedef struct {
+	spill_t* results;
+	double theta;
+	double window;
+	boolean less_than_theta;
+	boolean pairwise;
+	boolean use_avg;
+} distance_join_visitor_t;
+
+static
+double distance_join_visit (multidata_container_t *const data_container, void *const args) {
+	distance_join_visitor_t *const visitor = (distance_join_visitor_t *const) args;
+	boolean const use_avg = visitor->use_avg;
+	boolean const pairwise = visitor->pairwise;
+	boolean const less_than_theta = visitor->less_than_theta;
+
+	data_container->sort_key = use_avg?
+			(pairwise?avgdistance_pairwise_multikey(data_container,0):avgdistance_ordered_multikey(data_container,0))
+			:(less_than_theta?
+			(pairwise?maxdistance_pairwise_multikey(data_container,0):maxdistance_ordered_multikey(data_container,0))
+			:(pairwise?mindistance_pairwise_multikey(data_container,0):mindistance_ordered_multikey(data_container,0)));
+
+	if (less_than_theta ? data_container->sort_key <= visitor->theta : data_container->sort_key >= visitor->theta) {
+		insert_into_spill (visitor->results,data_container);
+	}else{
+		delete_multidata_container (data_container);
+	}
+	return visitor->window;
+}
+
+
+/**
+ * The threshold is the k-th distance among the combinations kept by the
+ * visitor; a parallel join also shares the best such threshold among its
+ * workers, which bounds the k-th distance of the overall result as well.
+ */
+typedef struct {
+	priority_queue_t* data_combinations;
+	double* threshold;
+	double* shared_threshold;
+	uint32_t cardinality;
+	uint32_t k;
+	boolean closest;
+	boolean pairwise;
+	boolean use_avg;
+} x_tuples_visitor_t;
+
+static
+double x_tuples_visit (multidata_container_t *const data_container, void *const args) {
+	x_tuples_visitor_t *const visitor = (x_tuples_visitor_t *const) args;
+	priority_queue_t *const data_combinations = visitor->data_combinations;
+	boolean const use_avg = visitor->use_avg;
+	boolean const pairwise = visitor->pairwise;
+	boolean const closest = visitor->closest;
+
+	data_container->sort_key = closest ?
+			(use_avg?
+			(pairwise?
+			avgdistance_pairwise_multikey(data_container,0)
+			:avgdistance_ordered_multikey(data_container,0))
+			:(pairwise?
+			maxdistance_pairwise_multikey(data_container,0)
+			:maxdistance_ordered_multikey(data_container,0)))
+			:(use_avg?
+			(pairwise?
+			avgdistance_pairwise_multikey(data_container,0)
+			:avgdistance_ordered_multikey(data_container,0))
+			:(pairwise?
+			mindistance_pairwise_multikey(data_container,0)
+			:mindistance_ordered_multikey(data_container,0)));
+
+	if (visitor->shared_threshold != NULL
+		&& (closest ?
+			data_container->sort_key > read_shared_value (visitor->shared_threshold)
+			:data_container->sort_key < read_shared_value (visitor->shared_threshold))) {
+
+		delete_multidata_container (data_container);
+	}else if (data_combinations->size < visitor->k) {
+		insert_into_priority_queue (data_combinations,data_container);
+	}else if (data_combinations->compare (data_container,peek_priority_queue (data_combinations)) > 0) {
+		delete_multidata_container (remove_from_priority_queue(data_combinations));
+		insert_into_priority_queue (data_combinations,data_container);
+	}else{
+		delete_multidata_container (data_container);
+	}
+
+	if (data_combinations->size == visitor->k) {
+		*visitor->threshold = ((multidata_container_t*) peek_priority_queue(data_combinations))->sort_key;
+		if (visitor->shared_threshold != NULL) {
+			if (closest) update_shared_minimum (visitor->shared_threshold,*visitor->threshold);
+			else update_shared_maximum (visitor->shared_threshold,*visitor->threshold);
+		}
+	}
+
+	double const threshold = visitor->shared_threshold != NULL ? read_shared_value (visitor->shared_threshold) : *visitor->threshold;
+	return closest ? combination_window (threshold,visitor->cardinality,use_avg,pairwise) : INFINITY;
+}
+
+
+/**
+ * Results are spilled to disk in sorted runs whenever they take up
+ * more than the given memory limit (none if zero), and the returned
+ * spill yields them in the order they are to be reported.
+ */
+spill_t* distance_join (double const theta,
+			boolean const less_than_theta,
+			boolean const pairwise,
+			boolean const use_avg,
+			lifo_t *const trees,
+			approximation_t *const approximation,
+			uint64_t const memory_limit) {
+
+	if (approximation != NULL) {
+		approximation->bound = theta;
+	}
+
+	spill_t *const results = new_spill (less_than_theta?&mincompare_combinations:&maxcompare_combinations,memory_limit);
+
+	if (!trees->size) return results;
+	if (less_than_theta && theta < 0) {
+		LOG (warn,"No point for negative distances in predicate joins...\n");
+		return results;
+	}
+
+	uint32_t const cardinality = trees->size;
+	uint32_t dimensions = UINT_MAX;
+	for (uint32_t i=0; i<trees->size; ++i) {
+		if (((tree_t *const)trees->buffer[i])->dimensions < dimensions) {
+			dimensions = ((tree_t *const)trees->buffer[i])->dimensions;
+		}
+	}
+
+	double const relaxation = approximation != NULL && approximation->epsilon > 0 ? 1+approximation->epsilon : 1;
+	uint64_t const max_pages = approximation != NULL ? approximation->max_pages : 0;
+
+	/**
+	 * Combinations of boxes are only explored if they may
+	 * enclose results that lie (1+epsilon) times closer
+	 * (resp. farther) than theta.
+	 */
+	double const pruning_theta = less_than_theta ? theta/relaxation : theta*relaxation;
+
+	lifo_t *const browse = new_stack();
+
+	/* the closest (resp. farthest) distance from any combination left unexplored */
+	double unexplored = less_than_theta ? DBL_MAX : 0;
+	uint64_t visited_pages = 0;
+
+	/* the cap on pages only stops the depth-first descent once it joined leaves */
+	boolean has_reached_leaves = false;
+
+	reset_search_operation:;
+
+	clear_spill (results);
+	unexplored = less_than_theta ? DBL_MAX : 0;
+	visited_pages = 0;
+	has_reached_leaves = false;
+
+	multibox_container_t* container = (multibox_container_t*) malloc (sizeof(multibox_container_t));
+
+	container->boxes = (interval_t *const) malloc (cardinality*dimensions*sizeof(interval_t));
+	container->page_ids = (uint64_t*const) malloc (cardinality*sizeof(uint64_t));
+	container->cardinality = cardinality;
+	container->dimensions = dimensions;
+
+	bzero (container->page_ids,cardinality*sizeof(uint64_t));
+
+	for (uint32_t i=0; i<cardinality; ++i) {
+		pthread_rwlock_rdlock (&TREE(i)->tree_lock);
+
+		memcpy (container->boxes+i*dimensions,
+				TREE(i)->root_box,
+				dimensions*sizeof(interval_t));
+
+		pthread_rwlock_unlock (&TREE(i)->tree_lock);
+	}
+
+	insert_into_stack (browse,container);
 
-				for (uint32_t j=0; j<i; ++j) {
-					pthread_rwlock_rdlock (&TREE(j)->tree_lock);
-					pthread_rwlock_t *const previous_lock = (pthread_rwlock_t *const) get(TREE(j)->page_locks,page_id);
-					pthread_rwlock_unlock (&TREE(j)->tree_lock);
+	while (browse->size) {
+		container = remove_from_stack (browse);
+
+		if (max_pages && visited_pages >= max_pages && has_reached_leaves) {
+			insert_into_stack (browse,container);
+			while (browse->size) {
+				container = remove_from_stack (browse);
 
-					pthread_rwlock_unlock (previous_lock);
+				double const distance = less_than_theta
+						? multibox_mindistance (container,use_avg,pairwise)
+						: multibox_maxdistance (container,use_avg,pairwise);
+
+				if (less_than_theta ? distance < unexplored : distance > unexplored) {
+					unexplored = distance;
 				}
 
+				TRACE_EVENT(nodes_pruned);
+				delete_multibox_container (container);
+			}
+			break;
+		}
+
+		boolean all_leaves = true;
+		for (uint32_t i=0; i<container->cardinality; ++i) {
+			uint64_t const page_id = container->page_ids[i];
+
+			load_page_return_pair_t *const load_pair = load_page (TREE(i),page_id);
+			pthread_rwlock_t *const page_lock = load_pair->page_lock;
+			page_t const*const page = load_pair->page;
+			free (load_pair);
+
+			assert (page != NULL);
+			assert (page_lock != NULL);
+
+			if (TRYRDLOCK (TREE(i),page_lock)) {
+				delete_multibox_container (container);
+				while (browse->size) {
+					delete_multibox_container (remove_from_stack (browse));
+				}
 				goto reset_search_operation;
 			}else{
+				++visited_pages;
 				if (!page->header.is_leaf) {
 					all_leaves = false;
 
 					uint32_t j = page->header.records-1;
 					do{
-						multibox_container_t *const new_container = (multibox_container_t *const) malloc (sizeof(multibox_container_t));
-
-						new_container->page_ids = (uint64_t *const) malloc (cardinality*sizeof(uint64_t));
-						memcpy (new_container->page_ids,container->page_ids,cardinality*sizeof(uint64_t));
-						new_container->page_ids[i] = page_id*TREE(i)->internal_entries+j+1;
-
-						new_container->boxes = (interval_t *const) malloc (cardinality*dimensions*sizeof(interval_t));
-						memcpy (new_container->boxes,container->boxes,cardinality*dimensions*sizeof(interval_t));
-						memcpy (new_container->boxes+i*dimensions,
-								page->node.internal.intervals+j*dimensions,
-								dimensions*sizeof(interval_t));
-
-						new_container->cardinality = cardinality;
-						new_container->dimensions = dimensions;
-
-						if ((less_than_theta && theta >= (use_avg?
-									(pairwise?
-									avg_mindistance_pairwise_multibox(new_container,0)
-									:avg_mindistance_ordered_multibox(new_container,0))
-									 :(pairwise?
-									max_mindistance_pairwise_multibox(new_container,0)
-									:max_mindistance_ordered_multibox(new_container,0))))
-						|| (!less_than_theta && theta <= (use_avg?
-									(pairwise?
-									avg_maxdistance_pairwise_multibox(new_container,0)
-									:avg_maxdistance_ordered_multibox(new_container,0))
-									 :(pairwise?
-									min_maxdistance_pairwise_multibox(new_container,0)
-									:min_maxdistance_ordered_multibox(new_container,0))))){
-
-								insert_into_stack (browse,new_container);
+						multibox_container_t *const new_container = new_child_multibox_container (container,i,
+											page_id*TREE(i)->internal_entries+j+1,
+											page->node.internal.intervals+j*dimensions);
+
+						double const distance = less_than_theta
+								? multibox_mindistance (new_container,use_avg,pairwise)
+								: multibox_maxdistance (new_container,use_avg,pairwise);
+
+						if (less_than_theta ? pruning_theta >= distance : pruning_theta <= distance) {
+							insert_into_stack (browse,new_container);
 						}else{
-							free (new_container->page_ids);
-							free (new_container->boxes);
-							free (new_container);
+							if (less_than_theta ? distance < unexplored : distance > unexplored) {
+								unexplored = distance;
+							}
+							TRACE_EVENT(nodes_pruned);
+							delete_multibox_container (new_container);
 						}
 
 						if (j) --j;
@@ -831,11 +2131,10 @@ fifo_t* distance_join (double const theta,
 			pthread_rwlock_t* page_locks [cardinality];
 
 			for (uint32_t i=0; i<cardinality; ++i) {
-				page_t const*const page = load_page (TREE(i),container->page_ids[i]);
-
-				pthread_rwlock_rdlock (&TREE(i)->tree_lock);
-				pthread_rwlock_t *const page_lock = (pthread_rwlock_t *const) get(TREE(i)->page_locks,container->page_ids[i]);
-				pthread_rwlock_unlock (&TREE(i)->tree_lock);
+				load_page_return_pair_t *const load_pair = load_page (TREE(i),container->page_ids[i]);
+				pthread_rwlock_t *const page_lock = load_pair->page_lock;
+				page_t const*const page = load_pair->page;
+				free (load_pair);
 
 				assert (page_lock != NULL);
 
@@ -845,88 +2144,87 @@ fifo_t* distance_join (double const theta,
 				page_locks[i] = page_lock;
 				pages[i] = page;
 
-				if (pthread_rwlock_tryrdlock (page_lock)) {
+				if (TRYRDLOCK (TREE(i),page_lock)) {
 					for (uint32_t j=0; j<i; ++j) {
 						pthread_rwlock_unlock (page_locks[j]);
 					}
+
+					delete_multibox_container (container);
+					while (browse->size) {
+						delete_multibox_container (remove_from_stack (browse));
+					}
 					goto reset_search_operation;
 				}
 			}
+			has_reached_leaves = true;
 
-			uint64_t offsets [cardinality];
-			bzero (offsets,cardinality*sizeof(uint64_t));
-
-			for (uint64_t j=0,i=0;;++j) {
-				if (offsets[i] >= pages[i]->header.records) {
-					offsets[i++] = 0;
-					if (i >= cardinality)
-						break;
-				}else{
-					multidata_container_t *const data_container = (multidata_container_t *const) malloc (sizeof(multidata_container_t));
-
-					data_container->keys = (index_t *const) malloc (cardinality*dimensions*sizeof(index_t));
-					data_container->objects = (object_t *const) malloc (cardinality*sizeof(object_t));
-					data_container->cardinality = cardinality;
-					data_container->dimensions = dimensions;
-
-					for (uint32_t offset=0; offset<cardinality; ++offset) {
-						data_container->objects[offset] = pages[offset]->node.leaf.objects[offsets[offset]];
-
-						memcpy (data_container->keys+offset*dimensions,
-								pages[offset]->node.leaf.keys+offsets[offset]*TREE(offset)->dimensions,
-								dimensions*sizeof(index_t));
-					}
-
-					data_container->sort_key = use_avg?
-							(pairwise?avgdistance_pairwise_multikey(data_container,0):avgdistance_ordered_multikey(data_container,0))
-							:(less_than_theta?
-							(pairwise?maxdistance_pairwise_multikey(data_container,0):maxdistance_ordered_multikey(data_container,0))
-							:(pairwise?mindistance_pairwise_multikey(data_container,0):mindistance_ordered_multikey(data_container,0)));
+			distance_join_visitor_t visitor = {
+				.results = results,
+				.theta = theta,
+				.window = less_than_theta ? combination_window (theta,cardinality,use_avg,pairwise) : INFINITY,
+				.less_than_theta = less_than_theta,
+				.pairwise = pairwise,
+				.use_avg = use_avg
+			};
 
-					if (less_than_theta ? data_container->sort_key <= theta : data_container->sort_key >= theta) {
-							insert_into_priority_queue (data_combinations,data_container);
-					}else{
-							free (data_container->objects);
-							free (data_container->keys);
-							free (data_container);
-					}
-					i=0;
-				}
-				++offsets[i];
-			}
+			enumerate_leaf_combinations (trees,pages,dimensions,pairwise,visitor.window,&distance_join_visit,&visitor);
 
 			for (uint32_t i=0; i<cardinality; ++i) {
 				pthread_rwlock_unlock (page_locks[i]);
 			}
-
-			free (container->page_ids);
-			free (container->boxes);
-			free (container);
 			/******************************************/
-		}else{
-			free (container->page_ids);
-			free (container->boxes);
-			free (container);
 		}
+
+		delete_multibox_container (container);
 	}
 
 	delete_stack (browse);
 
-	fifo_t *const result = new_queue();
-	while (data_combinations->size) {
-		insert_at_tail_of_queue(result,remove_from_priority_queue(data_combinations));
+	if (approximation != NULL) {
+		approximation->bound = less_than_theta ? MIN(theta,unexplored) : MAX(theta,unexplored);
 	}
 
-	delete_priority_queue (data_combinations);
+	return results;
+}
 
-	return result;
+
+/**
+ * All combinations closer (resp. farther) than the unexplored
+ * ones have been examined, hence the i-th reported distance is
+ * off from the exact i-th distance at most by the ratio of the
+ * last reported distance to the unexplored one, even if fewer
+ * than k combinations were found before the cap on pages.
+ */
+static
+double x_tuples_bound (boolean const closest, uint64_t const reported, double const last, double const unexplored) {
+	if (closest) {
+		if (unexplored == DBL_MAX || (reported && last <= unexplored)) {
+			return 1;
+		}else if (!reported || unexplored <= 0) {
+			return INFINITY;
+		}else{
+			return last / unexplored;
+		}
+	}else{
+		if (unexplored <= 0 || (reported && last >= unexplored)) {
+			return 1;
+		}else if (!reported || last <= 0) {
+			return INFINITY;
+		}else{
+			return unexplored / last;
+		}
+	}
 }
 
+fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg, boolean const pairwise,
+			lifo_t *const trees, approximation_t *const approximation) {
+
+	if (approximation != NULL) {
+		approximation->bound = 1;
+	}
 
-fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg, boolean const pairwise, lifo_t *const trees) {
 	if (!k || !trees->size) return new_queue();
 
-	index_t threshold = closest ? INDEX_T_MAX : -INDEX_T_MAX;
 	uint32_t const cardinality = trees->size;
 	uint32_t dimensions = UINT_MAX;
 
@@ -936,10 +2234,32 @@ fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg
 		}
 	}
 
-	priority_queue_t *const data_combinations = new_priority_queue (closest?&maxcompare_multicontainers:&mincompare_multicontainers);
+	double const relaxation = approximation != NULL && approximation->epsilon > 0 ? 1+approximation->epsilon : 1;
+	uint64_t const max_pages = approximation != NULL ? approximation->max_pages : 0;
+
+	priority_queue_t *const data_combinations = new_priority_queue (closest?&maxcompare_combinations:&mincompare_combinations);
 	priority_queue_t *const browse = new_priority_queue (closest?&mincompare_multicontainers:&maxcompare_multicontainers);
 
+	double threshold = closest ? INDEX_T_MAX : -INDEX_T_MAX;
+
+	/* the closest (resp. farthest) distance from any combination left unexplored */
+	double unexplored = closest ? DBL_MAX : 0;
+	uint64_t visited_pages = 0;
+
+	/* past the cap on pages, only the most promising child is followed down to first leaves */
+	multibox_container_t* descent = NULL;
+	boolean has_reached_leaves = false;
+
 	reset_search_operation:;
+
+	while (data_combinations->size) {
+		delete_multidata_container (remove_from_priority_queue (data_combinations));
+	}
+	threshold = closest ? INDEX_T_MAX : -INDEX_T_MAX;
+	unexplored = closest ? DBL_MAX : 0;
+	visited_pages = 0;
+	has_reached_leaves = false;
+
 	multibox_container_t* container = (multibox_container_t*) malloc (sizeof(multibox_container_t));
 	container->boxes = (interval_t *const) malloc (cardinality*dimensions*sizeof(interval_t));
 	container->page_ids = (uint64_t *const) malloc (cardinality*sizeof(uint64_t));
@@ -961,23 +2281,24 @@ fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg
 
 	insert_into_priority_queue (browse,container);
 
-	while (browse->size) {
-		container = remove_from_priority_queue (browse);
+	while (browse->size || descent != NULL) {
+		container = descent != NULL ? descent : remove_from_priority_queue (browse);
+		descent = NULL;
 
-		if (closest ?
-			container->sort_key > threshold
-			:container->sort_key < threshold) {
+		boolean const is_capped = max_pages && visited_pages >= max_pages;
+		if ((closest ?
+			container->sort_key * relaxation > threshold
+			:container->sort_key < threshold * relaxation)
+			|| (is_capped && has_reached_leaves)) {
 
-			free (container->page_ids);
-			free (container->boxes);
-			free (container);
+			if (closest ? container->sort_key < unexplored : container->sort_key > unexplored) {
+				unexplored = container->sort_key;
+			}
 
+			TRACE_EVENTS(nodes_pruned,1+browse->size);
+			delete_multibox_container (container);
 			while (browse->size) {
-				container = remove_from_priority_queue (browse);
-
-				free (container->page_ids);
-				free (container->boxes);
-				free (container);
+				delete_multibox_container (remove_from_priority_queue (browse));
 			}
 
 			break;
@@ -986,64 +2307,63 @@ fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg
 		boolean all_leaves = true;
 		for (uint32_t i=0; i<container->cardinality; ++i) {
 			uint64_t const page_id = container->page_ids[i];
-			page_t const*const page = load_page (TREE(i),page_id);
 
-			pthread_rwlock_rdlock (&TREE(i)->tree_lock);
-			pthread_rwlock_t *const page_lock = (pthread_rwlock_t *const) get(TREE(i)->page_locks,page_id);
-			pthread_rwlock_unlock (&TREE(i)->tree_lock);
+			load_page_return_pair_t *const load_pair = load_page (TREE(i),page_id);
+			pthread_rwlock_t *const page_lock = load_pair->page_lock;
+			page_t const*const page = load_pair->page;
+			free (load_pair);
 
+			assert (page != NULL);
 			assert (page_lock != NULL);
 
-			if (pthread_rwlock_tryrdlock (page_lock)) {
+			if (TRYRDLOCK (TREE(i),page_lock)) {
+				delete_multibox_container (container);
 				while (browse->size) {
-					multibox_container_t* temp = remove_from_priority_queue (browse);
-
-					free (temp->page_ids);
-					free (temp->boxes);
-					free (temp);
-				}
-
-				for (uint32_t j=0; j<i; ++j) {
-					pthread_rwlock_rdlock (&TREE(j)->tree_lock);
-					pthread_rwlock_t *const previous_lock = (pthread_rwlock_t *const) get(TREE(j)->page_locks,page_id);
-					pthread_rwlock_unlock (&TREE(j)->tree_lock);
-
-					pthread_rwlock_unlock (previous_lock);
+					delete_multibox_container (remove_from_priority_queue (browse));
 				}
-
 				goto reset_search_operation;
 			}
 
+			++visited_pages;
 			if (!page->header.is_leaf) {
 				all_leaves = false;
 				for (register uint32_t j=0; j<page->header.records; ++j) {
-					multibox_container_t *const new_container = (multibox_container_t *const) malloc (sizeof(multibox_container_t));
-
-					new_container->page_ids = (uint64_t *const) malloc (cardinality*sizeof(uint64_t));
-					memcpy (new_container->page_ids,container->page_ids,cardinality*sizeof(uint64_t));
-					new_container->page_ids[i] = page_id*TREE(i)->internal_entries+j+1;
-
-					new_container->boxes = (interval_t *const) malloc (cardinality*dimensions*sizeof(interval_t));
-					memcpy (new_container->boxes,container->boxes,cardinality*dimensions*sizeof(interval_t));
-					memcpy (new_container->boxes+i*dimensions,
-							page->node.internal.intervals+j*dimensions,
-							dimensions*sizeof(interval_t));
+					multibox_container_t *const new_container = new_child_multibox_container (container,i,
+										page_id*TREE(i)->internal_entries+j+1,
+										page->node.internal.intervals+j*dimensions);
 
-					new_container->cardinality = cardinality;
-					new_container->dimensions = dimensions;
 					new_container->sort_key = closest ?
-							(use_avg?
-							(pairwise?avg_mindistance_pairwise_multibox(new_container,0):avg_mindistance_ordered_multibox(new_container,0))
-							:(pairwise?max_mindistance_pairwise_multibox(new_container,0):max_mindistance_ordered_multibox(new_container,0)))
-							:(use_avg?
-							(pairwise?avg_maxdistance_pairwise_multibox(new_container,0):avg_maxdistance_ordered_multibox(new_container,0))
-							:(pairwise?min_maxdistance_pairwise_multibox(new_container,0):min_maxdistance_ordered_multibox(new_container,0)));
+							multibox_mindistance (new_container,use_avg,pairwise)
+							:multibox_maxdistance (new_container,use_avg,pairwise);
 
 					if (closest?
-						new_container->sort_key < threshold
-						:new_container->sort_key > threshold) {
+						new_container->sort_key * relaxation <= threshold
+						:new_container->sort_key >= threshold * relaxation) {
 
-						insert_into_priority_queue (browse,new_container);
+						if (!is_capped) {
+							insert_into_priority_queue (browse,new_container);
+							continue;
+						}
+
+						multibox_container_t* other = new_container;
+						if (descent == NULL || (closest ? new_container->sort_key < descent->sort_key
+										: new_container->sort_key > descent->sort_key)) {
+							other = descent;
+							descent = new_container;
+						}
+						if (other != NULL) {
+							if (closest ? other->sort_key < unexplored : other->sort_key > unexplored) {
+								unexplored = other->sort_key;
+							}
+							TRACE_EVENT(nodes_pruned);
+							delete_multibox_container (other);
+						}
+					}else{
+						if (closest ? new_container->sort_key < unexplored : new_container->sort_key > unexplored) {
+							unexplored = new_container->sort_key;
+						}
+						TRACE_EVENT(nodes_pruned);
+						delete_multibox_container (new_container);
 					}
 				}
 
@@ -1057,11 +2377,10 @@ fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg
 			pthread_rwlock_t * page_locks [cardinality];
 
 			for (uint32_t i=0; i<cardinality; ++i) {
-				page_t const* page = load_page(TREE(i),container->page_ids[i]);
-
-				pthread_rwlock_rdlock (&TREE(i)->tree_lock);
-				pthread_rwlock_t *const page_lock = (pthread_rwlock_t *const) get(TREE(i)->page_locks,container->page_ids[i]);
-				pthread_rwlock_unlock (&TREE(i)->tree_lock);
+				load_page_return_pair_t *const load_pair = load_page (TREE(i),container->page_ids[i]);
+				pthread_rwlock_t *const page_lock = load_pair->page_lock;
+				page_t const*const page = load_pair->page;
+				free (load_pair);
 
 				assert (page_lock != NULL);
 
@@ -1071,97 +2390,51 @@ fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg
 				page_locks[i] = page_lock;
 				pages[i] = page;
 
-				if (pthread_rwlock_tryrdlock (page_lock)) {
-
-					while (browse->size) {
-						multibox_container_t* temp = remove_from_priority_queue (browse);
-
-						free (temp->page_ids);
-						free (temp->boxes);
-						free (temp);
-					}
-
+				if (TRYRDLOCK (TREE(i),page_lock)) {
 					for (uint32_t j=0; j<i; ++j) {
 						pthread_rwlock_unlock (page_locks[j]);
 					}
 
-					goto reset_search_operation;
-				}
-			}
-
-			uint64_t offsets [cardinality];
-			bzero (offsets,cardinality*sizeof(uint64_t));
-
-			for (uint64_t j=0,i=0;;++j) {
-				if (offsets[i] >= pages[i]->header.records) {
-					offsets[i++] = 0;
-					if (i >= cardinality)
-						break;
-				}else{
-					multidata_container_t *const data_container = (multidata_container_t *const) malloc (sizeof(multidata_container_t));
-					data_container->keys = (index_t *const) malloc (cardinality*dimensions*sizeof(index_t));
-					data_container->objects = (object_t *const) malloc (cardinality*sizeof(object_t));
-
-					for (uint32_t offset=0; offset<cardinality; ++offset) {
-						data_container->objects[offset] = pages[offset]->node.leaf.objects[offsets[offset]];
-						memcpy (data_container->keys+offset*dimensions,
-								pages[offset]->node.leaf.keys+offsets[offset]*TREE(offset)->dimensions,
-								dimensions*sizeof(index_t));
-					}
-
-					data_container->cardinality = cardinality;
-					data_container->dimensions = dimensions;
-					data_container->sort_key = closest ?
-							(use_avg?
-							(pairwise?
-							avgdistance_pairwise_multikey(data_container,0)
-							:avgdistance_ordered_multikey(data_container,0))
-							:(pairwise?
-							maxdistance_pairwise_multikey(data_container,0)
-							:maxdistance_ordered_multikey(data_container,0)))
-							:(use_avg?
-							(pairwise?
-							avgdistance_pairwise_multikey(data_container,0)
-							:avgdistance_ordered_multikey(data_container,0))
-							:(pairwise?
-							mindistance_pairwise_multikey(data_container,0)
-							:mindistance_ordered_multikey(data_container,0)));
-
-					if (data_combinations->size < k) {
-						insert_into_priority_queue (data_combinations,data_container);
-					}else if (closest ?
-							data_container->sort_key < threshold
-							:data_container->sort_key > threshold) {
-
-						multidata_container_t* temp = remove_from_priority_queue(data_combinations);
-
-						free (temp->objects);
-						free (temp->keys);
-						free (temp);
-
-						insert_into_priority_queue (data_combinations,data_container);
+					delete_multibox_container (container);
+					while (browse->size) {
+						delete_multibox_container (remove_from_priority_queue (browse));
 					}
 
-					if (data_combinations->size == k) {
-						threshold = ((multidata_container_t*) peek_priority_queue(data_combinations))->sort_key;
-					}
-					i=0;
+					goto reset_search_operation;
 				}
-				++offsets[i];
 			}
+			has_reached_leaves = true;
+
+			x_tuples_visitor_t visitor = {
+				.data_combinations = data_combinations,
+				.threshold = &threshold,
+				.shared_threshold = NULL,
+				.cardinality = cardinality,
+				.k = k,
+				.closest = closest,
+				.pairwise = pairwise,
+				.use_avg = use_avg
+			};
+
+			enumerate_leaf_combinations (trees,pages,dimensions,pairwise,
+					closest ? combination_window (threshold,cardinality,use_avg,pairwise) : INFINITY,
+					&x_tuples_visit,&visitor);
 
 			for (uint32_t i=0; i<cardinality; ++i) {
 				pthread_rwlock_unlock (page_locks[i]);
 			}
 		}
 
-		free (container->page_ids);
-		free (container->boxes);
-		free (container);
+		delete_multibox_container (container);
 	}
 
 	delete_priority_queue (browse);
 
+	if (approximation != NULL) {
+		double const last = data_combinations->size ? ((multidata_container_t*) peek_priority_queue(data_combinations))->sort_key : 0;
+		approximation->bound = x_tuples_bound (closest,data_combinations->size,last,unexplored);
+	}
+
 	fifo_t *const result = new_queue();
 	while (data_combinations->size) {
 		insert_at_head_of_queue(result,remove_from_priority_queue(data_combinations));
@@ -1172,10 +2445,607 @@ fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg
 	return result;
 }
 
-fifo_t* closest_tuples_ordered  (uint32_t const k,
-				boolean const use_avg,
-				tree_t *const tree0,...) {
-	va_list args;
+/**
+ * Pairs a record of the outer operand of a probe join with one of the
+ * inner tree, keeping the order of the operands in the command.
+ */
+static
+multidata_container_t* new_probe_combination (data_pair_t const*const outer, boolean const outer_first,
+						index_t const inner_key[], object_t const inner_object, uint32_t const dimensions) {
+	multidata_container_t *const data_container = (multidata_container_t *const) malloc (sizeof(multidata_container_t));
+	if (data_container == NULL) {
+		LOG (fatal,"[new_probe_combination()] Unable to allocate additional memory for a new combination...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	data_container->keys = (index_t *const) malloc (2*dimensions*sizeof(index_t));
+	data_container->objects = (object_t *const) malloc (2*sizeof(object_t));
+	data_container->cardinality = 2;
+	data_container->dimensions = dimensions;
+
+	uint32_t const outer_offset = outer_first ? 0 : 1;
+	data_container->objects[outer_offset] = outer->object;
+	data_container->objects[1-outer_offset] = inner_object;
+	memcpy (data_container->keys+outer_offset*dimensions,outer->key,dimensions*sizeof(index_t));
+	memcpy (data_container->keys+(1-outer_offset)*dimensions,inner_key,dimensions*sizeof(index_t));
+
+	data_container->sort_key = maxdistance_ordered_multikey (data_container,0);
+	return data_container;
+}
+
+/**
+ * Distance join of the records of the outer operand with those of the
+ * inner tree within a range, by looking up the latter around each of the
+ * former. It consumes the outer operand, and it reports the combinations
+ * within the given distance in the same order as a distance join would.
+ */
+spill_t* probe_distance_join (fifo_t *const outer, boolean const outer_first,
+				tree_t *const inner, index_t const lo[], index_t const hi[],
+				double const theta, uint32_t const dimensions, uint64_t const memory_limit) {
+
+	spill_t *const results = new_spill (&mincompare_combinations,memory_limit);
+
+	index_t from [inner->dimensions];
+	index_t to [inner->dimensions];
+	interval_t query [inner->dimensions];
+
+	while (outer->size) {
+		data_pair_t *const tuple = remove_tail_of_queue (outer);
+
+		boolean is_empty = false;
+		for (uint32_t j=0; j<inner->dimensions; ++j) {
+			from[j] = lo[j];
+			to[j] = hi[j];
+			if (j < dimensions) {
+				/* widened by an ulp so that no key at exactly theta is left out */
+				index_t const start = nextafterf (tuple->key[j]-theta,-INFINITY);
+				index_t const end = nextafterf (tuple->key[j]+theta,INFINITY);
+				if (start > from[j]) from[j] = start;
+				if (end < to[j]) to[j] = end;
+			}
+			if (from[j] > to[j]) {
+				is_empty = true;
+				break;
+			}
+			query[j].start = from[j];
+			query[j].end = to[j];
+		}
+
+		if (!is_empty) {
+			pthread_rwlock_rdlock (&inner->tree_lock);
+			is_empty = !inner->indexed_records || !overlapping_boxes (query,inner->root_box,inner->dimensions);
+			pthread_rwlock_unlock (&inner->tree_lock);
+		}
+
+		fifo_t *const candidates = is_empty ? NULL : range (inner,from,to,inner->dimensions);
+		while (candidates != NULL && candidates->size) {
+			data_pair_t *const candidate = remove_tail_of_queue (candidates);
+			multidata_container_t *const data_container = new_probe_combination (tuple,outer_first,candidate->key,candidate->object,dimensions);
+
+			if (data_container->sort_key <= theta) {
+				insert_into_spill (results,data_container);
+			}else{
+				delete_multidata_container (data_container);
+			}
+
+			free (candidate->key);
+			free (candidate);
+		}
+
+		if (candidates != NULL) {
+			delete_queue (candidates);
+		}
+
+		free (tuple->key);
+		free (tuple);
+	}
+
+	delete_queue (outer);
+	return results;
+}
+
+/**
+ * The k closest pairs of the records of the outer operand with those
+ * of the inner tree within a range; they are among the k nearest inner
+ * records of each outer one, which are looked up one after the other.
+ * It consumes the outer operand, and it reports the pairs in the same
+ * order as x_tuples would.
+ */
+fifo_t* probe_closest_pairs (fifo_t *const outer, boolean const outer_first,
+				tree_t *const inner, index_t const lo[], index_t const hi[],
+				uint32_t const k, uint32_t const dimensions) {
+
+	priority_queue_t *const data_combinations = new_priority_queue (&maxcompare_combinations);
+	double threshold = INFINITY;
+
+	while (outer->size) {
+		data_pair_t *const tuple = remove_tail_of_queue (outer);
+
+		fifo_t *const neighbors = k ? bounded_search (inner,lo,hi,tuple->key,k,dimensions,NULL) : NULL;
+		while (neighbors != NULL && neighbors->size) {
+			data_container_t *const neighbor = remove_tail_of_queue (neighbors);
+
+			if (neighbor->sort_key <= threshold) {
+				multidata_container_t *const data_container = new_probe_combination (tuple,outer_first,neighbor->key,neighbor->object,dimensions);
+
+				if (data_combinations->size < k) {
+					insert_into_priority_queue (data_combinations,data_container);
+				}else if (data_combinations->compare (data_container,peek_priority_queue (data_combinations)) > 0) {
+					delete_multidata_container (remove_from_priority_queue(data_combinations));
+					insert_into_priority_queue (data_combinations,data_container);
+				}else{
+					delete_multidata_container (data_container);
+				}
+
+				if (data_combinations->size == k) {
+					threshold = ((multidata_container_t*) peek_priority_queue(data_combinations))->sort_key;
+				}
+			}
+
+			free (neighbor->key);
+			free (neighbor);
+		}
+
+		if (neighbors != NULL) {
+			delete_queue (neighbors);
+		}
+
+		free (tuple->key);
+		free (tuple);
+	}
+
+	delete_queue (outer);
+
+	fifo_t *const result = new_queue();
+	while (data_combinations->size) {
+		insert_at_head_of_queue (result,remove_from_priority_queue(data_combinations));
+	}
+
+	delete_priority_queue (data_combinations);
+
+	return result;
+}
+
+/**
+ * Loads and read-locks the pages of a combination of leaves altogether
+ * on behalf of a worker of a parallel join, so that it never waits for
+ * the loading lock while holding some of them locked. It returns false
+ * if any of the pages is being modified at the same time.
+ */
+static
+boolean acquire_pages (lifo_t *const trees, uint64_t const page_ids[], pthread_mutex_t *const io_lock,
+			page_t const* pages[], pthread_rwlock_t* page_locks[]) {
+	pthread_mutex_lock (io_lock);
+	for (uint32_t i=0; i<trees->size; ++i) {
+		load_page_return_pair_t *const load_pair = load_page (TREE(i),page_ids[i]);
+		page_locks[i] = load_pair->page_lock;
+		pages[i] = load_pair->page;
+		free (load_pair);
+
+		assert (page_locks[i] != NULL);
+
+		assert (pages[i] != NULL);
+		assert (pages[i]->header.is_leaf);
+
+		if (TRYRDLOCK (TREE(i),page_locks[i])) {
+			for (uint32_t j=0; j<i; ++j) {
+				pthread_rwlock_unlock (page_locks[j]);
+			}
+			pthread_mutex_unlock (io_lock);
+			return false;
+		}
+	}
+	pthread_mutex_unlock (io_lock);
+	return true;
+}
+
+static
+int farthest_multibox_first (void const*const x, void const*const y) {
+	double const sort_key_x = (*(multibox_container_t *const*)x)->sort_key;
+	double const sort_key_y = (*(multibox_container_t *const*)y)->sort_key;
+	return sort_key_x < sort_key_y ? 1 : sort_key_x > sort_key_y ? -1 : 0;
+}
+
+static
+int closest_multibox_first (void const*const x, void const*const y) {
+	return farthest_multibox_first (y,x);
+}
+
+
+/**
+ * State of a parallel distance join or top-k join (when k is non-zero).
+ * The bound is theta for the former, and for the latter the best k-th
+ * distance found by any of the workers so far; a combination of boxes is
+ * explored only if it is (1+epsilon) times closer (resp. farther) than it.
+ */
+typedef struct {
+	lifo_t* trees;
+	uint32_t cardinality;
+	uint32_t dimensions;
+
+	boolean closest;
+	boolean pairwise;
+	boolean use_avg;
+
+	uint32_t k;
+	double theta;
+
+	double relaxation;
+	uint64_t max_pages;
+	uint64_t memory_limit;
+
+	priority_queue_t** data_combinations;
+	spill_t** results;
+	double* thresholds;
+
+	double bound;
+	double unexplored;
+	uint64_t visited_pages;
+	boolean has_reached_leaves;
+
+	pthread_mutex_t io_lock;
+	boolean is_reset;
+} parallel_join_t;
+
+static
+boolean admissible_multibox (parallel_join_t const*const join, double const distance, double const bound) {
+	return join->closest ? distance * join->relaxation <= bound : distance >= bound * join->relaxation;
+}
+
+static
+void unexplored_multibox (parallel_join_t *const join, double const distance) {
+	TRACE_EVENT(nodes_pruned);
+	if (join->closest) update_shared_minimum (&join->unexplored,distance);
+	else update_shared_maximum (&join->unexplored,distance);
+}
+
+static
+void parallel_join_visit (work_group_t *const group, uint32_t const lane, void *const work) {
+	parallel_join_t *const join = (parallel_join_t *const) group->args;
+	multibox_container_t *const container = (multibox_container_t *const) work;
+
+	lifo_t *const trees = join->trees;
+	uint32_t const cardinality = join->cardinality;
+	uint32_t const dimensions = join->dimensions;
+
+	if (__atomic_load_n (&join->is_reset,__ATOMIC_SEQ_CST)) {
+		delete_multibox_container (container);
+		return;
+	}
+
+	/* past the cap on pages, lanes only follow their most promising child down to first leaves */
+	boolean const is_capped = join->max_pages && __atomic_load_n (&join->visited_pages,__ATOMIC_SEQ_CST) >= join->max_pages;
+	if (!admissible_multibox (join,container->sort_key,read_shared_value (&join->bound))
+		|| (is_capped && __atomic_load_n (&join->has_reached_leaves,__ATOMIC_SEQ_CST))) {
+		unexplored_multibox (join,container->sort_key);
+		delete_multibox_container (container);
+		return;
+	}
+
+	for (uint32_t i=0; i<cardinality; ++i) {
+		uint64_t const page_id = container->page_ids[i];
+
+		pthread_rwlock_t* page_lock = NULL;
+		page_t const*const page = acquire_page (TREE(i),page_id,&join->io_lock,&page_lock);
+		if (page == NULL) {
+			__atomic_store_n (&join->is_reset,true,__ATOMIC_SEQ_CST);
+			delete_multibox_container (container);
+			return;
+		}
+
+		__sync_fetch_and_add (&join->visited_pages,1);
+		if (!page->header.is_leaf) {
+			/* the most promising combination is pushed last so that the lane pops it first */
+			multibox_container_t* children [page->header.records];
+			uint32_t children_number = 0;
+
+			double const bound = read_shared_value (&join->bound);
+			for (register uint32_t j=0; j<page->header.records; ++j) {
+				multibox_container_t *const new_container = new_child_multibox_container (container,i,
+									page_id*TREE(i)->internal_entries+j+1,
+									page->node.internal.intervals+j*dimensions);
+
+				new_container->sort_key = join->closest ?
+						multibox_mindistance (new_container,join->use_avg,join->pairwise)
+						:multibox_maxdistance (new_container,join->use_avg,join->pairwise);
+
+				if (admissible_multibox (join,new_container->sort_key,bound)) {
+					children [children_number++] = new_container;
+				}else{
+					unexplored_multibox (join,new_container->sort_key);
+					delete_multibox_container (new_container);
+				}
+			}
+
+			pthread_rwlock_unlock (page_lock);
+
+			qsort (children,children_number,sizeof(multibox_container_t*),
+					join->closest ? &farthest_multibox_first : &closest_multibox_first);
+			for (register uint32_t j=0; j<children_number; ++j) {
+				if (is_capped && j+1 < children_number) {
+					unexplored_multibox (join,children[j]->sort_key);
+					delete_multibox_container (children[j]);
+				}else{
+					push_work (group,lane,children[j]);
+				}
+			}
+
+			delete_multibox_container (container);
+			return;
+		}else pthread_rwlock_unlock (page_lock);
+	}
+
+	page_t const* pages [cardinality];
+	pthread_rwlock_t* page_locks [cardinality];
+
+	if (!acquire_pages (trees,container->page_ids,&join->io_lock,pages,page_locks)) {
+		__atomic_store_n (&join->is_reset,true,__ATOMIC_SEQ_CST);
+		delete_multibox_container (container);
+		return;
+	}
+	__atomic_store_n (&join->has_reached_leaves,true,__ATOMIC_SEQ_CST);
+
+	if (join->k) {
+		x_tuples_visitor_t visitor = {
+			.data_combinations = join->data_combinations[lane],
+			.threshold = join->thresholds+lane,
+			.shared_threshold = &join->bound,
+			.cardinality = cardinality,
+			.k = join->k,
+			.closest = join->closest,
+			.pairwise = join->pairwise,
+			.use_avg = join->use_avg
+		};
+
+		enumerate_leaf_combinations (trees,pages,dimensions,join->pairwise,
+				join->closest ? combination_window (read_shared_value (&join->bound),cardinality,join->use_avg,join->pairwise) : INFINITY,
+				&x_tuples_visit,&visitor);
+	}else{
+		distance_join_visitor_t visitor = {
+			.results = join->results[lane],
+			.theta = join->theta,
+			.window = join->closest ? combination_window (join->theta,cardinality,join->use_avg,join->pairwise) : INFINITY,
+			.less_than_theta = join->closest,
+			.pairwise = join->pairwise,
+			.use_avg = join->use_avg
+		};
+
+		enumerate_leaf_combinations (trees,pages,dimensions,join->pairwise,visitor.window,&distance_join_visit,&visitor);
+	}
+
+	for (uint32_t i=0; i<cardinality; ++i) {
+		pthread_rwlock_unlock (page_locks[i]);
+	}
+
+	delete_multibox_container (container);
+}
+
+/**
+ * Runs a parallel join over the lanes of a work-group of the shared pool,
+ * starting from the combination of the roots, and it leaves the results
+ * of all lanes merged into those of the first one; for a top-k join only
+ * the k best are kept in its heap, whereas a distance join appends all
+ * spilled results. Combinations are totally ordered, so the merged results
+ * do not depend on which lane found what.
+ */
+static
+void run_parallel_join (parallel_join_t *const join, uint32_t const parallelism) {
+	lifo_t *const trees = join->trees;
+	uint32_t const cardinality = join->cardinality;
+	uint32_t const dimensions = join->dimensions;
+
+	thread_pool_t *const pool = shared_thread_pool ();
+	uint32_t const lanes = available_lanes (pool,parallelism);
+
+	join->data_combinations = NULL;
+	join->results = NULL;
+	if (join->k) {
+		join->data_combinations = (priority_queue_t**) malloc (lanes*sizeof(priority_queue_t*));
+	}else{
+		join->results = (spill_t**) malloc (lanes*sizeof(spill_t*));
+	}
+	join->thresholds = (double*) malloc (lanes*sizeof(double));
+	if ((join->data_combinations == NULL && join->results == NULL) || join->thresholds == NULL) {
+		LOG (fatal,"[run_parallel_join()] Unable to allocate memory for the combinations of %u lanes...\n",lanes);
+		exit (EXIT_FAILURE);
+	}
+	for (register uint32_t i=0; i<lanes; ++i) {
+		if (join->k) {
+			join->data_combinations[i] = new_priority_queue (join->closest?&maxcompare_combinations:&mincompare_combinations);
+		}else{
+			join->results[i] = new_spill (join->closest?&mincompare_combinations:&maxcompare_combinations,
+							join->memory_limit ? MAX(join->memory_limit/lanes,1) : 0);
+		}
+	}
+	pthread_mutex_init (&join->io_lock,NULL);
+
+	work_group_t *const group = new_work_group (lanes,&parallel_join_visit,join);
+
+	reset_search_operation:
+	for (register uint32_t i=0; i<lanes; ++i) {
+		if (join->k) {
+			while (join->data_combinations[i]->size) {
+				delete_multidata_container (remove_from_priority_queue (join->data_combinations[i]));
+			}
+		}else{
+			clear_spill (join->results[i]);
+		}
+		join->thresholds[i] = join->closest ? INDEX_T_MAX : -INDEX_T_MAX;
+	}
+	join->bound = join->k ? (join->closest ? INDEX_T_MAX : -INDEX_T_MAX) : join->theta;
+	join->unexplored = join->closest ? DBL_MAX : 0;
+	join->visited_pages = 0;
+	join->has_reached_leaves = false;
+	join->is_reset = false;
+
+	multibox_container_t *const container = (multibox_container_t *const) malloc (sizeof(multibox_container_t));
+	container->boxes = (interval_t *const) malloc (cardinality*dimensions*sizeof(interval_t));
+	container->page_ids = (uint64_t *const) malloc (cardinality*sizeof(uint64_t));
+	bzero (container->page_ids,cardinality*sizeof(uint64_t));
+
+	container->sort_key = join->closest ? 0 : DBL_MAX;
+	container->cardinality = cardinality;
+	container->dimensions = dimensions;
+
+	for (uint32_t i=0; i<cardinality; ++i) {
+		pthread_rwlock_rdlock (&TREE(i)->tree_lock);
+
+		memcpy (container->boxes+i*dimensions,
+				TREE(i)->root_box,
+				dimensions*sizeof(interval_t));
+
+		pthread_rwlock_unlock (&TREE(i)->tree_lock);
+	}
+
+	push_work (group,0,container);
+	run_work_group (pool,group);
+
+	if (join->is_reset) {
+		goto reset_search_operation;
+	}
+
+	for (register uint32_t i=1; i<lanes; ++i) {
+		if (!join->k) {
+			append_spill (join->results[0],join->results[i]);
+			continue;
+		}
+
+		priority_queue_t *const data_combinations = join->data_combinations[0];
+		while (join->data_combinations[i]->size) {
+			multidata_container_t *const data_container = remove_from_priority_queue (join->data_combinations[i]);
+			if (data_combinations->size < join->k) {
+				insert_into_priority_queue (data_combinations,data_container);
+			}else if (data_combinations->compare (data_container,peek_priority_queue (data_combinations)) > 0) {
+				delete_multidata_container (remove_from_priority_queue (data_combinations));
+				insert_into_priority_queue (data_combinations,data_container);
+			}else{
+				delete_multidata_container (data_container);
+			}
+		}
+		delete_priority_queue (join->data_combinations[i]);
+	}
+
+	delete_work_group (group);
+	pthread_mutex_destroy (&join->io_lock);
+	free (join->thresholds);
+}
+
+static
+uint32_t minimum_dimensionality (lifo_t const*const trees) {
+	uint32_t dimensions = UINT_MAX;
+	for (uint32_t i=0; i<trees->size; ++i) {
+		if (((tree_t *const)trees->buffer[i])->dimensions < dimensions) {
+			dimensions = ((tree_t *const)trees->buffer[i])->dimensions;
+		}
+	}
+	return dimensions;
+}
+
+/**
+ * Same as distance_join(), only the frontier of combinations of boxes
+ * is split among the lanes of a work-group of the shared pool, with the
+ * same result. A parallelism of less than two falls back to the former.
+ */
+spill_t* parallel_distance_join (double const theta,
+			boolean const less_than_theta,
+			boolean const pairwise,
+			boolean const use_avg,
+			lifo_t *const trees,
+			approximation_t *const approximation,
+			uint64_t const memory_limit,
+			uint32_t const parallelism) {
+
+	if (parallelism < 2 || !trees->size || (less_than_theta && theta < 0)) {
+		return distance_join (theta,less_than_theta,pairwise,use_avg,trees,approximation,memory_limit);
+	}
+
+	if (approximation != NULL) {
+		approximation->bound = theta;
+	}
+
+	parallel_join_t join = {
+		.trees = trees,
+		.cardinality = trees->size,
+		.dimensions = minimum_dimensionality (trees),
+		.closest = less_than_theta,
+		.pairwise = pairwise,
+		.use_avg = use_avg,
+		.k = 0,
+		.theta = theta,
+		.relaxation = approximation != NULL && approximation->epsilon > 0 ? 1+approximation->epsilon : 1,
+		.max_pages = approximation != NULL ? approximation->max_pages : 0,
+		.memory_limit = memory_limit
+	};
+
+	run_parallel_join (&join,parallelism);
+
+	spill_t *const results = join.results[0];
+	free (join.results);
+
+	if (approximation != NULL) {
+		approximation->bound = less_than_theta ? MIN(theta,join.unexplored) : MAX(theta,join.unexplored);
+	}
+
+	return results;
+}
+
+/**
+ * Same as x_tuples(), only the frontier of combinations of boxes is split
+ * among the lanes of a work-group of the shared pool, which share the best
+ * k-th distance found so far for pruning. Exact queries return the same
+ * result. A parallelism of less than two falls back to the former.
+ */
+fifo_t* parallel_x_tuples (uint32_t const k, boolean const closest, boolean const use_avg, boolean const pairwise,
+			lifo_t *const trees, approximation_t *const approximation, uint32_t const parallelism) {
+
+	if (parallelism < 2) {
+		return x_tuples (k,closest,use_avg,pairwise,trees,approximation);
+	}
+
+	if (approximation != NULL) {
+		approximation->bound = 1;
+	}
+
+	if (!k || !trees->size) return new_queue();
+
+	parallel_join_t join = {
+		.trees = trees,
+		.cardinality = trees->size,
+		.dimensions = minimum_dimensionality (trees),
+		.closest = closest,
+		.pairwise = pairwise,
+		.use_avg = use_avg,
+		.k = k,
+		.theta = 0,
+		.relaxation = approximation != NULL && approximation->epsilon > 0 ? 1+approximation->epsilon : 1,
+		.max_pages = approximation != NULL ? approximation->max_pages : 0,
+		.memory_limit = 0
+	};
+
+	run_parallel_join (&join,parallelism);
+
+	priority_queue_t *const data_combinations = join.data_combinations[0];
+	free (join.data_combinations);
+
+	if (approximation != NULL) {
+		double const last = data_combinations->size ? ((multidata_container_t*) peek_priority_queue(data_combinations))->sort_key : 0;
+		approximation->bound = x_tuples_bound (closest,data_combinations->size,last,join.unexplored);
+	}
+
+	fifo_t *const result = new_queue();
+	while (data_combinations->size) {
+		insert_at_head_of_queue(result,remove_from_priority_queue(data_combinations));
+	}
+
+	delete_priority_queue (data_combinations);
+
+	return result;
+}
+
+fifo_t* closest_tuples_ordered  (uint32_t const k,
+				boolean const use_avg,
+				tree_t *const tree0,...) {
+	va_list args;
 	va_start (args,tree0);
 
 	lifo_t *const trees = new_stack();
@@ -1187,7 +3057,7 @@ fifo_t* closest_tuples_ordered  (uint32_t const k,
 
 	va_end (args);
 
-	fifo_t *const result = x_tuples (k,true,use_avg,false,trees);
+	fifo_t *const result = x_tuples (k,true,use_avg,false,trees,NULL);
 	delete_stack (trees);
 	return result;
 }
@@ -1207,7 +3077,7 @@ fifo_t* farthest_tuples_ordered (uint32_t const k,
 
 	va_end (args);
 
-	fifo_t *const result = x_tuples (k,false,use_avg,false,trees);
+	fifo_t *const result = x_tuples (k,false,use_avg,false,trees,NULL);
 	delete_stack (trees);
 	return result;
 }
@@ -1227,7 +3097,7 @@ fifo_t* closest_tuples_pairwise  (uint32_t const k,
 
 	va_end (args);
 
-	fifo_t *const result = x_tuples (k,true,use_avg,true,trees);
+	fifo_t *const result = x_tuples (k,true,use_avg,true,trees,NULL);
 	delete_stack (trees);
 	return result;
 }
@@ -1247,7 +3117,363 @@ fifo_t* farthest_tuples_pairwise (uint32_t const k,
 
 	va_end (args);
 
-	fifo_t *const result = x_tuples (k,false,use_avg,true,trees);
+	fifo_t *const result = x_tuples (k,false,use_avg,true,trees,NULL);
 	delete_stack (trees);
 	return result;
 }
+
+
+typedef struct {
+	tree_t* outer;
+	tree_t* inner;
+
+	uint32_t k;
+	uint32_t dimensions;
+
+	pthread_mutex_t io_lock;
+} knn_join_t;
+
+/**
+ * An outer leaf along with the pairs of its points and their neighbors.
+ */
+typedef struct {
+	uint64_t leaf_id;
+	fifo_t* result;
+} knn_join_leaf_t;
+
+
+/**
+ * Batched nearest neighbors search for all points of a single outer leaf.
+ * The inner tree is browsed once per outer leaf in ascending distance from
+ * the MBB of the leaf, and a subtree is pruned as soon as it lies farther
+ * than the worst k-th distance among the points of the leaf. For k=1 the
+ * maximum distance from any child-box also upper-bounds the distance of
+ * the nearest neighbor, and that tightens the threshold early on.
+ * Pages are acquired under the I/O lock shared by the leaves of the join.
+ */
+static
+void knn_join_leaf (tree_t *const outer, tree_t *const inner, uint64_t const leaf_id,
+			uint32_t const k, uint32_t const dimensions, fifo_t *const result,
+			pthread_mutex_t *const io_lock) {
+
+	tree_t* tree = outer;
+
+	reset_outer_leaf:;
+
+	pthread_rwlock_t* outer_lock = NULL;
+	page_t const*const outer_page = acquire_page (tree,leaf_id,io_lock,&outer_lock);
+	if (outer_page == NULL) {
+		goto reset_outer_leaf;
+	}
+
+	assert (outer_page->header.is_leaf);
+
+	uint32_t const records = outer_page->header.records;
+	if (!records) {
+		pthread_rwlock_unlock (outer_lock);
+		return;
+	}
+
+	index_t *const points = (index_t *const) malloc (records*dimensions*sizeof(index_t));
+	object_t *const objects = (object_t *const) malloc (records*sizeof(object_t));
+	for (register uint32_t i=0; i<records; ++i) {
+		memcpy (points+i*dimensions,outer_page->node.leaf.KEY(i),dimensions*sizeof(index_t));
+		objects[i] = outer_page->node.leaf.objects[i];
+	}
+
+	pthread_rwlock_unlock (outer_lock);
+
+	interval_t mbb [dimensions];
+	for (uint32_t j=0; j<dimensions; ++j) {
+		mbb[j].start = INDEX_T_MAX;
+		mbb[j].end = -INDEX_T_MAX;
+	}
+	for (register uint32_t i=0; i<records; ++i) {
+		for (uint32_t j=0; j<dimensions; ++j) {
+			if (points[i*dimensions+j] < mbb[j].start) mbb[j].start = points[i*dimensions+j];
+			if (points[i*dimensions+j] > mbb[j].end) mbb[j].end = points[i*dimensions+j];
+		}
+	}
+
+	priority_queue_t* neighbors [records];
+	double bounds [records];
+	for (register uint32_t i=0; i<records; ++i) {
+		neighbors[i] = new_priority_queue (&maxcompare_containers);
+	}
+
+	priority_queue_t *const browse = new_priority_queue (&mincompare_containers);
+
+	tree = inner;
+
+	reset_search_operation:;
+
+	for (register uint32_t i=0; i<records; ++i) {
+		while (neighbors[i]->size) {
+			data_container_t *const temp = remove_from_priority_queue (neighbors[i]);
+			free (temp->key);
+			free (temp);
+		}
+		bounds[i] = DBL_MAX;
+	}
+
+	box_container_t* container = (box_container_t*) malloc (sizeof(box_container_t));
+
+	container->box = NULL;
+	container->sort_key = 0;
+	container->id = 0;
+
+	insert_into_priority_queue (browse,container);
+
+	while (browse->size) {
+		container = remove_from_priority_queue (browse);
+
+		double threshold = 0;
+		for (register uint32_t i=0; i<records; ++i) {
+			if (bounds[i] > threshold) {
+				threshold = bounds[i];
+			}
+		}
+
+		if (container->sort_key > threshold) {
+			TRACE_EVENTS(nodes_pruned,1+browse->size);
+			free (container);
+			while (browse->size) {
+				free (remove_from_priority_queue (browse));
+			}
+			break;
+		}
+
+		uint64_t const page_id = container->id;
+		free (container);
+
+		pthread_rwlock_t* page_lock = NULL;
+		page_t const*const page = acquire_page (tree,page_id,io_lock,&page_lock);
+		if (page == NULL) {
+			while (browse->size) {
+				free (remove_from_priority_queue (browse));
+			}
+			goto reset_search_operation;
+		}else{
+			if (page->header.is_leaf) {
+				for (register uint32_t i=0; i<records; ++i) {
+					index_t const*const point = points+i*dimensions;
+					for (register uint32_t j=0; j<page->header.records; ++j) {
+						double const distance = key_to_key_distance (point,page->node.leaf.KEY(j),dimensions);
+
+						if (neighbors[i]->size < k
+							|| distance < ((data_container_t*)peek_priority_queue(neighbors[i]))->sort_key) {
+
+							data_container_t *const data_container = (data_container_t *const) malloc (sizeof(data_container_t));
+
+							data_container->key = (index_t *const) malloc (dimensions*sizeof(index_t));
+							memcpy (data_container->key,page->node.leaf.KEY(j),dimensions*sizeof(index_t));
+
+							data_container->object = page->node.leaf.objects[j];
+							data_container->sort_key = distance;
+							data_container->dimensions = dimensions;
+
+							if (neighbors[i]->size == k) {
+								data_container_t *const temp = remove_from_priority_queue (neighbors[i]);
+								free (temp->key);
+								free (temp);
+							}
+							insert_into_priority_queue (neighbors[i],data_container);
+
+							if (neighbors[i]->size == k) {
+								double const kth_distance = ((data_container_t*)peek_priority_queue(neighbors[i]))->sort_key;
+								if (kth_distance < bounds[i]) {
+									bounds[i] = kth_distance;
+								}
+							}
+						}
+					}
+				}
+			}else{
+				if (k == 1) {
+					for (register uint32_t j=0; j<page->header.records; ++j) {
+						for (register uint32_t i=0; i<records; ++i) {
+							double const maxdistance = key_to_box_maxdistance (points+i*dimensions,page->node.internal.BOX(j),dimensions);
+							if (maxdistance < bounds[i]) {
+								bounds[i] = maxdistance;
+							}
+						}
+					}
+				}
+
+				for (register uint32_t j=0; j<page->header.records; ++j) {
+					double const sort_key = box_to_box_mindistance (mbb,page->node.internal.BOX(j),dimensions);
+
+					boolean is_useful = false;
+					for (register uint32_t i=0; i<records; ++i) {
+						if (key_to_box_mindistance (points+i*dimensions,page->node.internal.BOX(j),dimensions) <= bounds[i]) {
+							is_useful = true;
+							break;
+						}
+					}
+
+					if (is_useful) {
+						container = (box_container_t*) malloc (sizeof(box_container_t));
+
+						container->id = CHILD_ID(page_id,j);
+						container->box = NULL;
+						container->sort_key = sort_key;
+
+						insert_into_priority_queue (browse,container);
+					}else{
+						TRACE_EVENT(nodes_pruned);
+					}
+				}
+			}
+
+			pthread_rwlock_unlock (page_lock);
+		}
+	}
+
+	delete_priority_queue (browse);
+
+	for (register uint32_t i=0; i<records; ++i) {
+		data_container_t* sorted [neighbors[i]->size];
+		uint32_t const neighbors_number = neighbors[i]->size;
+		for (uint32_t j=neighbors_number; j>0; --j) {
+			sorted[j-1] = remove_from_priority_queue (neighbors[i]);
+		}
+
+		for (uint32_t j=0; j<neighbors_number; ++j) {
+			multidata_container_t *const pair = (multidata_container_t *const) malloc (sizeof(multidata_container_t));
+
+			pair->keys = (index_t *const) malloc ((dimensions<<1)*sizeof(index_t));
+			pair->objects = (object_t *const) malloc (2*sizeof(object_t));
+			pair->cardinality = 2;
+			pair->dimensions = dimensions;
+			pair->sort_key = sorted[j]->sort_key;
+
+			memcpy (pair->keys,points+i*dimensions,dimensions*sizeof(index_t));
+			memcpy (pair->keys+dimensions,sorted[j]->key,dimensions*sizeof(index_t));
+			pair->objects[0] = objects[i];
+			pair->objects[1] = sorted[j]->object;
+
+			insert_at_tail_of_queue (result,pair);
+
+			free (sorted[j]->key);
+			free (sorted[j]);
+		}
+
+		delete_priority_queue (neighbors[i]);
+	}
+
+	free (points);
+	free (objects);
+}
+
+static
+void knn_join_visit (work_group_t *const group, uint32_t const lane, void *const work) {
+	knn_join_t *const join = (knn_join_t *const) group->args;
+	knn_join_leaf_t *const leaf = (knn_join_leaf_t *const) work;
+	knn_join_leaf (join->outer,join->inner,leaf->leaf_id,join->k,join->dimensions,leaf->result,&join->io_lock);
+}
+
+
+/**
+ * It returns for every point of the outer tree its k nearest neighbors from
+ * the inner tree as pairs of the form (outer point, inner neighbor). The leaves
+ * of the outer tree are shared among the lanes of a work-group of the shared
+ * pool, whereas a parallelism of less than two processes them in turn. Pairs
+ * are grouped by outer point in ascending order of distance when consumed
+ * from the tail of the queue, and outer points in the order of their leaves.
+ */
+fifo_t* knn_join (tree_t *const outer, tree_t *const inner, uint32_t const k, uint32_t const parallelism) {
+	if (!k) return new_queue();
+
+	uint32_t const dimensions = MIN(outer->dimensions,inner->dimensions);
+
+	pthread_rwlock_rdlock (&inner->tree_lock);
+	boolean const is_empty = !inner->indexed_records;
+	pthread_rwlock_unlock (&inner->tree_lock);
+
+	if (is_empty) {
+		LOG (warn,"[%s][knn_join()] Inner tree '%s' does not index any records...\n",outer->filename,inner->filename);
+		return new_queue();
+	}
+
+	tree_t *const tree = outer;
+	lifo_t *const leaves = new_stack();
+	fifo_t *const browse = new_queue();
+
+	reset_search_operation:
+	clear_stack (leaves);
+	insert_at_tail_of_queue (browse,0);
+
+	while (browse->size) {
+		uint64_t const page_id = remove_head_of_queue (browse);
+
+		load_page_return_pair_t *const load_pair = load_page (tree,page_id);
+		pthread_rwlock_t *const page_lock = load_pair->page_lock;
+		page_t const*const page = load_pair->page;
+		free (load_pair);
+
+		assert (page != NULL);
+		assert (page_lock != NULL);
+
+		if (TRYRDLOCK (tree,page_lock)) {
+			clear_queue (browse);
+			goto reset_search_operation;
+		}else{
+			if (page->header.is_leaf) {
+				insert_into_stack (leaves,page_id);
+			}else{
+				for (register uint32_t i=0; i<page->header.records; ++i) {
+					insert_at_tail_of_queue (browse,CHILD_ID(page_id,i));
+				}
+			}
+			pthread_rwlock_unlock (page_lock);
+		}
+	}
+
+	delete_queue (browse);
+
+	knn_join_leaf_t *const outer_leaves = (knn_join_leaf_t *const) malloc (MAX(leaves->size,1)*sizeof(knn_join_leaf_t));
+	if (outer_leaves == NULL) {
+		LOG (fatal,"[%s][knn_join()] Unable to allocate memory for %lu outer leaves...\n",outer->filename,leaves->size);
+		exit (EXIT_FAILURE);
+	}
+	for (uint64_t i=0; i<leaves->size; ++i) {
+		outer_leaves[i].leaf_id = (uint64_t) leaves->buffer[i];
+		outer_leaves[i].result = new_queue();
+	}
+
+	knn_join_t join;
+	join.outer = outer;
+	join.inner = inner;
+	join.k = k;
+	join.dimensions = dimensions;
+	pthread_mutex_init (&join.io_lock,NULL);
+
+	thread_pool_t *const pool = shared_thread_pool ();
+	uint32_t const lanes = available_lanes (pool,MIN(parallelism,MAX(leaves->size,1)));
+	if (lanes < 2) {
+		for (uint64_t i=0; i<leaves->size; ++i) {
+			knn_join_leaf (outer,inner,outer_leaves[i].leaf_id,k,dimensions,outer_leaves[i].result,&join.io_lock);
+		}
+	}else{
+		work_group_t *const group = new_work_group (lanes,&knn_join_visit,&join);
+		for (uint64_t i=0; i<leaves->size; ++i) {
+			push_work (group,i*lanes/leaves->size,outer_leaves+i);
+		}
+		run_work_group (pool,group);
+		delete_work_group (group);
+	}
+	pthread_mutex_destroy (&join.io_lock);
+
+	fifo_t *const result = new_queue();
+	for (uint64_t i=0; i<leaves->size; ++i) {
+		while (outer_leaves[i].result->size) {
+			insert_at_head_of_queue (result,remove_head_of_queue (outer_leaves[i].result));
+		}
+		delete_queue (outer_leaves[i].result);
+	}
+	free (outer_leaves);
+
+	delete_stack (leaves);
+
+	return result;
+}
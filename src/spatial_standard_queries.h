@@ -8,8 +8,16 @@ fifo_t* find_all_in_rtree (tree_t *const tree, index_t const key[], uint32_t pro
 object_t find_any_in_rtree (tree_t *const tree, index_t const key[], uint32_t proj_dimensions);
 
 fifo_t* range (tree_t *const, index_t const lo[], index_t const hi[], uint32_t proj_dimensions);
+uint64_t count_range (tree_t *const, index_t const lo[], index_t const hi[], uint64_t const reach);
+fifo_t* paged_range (tree_t *const, index_t const lo[], index_t const hi[], uint32_t proj_dimensions, uint64_t const offset, uint64_t const limit, boolean const with_keys);
+fifo_t* page_results (fifo_t *const results, uint64_t const offset, uint64_t const limit);
+fifo_t* sample_range (tree_t *const, index_t const lo[], index_t const hi[], uint64_t const size);
+fifo_t* sample_results (fifo_t *const results, uint64_t const size, unsigned short seed[3]);
 fifo_t* nearest (tree_t *const, index_t const center[], uint32_t const k);
-fifo_t* bounded_search (tree_t *const, index_t const lo[], index_t const hi[], index_t const center[], uint32_t const k, uint32_t proj_dimensions);
+fifo_t* bounded_search (tree_t *const, index_t const lo[], index_t const hi[], index_t const center[], uint32_t const k, uint32_t proj_dimensions, approximation_t *const);
+
+fifo_t* parallel_range (tree_t *const, index_t const lo[], index_t const hi[], uint32_t proj_dimensions, uint32_t const parallelism);
+fifo_t* parallel_bounded_search (tree_t *const, index_t const lo[], index_t const hi[], index_t const center[], uint32_t const k, uint32_t proj_dimensions, approximation_t *const, uint32_t const parallelism);
 
 fifo_t* distance_join_ordered (double const theta,
 				boolean const less_than_theta,
@@ -21,7 +29,7 @@ fifo_t* distance_join_pairwise (double const theta,
 				boolean const use_avg,
 				tree_t *const tree0,...);
 
-fifo_t* distance_join (double theta, boolean const less_than, boolean const pairwise, boolean const use_avg, lifo_t *const trees);
+spill_t* distance_join (double theta, boolean const less_than, boolean const pairwise, boolean const use_avg, lifo_t *const trees, approximation_t *const, uint64_t const memory_limit);
 
 fifo_t* closest_tuples_ordered (uint32_t const k, boolean const use_avg, tree_t *const,...);
 fifo_t* closest_tuples_pairwise (uint32_t const k, boolean const use_avg, tree_t *const,...);
@@ -29,7 +37,15 @@ fifo_t* closest_tuples_pairwise (uint32_t const k, boolean const use_avg, tree_t
 fifo_t* farthest_tuples_ordered (uint32_t const k, boolean const use_avg, tree_t *const,...);
 fifo_t* farthest_tuples_pairwise (uint32_t const k, boolean const use_avg, tree_t *const,...);
 
-fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg, boolean const pairwise, lifo_t *const trees);
+fifo_t* x_tuples (uint32_t const k, boolean const closest, boolean const use_avg, boolean const pairwise, lifo_t *const trees, approximation_t *const);
+
+spill_t* parallel_distance_join (double theta, boolean const less_than, boolean const pairwise, boolean const use_avg, lifo_t *const trees, approximation_t *const, uint64_t const memory_limit, uint32_t const parallelism);
+fifo_t* parallel_x_tuples (uint32_t const k, boolean const closest, boolean const use_avg, boolean const pairwise, lifo_t *const trees, approximation_t *const, uint32_t const parallelism);
+
+spill_t* probe_distance_join (fifo_t *const outer, boolean const outer_first, tree_t *const inner, index_t const lo[], index_t const hi[], double const theta, uint32_t const dimensions, uint64_t const memory_limit);
+fifo_t* probe_closest_pairs (fifo_t *const outer, boolean const outer_first, tree_t *const inner, index_t const lo[], index_t const hi[], uint32_t const k, uint32_t const dimensions);
+
+fifo_t* knn_join (tree_t *const outer, tree_t *const inner, uint32_t const k, uint32_t const parallelism);
 
 fifo_t* multichromatic_reverse_nearest_neighbors (index_t const[], tree_t *const data_tree, lifo_t *const feature_trees, uint32_t proj_dimensions);
 
@@ -0,0 +1,405 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "priority_queue.h"
+#include "spill.h"
+#include "stack.h"
+#include "queue.h"
+#include "defs.h"
+
+
+static
+uint64_t footprint (multidata_container_t const*const container) {
+	return sizeof(multidata_container_t) + sizeof(void*)
+		+ container->cardinality*(sizeof(object_t)+container->dimensions*sizeof(index_t));
+}
+
+static
+void delete_container (multidata_container_t *const container) {
+	free (container->objects);
+	free (container->keys);
+	free (container);
+}
+
+static
+int mincompare_spill_runs (void const*const x, void const*const y) {
+	spill_run_t const*const run_x = (spill_run_t const*const) x;
+	spill_run_t const*const run_y = (spill_run_t const*const) y;
+	return run_x->compare (run_x->head,run_y->head);
+}
+
+
+static
+void write_container (FILE *const file, multidata_container_t const*const container) {
+	uint32_t const keys_number = container->cardinality*container->dimensions;
+	if (fwrite (&container->cardinality,sizeof(uint16_t),1,file) < 1
+		|| fwrite (&container->dimensions,sizeof(uint16_t),1,file) < 1
+		|| fwrite (&container->sort_key,sizeof(double),1,file) < 1
+		|| fwrite (container->objects,sizeof(object_t),container->cardinality,file) < container->cardinality
+		|| fwrite (container->keys,sizeof(index_t),keys_number,file) < keys_number) {
+		LOG (fatal,"[write_container()] Unable to write join results to temporary file...\n");
+		exit (EXIT_FAILURE);
+	}
+}
+
+/**
+ * Returns the next container of a run, or NULL
+ * when there are no more containers to be read.
+ */
+static
+multidata_container_t* read_container (FILE *const file) {
+	uint16_t header [2];
+	if (fread (header,sizeof(uint16_t),2,file) < 2) {
+		return NULL;
+	}
+
+	multidata_container_t *const container = (multidata_container_t *const) malloc (sizeof(multidata_container_t));
+	if (container == NULL) {
+		LOG (fatal,"[read_container()] Unable to allocate memory for spilled join result...\n");
+		exit (EXIT_FAILURE);
+	}
+	container->cardinality = header[0];
+	container->dimensions = header[1];
+
+	uint32_t const keys_number = container->cardinality*container->dimensions;
+	container->objects = (object_t*) malloc (container->cardinality*sizeof(object_t));
+	container->keys = (index_t*) malloc (keys_number*sizeof(index_t));
+	if (container->objects == NULL || container->keys == NULL) {
+		LOG (fatal,"[read_container()] Unable to allocate memory for spilled join result...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	if (fread (&container->sort_key,sizeof(double),1,file) < 1
+		|| fread (container->objects,sizeof(object_t),container->cardinality,file) < container->cardinality
+		|| fread (container->keys,sizeof(index_t),keys_number,file) < keys_number) {
+		LOG (error,"[read_container()] Temporary file of join results has been truncated...\n");
+		delete_container (container);
+		return NULL;
+	}
+	return container;
+}
+
+static
+spill_run_t* new_run (FILE *const file, spill_t const*const spill, uint32_t const level) {
+	spill_run_t *const run = (spill_run_t *const) malloc (sizeof(spill_run_t));
+	if (run == NULL) {
+		LOG (fatal,"[new_run()] Unable to allocate memory for new run...\n");
+		exit (EXIT_FAILURE);
+	}
+	run->file = file;
+	run->head = NULL;
+	run->compare = spill->compare;
+	run->level = level;
+	return run;
+}
+
+static
+void delete_run (spill_run_t *const run) {
+	if (run->head != NULL) {
+		delete_container (run->head);
+	}
+	fclose (run->file);
+	free (run);
+}
+
+/**
+ * Positions the run at its first container and
+ * returns whether it contains any at all.
+ */
+static
+boolean rewind_run (spill_run_t *const run) {
+	if (run->head != NULL) {
+		delete_container (run->head);
+	}
+	rewind (run->file);
+	run->head = read_container (run->file);
+	return run->head != NULL;
+}
+
+/**
+ * Merges the most recent runs, all of the same level,
+ * into a single run of the next level.
+ */
+static
+void merge_runs (spill_t *const spill) {
+	FILE *const file = tmpfile ();
+	if (file == NULL) {
+		LOG (error,"[merge_runs()] Unable to create temporary file; will keep %lu runs of join results instead.\n",spill->runs->size);
+		return;
+	}
+
+	uint32_t const level = ((spill_run_t *const) peek_at_stack (spill->runs))->level;
+	LOG (info,"[merge_runs()] Merging %u runs of level %u into a single run.\n",SPILL_MERGE_FANIN,level);
+
+	priority_queue_t *const merge = new_priority_queue (&mincompare_spill_runs);
+	for (register uint32_t i=0; i<SPILL_MERGE_FANIN; ++i) {
+		spill_run_t *const run = remove_from_stack (spill->runs);
+		if (rewind_run (run)) {
+			insert_into_priority_queue (merge,run);
+		}else{
+			delete_run (run);
+		}
+	}
+
+	while (merge->size) {
+		spill_run_t *const run = remove_from_priority_queue (merge);
+		write_container (file,run->head);
+		delete_container (run->head);
+
+		run->head = read_container (run->file);
+		if (run->head != NULL) {
+			insert_into_priority_queue (merge,run);
+		}else{
+			delete_run (run);
+		}
+	}
+	delete_priority_queue (merge);
+
+	insert_into_stack (spill->runs,new_run (file,spill,level+1));
+}
+
+static
+boolean is_mergeable (spill_t const*const spill) {
+	if (spill->runs->size < SPILL_MERGE_FANIN) return false;
+
+	uint32_t const level = ((spill_run_t *const) peek_at_stack (spill->runs))->level;
+	for (register uint32_t i=1; i<=SPILL_MERGE_FANIN; ++i) {
+		if (((spill_run_t *const) spill->runs->buffer[spill->runs->size-i])->level != level) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Writes all containers kept in memory to a new temporary file in
+ * the order they are to be removed, i.e. as yet another sorted run.
+ */
+static
+void write_run (spill_t *const spill) {
+	FILE *const file = tmpfile ();
+	if (file == NULL) {
+		LOG (error,"[write_run()] Unable to create temporary file; will keep %lu join results in memory instead.\n",spill->memory->size);
+		spill->memory_limit = 0;
+		return;
+	}
+
+	LOG (info,"[write_run()] Writing run %lu of %lu join results (%lu bytes) to temporary file.\n",spill->runs->size,spill->memory->size,spill->memory_used);
+	while (spill->memory->size) {
+		multidata_container_t *const container = remove_from_priority_queue (spill->memory);
+		write_container (file,container);
+		delete_container (container);
+	}
+	clear_priority_queue (spill->memory);
+	spill->memory_used = 0;
+
+	insert_into_stack (spill->runs,new_run (file,spill,0));
+	while (is_mergeable (spill)) {
+		merge_runs (spill);
+	}
+}
+
+static
+void start_merge (spill_t *const spill) {
+	spill->merge = new_priority_queue (&mincompare_spill_runs);
+	for (register uint64_t i=0; i<spill->runs->size; ++i) {
+		spill_run_t *const run = spill->runs->buffer[i];
+		if (rewind_run (run)) {
+			insert_into_priority_queue (spill->merge,run);
+		}
+	}
+}
+
+
+/**
+ * Containers are removed from smallest to largest with respect to the
+ * given comparator; a zero memory limit keeps all of them in memory.
+ */
+spill_t* new_spill (int (*compare) (void const*const,void const*const), uint64_t const memory_limit) {
+	spill_t *const spill = (spill_t *const) malloc (sizeof(spill_t));
+	if (spill == NULL) {
+		LOG (fatal,"[new_spill()] Unable to allocate memory for new spill...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	spill->memory = new_priority_queue (compare);
+	spill->runs = new_stack();
+	spill->merge = NULL;
+
+	spill->compare = compare;
+
+	spill->memory_limit = memory_limit;
+	spill->memory_used = 0;
+	spill->size = 0;
+
+	spill->scan_position = 0;
+	spill->scan_run = 0;
+	spill->scanned = NULL;
+
+	return spill;
+}
+
+void clear_spill (spill_t *const spill) {
+	if (spill->merge != NULL) {
+		delete_priority_queue (spill->merge);
+		spill->merge = NULL;
+	}
+	while (spill->runs->size) {
+		delete_run (remove_from_stack (spill->runs));
+	}
+	while (spill->memory->size) {
+		delete_container (remove_from_priority_queue (spill->memory));
+	}
+	clear_priority_queue (spill->memory);
+
+	if (spill->scanned != NULL) {
+		delete_container (spill->scanned);
+		spill->scanned = NULL;
+	}
+	spill->scan_position = 0;
+	spill->scan_run = 0;
+
+	spill->memory_used = 0;
+	spill->size = 0;
+}
+
+void delete_spill (spill_t *const spill) {
+	clear_spill (spill);
+	delete_priority_queue (spill->memory);
+	delete_stack (spill->runs);
+	free (spill);
+}
+
+void insert_into_spill (spill_t *const spill, multidata_container_t *const container) {
+	assert (spill->merge == NULL);
+
+	insert_into_priority_queue (spill->memory,container);
+	spill->memory_used += footprint (container);
+	++spill->size;
+
+	if (spill->memory_limit && spill->memory_used > spill->memory_limit) {
+		write_run (spill);
+	}
+}
+
+/**
+ * Merges the runs written so far with the
+ * containers still kept in memory on the fly.
+ */
+multidata_container_t* remove_from_spill (spill_t *const spill) {
+	if (!spill->size) return NULL;
+
+	if (spill->merge == NULL && spill->runs->size) {
+		start_merge (spill);
+	}
+
+	spill_run_t *const run = spill->merge != NULL && spill->merge->size ? peek_priority_queue (spill->merge) : NULL;
+
+	multidata_container_t* container = NULL;
+	if (run != NULL && (!spill->memory->size || spill->compare (run->head,peek_priority_queue (spill->memory)) <= 0)) {
+		remove_from_priority_queue (spill->merge);
+		container = run->head;
+
+		run->head = read_container (run->file);
+		if (run->head != NULL) {
+			insert_into_priority_queue (spill->merge,run);
+		}
+	}else{
+		container = remove_from_priority_queue (spill->memory);
+		spill->memory_used -= footprint (container);
+	}
+
+	--spill->size;
+	return container;
+}
+
+/**
+ * Moves all containers of the source to the target, whose runs now
+ * include those of the source, and deletes the source altogether.
+ */
+void append_spill (spill_t *const target, spill_t *const source) {
+	assert (target->merge == NULL);
+	assert (source->merge == NULL);
+
+	target->size += source->size - source->memory->size;
+	while (source->runs->size) {
+		insert_into_stack (target->runs,remove_from_stack (source->runs));
+	}
+	while (source->memory->size) {
+		insert_into_spill (target,remove_from_priority_queue (source->memory));
+	}
+	source->size = 0;
+	source->memory_used = 0;
+
+	delete_spill (source);
+}
+
+void rewind_spill (spill_t *const spill) {
+	assert (spill->merge == NULL);
+
+	if (spill->scanned != NULL) {
+		delete_container (spill->scanned);
+		spill->scanned = NULL;
+	}
+	for (register uint64_t i=0; i<spill->runs->size; ++i) {
+		rewind (((spill_run_t *const) spill->runs->buffer[i])->file);
+	}
+	spill->scan_position = 0;
+	spill->scan_run = 0;
+}
+
+/**
+ * Returns the containers one after the other in no particular
+ * order, or NULL after the last one; a returned container is
+ * owned by the spill and is valid until the next call.
+ */
+multidata_container_t const* scan_spill (spill_t *const spill) {
+	assert (spill->merge == NULL);
+
+	if (spill->scan_position < spill->memory->size) {
+		return spill->memory->buffer[1+spill->scan_position++];
+	}
+
+	if (spill->scanned != NULL) {
+		delete_container (spill->scanned);
+		spill->scanned = NULL;
+	}
+	while (spill->scan_run < spill->runs->size) {
+		spill->scanned = read_container (((spill_run_t *const) spill->runs->buffer[spill->scan_run])->file);
+		if (spill->scanned != NULL) {
+			return spill->scanned;
+		}
+		++spill->scan_run;
+	}
+	return NULL;
+}
+
+/**
+ * Removes all containers into a new queue whose tail is the
+ * first of them, i.e. in the order they are reported by the
+ * query processor, and deletes the spill altogether.
+ */
+fifo_t* transform_spill_into_queue (spill_t *const spill) {
+	fifo_t *const queue = new_queue();
+	for (multidata_container_t* container; (container = remove_from_spill (spill)) != NULL;) {
+		insert_at_head_of_queue (queue,container);
+	}
+	delete_spill (spill);
+	return queue;
+}
@@ -0,0 +1,21 @@
+#ifndef SPILL_H_
+#define SPILL_H_
+
+#include "defs.h"
+
+spill_t* new_spill (int (*compare) (void const*const,void const*const), uint64_t const memory_limit);
+
+void clear_spill (spill_t *const spill);
+void delete_spill (spill_t *const spill);
+
+void insert_into_spill (spill_t *const spill, multidata_container_t *const container);
+multidata_container_t* remove_from_spill (spill_t *const spill);
+
+void append_spill (spill_t *const target, spill_t *const source);
+
+void rewind_spill (spill_t *const spill);
+multidata_container_t const* scan_spill (spill_t *const spill);
+
+fifo_t* transform_spill_into_queue (spill_t *const spill);
+
+#endif /* SPILL_H_ */
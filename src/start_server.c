@@ -21,6 +21,10 @@
 #include "rtree.h"
 #include "spatial_standard_queries.h"
 #include "qprocessor.h"
+#include "writer.h"
+#include "reactor.h"
+#include "shared_ring.h"
+#include "stats.h"
 #include "getopt.h"
 #include <ctype.h>
 #include <errno.h>
@@ -30,23 +34,28 @@
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
 #include <fenv.h>
 
-pthread_mutex_t lmx = PTHREAD_MUTEX_INITIALIZER;
-
 uint32_t PORT;
 char const* HOST;
 char const* FOLDER;
+char const* SOCKET_PATH;
+uint32_t IDLE_TIMEOUT = CONNECTION_IDLE_TIMEOUT;
+
+static reactor_t* server_reactor = NULL;
+
+static char headers[] = "HTTP/1.1 %s\r\n"
+				"Access-Control-Allow-Origin: *\r\n"
+				"Access-Control-Allow-Methods: GET, POST, DELETE, PUT\r\n"
+				"Content-type: %s\r\n"
+				"Connection: %s\r\n";
 
-static char ok_response[] = "HTTP/1.0 200 OK\n"
-				"Access-Control-Allow-Origin: *\n"
-				"Access-Control-Allow-Methods: GET, POST, DELETE, PUT\n"
-				"Content-type: text/json\n\n"
-				"{\n\t\"status\": \"%s\",\n"
+static char ok_response[] = "{\n\t\"status\": \"%s\",\n"
 				"\t\"query\": \"%s\",\n"
 				"\t\"message\": \"%s\",\n"
 				"\t\"io_blocks\": %lu,\n"
@@ -54,11 +63,8 @@ static char ok_response[] = "HTTP/1.0 200 OK\n"
 				"\t\"proc_time\": %lu,\n"
 				"\t\"data\": ";
 
-static char ok_data[] = "HTTP/1.0 200 OK\n"
-				"Access-Control-Allow-Origin: *\n"
-				"Access-Control-Allow-Methods: GET, POST, DELETE, PUT\n"
-				"Content-type: text/json\n\n"
-				"{\n\t\"data\": ";
+static char ok_data[] = "{\n\t\"data\": ";
+static char ok_progress[] = "{\n\t\"progress\": ";
 
 static char metadata[] = "\t\"status\": \"%s\",\n"
 				"\t\"query\": \"%s\",\n"
@@ -67,11 +73,7 @@ static char metadata[] = "\t\"status\": \"%s\",\n"
 				"\t\"io_mb\": %.3lf,\n"
 				"\t\"proc_time\": %lu\n";
 
-static char bad_request_response[] = "HTTP/1.0 400 Bad Request\n"
-				"Access-Control-Allow-Origin: *\n"
-				"Access-Control-Allow-Methods: GET, POST, DELETE, PUT\n"
-				"Content-type: text/json\n\n"
-				"{\n\t\"status\": \"ERROR\"\n,"
+static char bad_request_response[] = "{\n\t\"status\": \"ERROR\"\n,"
 				"\t\"query\": \"%s\",\n"
 				"\t\"message\": \"Unable to process query from bad request.\",\n"
 				"\t\"io_blocks\": 0,\n"
@@ -80,11 +82,7 @@ static char bad_request_response[] = "HTTP/1.0 400 Bad Request\n"
 				"\t\"data\": null\n"
 				"}\n";
 
-static char not_found_response_template[] = "HTTP/1.0 404 Not Found\n"
-				"Access-Control-Allow-Origin: *\n"
-				"Access-Control-Allow-Methods: GET, POST, DELETE, PUT\n"
-				"Content-type: text/json\n\n"
-				"{\n\t\"status\":\"ERROR\"\n,"
+static char not_found_response_template[] = "{\n\t\"status\":\"ERROR\"\n,"
 				"\t\"query\": \"%s\",\n"
 				"\t\"message\": \"The requested URL '%s' was not found.\",\n"
 				"\t\"io_blocks\": 0,\n"
@@ -93,11 +91,7 @@ static char not_found_response_template[] = "HTTP/1.0 404 Not Found\n"
 				"\t\"data\": null\n"
 				"}\n";
 
-static char bad_method_response_template[] = "HTTP/1.0 501 Method Not implemented\n"
-				"Access-Control-Allow-Origin: *\n"
-				"Access-Control-Allow-Methods: GET, POST, DELETE, PUT\n"
-				"Content-type: text/json\n\n"
-				"{\n\t\"status\":\"ERROR\"\n,"
+static char bad_method_response_template[] = "{\n\t\"status\":\"ERROR\"\n,"
 				"\t\"query\": \"%s\"\n"
 				"\t\"message\": \"The requested method '%s' is not implemented.\"\n"
 				"\t\"io_blocks\": 0,\n"
@@ -118,17 +112,31 @@ void print_usage (char const*const program) {
 	printf (" ** Usage:\t %s [option] [parameter]\n", program);
 	puts ("\t\t-h --host :\t The server address.");
 	puts ("\t\t-p --port :\t The server port-number.");
+	puts ("\t\t-s --socket :\t The path of a Unix-domain socket for co-located clients.");
 	puts ("\t\t-f --folder :\t The folder to the path containing the heapfiles.");
+	puts ("\t\t-t --threads :\t The number of threads processing each query by default.");
+	puts ("\t\t-m --memory :\t The megabytes of join results kept in memory before spilling to disk, unless set per join (memory=).");
+	puts ("\t\t-c --cache :\t The megabytes of responses kept for repeated queries.");
+	puts ("\t\t-i --idle :\t The seconds a connection is kept alive without requests.");
+	puts ("\t\t-l --slow :\t The milliseconds after which a request is logged with what it cost.");
+	puts ("\t\t-r --slow-rate :\t The most slow requests logged per second.");
 }
 
 static
 void process_arguments (int argc,char *argv[]) {
-	char const*const short_options = "uh:p:f:";
+	char const*const short_options = "uh:p:s:f:t:m:c:i:l:r:";
 	const struct option long_options [] = {
 		{"usage",0,NULL,'u'},
 		{"host",1,NULL,'h'},
 		{"port",1,NULL,'p'},
+		{"socket",1,NULL,'s'},
 		{"folder",1,NULL,'f'},
+		{"threads",1,NULL,'t'},
+		{"memory",1,NULL,'m'},
+		{"cache",1,NULL,'c'},
+		{"idle",1,NULL,'i'},
+		{"slow",1,NULL,'l'},
+		{"slow-rate",1,NULL,'r'},
 		{NULL,0,NULL,0}
 	};
 
@@ -150,6 +158,27 @@ void process_arguments (int argc,char *argv[]) {
 		case 'p':
 			PORT = atoi(optarg);
 			break;
+		case 's':
+			SOCKET_PATH = optarg;
+			break;
+		case 't':
+			PARALLELISM = atoi(optarg);
+			break;
+		case 'm':
+			MEMORY_LIMIT = atof(optarg)*(1<<20);
+			break;
+		case 'c':
+			CACHE_LIMIT = atof(optarg)*(1<<20);
+			break;
+		case 'i':
+			IDLE_TIMEOUT = atoi(optarg);
+			break;
+		case 'l':
+			SLOW_QUERY_LIMIT = atoi(optarg);
+			break;
+		case 'r':
+			SLOW_QUERY_RATE = atoi(optarg);
+			break;
 		case -1:
 			break;
 		case '?':
@@ -162,20 +191,133 @@ void process_arguments (int argc,char *argv[]) {
 }
 
 
+/**
+ * Whether any header of the request by the given name contains
+ * the value given, regardless of the case of either, as found in
+ * place among the bytes of the header.
+ */
+static
+boolean has_header_value (char const request[], char const name[], char const value[]) {
+	uint64_t const name_length = strlen (name);
+	uint64_t const value_length = strlen (value);
+	for (char const* line = strchr (request,'\n'); line != NULL && line[1] != '\n' && line[1] != '\r'; line = strchr (line+1,'\n')) {
+		if (!strncasecmp (line+1,name,name_length) && line[1+name_length] == ':') {
+			char const* end = strchr (line+1,'\n');
+			if (end == NULL) {
+				end = line + 1 + strlen (line+1);
+			}
+			for (char const* header = line+2+name_length; header+value_length <= end; ++header) {
+				if (!strncasecmp (header,value,value_length)) {
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+/**
+ * Whether any header line of the request, up to where its
+ * body begins, is longer than the limit of header lines.
+ */
+static
+boolean has_oversized_header (char const request[], char const*const body) {
+	for (char const* line = strchr (request,'\n'); line != NULL && line+1 < body; ) {
+		char const*const end = strchr (line+1,'\n');
+		if ((end != NULL ? end : body) - line - 1 > HEADER_LINE_LIMIT) {
+			return true;
+		}
+		line = end;
+	}
+	return false;
+}
+
+/**
+ * Binary results are negotiated through the Accept header, where
+ * parameter "layout=columns" asks for tuples column by column.
+ */
+static
+format_t accepted_format (char const request[]) {
+	if (has_header_value (request,"accept","application/octet-stream")) {
+		return has_header_value (request,"accept","layout=columns") ? COLUMNS_FORMAT : ROWS_FORMAT;
+	}
+	return JSON_FORMAT;
+}
+
+#define UNKNOWN_LENGTH UINT64_MAX
+
+/**
+ * Writes the status line and the headers of a response. Bodies of
+ * unknown length are sent in chunks when the connection is kept
+ * alive, or else their end is marked by closing the connection.
+ */
+static
+void write_headers (writer_t *const writer, char const status[], char const content_type[],
+			boolean const keep_alive, uint64_t const content_length) {
+	char response [sizeof(headers)+strlen(status)+strlen(content_type)+16];
+	snprintf (response,sizeof(response),headers,status,content_type,keep_alive ? "keep-alive" : "close");
+	write_string (writer,response);
+	if (content_length != UNKNOWN_LENGTH) {
+		write_string (writer,"Content-Length: ");
+		write_unsigned (writer,content_length);
+		write_string (writer,"\r\n\r\n");
+	}else if (keep_alive) {
+		write_string (writer,"Transfer-Encoding: chunked\r\n\r\n");
+		begin_chunks (writer);
+	}else{
+		write_string (writer,"\r\n");
+	}
+}
+
+static
+void send_response (int const fd, char const status[], char const body[], boolean const keep_alive) {
+	writer_t *const writer = new_writer (fd,NULL,NULL);
+	write_headers (writer,status,"text/json",keep_alive,strlen (body));
+	write_string (writer,body);
+	free (delete_writer (writer));
+}
+
+/**
+ * Replaces any trailing slashes of a request URL by the semicolon
+ * ending its command; i.e. the URL is expected to have room for it.
+ */
 static
-void handle (int fd, char const method[], char url[], char const body[], char const folder[]) {
+void terminate_command (char request[]) {
+	uint64_t i = strlen(request)-1;
+	while (i && request[i] == '/') {
+		request [i--] = '\0';
+	}
+	request [i+1] = ';';
+	request [i+2] = '\0';
+}
+
+/**
+ * Returns whether the connection is kept alive after the response.
+ */
+static
+boolean handle (int fd, char const method[], char url[], char const body[], uint64_t const body_length, char const folder[], format_t format, boolean const keep_alive) {
 	//LOG (info,"[start#server] Server received request: %s %s %s\n",method,url,body);
 	LOG (info,"[start#server] Server received request: %s %s\n",method,url);
 
 	boolean write_through = true;
 	char* request = url;
-	if (*request == '/') {
-		uint64_t i = strlen(request)-1;
-		while (i && request[i] == '/') {
-			request [i--] = '\0';
+
+	/* query results may also be asked for in binary by prefixing their URL */
+	if (!strncmp (request,"/binary/",8)) {
+		request += 7;
+		format = ROWS_FORMAT;
+		if (!strncmp (request,"/columns/",9)) {
+			request += 8;
+			format = COLUMNS_FORMAT;
 		}
-		request [i+1] = ';';
-		request [i+2] = '\0';
+	}
+
+	if (*request == '/') {
+		terminate_command (request);
+
+		/* records are posted in bulk to the URL of their heapfile followed by "/bulk" */
+		char const*const suffix = strrchr (request,'/');
+		boolean const is_bulk = !strcmp (method,"POST") && suffix != request && !strcmp (suffix,"/bulk;");
 
 		char message [BUFSIZ<<2];
 		bzero (message,sizeof(message));
@@ -186,17 +328,19 @@ void handle (int fd, char const method[], char url[], char const body[], char co
 		boolean free_data = false;
 		double io_mb_counter = 0;
 		uint64_t io_blocks_counter = 0;
-		clock_t start = clock();
+		writer_t *const writer = new_writer (fd,NULL,NULL);
+		uint64_t const start = wall_clock_micros();
 		if (!strcmp(method,"GET")) {
 			if (write_through) {
-				if (write (fd,ok_data,strlen(ok_data)*sizeof(char)) < strlen(ok_data)*sizeof(char)) {
-					LOG (error,"[start#server] Error while sending data using file-descriptor %u.\n",fd);
-					data = NULL;
+				write_headers (writer,"200 OK",format == JSON_FORMAT ? "text/json" : "application/octet-stream",keep_alive,UNKNOWN_LENGTH);
+				if (format != JSON_FORMAT) {
+					write_schema (writer,format);
 				}else{
-					data = qprocessor (request,folder,message,&io_blocks_counter,&io_mb_counter,fd);
+					write_string (writer,ok_data);
 				}
+				data = qprocessor (request,folder,message,&io_blocks_counter,&io_mb_counter,writer,format);
 			}else{
-				data = qprocessor (request,folder,message,&io_blocks_counter,&io_mb_counter,0);
+				data = qprocessor (request,folder,message,&io_blocks_counter,&io_mb_counter,NULL,JSON_FORMAT);
 			}
 
 			if (data != NULL) {
@@ -207,13 +351,26 @@ void handle (int fd, char const method[], char url[], char const body[], char co
 				data = " null\n";
 				result_code = "FAILURE";
 			}
+		}else if (is_bulk) {
+			char heapfile [suffix-request];
+			memcpy (heapfile,request+1,suffix-request-1);
+			heapfile [suffix-request-1] = '\0';
+
+			format = JSON_FORMAT;
+			write_headers (writer,"200 OK","text/json",keep_alive,UNKNOWN_LENGTH);
+			write_string (writer,ok_progress);
+			int const rval = process_bulk_request (heapfile,body,body_length,folder,message,&io_blocks_counter,&io_mb_counter,writer);
+
+			data = " null\n";
+			result_code = rval == EXIT_SUCCESS ? "SUCCESS" : "FAILURE";
 		}else{
 			write_through = false;
+			format = JSON_FORMAT;
 			int rval = EXIT_FAILURE;
 			if (!strcmp(method,"DELETE")) {
-				rval = process_rest_request (body,folder,message,&io_blocks_counter,&io_mb_counter,DELETE);
+				rval = process_rest_request (body,body_length,folder,message,&io_blocks_counter,&io_mb_counter,DELETE);
 			}else if (!strcmp(method,"PUT")) {
-				rval = process_rest_request (body,folder,message,&io_blocks_counter,&io_mb_counter,PUT);
+				rval = process_rest_request (body,body_length,folder,message,&io_blocks_counter,&io_mb_counter,PUT);
 			}else{
 				strcat (message,"Unknown request type.");
 			}
@@ -241,143 +398,251 @@ void handle (int fd, char const method[], char url[], char const body[], char co
 			request = body;
 */
 		}
-		clock_t end = clock();
+		uint64_t const end = wall_clock_micros();
 
-		if (write_through) {
+		char body_end[] = "}\n";
+
+		if (format != JSON_FORMAT) {
+			write_trailer (writer,free_data,io_blocks_counter,io_mb_counter,
+					((end-start)/1000),message);
+		}else if (write_through) {
 			char response[strlen(metadata)+strlen(result_code)+strlen(request)+strlen(message)+1];
 			snprintf (response,sizeof(response),metadata,result_code,request,message,
 					io_blocks_counter,io_mb_counter,
-					((end-start)*1000/CLOCKS_PER_SEC));
-			if (write (fd,response,strlen(response)*sizeof(char)) < strlen(response)*sizeof(char)) {
-				LOG (error,"[start#server] Error while sending data using file-descriptor %u.\n",fd);
-			}
+					((end-start)/1000));
+			write_string (writer,response);
+			write_string (writer,body_end);
 		}else{
 			char response[strlen(ok_response)+strlen(result_code)+strlen(request)+strlen(message)+1];
 			snprintf (response,sizeof(response),ok_response,result_code,request,message,
 					io_blocks_counter,io_mb_counter,
-					((end-start)*1000/CLOCKS_PER_SEC));
-			if (write (fd,response,strlen(response)*sizeof(char)) < strlen(response)*sizeof(char)) {
-				LOG (error,"[start#server] Error while sending data using file-descriptor %u.\n",fd);
-			}
+					((end-start)/1000));
+			write_headers (writer,"200 OK","text/json",keep_alive,strlen(response)+strlen(data)+strlen(body_end));
+			write_string (writer,response);
+			write_string (writer,data);
+			write_string (writer,body_end);
+		}
 
-			if (write (fd,data,strlen(data)*sizeof(char)) < strlen(data)*sizeof(char)) {
-				LOG (error,"[start#server] Error while sending data using file-descriptor %u.\n",fd);
-			}
+		if (write_through && keep_alive) {
+			end_chunks (writer);
 		}
+		free (delete_writer (writer));
 
 		if (free_data) {
 			free (data);
 		}
-
-		char body_end[] = "}\n";
-
-		if (write (fd,body_end,strlen(body_end)*sizeof(char)) < strlen(body_end)*sizeof(char)) {
-			LOG (error,"[start#server] Error while sending data using file-descriptor %u.\n",fd);
-		}
 	}else{
 		char response[strlen(not_found_response_template)+strlen(url)+strlen(request)+1];
 		snprintf (response,sizeof(response),not_found_response_template,url,request);
-		if (write (fd,response,strlen(response)*sizeof(char)) < strlen(response)*sizeof(char)) {
-			LOG (error,"[start#server] Error while sending data using file-descriptor %u.\n",fd);
-		}
+		send_response (fd,"404 Not Found",response,keep_alive);
 	}
+	return keep_alive;
 }
 
 
-typedef struct {
-    char* folder;
-    int connection;
-} handler_args;
+/**
+ * Responds to GET /_stats with the load of the reactor, the counters
+ * of the open heapfiles and the latencies of the operators; i.e. in
+ * lines of text if so accepted by the client, or else in JSON.
+ */
+static
+void send_statistics (int const fd, boolean const as_text, boolean const keep_alive) {
+	uint64_t queued = 0;
+	uint32_t active = 0;
+	uint32_t workers = 0;
+	if (server_reactor != NULL) {
+		measure_reactor (server_reactor,&queued,&active);
+		workers = server_reactor->workers_number;
+	}
+
+	writer_t *const writer = new_writer (fd,NULL,NULL);
+	write_headers (writer,"200 OK",as_text ? "text/plain" : "text/json",keep_alive,UNKNOWN_LENGTH);
+	if (as_text) {
+		write_string (writer,"server_queue_depth ");
+		write_unsigned (writer,queued);
+		write_string (writer,"\nserver_active_workers ");
+		write_unsigned (writer,active);
+		write_string (writer,"\nserver_workers ");
+		write_unsigned (writer,workers);
+		write_string (writer,"\n");
+	}else{
+		write_string (writer,"{\"server\":{\"queue_depth\":");
+		write_unsigned (writer,queued);
+		write_string (writer,",\"active_workers\":");
+		write_unsigned (writer,active);
+		write_string (writer,",\"workers\":");
+		write_unsigned (writer,workers);
+		write_string (writer,"},");
+	}
+	report_statistics (writer,as_text);
+	if (!as_text) {
+		write_string (writer,"}\n");
+	}
+	if (keep_alive) {
+		end_chunks (writer);
+	}
+	free (delete_writer (writer));
+}
 
+/**
+ * Copies the next token of the request line into a buffer of the
+ * given size and moves past it, returning its length; tokens that
+ * would not fit in the buffer, terminator included, are not copied.
+ */
 static
-void handle_connection (void *const args) {
-	char const*const folder = ((handler_args const*const)args)->folder;
-	int const fd = ((handler_args const*const)args)->connection;
-	free (args);
-
-	LOG (info,"[start#server] Handling new connection for file descriptor %u.\n",fd)
-
-	char buffer[BUFSIZ<<1];
-	ssize_t bytes_read = read (fd,buffer,sizeof(buffer));
-	if (bytes_read > 0) {
-		char url[BUFSIZ];
-		char method[BUFSIZ];
-		char protocol[BUFSIZ];
-
-		buffer[bytes_read] = '\0';
-		//LOG (debug,"[start#server] BUFFER:\n%s\n",buffer);
-
-		sscanf (buffer,"%s %s %s",method,url,protocol);
-
-		uint64_t content_length = 0;
-		lifo_t* content_stack = NULL;
-		char* content = NULL;
-		do{
-			if ((content = strstr(buffer,"\r\n\r\n")) != NULL || (content = strstr(buffer,"\n\n")) != NULL) {
-				char* cl_ptr = strstr (buffer,"content-length");
-				if (cl_ptr == NULL) cl_ptr = strstr (buffer,"Content-Length");
-
-				if (cl_ptr != NULL) {
-					cl_ptr += strlen("content-length: ");
-					sscanf (cl_ptr,"%lu",&content_length);
-
-					if (*content == '\r') ++content;
-					if (*content == '\n') ++content;
-					if (*content == '\r') ++content;
-					if (*content == '\n') ++content;
-
-					content_stack = new_stack();
-					do{
-						for (;content < buffer+sizeof(buffer) && content_stack->size < content_length;
-								insert_into_stack (content_stack,*content++))
-							;
-
-						if (content_stack->size < content_length) {
-							LOG (debug,"[start#server] Emptying and refilling network buffer...\n");
-							bzero (buffer,sizeof(buffer));
-							bytes_read = read (fd,buffer,sizeof(buffer));
-							buffer[bytes_read] = '\0';
-							content = buffer;
-							//LOG (debug,"[start#server] BUFFER:\n%s\n",buffer);
-						}else{
-							insert_into_stack (content_stack,'\0');
-							break;
-						}
-					}while (bytes_read > 0);
-				}
-				break;
-			}
-		}while (bytes_read > 0);
+uint64_t next_token (char const**const line, char token[], uint64_t const size) {
+	*line += strspn (*line," \t");
+	uint64_t const length = strcspn (*line," \t\r\n");
+	if (length < size) {
+		memcpy (token,*line,length);
+		token [length] = '\0';
+	}
+	*line += length;
+	return length;
+}
 
-		char body [content_length+1];
-		if (content_length) {
-			char *to = body;
-			for (register uint32_t i=0; i<=content_length; ++i) {
-				*to++ = content_stack->buffer[i];
-			}
-			*to = '\0';
-			delete_stack (content_stack);
+/**
+ * Serves a request read in full by the reactor. Connections of
+ * HTTP/1.1 are kept alive for more requests unless asked otherwise.
+ */
+static
+boolean handle_request (int const fd, char request[], uint64_t const length, void **const session, void *const args) {
+	char const*const folder = (char const*const) args;
+
+	LOG (info,"[start#server] Handling new request for file descriptor %u.\n",fd)
+
+	char url[BUFSIZ];
+	char method[BUFSIZ>>8];
+	char protocol[BUFSIZ>>8];
+
+	//LOG (debug,"[start#server] BUFFER:\n%s\n",request);
+
+	char response[BUFSIZ];
+	char const* request_line = request;
+	uint64_t const method_length = next_token (&request_line,method,sizeof(method));
+	uint64_t const url_length = next_token (&request_line,url,sizeof(url)-1);
+	uint64_t const protocol_length = next_token (&request_line,protocol,sizeof(protocol));
+	if (url_length >= sizeof(url)-1) {
+		LOG (warn,"[start#server] Request of file descriptor %u has a URL longer than %lu bytes.\n",fd,sizeof(url)-2);
+		snprintf (response,sizeof(response),bad_request_response,"");
+		send_response (fd,"414 URI Too Long",response,false);
+		return false;
+	}else if (!method_length || !url_length || !protocol_length
+			|| method_length >= sizeof(method) || protocol_length >= sizeof(protocol)) {
+		LOG (error,"[start#server] Problematic IPC...\n");
+		snprintf (response,sizeof(response),bad_request_response,"");
+		send_response (fd,"400 Bad Request",response,false);
+		return false;
+	}
+
+	char* body = strstr (request,"\r\n\r\n");
+	if (body != NULL) {
+		body += 4;
+	}else if ((body = strstr (request,"\n\n")) != NULL) {
+		body += 2;
+	}else{
+		body = request + length;
+	}
+
+	if (has_oversized_header (request,body)) {
+		LOG (warn,"[start#server] Request of file descriptor %u has a header line longer than %u bytes.\n",fd,HEADER_LINE_LIMIT);
+		snprintf (response,sizeof(response),bad_request_response,url);
+		send_response (fd,"431 Request Header Fields Too Large",response,false);
+		return false;
+	}
+
+	format_t const format = accepted_format (request);
+	boolean const keep_alive = !strcmp (protocol,"HTTP/1.1") && !has_header_value (request,"connection","close");
+
+	LOG (debug,"[start#server] FULL BODY:\n%s\n",body);
+	if (strcmp(protocol,"HTTP/1.0") && strcmp(protocol,"HTTP/1.1")) {
+		snprintf (response,sizeof(response),bad_request_response,url);
+		send_response (fd,"400 Bad Request",response,false);
+		return false;
+	}else if (strcmp(method,"GET") && strcmp(method,"POST") && strcmp(method,"PUT") && strcmp(method,"DELETE")) {
+		snprintf (response,sizeof(response),bad_method_response_template,url,method);
+		send_response (fd,"501 Method Not implemented",response,keep_alive);
+		return keep_alive;
+	}else if (!strcmp(method,"GET") && (!strcmp(url,"/_stats") || !strncmp(url,"/_stats?",8))) {
+		send_statistics (fd,has_header_value (request,"accept","text/plain"),keep_alive);
+		return keep_alive;
+	}else return handle (fd,method,url,body,request+length-body,folder,format,keep_alive);
+}
+
+/**
+ * Serves a request framed by a co-located client. Results are sent
+ * in binary as for HTTP, though in frames whose payloads are placed
+ * in the shared ring of the connection if so asked for, which is
+ * then kept as its session; the connection is always kept alive.
+ */
+static
+boolean handle_frame (int const fd, char request[], uint64_t const length, void **const session, void *const args) {
+	char const*const folder = (char const*const) args;
+
+	char const operation = request[4];
+	uint8_t const flags = request[5];
+	char *const payload = request + FRAME_HEADER_SIZE;
+	uint64_t const payload_length = length - FRAME_HEADER_SIZE;
+	format_t const format = flags & FRAME_COLUMNS ? COLUMNS_FORMAT : ROWS_FORMAT;
+
+	LOG (info,"[start#server] Handling framed request '%c' of %lu bytes for file descriptor %u.\n",operation,payload_length,fd);
+
+	if ((flags & FRAME_SHARED) && *session == NULL) {
+		*session = new_shared_ring (SHARED_RING_CAPACITY);
+	}
+
+	char message [BUFSIZ<<2];
+	*message = '\0';
+
+	boolean is_successful = false;
+	double io_mb_counter = 0;
+	uint64_t io_blocks_counter = 0;
+	writer_t *const writer = new_writer (fd,NULL,NULL);
+	begin_frames (writer,flags & FRAME_SHARED ? *session : NULL);
+	write_schema (writer,format);
+
+	uint64_t const start = wall_clock_micros();
+	if (operation == FRAME_QUERY) {
+		char command [BUFSIZ];
+		if (payload_length && *payload == '/' && payload_length < sizeof(command)-1) {
+			memcpy (command,payload,payload_length);
+			command [payload_length] = '\0';
+			terminate_command (command);
+			char *const data = qprocessor (command,folder,message,&io_blocks_counter,&io_mb_counter,writer,format);
+			is_successful = data != NULL;
+			free (data);
+		}else{
+			strcat (message,"Unable to process query from bad request.");
 		}
-		LOG (debug,"[start#server] FULL BODY:\n%s\n",body);
-		char response[BUFSIZ];
-		if (strcmp(protocol,"HTTP/1.0") && strcmp(protocol,"HTTP/1.1")) {
-			snprintf (response,sizeof(response),bad_request_response,url);
-			if (write (fd,response,strlen(response)*sizeof(char)) < strlen(response)*sizeof(char)) {
-				LOG (error,"[start#server] Error while sending data using file-descriptor %u.\n",fd);
-			}
-		}else if (strcmp(method,"GET") && strcmp(method,"POST") && strcmp(method,"PUT") && strcmp(method,"DELETE")) {
-			snprintf (response,sizeof(response),bad_method_response_template,url,method);
-			if (write (fd,response,strlen(response)*sizeof(char)) < strlen(response)*sizeof(char)) {
-				LOG (error,"[start#server] Error while sending data using file-descriptor %u.\n",fd);
-			}
-		}else handle (fd,method,url,body,folder);
-	}else LOG (error,"[start#server] Problematic IPC...\n");
-	close (fd);
-	pthread_exit (NULL);
+	}else if (operation == FRAME_PUT || operation == FRAME_DELETE) {
+		is_successful = process_rest_request (payload,payload_length,folder,message,&io_blocks_counter,&io_mb_counter,
+						operation == FRAME_PUT ? PUT : DELETE) == EXIT_SUCCESS;
+	}else if (operation == FRAME_BULK) {
+		char const*const data = memchr (payload,'\0',payload_length);
+		if (data != NULL) {
+			is_successful = process_bulk_request (payload,data+1,payload+payload_length-data-1,folder,message,
+							&io_blocks_counter,&io_mb_counter,NULL) == EXIT_SUCCESS;
+		}else{
+			strcat (message,"Invalid heapfile name.");
+		}
+	}else{
+		strcat (message,"Unknown request type.");
+	}
+	uint64_t const end = wall_clock_micros();
+
+	write_trailer (writer,is_successful,io_blocks_counter,io_mb_counter,((end-start)/1000),message);
+	end_chunks (writer);
+	free (delete_writer (writer));
+	return true;
+}
+
+static
+void end_shared_ring (void *const session) {
+	delete_shared_ring ((shared_ring_t*) session);
 }
 
 static
-void server_run (struct in_addr const local_address, uint16_t const port, char const folder[]) {
+int open_tcp_socket (struct in_addr const local_address, uint16_t const port) {
 	struct sockaddr_in socket_address;
 	bzero (&socket_address,sizeof(socket_address));
 	socket_address.sin_family = AF_INET;
@@ -385,16 +650,21 @@ void server_run (struct in_addr const local_address, uint16_t const port, char c
 	socket_address.sin_port = port;
 
 	int server_socket = socket (PF_INET,SOCK_STREAM,0);
-	if (server_socket < 0) LOG (error,"[start#server] Cannot create a TCP socket...\n");
+	if (server_socket < 0) {
+		LOG (error,"[start#server] Cannot create a TCP socket...\n");
+		return -1;
+	}
 
 	if (bind (server_socket,&socket_address,sizeof(socket_address))) {
 		LOG (error,"[start#server] Unable to bind address. Try a different address/port pair...\n");
-		return;
+		close (server_socket);
+		return -1;
 	}
 
-	if (listen (server_socket,5)) {
+	if (listen (server_socket,SOMAXCONN)) {
 		LOG (error,"[start#server] Cannot set-up server for listening for new connections...\n");
-		return;
+		close (server_socket);
+		return -1;
 	}
 
 	socklen_t address_length = sizeof (socket_address);
@@ -404,52 +674,88 @@ void server_run (struct in_addr const local_address, uint16_t const port, char c
 	LOG (info,"[start#server] Server listening on '%s':%d\n",
 				inet_ntoa(socket_address.sin_addr),
 				ntohs(socket_address.sin_port));
+	return server_socket;
+}
 
-	while (true) {
-		struct sockaddr_in remote_address;
-		address_length = sizeof (remote_address);
-		int connection = accept (server_socket,&remote_address,&address_length);
+/**
+ * Listens on a Unix-domain socket at the path given, replacing
+ * whatever socket was left there by a previous run of the server.
+ */
+static
+int open_unix_socket (char const path[]) {
+	struct sockaddr_un socket_address;
+	bzero (&socket_address,sizeof(socket_address));
+	socket_address.sun_family = AF_UNIX;
+	if (strlen (path) >= sizeof(socket_address.sun_path)) {
+		LOG (error,"[start#server] Socket path '%s' is too long...\n",path);
+		return -1;
+	}
+	strcpy (socket_address.sun_path,path);
 
-		if (connection < 0) {
-			/* the call to accept failed. */
-			if (errno == EINTR) continue;
-			else LOG (error,"[start#server] Error while accepting new connection...\n");
-		}else{
-			address_length = sizeof (socket_address);
-			if (getpeername (connection,&socket_address,&address_length)) {
-				LOG (warn,"[start#server] Problem establishing connection with '%s'...\n",inet_ntoa(socket_address.sin_addr));
-			}else{
-				LOG (info,"[start#server] Server accepted new connection from '%s'.\n",inet_ntoa(socket_address.sin_addr));
-			}
+	int server_socket = socket (PF_UNIX,SOCK_STREAM,0);
+	if (server_socket < 0) {
+		LOG (error,"[start#server] Cannot create a Unix-domain socket...\n");
+		return -1;
+	}
 
-			handler_args *const args = (handler_args* const) malloc (sizeof (handler_args));
-			args->connection = connection;
-			args->folder = folder;
-
-			pthread_t thread;
-			pthread_attr_t attr;
-			pthread_attr_init (&attr);
-			pthread_attr_setscope (&attr,PTHREAD_SCOPE_SYSTEM);
-			pthread_attr_setstacksize (&attr,THREAD_STACK_SIZE);
-			pthread_attr_setdetachstate (&attr,PTHREAD_CREATE_DETACHED);
-			if (pthread_create (&thread,&attr,&handle_connection,args)) {
-				LOG (fatal,"[start#server] Unable to create new thread...\n");
-				exit (EXIT_FAILURE);
-			}
-			pthread_attr_destroy (&attr);
-		}
+	unlink (path);
+	if (bind (server_socket,(struct sockaddr*)&socket_address,sizeof(socket_address))) {
+		LOG (error,"[start#server] Unable to bind socket path '%s'...\n",path);
+		close (server_socket);
+		return -1;
+	}
+
+	if (listen (server_socket,SOMAXCONN)) {
+		LOG (error,"[start#server] Cannot set-up server for listening for new local connections...\n");
+		close (server_socket);
+		unlink (path);
+		return -1;
+	}
+
+	LOG (info,"[start#server] Server listening on '%s'\n",path);
+	return server_socket;
+}
+
+static
+void server_run (struct in_addr const local_address, uint16_t const port, char const socket_path[], char const folder[]) {
+	/* requests are served by as many workers as there are cores */
+	uint32_t const workers_number = sysconf (_SC_NPROCESSORS_ONLN);
+	reactor_t *const reactor = new_reactor (workers_number,workers_number*REACTOR_QUEUE_FACTOR,IDLE_TIMEOUT);
+	server_reactor = reactor;
+
+	int const tcp_socket = port ? open_tcp_socket (local_address,port) : -1;
+	if (tcp_socket >= 0) {
+		listen_reactor (reactor,tcp_socket,HTTP_PROTOCOL,&handle_request,NULL,(void*)folder);
+	}
+	int const unix_socket = socket_path != NULL ? open_unix_socket (socket_path) : -1;
+	if (unix_socket >= 0) {
+		listen_reactor (reactor,unix_socket,FRAMED_PROTOCOL,&handle_frame,&end_shared_ring,(void*)folder);
+	}
+
+	if ((!port || tcp_socket >= 0) && (socket_path == NULL || unix_socket >= 0)) {
+		run_reactor (reactor);
+	}
+	server_reactor = NULL;
+	delete_reactor (reactor);
+
+	if (tcp_socket >= 0) {
+		close (tcp_socket);
+	}
+	if (unix_socket >= 0) {
+		close (unix_socket);
+		unlink (socket_path);
 	}
 }
 
 
 static 
-void server_start (char const hostname[], uint32_t const port_number, char const folder[]) {
+void server_start (char const hostname[], uint32_t const port_number, char const socket_path[], char const folder[]) {
 	//struct hostent *local_hostname = gethostbyname (hostname);
 	struct in_addr local_address;
 	local_address.s_addr = hostname != NULL ? inet_addr (hostname) : INADDR_ANY;
 
 	uint16_t port = htons(port_number);
-	server_run (local_address,port,folder);
+	server_run (local_address,port,socket_path,folder);
 }
 
 static char* pull_random_quote (void);
@@ -458,25 +764,25 @@ int main (int argc, char* argv[]) {
 	print_notice ();
 	process_arguments (argc,argv);
 
-	if (!PORT) {
-		LOG (error,"[%s] Please specify a port number...\n",argv[0]);
+	if (!PORT && SOCKET_PATH == NULL) {
+		LOG (error,"[%s] Please specify a port number or a socket path...\n",argv[0]);
 	}
 	if (!FOLDER) {
 		LOG (error,"[%s] Please specify the directory containing the heapfiles...\n",argv[0]);
 	}
 
 
-	if (PORT && FOLDER) {
+	if ((PORT || SOCKET_PATH != NULL) && FOLDER) {
 		puts (pull_random_quote());
 		if (feraiseexcept (FE_OVERFLOW | FE_UNDERFLOW | FE_DIVBYZERO | FE_INVALID)){
 			LOG (error,"[%s] FE ENABLE EXCEPTIONS FAILED...\n",argv[0]);
 		}
-		server_start (HOST,PORT,FOLDER);
-		pthread_mutex_destroy (&lmx);
+		server_start (HOST,PORT,SOCKET_PATH,FOLDER);
+		flush_log ();
 		return EXIT_SUCCESS;
 	}else{
 		print_usage (argv[0]);
-		pthread_mutex_destroy (&lmx);
+		flush_log ();
 		return EXIT_FAILURE;
 	}
 }
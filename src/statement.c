@@ -0,0 +1,146 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "statement.h"
+#include "stack.h"
+#include "defs.h"
+
+
+/**
+ * Compiles the tokens pushed by the parser of a command. Values are
+ * those of the tokens pointing in the array of the parser, the last
+ * of which is always the threshold of the command; strings and the
+ * placeholders are listed by the parser as their positions.
+ */
+statement_t* new_statement (char const command[], lifo_t const*const stack, double const varray[],
+				lifo_t const*const strings, lifo_t const*const placeholders) {
+	statement_t *const statement = (statement_t *const) malloc (sizeof(statement_t));
+	if (statement == NULL) {
+		LOG (fatal,"[new_statement()] Unable to allocate memory for new statement...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	statement->tokens_number = stack->size;
+	statement->tokens = (void**) malloc (sizeof(void*)*stack->size);
+	statement->kinds = (token_kind_t*) malloc (sizeof(token_kind_t)*stack->size);
+	if (statement->tokens == NULL || statement->kinds == NULL) {
+		LOG (fatal,"[new_statement()] Unable to allocate memory for the tokens of new statement...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	statement->values_number = 0;
+	for (uint64_t i=0; i<stack->size; ++i) {
+		double const*const token = (double const*const) stack->buffer[i];
+		if (token >= varray && token < varray+BUFSIZ) {
+			uint32_t const position = token - varray;
+			statement->tokens[i] = (void*)(uint64_t)position;
+			statement->kinds[i] = VALUE_TOKEN;
+			if (position >= statement->values_number) {
+				statement->values_number = position + 1;
+			}
+		}else{
+			statement->tokens[i] = stack->buffer[i];
+			statement->kinds[i] = PLAIN_TOKEN;
+		}
+	}
+	for (uint64_t i=0; i<strings->size; ++i) {
+		uint64_t const position = (uint64_t) strings->buffer[i];
+		statement->tokens[position] = strdup ((char const*const) stack->buffer[position]);
+		statement->kinds[position] = STRING_TOKEN;
+	}
+
+	statement->values = (double*) malloc (sizeof(double)*(statement->values_number+1));
+	if (statement->values == NULL) {
+		LOG (fatal,"[new_statement()] Unable to allocate memory for the values of new statement...\n");
+		exit (EXIT_FAILURE);
+	}
+	memcpy (statement->values,varray,sizeof(double)*statement->values_number);
+
+	statement->placeholders_number = placeholders->size >> 1;
+	statement->arguments = (uint32_t*) malloc (sizeof(uint32_t)*(statement->placeholders_number+1));
+	statement->positions = (uint32_t*) malloc (sizeof(uint32_t)*(statement->placeholders_number+1));
+	if (statement->arguments == NULL || statement->positions == NULL) {
+		LOG (fatal,"[new_statement()] Unable to allocate memory for the placeholders of new statement...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	statement->arguments_number = 0;
+	for (uint32_t i=0; i<statement->placeholders_number; ++i) {
+		statement->arguments[i] = (uint64_t) placeholders->buffer[i<<1];
+		statement->positions[i] = (uint64_t) placeholders->buffer[(i<<1)+1];
+		if (statement->arguments[i] > statement->arguments_number) {
+			statement->arguments_number = statement->arguments[i];
+		}
+	}
+
+	statement->is_single_subquery = strchr (command,'/') == strrchr (command,'/');
+	return statement;
+}
+
+void delete_statement (statement_t *const statement) {
+	for (uint64_t i=0; i<statement->tokens_number; ++i) {
+		if (statement->kinds[i] == STRING_TOKEN) {
+			free (statement->tokens[i]);
+		}
+	}
+	free (statement->tokens);
+	free (statement->kinds);
+	free (statement->values);
+	free (statement->arguments);
+	free (statement->positions);
+	free (statement);
+}
+
+uint64_t statement_size (statement_t const*const statement) {
+	uint64_t size = sizeof(statement_t)
+			+ statement->tokens_number*(sizeof(void*)+sizeof(token_kind_t))
+			+ statement->values_number*sizeof(double)
+			+ statement->placeholders_number*(sizeof(uint32_t)<<1);
+	for (uint64_t i=0; i<statement->tokens_number; ++i) {
+		if (statement->kinds[i] == STRING_TOKEN) {
+			size += strlen (statement->tokens[i]) + 1;
+		}
+	}
+	return size;
+}
+
+/**
+ * Pushes the tokens of a statement onto an empty stack to be processed,
+ * with its values copied in the given array after binding its arguments.
+ */
+void instantiate_statement (statement_t const*const statement, double const arguments[], lifo_t *const stack, double varray[]) {
+	memcpy (varray,statement->values,sizeof(double)*statement->values_number);
+	for (uint32_t i=0; i<statement->placeholders_number; ++i) {
+		varray [statement->positions[i]] = arguments [statement->arguments[i]-1];
+	}
+
+	for (uint64_t i=0; i<statement->tokens_number; ++i) {
+		switch (statement->kinds[i]) {
+			case VALUE_TOKEN:
+				insert_into_stack (stack,varray+(uint64_t)statement->tokens[i]);
+				break;
+			case STRING_TOKEN:
+				insert_into_stack (stack,strdup ((char const*const) statement->tokens[i]));
+				break;
+			default:
+				insert_into_stack (stack,statement->tokens[i]);
+		}
+	}
+}
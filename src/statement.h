@@ -0,0 +1,15 @@
+#ifndef STATEMENT_H_
+#define STATEMENT_H_
+
+#include "defs.h"
+
+statement_t* new_statement (char const command[], lifo_t const*const stack, double const varray[],
+				lifo_t const*const strings, lifo_t const*const placeholders);
+
+void delete_statement (statement_t *const statement);
+
+uint64_t statement_size (statement_t const*const statement);
+
+void instantiate_statement (statement_t const*const statement, double const arguments[], lifo_t *const stack, double varray[]);
+
+#endif /* STATEMENT_H_ */
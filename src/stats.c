@@ -0,0 +1,235 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "writer.h"
+#include "stats.h"
+#include "defs.h"
+
+
+static
+char const*const operator_names [OPERATORS_NUMBER] = {"lookup","range","nearest","skyline","sample","count",
+		"distance_join","closest_pairs","knn_join","insert","delete","bulk"};
+
+static
+histogram_t latencies [OPERATORS_NUMBER];
+
+
+uint64_t wall_clock_micros (void) {
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC,&now);
+	return now.tv_sec*1000000 + now.tv_nsec/1000;
+}
+
+/**
+ * Charges the query traced by the calling thread, if any, with the
+ * time elapsed in the given phase, and returns when the next began.
+ */
+uint64_t trace_phase (phase_t const phase, uint64_t const started) {
+	uint64_t const now = wall_clock_micros();
+	TRACE_EVENTS(phases[phase],now-started);
+	return now;
+}
+
+/**
+ * Describes what evaluating a query cost in a row of a response,
+ * as the last of those explaining how it was planned.
+ */
+char* explain_trace (query_context_t const*const context, uint64_t const rows) {
+	char *const buffer = (char *const) malloc (sizeof(char)*(BUFSIZ+TRACE_LEVELS*24));
+	if (buffer == NULL) {
+		LOG (fatal,"[explain_trace()] Unable to allocate additional memory for the trace of a query...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	uint32_t levels = TRACE_LEVELS;
+	while (levels > 1 && !context->visits[levels-1]) {
+		--levels;
+	}
+
+	char* row = buffer;
+	row += sprintf (row,"\t{ \"analyze\": { \"rows\": %lu, \"visits\": [",rows);
+	for (uint32_t i=0; i<levels; ++i) {
+		row += sprintf (row,"%s%lu",i?",":"",context->visits[i]);
+	}
+	sprintf (row,"], \"disk_reads\": %lu, \"disk_writes\": %lu, \"entries_tested\": %lu, \"nodes_pruned\": %lu, "
+			"\"distances\": %lu, \"restarts\": %lu, \"parse_us\": %lu, \"subquery_us\": %lu, "
+			"\"join_us\": %lu, \"serialize_us\": %lu } },\n",
+			context->disk_reads,context->disk_writes,context->entries_tested,context->nodes_pruned,
+			context->distances,context->restarts,context->phases[PARSE_PHASE],
+			context->phases[SUBQUERY_PHASE],context->phases[JOIN_PHASE],context->phases[SERIALIZE_PHASE]);
+
+	return buffer;
+}
+
+static
+uint32_t histogram_bucket (uint64_t value) {
+	if (value >= (1lu<<HISTOGRAM_MAGNITUDE)) {
+		value = (1lu<<HISTOGRAM_MAGNITUDE)-1;
+	}
+	if (value < (1<<HISTOGRAM_PRECISION)) {
+		return value;
+	}
+	uint32_t const shift = 63-__builtin_clzl (value)-(HISTOGRAM_PRECISION-1);
+	return (1<<HISTOGRAM_PRECISION) + (shift-1)*(1<<(HISTOGRAM_PRECISION-1))
+		+ (value>>shift)-(1<<(HISTOGRAM_PRECISION-1));
+}
+
+/**
+ * The greatest value counted in a bucket.
+ */
+static
+uint64_t histogram_value (uint32_t const bucket) {
+	if (bucket < (1<<HISTOGRAM_PRECISION)) {
+		return bucket;
+	}
+	uint32_t const shift = (bucket-(1<<HISTOGRAM_PRECISION))/(1<<(HISTOGRAM_PRECISION-1))+1;
+	uint64_t const mantissa = (bucket-(1<<HISTOGRAM_PRECISION))%(1<<(HISTOGRAM_PRECISION-1))+(1<<(HISTOGRAM_PRECISION-1));
+	return ((mantissa+1)<<shift)-1;
+}
+
+void record_latency (operator_t const operator, uint64_t const micros) {
+	histogram_t *const histogram = latencies + operator;
+	__atomic_add_fetch (histogram->counts+histogram_bucket (micros),1,__ATOMIC_RELAXED);
+	__atomic_add_fetch (&histogram->total,1,__ATOMIC_RELAXED);
+	__atomic_add_fetch (&histogram->sum,micros,__ATOMIC_RELAXED);
+
+	uint64_t max = __atomic_load_n (&histogram->max,__ATOMIC_RELAXED);
+	while (micros > max && !__atomic_compare_exchange_n (&histogram->max,&max,micros,true,__ATOMIC_RELAXED,__ATOMIC_RELAXED));
+}
+
+/**
+ * The latency below which the given thousandths of the recorded
+ * ones fall, as counted by a histogram while being recorded to.
+ */
+static
+uint64_t latency_percentile (histogram_t const*const histogram, uint64_t const total, uint64_t const permille) {
+	uint64_t const rank = (total*permille+999)/1000;
+	uint64_t const max = __atomic_load_n (&histogram->max,__ATOMIC_RELAXED);
+	uint64_t cumulative = 0;
+	for (register uint32_t i=0; i<HISTOGRAM_BUCKETS; ++i) {
+		cumulative += __atomic_load_n (histogram->counts+i,__ATOMIC_RELAXED);
+		if (cumulative >= rank) {
+			uint64_t const value = histogram_value (i);
+			return value < max ? value : max;
+		}
+	}
+	return max;
+}
+
+static
+void write_metric (writer_t *const writer, boolean const as_text, char const name[],
+			char const label[], char const label_value[], uint64_t const value) {
+	if (as_text) {
+		write_string (writer,name);
+		write_string (writer,"{");
+		write_string (writer,label);
+		write_string (writer,"=\"");
+		write_string (writer,label_value);
+		write_string (writer,"\"} ");
+		write_unsigned (writer,value);
+		write_string (writer,"\n");
+	}else{
+		write_string (writer,",\"");
+		write_string (writer,name);
+		write_string (writer,"\":");
+		write_unsigned (writer,value);
+	}
+}
+
+/**
+ * Writes the counters of a tree either as lines of text, one per counter,
+ * or as a JSON object, preceded by a comma unless it is the first one.
+ */
+void write_tree_statistics (writer_t *const writer, tree_t *const tree, boolean const as_text, boolean const is_first) {
+	pthread_rwlock_rdlock (&tree->tree_lock);
+	uint64_t const buffered = tree->swap->size;
+	uint64_t const records = tree->indexed_records;
+	uint64_t const pages = tree->tree_size;
+	pthread_rwlock_unlock (&tree->tree_lock);
+
+	if (!as_text) {
+		write_string (writer,is_first ? "{\"heapfile\":\"" : ",{\"heapfile\":\"");
+		write_string (writer,tree->filename);
+		write_string (writer,"\"");
+	}
+	write_metric (writer,as_text,"tree_records","heapfile",tree->filename,records);
+	write_metric (writer,as_text,"tree_pages","heapfile",tree->filename,pages);
+	write_metric (writer,as_text,"tree_buffered_pages","heapfile",tree->filename,buffered);
+	write_metric (writer,as_text,"tree_hits","heapfile",tree->filename,__atomic_load_n (&tree->stats.hits,__ATOMIC_RELAXED));
+	write_metric (writer,as_text,"tree_misses","heapfile",tree->filename,__atomic_load_n (&tree->stats.misses,__ATOMIC_RELAXED));
+	write_metric (writer,as_text,"tree_evictions","heapfile",tree->filename,__atomic_load_n (&tree->stats.evictions,__ATOMIC_RELAXED));
+	write_metric (writer,as_text,"tree_dirty_writes","heapfile",tree->filename,__atomic_load_n (&tree->stats.dirty_writes,__ATOMIC_RELAXED));
+	write_metric (writer,as_text,"tree_restarts","heapfile",tree->filename,__atomic_load_n (&tree->stats.restarts,__ATOMIC_RELAXED));
+	write_metric (writer,as_text,"tree_splits","heapfile",tree->filename,__atomic_load_n (&tree->stats.splits,__ATOMIC_RELAXED));
+	write_metric (writer,as_text,"tree_merges","heapfile",tree->filename,__atomic_load_n (&tree->stats.merges,__ATOMIC_RELAXED));
+	if (!as_text) {
+		write_string (writer,"}");
+	}
+}
+
+/**
+ * Writes for every operator that has been timed the number of
+ * evaluations, and their mean, median, 99th and 999th permille,
+ * and maximum latency in microseconds; i.e. as lines of text,
+ * or else as the elements of a JSON array.
+ */
+void write_latency_statistics (writer_t *const writer, boolean const as_text) {
+	boolean is_first = true;
+	for (register uint32_t i=0; i<OPERATORS_NUMBER; ++i) {
+		histogram_t const*const histogram = latencies + i;
+		uint64_t const total = __atomic_load_n (&histogram->total,__ATOMIC_RELAXED);
+		if (!total) continue;
+
+		uint64_t const mean = __atomic_load_n (&histogram->sum,__ATOMIC_RELAXED)/total;
+		uint64_t const max = __atomic_load_n (&histogram->max,__ATOMIC_RELAXED);
+		uint64_t const p50 = latency_percentile (histogram,total,500);
+		uint64_t const p99 = latency_percentile (histogram,total,990);
+		uint64_t const p999 = latency_percentile (histogram,total,999);
+
+		if (as_text) {
+			char const*const quantiles [] = {"0.5","0.99","0.999"};
+			uint64_t const values [] = {p50,p99,p999};
+			for (register uint32_t j=0; j<3; ++j) {
+				write_string (writer,"operator_latency_us{operator=\"");
+				write_string (writer,operator_names[i]);
+				write_string (writer,"\",quantile=\"");
+				write_string (writer,quantiles[j]);
+				write_string (writer,"\"} ");
+				write_unsigned (writer,values[j]);
+				write_string (writer,"\n");
+			}
+			write_metric (writer,true,"operator_latency_us_max","operator",operator_names[i],max);
+			write_metric (writer,true,"operator_latency_us_mean","operator",operator_names[i],mean);
+			write_metric (writer,true,"operator_latency_us_count","operator",operator_names[i],total);
+		}else{
+			write_string (writer,is_first ? "{\"operator\":\"" : ",{\"operator\":\"");
+			write_string (writer,operator_names[i]);
+			write_string (writer,"\"");
+			write_metric (writer,false,"count",NULL,NULL,total);
+			write_metric (writer,false,"mean_us",NULL,NULL,mean);
+			write_metric (writer,false,"p50_us",NULL,NULL,p50);
+			write_metric (writer,false,"p99_us",NULL,NULL,p99);
+			write_metric (writer,false,"p999_us",NULL,NULL,p999);
+			write_metric (writer,false,"max_us",NULL,NULL,max);
+			write_string (writer,"}");
+		}
+		is_first = false;
+	}
+}
@@ -0,0 +1,16 @@
+#ifndef STATS_H_
+#define STATS_H_
+
+#include "defs.h"
+
+uint64_t wall_clock_micros (void);
+
+uint64_t trace_phase (phase_t const phase, uint64_t const started);
+char* explain_trace (query_context_t const*const context, uint64_t const rows);
+
+void record_latency (operator_t const operator, uint64_t const micros);
+
+void write_tree_statistics (writer_t *const writer, tree_t *const tree, boolean const as_text, boolean const is_first);
+void write_latency_statistics (writer_t *const writer, boolean const as_text);
+
+#endif /* STATS_H_ */
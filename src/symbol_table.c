@@ -412,13 +412,15 @@ tree_node_t* insert_node_recursive (symbol_table_t const*const rbtree,
 		new_node->size = 1;
 		return new_node;
 	}else{
-		if (key<tree_node->key) {
+		int const comparison = rbtree->compare!=NULL ? rbtree->compare(key,tree_node->key)
+								: (key<tree_node->key ? -1 : key>tree_node->key ? 1 : 0);
+		if (comparison<0) {
 			tree_node->left = insert_node_recursive (rbtree,tree_node->left,key,value);
 			if (tree_node->left->color == red
 				&& tree_node->left->left != NULL
 				&& tree_node->left->left->color == red)
 					return rotate_right (tree_node);
-		}else if (key>tree_node->key) {
+		}else if (comparison>0) {
 			tree_node->right = insert_node_recursive (rbtree,tree_node->right,key,value);
 			if (tree_node->right->color == red) {
 				if (tree_node->left != NULL
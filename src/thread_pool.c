@@ -0,0 +1,327 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+#include "queue.h"
+#include "defs.h"
+
+
+static thread_pool_t* shared_pool = NULL;
+static pthread_once_t shared_pool_once = PTHREAD_ONCE_INIT;
+
+
+/**
+ * Takes the most recent work of the given lane, or else
+ * steals the oldest work of any other lane, which usually
+ * stands for a larger part of the search space.
+ */
+static
+void* take_work (work_group_t *const group, uint32_t const lane) {
+	void* work = NULL;
+	for (register uint32_t i=0; i<group->lanes_number && work == NULL; ++i) {
+		work_lane_t *const victim = group->lanes + (lane+i)%group->lanes_number;
+
+		pthread_mutex_lock (&victim->lock);
+		if (victim->deque->size) {
+			work = i ? remove_head_of_queue (victim->deque) : remove_tail_of_queue (victim->deque);
+		}
+		pthread_mutex_unlock (&victim->lock);
+	}
+	if (work != NULL) {
+		__sync_fetch_and_sub (&group->queued,1);
+	}
+	return work;
+}
+
+/**
+ * Processes work on behalf of a lane until all work
+ * of the group, including any spawned meanwhile, is done.
+ */
+static
+void run_lane (work_group_t *const group, uint32_t const lane) {
+	for (;;) {
+		void *const work = take_work (group,lane);
+		if (work != NULL) {
+			group->process (group,lane,work);
+
+			if (!__sync_sub_and_fetch (&group->pending,1)) {
+				pthread_mutex_lock (&group->idle_lock);
+				pthread_cond_broadcast (&group->idle_cond);
+				pthread_mutex_unlock (&group->idle_lock);
+			}
+		}else{
+			pthread_mutex_lock (&group->idle_lock);
+			while (__atomic_load_n (&group->pending,__ATOMIC_SEQ_CST)
+				&& !__atomic_load_n (&group->queued,__ATOMIC_SEQ_CST)) {
+				pthread_cond_wait (&group->idle_cond,&group->idle_lock);
+			}
+			boolean const is_done = !__atomic_load_n (&group->pending,__ATOMIC_SEQ_CST);
+			pthread_mutex_unlock (&group->idle_lock);
+
+			if (is_done) return;
+		}
+	}
+}
+
+static
+void* pool_worker (void* args) {
+	thread_pool_t *const pool = (thread_pool_t *const) args;
+
+	pthread_mutex_lock (&pool->lock);
+	while (!pool->is_shutdown) {
+		if (pool->tickets->size) {
+			work_ticket_t *const ticket = remove_head_of_queue (pool->tickets);
+			work_group_t *const group = ticket->group;
+			uint32_t const lane = ticket->lane;
+			free (ticket);
+
+			++group->helpers;
+			pthread_mutex_unlock (&pool->lock);
+
+			query_context = group->context;
+			run_lane (group,lane);
+			merge_trace_counters ();
+			query_context = NULL;
+
+			pthread_mutex_lock (&pool->lock);
+			--group->helpers;
+			pthread_cond_broadcast (&pool->released);
+		}else{
+			pthread_cond_wait (&pool->wakeup,&pool->lock);
+		}
+	}
+	pthread_mutex_unlock (&pool->lock);
+
+	return NULL;
+}
+
+
+thread_pool_t* new_thread_pool (uint32_t const threads_number) {
+	thread_pool_t *const pool = (thread_pool_t *const) malloc (sizeof(thread_pool_t));
+	if (pool == NULL) {
+		LOG (fatal,"[new_thread_pool()] Unable to allocate memory for new thread-pool...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	pool->threads = (pthread_t*) malloc (threads_number*sizeof(pthread_t));
+	if (pool->threads == NULL) {
+		LOG (fatal,"[new_thread_pool()] Unable to allocate memory for %u new threads...\n",threads_number);
+		exit (EXIT_FAILURE);
+	}
+	pool->threads_number = threads_number;
+	pool->tickets = new_queue();
+	pool->is_shutdown = false;
+
+	pthread_mutex_init (&pool->lock,NULL);
+	pthread_cond_init (&pool->wakeup,NULL);
+	pthread_cond_init (&pool->released,NULL);
+
+	pthread_attr_t attr;
+	pthread_attr_init (&attr);
+	pthread_attr_setstacksize (&attr,THREAD_STACK_SIZE);
+
+	for (register uint32_t i=0; i<threads_number; ++i) {
+		if (pthread_create (pool->threads+i,&attr,&pool_worker,pool)) {
+			LOG (fatal,"[new_thread_pool()] Unable to create worker thread %u...\n",i);
+			exit (EXIT_FAILURE);
+		}
+	}
+	pthread_attr_destroy (&attr);
+
+	LOG (info,"[new_thread_pool()] Started a pool of %u worker threads.\n",threads_number);
+	return pool;
+}
+
+void delete_thread_pool (thread_pool_t *const pool) {
+	pthread_mutex_lock (&pool->lock);
+	pool->is_shutdown = true;
+	pthread_cond_broadcast (&pool->wakeup);
+	pthread_mutex_unlock (&pool->lock);
+
+	for (register uint32_t i=0; i<pool->threads_number; ++i) {
+		pthread_join (pool->threads[i],NULL);
+	}
+
+	while (pool->tickets->size) {
+		free (remove_head_of_queue (pool->tickets));
+	}
+	delete_queue (pool->tickets);
+
+	pthread_cond_destroy (&pool->released);
+	pthread_cond_destroy (&pool->wakeup);
+	pthread_mutex_destroy (&pool->lock);
+
+	free (pool->threads);
+	free (pool);
+}
+
+
+static
+void create_shared_thread_pool (void) {
+	long const processors = sysconf (_SC_NPROCESSORS_ONLN);
+	shared_pool = new_thread_pool (processors > 1 ? processors-1 : 1);
+}
+
+/**
+ * The pool shared among all queries of the process,
+ * with one thread per processor besides the caller's.
+ */
+thread_pool_t* shared_thread_pool (void) {
+	pthread_once (&shared_pool_once,&create_shared_thread_pool);
+	return shared_pool;
+}
+
+
+work_group_t* new_work_group (uint32_t const lanes_number, work_function_t const process, void *const args) {
+	work_group_t *const group = (work_group_t *const) malloc (sizeof(work_group_t));
+	if (group == NULL) {
+		LOG (fatal,"[new_work_group()] Unable to allocate memory for new work-group...\n");
+		exit (EXIT_FAILURE);
+	}
+
+	group->lanes = (work_lane_t*) malloc (lanes_number*sizeof(work_lane_t));
+	if (group->lanes == NULL) {
+		LOG (fatal,"[new_work_group()] Unable to allocate memory for %u new lanes...\n",lanes_number);
+		exit (EXIT_FAILURE);
+	}
+	for (register uint32_t i=0; i<lanes_number; ++i) {
+		group->lanes[i].deque = new_queue();
+		pthread_mutex_init (&group->lanes[i].lock,NULL);
+	}
+	group->lanes_number = lanes_number;
+
+	group->process = process;
+	group->args = args;
+	group->context = query_context;
+
+	group->pending = 0;
+	group->queued = 0;
+	group->helpers = 0;
+
+	pthread_mutex_init (&group->idle_lock,NULL);
+	pthread_cond_init (&group->idle_cond,NULL);
+
+	return group;
+}
+
+void delete_work_group (work_group_t *const group) {
+	for (register uint32_t i=0; i<group->lanes_number; ++i) {
+		assert (!group->lanes[i].deque->size);
+		delete_queue (group->lanes[i].deque);
+		pthread_mutex_destroy (&group->lanes[i].lock);
+	}
+	pthread_cond_destroy (&group->idle_cond);
+	pthread_mutex_destroy (&group->idle_lock);
+
+	free (group->lanes);
+	free (group);
+}
+
+/**
+ * Work is opaque to the group and should never be NULL;
+ * it can be pushed either before the group runs or from
+ * within the processing of other work of the same group.
+ */
+void push_work (work_group_t *const group, uint32_t const lane, void *const work) {
+	assert (work != NULL);
+	assert (lane < group->lanes_number);
+
+	__sync_fetch_and_add (&group->pending,1);
+
+	pthread_mutex_lock (&group->lanes[lane].lock);
+	insert_at_tail_of_queue (group->lanes[lane].deque,work);
+	pthread_mutex_unlock (&group->lanes[lane].lock);
+
+	__sync_fetch_and_add (&group->queued,1);
+
+	pthread_mutex_lock (&group->idle_lock);
+	pthread_cond_signal (&group->idle_cond);
+	pthread_mutex_unlock (&group->idle_lock);
+}
+
+/**
+ * The calling thread serves the first lane, while the rest are
+ * offered to the threads of the pool; once all work is done, any
+ * lanes not claimed yet are withdrawn and it waits for the threads
+ * that joined in to leave. A NULL pool runs all work in the caller.
+ */
+void run_work_group (thread_pool_t *const pool, work_group_t *const group) {
+	if (pool != NULL && group->lanes_number > 1) {
+		pthread_mutex_lock (&pool->lock);
+		for (register uint32_t i=1; i<group->lanes_number; ++i) {
+			work_ticket_t *const ticket = (work_ticket_t *const) malloc (sizeof(work_ticket_t));
+			if (ticket == NULL) {
+				LOG (fatal,"[run_work_group()] Unable to allocate memory for new work-ticket...\n");
+				exit (EXIT_FAILURE);
+			}
+			ticket->group = group;
+			ticket->lane = i;
+			insert_at_tail_of_queue (pool->tickets,ticket);
+		}
+		pthread_cond_broadcast (&pool->wakeup);
+		pthread_mutex_unlock (&pool->lock);
+	}
+
+	run_lane (group,0);
+
+	if (pool != NULL && group->lanes_number > 1) {
+		pthread_mutex_lock (&pool->lock);
+		for (uint64_t i=pool->tickets->size; i>0; --i) {
+			work_ticket_t *const ticket = remove_head_of_queue (pool->tickets);
+			if (ticket->group == group) {
+				free (ticket);
+			}else{
+				insert_at_tail_of_queue (pool->tickets,ticket);
+			}
+		}
+		while (group->helpers) {
+			pthread_cond_wait (&pool->released,&pool->lock);
+		}
+		pthread_mutex_unlock (&pool->lock);
+	}
+}
+
+
+double read_shared_value (double *const shared) {
+	double value;
+	__atomic_load (shared,&value,__ATOMIC_SEQ_CST);
+	return value;
+}
+
+/**
+ * Lowers a value shared among the workers of a group,
+ * e.g. a pruning threshold, unless it is already lower.
+ */
+void update_shared_minimum (double *const shared, double const value) {
+	double current = read_shared_value (shared);
+	double desired = value;
+	while (desired < current
+		&& !__atomic_compare_exchange (shared,&current,&desired,true,__ATOMIC_SEQ_CST,__ATOMIC_SEQ_CST));
+}
+
+/**
+ * Raises a value shared among the workers
+ * of a group, unless it is already higher.
+ */
+void update_shared_maximum (double *const shared, double const value) {
+	double current = read_shared_value (shared);
+	double desired = value;
+	while (desired > current
+		&& !__atomic_compare_exchange (shared,&current,&desired,true,__ATOMIC_SEQ_CST,__ATOMIC_SEQ_CST));
+}
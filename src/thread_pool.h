@@ -0,0 +1,21 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include "defs.h"
+
+thread_pool_t* new_thread_pool (uint32_t const threads_number);
+void delete_thread_pool (thread_pool_t *const pool);
+
+thread_pool_t* shared_thread_pool (void);
+
+work_group_t* new_work_group (uint32_t const lanes_number, work_function_t const process, void *const args);
+void delete_work_group (work_group_t *const group);
+
+void push_work (work_group_t *const group, uint32_t const lane, void *const work);
+void run_work_group (thread_pool_t *const pool, work_group_t *const group);
+
+double read_shared_value (double *const shared);
+void update_shared_minimum (double *const shared, double const value);
+void update_shared_maximum (double *const shared, double const value);
+
+#endif /* THREAD_POOL_H_ */
@@ -0,0 +1,533 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include "shared_ring.h"
+#include "writer.h"
+#include "defs.h"
+
+
+static double const powers_of_ten [] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static
+double scale_by_power_of_ten (double value, int32_t exponent) {
+	for (; exponent > 22; exponent -= 22) value *= 1e22;
+	for (; exponent < -22; exponent += 22) value /= 1e22;
+	return exponent >= 0 ? value * powers_of_ten[exponent] : value / powers_of_ten[-exponent];
+}
+
+/**
+ * Formats a float with the fewest significant digits that are read
+ * back as the same float; i.e. it tries increasingly many digits up
+ * to the nine that always suffice. Values are scaled in double, which
+ * is precise enough for rounding them to floats. Returns the length.
+ */
+static
+uint32_t format_float (char output[], float const value) {
+	char* c = output;
+	if (isnan (value) || isinf (value)) {
+		strcpy (output,"null");
+		return 4;
+	}else if (value == 0) {
+		strcpy (output,"0.0");
+		return 3;
+	}else if (value < 0) {
+		*c++ = '-';
+	}
+
+	double const magnitude = fabs ((double)value);
+	int32_t exponent = floor (log10 (magnitude));
+	if (magnitude < scale_by_power_of_ten (1,exponent)) --exponent;
+	else if (magnitude >= scale_by_power_of_ten (1,exponent+1)) ++exponent;
+
+	uint64_t mantissa = 0;
+	int32_t scale = 0;
+	for (uint32_t digits=1; digits<=9; ++digits) {
+		scale = digits - 1 - exponent;
+		mantissa = llround (scale_by_power_of_ten (magnitude,scale));
+		if ((float) scale_by_power_of_ten (mantissa,-scale) == (float) magnitude) break;
+	}
+	for (; mantissa && !(mantissa % 10); mantissa /= 10) {
+		--scale;
+	}
+
+	char digits [24];
+	uint32_t length = 0;
+	for (uint64_t m = mantissa; m; m /= 10) {
+		digits [length++] = '0' + m % 10;
+	}
+
+	/* the number of digits before the decimal point */
+	int32_t const point = (int32_t)length - scale;
+	if (point > 0 && point <= 21) {
+		for (int32_t i=0; i<point; ++i) {
+			*c++ = i < length ? digits [length-1-i] : '0';
+		}
+		*c++ = '.';
+		if (point >= length) {
+			*c++ = '0';
+		}
+		for (int32_t i=point; i<length; ++i) {
+			*c++ = digits [length-1-i];
+		}
+	}else if (point <= 0 && point > -6) {
+		*c++ = '0';
+		*c++ = '.';
+		for (int32_t i=point; i<0; ++i) {
+			*c++ = '0';
+		}
+		for (int32_t i=0; i<length; ++i) {
+			*c++ = digits [length-1-i];
+		}
+	}else{
+		*c++ = digits [length-1];
+		*c++ = '.';
+		if (length == 1) {
+			*c++ = '0';
+		}
+		for (int32_t i=1; i<length; ++i) {
+			*c++ = digits [length-1-i];
+		}
+		*c++ = 'e';
+		int32_t power = point - 1;
+		if (power < 0) {
+			*c++ = '-';
+			power = -power;
+		}
+		if (power >= 10) {
+			*c++ = '0' + power / 10;
+		}
+		*c++ = '0' + power % 10;
+	}
+	*c = '\0';
+	return c - output;
+}
+
+
+writer_t* new_writer (int const fd, void (*tap) (void *const, char const*const, uint64_t const), void *const tap_args) {
+	writer_t *const writer = (writer_t *const) malloc (sizeof(writer_t));
+	if (writer == NULL) {
+		LOG (fatal,"[new_writer()] Unable to allocate memory for new writer...\n");
+		exit (EXIT_FAILURE);
+	}
+	writer->ring = (char*) malloc (sizeof(char)*WRITER_RING_SIZE);
+	if (writer->ring == NULL) {
+		LOG (fatal,"[new_writer()] Unable to allocate memory for the buffer of new writer...\n");
+		exit (EXIT_FAILURE);
+	}
+	writer->head = 0;
+	writer->size = 0;
+
+	writer->fd = fd;
+	writer->output = NULL;
+	writer->output_length = 0;
+	writer->output_capacity = 0;
+
+	writer->tap = tap;
+	writer->tap_args = tap_args;
+	writer->is_chunked = false;
+	writer->is_framed = false;
+	writer->unframed = 0;
+	writer->shared = NULL;
+	return writer;
+}
+
+/**
+ * The segments of the ring holding the buffered output that
+ * begins at the given offset; i.e. up to two if wrapping around.
+ */
+static
+uint32_t ring_segments (writer_t const*const writer, uint64_t const offset, uint64_t const length, struct iovec segments[]) {
+	if (!length) return 0;
+	uint64_t const start = (writer->head + offset) % WRITER_RING_SIZE;
+	segments[0].iov_base = writer->ring + start;
+	segments[0].iov_len = MIN(length,WRITER_RING_SIZE - start);
+	if (segments[0].iov_len == length) return 1;
+	segments[1].iov_base = writer->ring;
+	segments[1].iov_len = length - segments[0].iov_len;
+	return 2;
+}
+
+/**
+ * Writes a frame in full, resuming after partial writes. The
+ * file-descriptor given, if any, is passed along with its first byte.
+ */
+static
+void send_frame (writer_t *const writer, struct iovec frame[], uint32_t const total, int passed_fd) {
+	for (uint32_t first = 0; first < total;) {
+		ssize_t written;
+		if (passed_fd >= 0) {
+			char control [CMSG_SPACE(sizeof(int))];
+			bzero (control,sizeof(control));
+
+			struct msghdr message;
+			bzero (&message,sizeof(message));
+			message.msg_iov = frame+first;
+			message.msg_iovlen = total-first;
+			message.msg_control = control;
+			message.msg_controllen = sizeof(control);
+
+			struct cmsghdr *const header = CMSG_FIRSTHDR (&message);
+			header->cmsg_level = SOL_SOCKET;
+			header->cmsg_type = SCM_RIGHTS;
+			header->cmsg_len = CMSG_LEN (sizeof(int));
+			memcpy (CMSG_DATA (header),&passed_fd,sizeof(int));
+
+			written = sendmsg (writer->fd,&message,0);
+			if (written >= 0) {
+				passed_fd = -1;
+			}
+		}else{
+			written = writev (writer->fd,frame+first,total-first);
+		}
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			LOG (error,"[send_frame()] Error while sending data using file-descriptor %u.\n",writer->fd);
+			break;
+		}
+		for (; first < total && written >= frame[first].iov_len; ++first) {
+			written -= frame[first].iov_len;
+		}
+		if (first < total) {
+			frame[first].iov_base = (char*) frame[first].iov_base + written;
+			frame[first].iov_len -= written;
+		}
+	}
+}
+
+/**
+ * Sends all buffered output as a single chunk, i.e. preceded by its
+ * size in hex and followed by a line-break, after any output that was
+ * buffered before chunks began. The last chunk, which is empty, may
+ * follow in the same write. Frames of the binary protocol are instead
+ * preceded by their size, unless placed in the shared ring, when only
+ * their size and position are sent.
+ */
+static
+void send_chunk (writer_t *const writer, boolean const is_last) {
+	char size_line [24];
+	uint64_t const size = writer->size - writer->unframed;
+
+	struct iovec frame [7];
+	uint32_t total = ring_segments (writer,0,writer->unframed,frame);
+	int passed_fd = -1;
+	if (size && writer->is_framed) {
+		struct iovec payload [2];
+		uint32_t const count = ring_segments (writer,writer->unframed,size,payload);
+
+		uint64_t position;
+		if (writer->shared != NULL && size >= SHARED_RING_THRESHOLD
+				&& put_into_shared_ring (writer->shared,payload,count,size,&position)) {
+			uint32_t const word = htole32 (FRAME_SHARED_PAYLOAD | size);
+			uint64_t const le_position = htole64 (position);
+			memcpy (size_line,&word,sizeof(uint32_t));
+			memcpy (size_line+sizeof(uint32_t),&le_position,sizeof(uint64_t));
+			frame[total].iov_base = size_line;
+			frame[total++].iov_len = sizeof(uint32_t)+sizeof(uint64_t);
+			if (!writer->shared->is_announced) {
+				writer->shared->is_announced = true;
+				passed_fd = writer->shared->fd;
+			}
+		}else{
+			uint32_t const word = htole32 (size);
+			memcpy (size_line,&word,sizeof(uint32_t));
+			frame[total].iov_base = size_line;
+			frame[total++].iov_len = sizeof(uint32_t);
+			memcpy (frame+total,payload,count*sizeof(struct iovec));
+			total += count;
+		}
+	}else if (size) {
+		frame[total].iov_base = size_line;
+		frame[total++].iov_len = snprintf (size_line,sizeof(size_line),"%lx\r\n",size);
+		total += ring_segments (writer,writer->unframed,size,frame+total);
+		frame[total].iov_base = (void*) "\r\n";
+		frame[total++].iov_len = 2;
+	}
+	if (is_last && writer->is_framed) {
+		frame[total].iov_base = (void*) "\0\0\0\0";
+		frame[total++].iov_len = sizeof(uint32_t);
+	}else if (is_last) {
+		frame[total].iov_base = (void*) "0\r\n\r\n";
+		frame[total++].iov_len = 5;
+	}
+
+	send_frame (writer,frame,total,passed_fd);
+
+	if (writer->tap != NULL) {
+		struct iovec segments [2];
+		uint32_t const count = ring_segments (writer,0,writer->size,segments);
+		for (uint32_t i=0; i<count; ++i) {
+			writer->tap (writer->tap_args,segments[i].iov_base,segments[i].iov_len);
+		}
+	}
+	writer->head = 0;
+	writer->size = 0;
+	writer->unframed = 0;
+}
+
+/**
+ * Flushes all buffered output, which may wrap around the end of the
+ * ring; i.e. in up to two segments written together.
+ */
+void flush_writer (writer_t *const writer) {
+	if (writer->fd && writer->is_chunked) {
+		send_chunk (writer,false);
+		return;
+	}
+	while (writer->size) {
+		struct iovec segments [2];
+		uint32_t count = 1;
+		segments[0].iov_base = writer->ring + writer->head;
+		segments[0].iov_len = writer->head + writer->size > WRITER_RING_SIZE ? WRITER_RING_SIZE - writer->head : writer->size;
+		if (segments[0].iov_len < writer->size) {
+			segments[1].iov_base = writer->ring;
+			segments[1].iov_len = writer->size - segments[0].iov_len;
+			count = 2;
+		}
+
+		ssize_t written = 0;
+		if (writer->fd) {
+			written = writev (writer->fd,segments,count);
+			if (written < 0) {
+				if (errno == EINTR) continue;
+				LOG (error,"[flush_writer()] Error while sending data using file-descriptor %u.\n",writer->fd);
+				written = writer->size;
+			}
+		}else{
+			if (writer->output_length + writer->size + 1 > writer->output_capacity) {
+				writer->output_capacity = MAX(writer->output_capacity<<1,writer->output_length+writer->size+1);
+				writer->output = (char*) realloc (writer->output,sizeof(char)*writer->output_capacity);
+				if (writer->output == NULL) {
+					LOG (fatal,"[flush_writer()] Unable to allocate memory for output...\n");
+					exit (EXIT_FAILURE);
+				}
+			}
+			for (uint32_t i=0; i<count; ++i) {
+				memcpy (writer->output+writer->output_length,segments[i].iov_base,segments[i].iov_len);
+				writer->output_length += segments[i].iov_len;
+			}
+			written = writer->size;
+		}
+
+		if (writer->tap != NULL) {
+			uint64_t const first = MIN(written,segments[0].iov_len);
+			writer->tap (writer->tap_args,segments[0].iov_base,first);
+			if (written > first) {
+				writer->tap (writer->tap_args,segments[1].iov_base,written-first);
+			}
+		}
+		writer->head = (writer->head + written) % WRITER_RING_SIZE;
+		writer->size -= written;
+	}
+	writer->head = 0;
+}
+
+/**
+ * Hands all output from now on to another tap, if any.
+ */
+void tap_writer (writer_t *const writer, void (*tap) (void *const, char const*const, uint64_t const), void *const tap_args) {
+	flush_writer (writer);
+	writer->tap = tap;
+	writer->tap_args = tap_args;
+}
+
+/**
+ * Output to a file-descriptor is sent in chunks from now on, one
+ * per flush, until the last chunk, which is left empty. Output still
+ * buffered is sent as is along with the first chunk.
+ */
+void begin_chunks (writer_t *const writer) {
+	writer->unframed = writer->size;
+	writer->is_chunked = true;
+}
+
+/**
+ * Output to a file-descriptor is sent in frames of the binary
+ * protocol from now on, one per flush, whose payloads are placed
+ * in the shared ring given, if any, when large enough.
+ */
+void begin_frames (writer_t *const writer, shared_ring_t *const shared) {
+	begin_chunks (writer);
+	writer->is_framed = true;
+	writer->shared = shared;
+}
+
+void end_chunks (writer_t *const writer) {
+	if (writer->fd) {
+		send_chunk (writer,true);
+	}
+	writer->is_chunked = false;
+	writer->is_framed = false;
+	writer->shared = NULL;
+}
+
+/**
+ * Flushes the writer and frees it, while returning its output
+ * unless written to a file-descriptor, when it is left empty.
+ */
+char* delete_writer (writer_t *const writer) {
+	flush_writer (writer);
+	char* output = writer->output;
+	if (output == NULL) {
+		output = (char*) malloc (sizeof(char));
+		if (output == NULL) {
+			LOG (fatal,"[delete_writer()] Unable to allocate memory for output...\n");
+			exit (EXIT_FAILURE);
+		}
+	}else{
+		output [writer->output_length] = '\0';
+	}
+	if (writer->fd) {
+		*output = '\0';
+	}
+	free (writer->ring);
+	free (writer);
+	return output;
+}
+
+void write_bytes (writer_t *const writer, char const data[], uint64_t length) {
+	while (length) {
+		uint64_t const tail = (writer->head + writer->size) % WRITER_RING_SIZE;
+		uint64_t const available = MIN(WRITER_RING_SIZE - writer->size,WRITER_RING_SIZE - tail);
+		uint64_t const chunk = MIN(length,available);
+
+		memcpy (writer->ring+tail,data,chunk);
+		writer->size += chunk;
+		data += chunk;
+		length -= chunk;
+
+		if (writer->size == WRITER_RING_SIZE) {
+			flush_writer (writer);
+		}
+	}
+}
+
+void write_string (writer_t *const writer, char const string[]) {
+	write_bytes (writer,string,strlen (string));
+}
+
+void write_unsigned (writer_t *const writer, uint64_t value) {
+	char digits [24];
+	char* c = digits + sizeof(digits);
+	do{
+		*--c = '0' + value % 10;
+		value /= 10;
+	}while (value);
+	write_bytes (writer,c,digits+sizeof(digits)-c);
+}
+
+void write_float (writer_t *const writer, float const value) {
+	char number [32];
+	write_bytes (writer,number,format_float (number,value));
+}
+
+void write_le32 (writer_t *const writer, uint32_t const value) {
+	uint32_t const le_value = htole32 (value);
+	write_bytes (writer,(char const*)&le_value,sizeof(uint32_t));
+}
+
+void write_le64 (writer_t *const writer, uint64_t const value) {
+	uint64_t const le_value = htole64 (value);
+	write_bytes (writer,(char const*)&le_value,sizeof(uint64_t));
+}
+
+static
+void write_le_key (writer_t *const writer, index_t const value) {
+	uint32_t bits;
+	memcpy (&bits,&value,sizeof(index_t));
+	write_le32 (writer,bits);
+}
+
+/**
+ * Binary results begin with a header naming the format, its layout,
+ * and the sizes of object-ids and coordinates.
+ */
+void write_schema (writer_t *const writer, format_t const format) {
+	char const schema [] = {
+		BINARY_VERSION,
+		format == COLUMNS_FORMAT,
+		sizeof(object_t),
+		sizeof(index_t)
+	};
+	write_bytes (writer,BINARY_MAGIC,4);
+	write_bytes (writer,schema,sizeof(schema));
+}
+
+/**
+ * Encodes a block of tuples, each of which combines as many objects
+ * as the cardinality given. Objects and their keys are given in the
+ * order of the tuples, and are written either tuple by tuple, or else
+ * all ids of each operand followed by all its coordinates per dimension.
+ */
+void write_block (writer_t *const writer, format_t const format, uint32_t const rows,
+			uint32_t const cardinality, uint32_t const dimensions,
+			object_t const objects[], index_t const keys[]) {
+	write_le32 (writer,rows);
+	write_le32 (writer,cardinality);
+	write_le32 (writer,dimensions);
+	if (format == COLUMNS_FORMAT) {
+		for (uint32_t i=0; i<cardinality; ++i) {
+			for (uint32_t r=0; r<rows; ++r) {
+				write_le64 (writer,objects[r*cardinality+i]);
+			}
+		}
+		for (uint32_t i=0; i<cardinality; ++i) {
+			for (uint32_t j=0; j<dimensions; ++j) {
+				for (uint32_t r=0; r<rows; ++r) {
+					write_le_key (writer,keys[(r*cardinality+i)*dimensions+j]);
+				}
+			}
+		}
+	}else{
+		for (uint32_t r=0; r<rows; ++r) {
+			for (uint32_t i=0; i<cardinality; ++i) {
+				write_le64 (writer,objects[r*cardinality+i]);
+			}
+			for (uint32_t k=0; k<cardinality*dimensions; ++k) {
+				write_le_key (writer,keys[r*cardinality*dimensions+k]);
+			}
+		}
+	}
+}
+
+/**
+ * Binary results end with the status of the query along with
+ * the statistics and the message otherwise sent as metadata.
+ */
+void write_trailer (writer_t *const writer, boolean const is_successful,
+			uint64_t const io_blocks, double const io_mb, uint64_t const proc_time, char const message[]) {
+	uint64_t mb_bits;
+	memcpy (&mb_bits,&io_mb,sizeof(double));
+
+	write_le32 (writer,BINARY_TRAILER);
+	write_le32 (writer,is_successful ? 0 : 1);
+	write_le64 (writer,io_blocks);
+	write_le64 (writer,mb_bits);
+	write_le64 (writer,proc_time);
+	write_le32 (writer,strlen (message));
+	write_string (writer,message);
+}
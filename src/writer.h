@@ -0,0 +1,31 @@
+#ifndef WRITER_H_
+#define WRITER_H_
+
+#include "defs.h"
+
+writer_t* new_writer (int const fd, void (*tap) (void *const, char const*const, uint64_t const), void *const tap_args);
+char* delete_writer (writer_t *const writer);
+
+void flush_writer (writer_t *const writer);
+void tap_writer (writer_t *const writer, void (*tap) (void *const, char const*const, uint64_t const), void *const tap_args);
+
+void begin_chunks (writer_t *const writer);
+void begin_frames (writer_t *const writer, shared_ring_t *const shared);
+void end_chunks (writer_t *const writer);
+
+void write_bytes (writer_t *const writer, char const data[], uint64_t length);
+void write_string (writer_t *const writer, char const string[]);
+void write_unsigned (writer_t *const writer, uint64_t value);
+void write_float (writer_t *const writer, float const value);
+
+void write_le32 (writer_t *const writer, uint32_t const value);
+void write_le64 (writer_t *const writer, uint64_t const value);
+
+void write_schema (writer_t *const writer, format_t const format);
+void write_block (writer_t *const writer, format_t const format, uint32_t const rows,
+			uint32_t const cardinality, uint32_t const dimensions,
+			object_t const objects[], index_t const keys[]);
+void write_trailer (writer_t *const writer, boolean const is_successful,
+			uint64_t const io_blocks, double const io_mb, uint64_t const proc_time, char const message[]);
+
+#endif /* WRITER_H_ */
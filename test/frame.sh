@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# Sends the payload read from the standard input to the Unix-domain
+# socket of the server, framed by its le32 length, the operation
+# (G to query, P to insert, D to delete, B to bulk load), the flags
+# (1 for results in columns) and two reserved bytes. The payloads of
+# the frames of the response are written out in hex, up to the empty
+# frame ending it, which must be there for the request to succeed.
+#
+# Usage: frame.sh <socket> <operation> [flags] < payload
+
+	if [[ $# -lt 2 ]]
+	then
+		echo "Usage: $0 <socket> <operation> [flags] < payload" 1>&2;
+		exit 1;
+	fi
+
+	server_socket=$1;
+	operation=$2;
+	flags=${3:-0};
+
+	payload=`mktemp` || exit 1;
+	trap "rm -f $payload" EXIT;
+	cat > $payload;
+	length=`wc -c < $payload`;
+	header=`printf '\\\\x%02x' $((length & 255)) $((length >> 8 & 255)) $((length >> 16 & 255)) $((length >> 24 & 255))`;
+
+	{ printf "%b%s%b" "$header" "$operation" `printf '\\\\x%02x\\\\x00\\\\x00' $flags`; cat $payload; } \
+	| nc -N -U $server_socket | od -An -tx1 -v \
+	| awk 'function byte(hex) { return 16*index("0123456789abcdef",substr(hex,1,1)) + index("0123456789abcdef",substr(hex,2,1)) - 17; }
+		{ for (i=1; i<=NF; ++i) response = response $i; }
+		END {
+			for (i=1; i+7 <= length(response); i+=8+2*frame) {
+				frame = 0;
+				for (j=3; j>=0; --j) frame = 256*frame + byte(substr(response,i+2*j,2));
+				if (!frame) { print payloads; exit 0; }
+				payloads = payloads substr(response,i+8,2*frame);
+			}
+			exit 1;
+		}';
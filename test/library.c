@@ -0,0 +1,93 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Client of libindexing.so, linked against nothing but the entry
+ * points it exports. A heapfile is created at the path given and
+ * bulk-loaded with a grid of points, each identified by its row and
+ * column, and closed. It is then opened again and queried through
+ * cursors, whose tuples must be those of the grid, and closed.
+ *
+ * Usage: library <heapfile>
+ */
+
+#include "indexing.h"
+
+#define GRID_SIDE 100
+
+
+static
+void check (boolean const condition, char const what[]) {
+	if (!condition) {
+		fprintf (stderr,"library: %s\n",what);
+		exit (EXIT_FAILURE);
+	}
+}
+
+int main (int argc, char* argv[]) {
+	if (argc < 2) {
+		fprintf (stderr,"Usage: %s <heapfile>\n",argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	index_t keys [2*GRID_SIDE*GRID_SIDE];
+	object_t objects [GRID_SIDE*GRID_SIDE];
+	for (uint32_t i=0; i<GRID_SIDE*GRID_SIDE; ++i) {
+		keys[2*i] = i / GRID_SIDE;
+		keys[2*i+1] = i % GRID_SIDE;
+		objects[i] = i;
+	}
+
+	tree_t* tree = new_rtree (argv[1],4096,2,false);
+	check (tree != NULL,"unable to create the heapfile");
+	bulk_load_rtree (tree,keys,objects,GRID_SIDE*GRID_SIDE,NULL,NULL);
+	delete_tree (tree);
+
+	tree = load_rtree (argv[1]);
+	check (tree != NULL,"unable to open the heapfile again");
+
+	index_t const lo [2] = {10,20};
+	index_t const hi [2] = {19,29};
+	uint64_t tuples = 0;
+	cursor_t* cursor = range_cursor (tree,lo,hi);
+	while (next_tuple (cursor)) {
+		check (cursor->objects[0] == cursor->keys[0]*GRID_SIDE + cursor->keys[1],"tuple of the range not of the grid");
+		check (cursor->keys[0] >= lo[0] && cursor->keys[0] <= hi[0] && cursor->keys[1] >= lo[1] && cursor->keys[1] <= hi[1],
+			"tuple of the range out of it");
+		++tuples;
+	}
+	delete_cursor (cursor);
+	check (tuples == 100,"range missing tuples of the grid");
+
+	index_t const center [2] = {50,50};
+	double distance = 0;
+	tuples = 0;
+	cursor = nearest_cursor (tree,center,5);
+	while (next_tuple (cursor)) {
+		check (tuples || cursor->objects[0] == 50*GRID_SIDE + 50,"nearest neighbor not the center of the grid");
+		check (cursor->distance >= distance,"neighbors not reported nearest first");
+		distance = cursor->distance;
+		++tuples;
+	}
+	delete_cursor (cursor);
+	check (tuples == 5,"neighbors missing");
+
+	delete_tree (tree);
+
+	printf ("library: heapfile created, opened again and queried through cursors\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,274 @@
+/**
+ *  Copyright (C) 2016 George Tsatsanifos <gtsatsanifos@gmail.com>
+ *
+ *  #indexing is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Client of the shared ring of the framed protocol. The query read
+ * from the standard input is sent to the Unix-domain socket given,
+ * first for its results inline, and then for its results in the
+ * shared ring, which is mapped from the file-descriptor passed along
+ * with the first frame placed in it. The results must be the same
+ * byte for byte, but for the I/O and the time reported in their
+ * trailers, which vary from one evaluation to the next. The query is
+ * then repeated without the head of the ring moving, until the ring
+ * is full and frames fall back to being sent inline, and once more
+ * after the head catches up, when the ring must be used again.
+ *
+ * Usage: ring <socket> < query
+ */
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include "defs.h"
+
+
+typedef struct {
+	char* data;
+	uint64_t length;
+	uint64_t capacity;
+
+	uint32_t shared_frames;
+	uint32_t inline_frames;
+	boolean has_fallen_back;
+} response_t;
+
+static int ring_fd = -1;
+static char* region = NULL;
+static uint64_t ring_capacity = 0;
+
+/**
+ * Reads as many bytes as asked for from the socket, keeping any
+ * file-descriptor passed along with them as that of the ring.
+ */
+static
+void receive (int const fd, void *const buffer, uint64_t const length) {
+	for (uint64_t received = 0; received < length;) {
+		struct iovec segment = {.iov_base = (char*) buffer + received, .iov_len = length - received};
+		char control [CMSG_SPACE(sizeof(int))];
+		struct msghdr message = {.msg_iov = &segment, .msg_iovlen = 1, .msg_control = control, .msg_controllen = sizeof(control)};
+
+		ssize_t const bytes_read = recvmsg (fd,&message,0);
+		if (bytes_read < 0 && errno == EINTR) {
+			continue;
+		}else if (bytes_read <= 0) {
+			fprintf (stderr,"ring: connection closed after %lu of %lu bytes\n",received,length);
+			exit (EXIT_FAILURE);
+		}
+		for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header != NULL; header = CMSG_NXTHDR(&message,header)) {
+			if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+				memcpy (&ring_fd,CMSG_DATA(header),sizeof(int));
+			}
+		}
+		received += bytes_read;
+	}
+}
+
+static
+void map_ring (void) {
+	struct stat status;
+	if (ring_fd < 0 || fstat (ring_fd,&status)) {
+		fprintf (stderr,"ring: no file-descriptor passed with the first shared frame\n");
+		exit (EXIT_FAILURE);
+	}
+	region = (char*) mmap (NULL,status.st_size,PROT_READ|PROT_WRITE,MAP_SHARED,ring_fd,0);
+	if (region == MAP_FAILED || memcmp (region,SHARED_RING_MAGIC,4)) {
+		fprintf (stderr,"ring: unable to map the shared ring\n");
+		exit (EXIT_FAILURE);
+	}
+	ring_capacity = *(uint64_t*)(region+SHARED_RING_CAPACITY_OFFSET);
+}
+
+static
+void append (response_t *const response, char const*const data, uint64_t const length) {
+	if (response->length + length > response->capacity) {
+		response->capacity = MAX(response->capacity<<1,response->length+length);
+		response->data = (char*) realloc (response->data,response->capacity);
+		if (response->data == NULL) {
+			fprintf (stderr,"ring: unable to allocate memory for the response\n");
+			exit (EXIT_FAILURE);
+		}
+	}
+	memcpy (response->data+response->length,data,length);
+	response->length += length;
+}
+
+/**
+ * Sends the query framed with the flags given and collects the
+ * payloads of the frames of the response, either sent inline or
+ * placed in the ring, whose head is moved past each payload only
+ * if so asked for.
+ */
+static
+response_t query (int const fd, char const url[], uint8_t const flags, boolean const is_consuming) {
+	char header [FRAME_HEADER_SIZE] = {0};
+	uint32_t const length = htole32 (strlen (url));
+	memcpy (header,&length,sizeof(uint32_t));
+	header[4] = FRAME_QUERY;
+	header[5] = flags;
+	if (write (fd,header,FRAME_HEADER_SIZE) != FRAME_HEADER_SIZE || write (fd,url,strlen (url)) != (ssize_t) strlen (url)) {
+		fprintf (stderr,"ring: unable to send the query\n");
+		exit (EXIT_FAILURE);
+	}
+
+	response_t response = {NULL,0,0,0,0,false};
+	for (;;) {
+		uint32_t word;
+		receive (fd,&word,sizeof(uint32_t));
+		word = le32toh (word);
+		if (!word) {
+			return response;
+		}else if (word & FRAME_SHARED_PAYLOAD) {
+			uint64_t position;
+			receive (fd,&position,sizeof(uint64_t));
+			position = le64toh (position);
+			if (region == NULL) {
+				map_ring ();
+			}
+
+			uint64_t const size = word & ~FRAME_SHARED_PAYLOAD;
+			char const*const data = region + SHARED_RING_HEADER_SIZE;
+			uint64_t const offset = position % ring_capacity;
+			uint64_t const first = MIN(size,ring_capacity-offset);
+			append (&response,data+offset,first);
+			append (&response,data,size-first);
+			if (is_consuming) {
+				__atomic_store_n ((uint64_t*)(region+SHARED_RING_HEAD_OFFSET),position+size,__ATOMIC_RELEASE);
+			}
+			++response.shared_frames;
+		}else{
+			char payload [word];
+			receive (fd,payload,word);
+			append (&response,payload,word);
+			++response.inline_frames;
+			if (region != NULL && word >= SHARED_RING_THRESHOLD) {
+				response.has_fallen_back = true;
+			}
+		}
+	}
+}
+
+/**
+ * Where the trailer of the results begins; i.e. its marker followed
+ * by the status, the I/O, the time and the length of the message
+ * that ends the results.
+ */
+static
+uint64_t trailer (response_t const*const response) {
+	uint64_t const fixed = 2*sizeof(uint32_t) + 3*sizeof(uint64_t);
+	for (uint64_t i = response->length >= fixed+sizeof(uint32_t) ? response->length-fixed-sizeof(uint32_t)+1 : 0; i--;) {
+		uint32_t marker, message_length;
+		memcpy (&marker,response->data+i,sizeof(uint32_t));
+		memcpy (&message_length,response->data+i+fixed,sizeof(uint32_t));
+		if (le32toh (marker) == BINARY_TRAILER && i+fixed+sizeof(uint32_t)+le32toh (message_length) == response->length) {
+			return i;
+		}
+	}
+	fprintf (stderr,"ring: no trailer at the end of the results\n");
+	exit (EXIT_FAILURE);
+}
+
+/**
+ * Whether two responses hold the same results, the same status and
+ * the same message, regardless of the I/O and the time reported.
+ */
+static
+boolean is_same_response (response_t const*const expected, response_t const*const actual) {
+	uint64_t const start = trailer (expected);
+	uint64_t const status_end = start + 2*sizeof(uint32_t);
+	uint64_t const message_start = status_end + 3*sizeof(uint64_t);
+	return expected->length == actual->length && trailer (actual) == start
+		&& !memcmp (expected->data,actual->data,status_end)
+		&& !memcmp (expected->data+message_start,actual->data+message_start,expected->length-message_start);
+}
+
+static
+int connect_to (char const path[]) {
+	struct sockaddr_un address;
+	bzero (&address,sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy (address.sun_path,path,sizeof(address.sun_path)-1);
+
+	int const fd = socket (AF_UNIX,SOCK_STREAM,0);
+	if (fd < 0 || connect (fd,(struct sockaddr*)&address,sizeof(address))) {
+		fprintf (stderr,"ring: unable to connect to '%s'\n",path);
+		exit (EXIT_FAILURE);
+	}
+	return fd;
+}
+
+static
+void check (boolean const condition, char const what[]) {
+	if (!condition) {
+		fprintf (stderr,"ring: %s\n",what);
+		exit (EXIT_FAILURE);
+	}
+}
+
+int main (int argc, char* argv[]) {
+	if (argc < 2) {
+		fprintf (stderr,"Usage: %s <socket> < query\n",argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	char url [BUFSIZ];
+	if (fgets (url,sizeof(url),stdin) == NULL) {
+		fprintf (stderr,"ring: no query given\n");
+		return EXIT_FAILURE;
+	}
+	url [strcspn (url,"\r\n")] = '\0';
+
+	int const inline_fd = connect_to (argv[1]);
+	response_t const expected = query (inline_fd,url,0,true);
+	close (inline_fd);
+	check (!expected.shared_frames,"results placed in the ring without being asked to");
+	uint32_t status;
+	memcpy (&status,expected.data+trailer (&expected)+sizeof(uint32_t),sizeof(uint32_t));
+	check (!status,"query unsuccessful");
+
+	int const fd = connect_to (argv[1]);
+	response_t response = query (fd,url,FRAME_SHARED,true);
+	check (response.shared_frames > 0,"no results placed in the ring");
+	check (is_same_response (&expected,&response),"results in the ring differ from those inline");
+	uint32_t shared_frames = response.shared_frames;
+	free (response.data);
+
+	/* results are left unconsumed until the ring is too full to hold more */
+	boolean has_fallen_back = false;
+	for (uint64_t i=0; !has_fallen_back && i<ring_capacity/expected.length+2; ++i) {
+		response = query (fd,url,FRAME_SHARED,false);
+		check (is_same_response (&expected,&response),"results falling back from a full ring differ from those inline");
+		has_fallen_back = response.has_fallen_back;
+		shared_frames += response.shared_frames;
+		free (response.data);
+	}
+	check (has_fallen_back,"no results sent inline while the ring was full");
+
+	__atomic_store_n ((uint64_t*)(region+SHARED_RING_HEAD_OFFSET),
+			__atomic_load_n ((uint64_t*)(region+SHARED_RING_TAIL_OFFSET),__ATOMIC_ACQUIRE),__ATOMIC_RELEASE);
+	response = query (fd,url,FRAME_SHARED,true);
+	check (response.shared_frames > 0,"ring not used again once consumed");
+	check (is_same_response (&expected,&response),"results in the ring differ from those inline");
+	shared_frames += response.shared_frames;
+	free (response.data);
+	close (fd);
+
+	printf ("ring: %u frames placed in the ring match the %lu bytes of results inline\n",shared_frames,expected.length);
+	return EXIT_SUCCESS;
+}
@@ -6,11 +6,17 @@
 
 	server_port=12345;
 	server_host=localhost;
+	server_socket=/tmp/indexing.sock;
+
+	# test programs are built here, and their heapfiles kept, for the run
+	programs=`mktemp -d` || exit 1;
+	trap "rm -rf $programs" EXIT;
 
 	counter=0;
-	for f in NNx.http NNxy.http \
+	for f in NNx.http NNxy.http NNxyp.http \
 		SKYx.http SKYxy.http \
-		CP2.http CP3.http ;
+		CP2.http CP3.http CP2e.http CP3p.http \
+		KNNJ.http EXPLAIN.http SAMPLE.http PAGE.http PIPELINE.http ;
 	do
 		counter=`expr $counter + 1`;
 		echo "%% Processing request: $f";
@@ -26,6 +32,229 @@
 		fi
 	done
 
+	# kNN results are expected to be reported nearest first, up to
+	# the precision of the keys in the response
+	f=NNorder.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo "$server_response" | sed -n 's/.*"keys": \[\[\([^]]*\)\]\].*/\1/p' \
+		| awk -F, -v x=-75000000 -v y=42000000 '{ d = sqrt(($1-x)^2 + ($2-y)^2); if (NR > 1 && d < last - 1e-6*(-x+y)) unordered = 1; last = d; }
+			END { print (NR > 1 && !unordered); }'` -ne 1 ]]
+	then
+		echo "%% FAILURE - Neighbors not reported nearest first for request: `cat $f`";
+		exit 1;
+	fi
+
+	# A cap on pages below the height of the tree still descends to
+	# a leaf, so neighbors are found and their bound is finite
+	f=NNpages.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo "$server_response" | grep -c '"rid"'` -ne 25 || `echo $server_response | grep "factor of inf" | wc -l` -ne 0 ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+
+	# A repeated query is answered from the cache of responses, without
+	# reading again any of the pages of its heapfile from the disk
+	f=CACHE.http;
+	echo "%% Processing request: $f";
+	cat $f | nc -v $server_host $server_port > /dev/null || exit 1;
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "SUCCESS" | grep '"io_blocks": 0,' | wc -l` -ne 1 ]]
+	then
+		echo "%% FAILURE - Response not served from the cache for request: `cat $f`";
+		exit 1;
+	fi
+
+	# A distance join whose results spill to disk beyond a tiny limit
+	# on memory reports the same results in the same order as in memory
+	f=DJ2m.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "SUCCESS" | wc -l` -ne 1 \
+		|| `echo "$server_response" | grep '"rid"' | wc -l` -eq 0 \
+		|| "`echo "$server_response" | grep '"rid"'`" != "`cat DJ2.http | nc -v $server_host $server_port | grep '"rid"'`" ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+
+	# A count honors the offset and the limit, and it reads no more
+	# blocks than the page of results it counts
+	f=LIMIT.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	io_blocks=`echo "$server_response" | sed -n 's/.*"io_blocks": \([0-9]*\).*/\1/p'`;
+	f=COUNT.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "SUCCESS" | grep '"count": 25 }' | wc -l` -ne 1 \
+		|| `echo "$server_response" | sed -n 's/.*"io_blocks": \([0-9]*\).*/\1/p'` -gt $io_blocks ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+
+	# A prepared query executed with the values of another query
+	# reports as many records as that query does
+	f=PREPARE.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "SUCCESS" | wc -l` -ne 1 ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+	f=EXECUTE.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "SUCCESS" | wc -l` -ne 1 \
+		|| `echo "$server_response" | grep -c '"rid"'` -ne `cat CACHE.http | nc -v $server_host $server_port | grep -c '"rid"'` ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+
+	# Placeholders stand for values of keys only, and are reported
+	# as such anywhere else, e.g. for the limit of the results
+	f=PREPAREo.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "FAILURE" | wc -l` -ne 1 \
+		|| `echo $server_response | grep "placeholders are only allowed in keys" | wc -l` -ne 1 ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+
+	# Clients accepting binary get the schema right after the headers,
+	# and the results end with an empty block and a successful trailer
+	f=BINARY.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port | od -An -tx1 -v | tr -d ' \n'` || exit 1;
+	if [[ $server_response != *0a49445842* || $server_response != *00000000ffffffff00000000* ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+
+	# Large bodies are read in place; the records inserted in a heapfile
+	# of its own are all deleted again, which also removes the heapfile
+	for f in PUT DELETE;
+	do
+		echo "%% Processing request: $f of 20000 records";
+		body=`awk -v method=$f 'BEGIN {
+			printf "{\"heapfile\": \"TEST.b256.rtree\", \"%s\": [", method == "PUT" ? "data" : "keys";
+			for (i=0; i<20000; ++i) {
+				if (method == "PUT") printf "%s{\"key\": [%d,%d], \"object\": %d}", (i ? "," : ""), -75000000-i, 42000000+i, i;
+				else printf "%s[%d,%d]", (i ? "," : ""), -75000000-i, 42000000+i;
+			}
+			print "]}";
+		}'`;
+		server_response=`printf "$f / HTTP/1.0\nContent-Length: ${#body}\n\n%s" "$body" | nc -v $server_host $server_port` || exit 1;
+		if [[ `echo $server_response | grep "Successfully processed 20000 data entries out of 20000" | wc -l` -ne 1 ]]
+		then
+			echo "%% FAILURE - Testing failed with $f request of 20000 records";
+			exit 1;
+		fi
+	done
+
+	# Bodies beyond the size limit are rejected before being read
+	echo "%% Processing request: PUT of a body beyond the size limit";
+	server_response=`printf "PUT / HTTP/1.0\nContent-Length: 2000000000\n\n" | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "413 Payload Too Large" | wc -l` -ne 1 ]]
+	then
+		echo "%% FAILURE - Testing failed with PUT of a body beyond the size limit";
+		exit 1;
+	fi
+
+	# Binary records are bulk-loaded into a heapfile of their own, whose
+	# pages are written straight to disk and counted as blocks of I/O;
+	# deleting the records again removes the heapfile
+	echo "%% Processing request: POST of 20000 records in binary";
+	server_response=`{ printf "POST /BULK.b256.rtree/bulk HTTP/1.0\nContent-Length: %u\n\n" $((12+16*20000));
+		LC_ALL=C awk 'function le(n, bytes,   j) { for (j=0; j<bytes; ++j) { printf "%c", n%256; n = int(n/256); } }
+			function float_bits(v,   k) { for (k=0; 2^(k+1) <= v; ++k); return (k+127)*2^23 + (v-2^k)*2^(23-k); }
+			BEGIN {
+				printf "IDXB%c%c%c%c", 1, 0, 8, 4; le(2,4);
+				for (i=0; i<20000; ++i) { le(i,8); le(float_bits(1000+i),4); le(float_bits(3000000+7*i),4); }
+			}'; } | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "Successfully processed 20000 data entries out of 20000" | wc -l` -ne 1 \
+		|| `echo "$server_response" | sed -n 's/.*"io_blocks": \([0-9]*\).*/\1/p'` -le 1 ]]
+	then
+		echo "%% FAILURE - Testing failed with POST of 20000 records in binary";
+		exit 1;
+	fi
+	body=`awk 'BEGIN { printf "{\"heapfile\": \"BULK.b256.rtree\", \"keys\": ["; for (i=0; i<20000; ++i) printf "%s[%d,%d]", (i ? "," : ""), 1000+i, 3000000+7*i; print "]}"; }'`;
+	server_response=`printf "DELETE / HTTP/1.0\nContent-Length: ${#body}\n\n%s" "$body" | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "Successfully processed 20000 data entries out of 20000" | wc -l` -ne 1 ]]
+	then
+		echo "%% FAILURE - Testing failed with DELETE of 20000 records loaded in binary";
+		exit 1;
+	fi
+
+	# Co-located clients get the same binary results in frames over the
+	# Unix-domain socket, if the server was started with one at the path
+	# given (-s $server_socket)
+	if [[ -S $server_socket ]]
+	then
+		f=CACHE.http;
+		echo "%% Processing framed request: $f";
+		server_response=`sed -n 's/^GET \([^ ]*\) .*/\1/p' $f | tr -d '\n' | ./frame.sh $server_socket G` || exit 1;
+		if [[ $server_response != 49445842* || $server_response != *00000000ffffffff00000000* ]]
+		then
+			echo "%% FAILURE - Testing failed with framed request: `cat $f`";
+			exit 1;
+		fi
+
+		# Results placed in the shared ring are the same as those sent
+		# inline, and they are sent inline again while the ring is full
+		f=RING.http;
+		echo "%% Processing framed request in the shared ring: $f";
+		cc -std=gnu11 -iquote ../src -o $programs/ring ring.c -lrt 2> /dev/null || exit 1;
+		if ! sed -n 's/^GET \([^ ]*\) .*/\1/p' $f | $programs/ring $server_socket
+		then
+			echo "%% FAILURE - Testing failed with framed request in the shared ring: `cat $f`";
+			exit 1;
+		fi
+	else
+		echo "%% Skipping framed requests; no Unix-domain socket at $server_socket";
+	fi
+
+	# Statistics list the heapfiles accessed and the operators evaluated
+	f=STATSJ.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep '"heapfile":"[^"]*/USA.b256.rtree","tree_records":[1-9]' \
+		| grep '"operator":"range","count":[1-9]' | grep '"server":{"queue_depth":' | wc -l` -ne 1 ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+
+	# Analyzed queries report the rows they returned and the pages
+	# they visited on each level of the tree
+	f=EXPLAINA.http;
+	echo "%% Processing request: $f";
+	server_response=`cat $f | nc -v $server_host $server_port` || exit 1;
+	if [[ `echo $server_response | grep "SUCCESS" | grep '"analyze": { "rows": 25, "visits": \[[1-9]' | wc -l` -ne 1 ]]
+	then
+		echo "%% FAILURE - Testing failed with request: `cat $f`";
+		exit 1;
+	fi
+
+	# Programs linked with libindexing.so create, open, query and close
+	# heapfiles in-process through the entry points it exports alone
+	echo "%% Processing heapfile in-process through libindexing.so";
+	cc -std=gnu11 -iquote ../src -o $programs/library library.c -L../src -lindexing -Wl,-rpath,`cd ../src && pwd` -lpthread -lm -lrt 2> /dev/null || exit 1;
+	if ! $programs/library $programs/GRID.rtree 2> /dev/null
+	then
+		echo "%% FAILURE - Testing failed with heapfile in-process through libindexing.so";
+		exit 1;
+	fi
+
 	echo "%% SUCCESS!";
 
 